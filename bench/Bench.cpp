@@ -0,0 +1,509 @@
+// Microbenchmarks for Fwog's hot paths:
+// - pipeline_bind: Cmd::BindGraphicsPipeline alternating between pairs of pipelines that differ by increasing amounts
+// - framebuffer_cache: FramebufferCache::CreateOrGetCachedFramebuffer hits with 10 to 10k cached framebuffers
+// - sampler_cache: constructing a Fwog::Sampler from a SamplerState that is already cached
+// - vertex_array_cache: VertexArrayCache::Acquire and Release of cached layouts, as when creating and destroying pipelines
+// - texture_churn: creating and destroying a texture
+// - buffer_update: Buffer::UpdateData of various sizes
+// - draw: submitting draws, with and without state changes between them
+//
+// Each benchmark runs its operation in batches, doubling the batch size until a batch takes long enough to time
+// reliably, then reports the median of five batches. The GPU is waited on at the end of each batch so queued work is
+// not attributed to the next one. Draws are degenerate, so the draw benchmarks measure submission rather than
+// rasterization.
+//
+// Usage: fwog_bench [--filter <substring>] [--min-time <ms> = 100] [--csv]
+
+#include <Fwog/Buffer.h>
+#include <Fwog/Context.h>
+#include <Fwog/HeadlessContext.h>
+#include <Fwog/Pipeline.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Shader.h>
+#include <Fwog/Texture.h>
+#include <Fwog/detail/ContextState.h>
+#include <Fwog/detail/FramebufferCache.h>
+#include <Fwog/detail/PipelineManager.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <glad/gl.h>
+
+namespace
+{
+  constexpr const char* vertexSource = R"(
+#version 450 core
+void main() { gl_Position = vec4(0.0, 0.0, 0.0, 1.0); }
+)";
+
+  constexpr const char* vertexInputSource = R"(
+#version 450 core
+layout(location = 0) in vec3 a_pos;
+void main() { gl_Position = vec4(a_pos * 0.0, 1.0); }
+)";
+
+  constexpr const char* fragmentSource = R"(
+#version 450 core
+layout(location = 0) out vec4 o_color;
+void main() { o_color = vec4(1.0); }
+)";
+
+  constexpr const char* otherFragmentSource = R"(
+#version 450 core
+layout(location = 0) out vec4 o_color;
+void main() { o_color = vec4(0.5); }
+)";
+
+  // Keeps results of benchmarked operations alive so they are not optimized away
+  volatile uint64_t sink = 0;
+
+  class Random
+  {
+  public:
+    uint32_t Next(uint32_t bound)
+    {
+      state_ = state_ * 1664525u + 1013904223u;
+      return (state_ >> 8) % bound;
+    }
+
+  private:
+    uint32_t state_ = 12345;
+  };
+
+  struct Result
+  {
+    std::string name;
+    uint64_t batchSize;
+    double nsPerOp;
+    uint64_t bytesPerOp;
+  };
+
+  double Median(std::vector<double> samples)
+  {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+  }
+
+  class Runner
+  {
+  public:
+    Runner(std::string filter, double minTimeMs) : filter_(std::move(filter)), minTimeMs_(minTimeMs) {}
+
+    // Benchmarks that need expensive setup check this first, so filtered-out benchmarks can be skipped entirely
+    [[nodiscard]] bool Matches(const std::string& name) const
+    {
+      return filter_.empty() || name.find(filter_) != std::string::npos;
+    }
+
+    // Times func(n), which must perform n operations. bytesPerOp is used to report throughput, if nonzero.
+    template<class Func>
+    void Run(const std::string& name, Func func, uint64_t bytesPerOp = 0)
+    {
+      if (!Matches(name))
+      {
+        return;
+      }
+
+      auto time = [&func](uint64_t n)
+      {
+        auto start = std::chrono::steady_clock::now();
+        func(n);
+        glFinish();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      };
+
+      // The first batch can include one-time costs like the driver compiling shader variants, so it is not used to
+      // choose the batch size
+      time(1);
+      uint64_t batchSize = 1;
+      while (time(batchSize) < minTimeMs_ / 5 && batchSize < (uint64_t(1) << 30))
+      {
+        batchSize *= 2;
+      }
+
+      auto samples = std::vector<double>();
+      for (int i = 0; i < 5; i++)
+      {
+        samples.push_back(time(batchSize) * 1e6 / batchSize);
+      }
+
+      results_.push_back({name, batchSize, Median(samples), bytesPerOp});
+      std::fprintf(stderr, "  %s\n", name.c_str());
+    }
+
+    [[nodiscard]] const std::vector<Result>& Results() const
+    {
+      return results_;
+    }
+
+  private:
+    std::string filter_;
+    double minTimeMs_;
+    std::vector<Result> results_;
+  };
+
+  // Renders to a small offscreen target
+  struct Target
+  {
+    Fwog::Texture texture = Fwog::CreateTexture2D({64, 64}, Fwog::Format::R8G8B8A8_UNORM);
+    Fwog::RenderColorAttachment attachment{.texture = texture, .loadOp = Fwog::AttachmentLoadOp::DONT_CARE};
+    Fwog::RenderInfo renderInfo{.colorAttachments = {&attachment, 1}};
+  };
+
+  void BenchPipelineBind(Runner& runner, const Target& target)
+  {
+    auto vertexShader = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER, vertexSource);
+    auto fragmentShader = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER, fragmentSource);
+    auto otherFragmentShader = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER, otherFragmentSource);
+
+    auto opaque = Fwog::ColorBlendAttachmentState{};
+    auto translucent = Fwog::ColorBlendAttachmentState{
+      .blendEnable = true,
+      .srcColorBlendFactor = Fwog::BlendFactor::SRC_ALPHA,
+      .dstColorBlendFactor = Fwog::BlendFactor::ONE_MINUS_SRC_ALPHA,
+    };
+
+    const auto baseInfo = Fwog::GraphicsPipelineInfo{
+      .vertexShader = &vertexShader,
+      .fragmentShader = &fragmentShader,
+      .depthState = {.depthTestEnable = true, .depthWriteEnable = true, .depthCompareOp = Fwog::CompareOp::LESS},
+      .colorBlendState = {.attachments = {&opaque, 1}},
+    };
+
+    auto base = Fwog::GraphicsPipeline(baseInfo);
+
+    auto oneFieldInfo = baseInfo;
+    oneFieldInfo.rasterizationState.cullMode = Fwog::CullMode::NONE;
+    auto oneField = Fwog::GraphicsPipeline(oneFieldInfo);
+
+    auto manyFieldsInfo = baseInfo;
+    manyFieldsInfo.rasterizationState.cullMode = Fwog::CullMode::FRONT;
+    manyFieldsInfo.rasterizationState.polygonMode = Fwog::PolygonMode::LINE;
+    manyFieldsInfo.rasterizationState.depthBiasEnable = true;
+    manyFieldsInfo.depthState = {.depthTestEnable = true, .depthWriteEnable = false};
+    manyFieldsInfo.stencilState = {.stencilTestEnable = true};
+    manyFieldsInfo.colorBlendState.attachments = {&translucent, 1};
+    auto manyFields = Fwog::GraphicsPipeline(manyFieldsInfo);
+
+    auto programInfo = baseInfo;
+    programInfo.fragmentShader = &otherFragmentShader;
+    auto program = Fwog::GraphicsPipeline(programInfo);
+
+    auto bindPair = [&target](const Fwog::GraphicsPipeline& a, const Fwog::GraphicsPipeline& b)
+    {
+      return [&target, &a, &b](uint64_t n)
+      {
+        Fwog::Render(target.renderInfo,
+                     [&]
+                     {
+                       for (uint64_t i = 0; i < n; i++)
+                       {
+                         Fwog::Cmd::BindGraphicsPipeline(i % 2 == 0 ? a : b);
+                       }
+                     });
+      };
+    };
+
+    runner.Run("pipeline_bind/same", bindPair(base, base));
+    runner.Run("pipeline_bind/one_field", bindPair(base, oneField));
+    runner.Run("pipeline_bind/many_fields", bindPair(base, manyFields));
+    runner.Run("pipeline_bind/program", bindPair(base, program));
+  }
+
+  void BenchFramebufferCache(Runner& runner)
+  {
+    for (uint32_t count : {10u, 100u, 1000u, 10000u})
+    {
+      const auto name = "framebuffer_cache/hit/" + std::to_string(count);
+      if (!runner.Matches(name))
+      {
+        continue;
+      }
+
+      // Each framebuffer has a different attachment. A separate cache is used so the context's is not polluted.
+      auto cache = Fwog::detail::FramebufferCache();
+      auto textures = std::vector<Fwog::Texture>();
+      auto attachments = std::vector<Fwog::RenderColorAttachment>();
+      textures.reserve(count);
+      attachments.reserve(count);
+      for (uint32_t i = 0; i < count; i++)
+      {
+        const auto& texture = textures.emplace_back(Fwog::CreateTexture2D({1, 1}, Fwog::Format::R8G8B8A8_UNORM));
+        attachments.push_back({.texture = texture});
+      }
+
+      auto renderInfos = std::vector<Fwog::RenderInfo>();
+      for (const auto& attachment : attachments)
+      {
+        renderInfos.push_back({.colorAttachments = {&attachment, 1}});
+        cache.CreateOrGetCachedFramebuffer(renderInfos.back());
+      }
+
+      auto random = Random();
+      auto sequence = std::vector<uint32_t>(4096);
+      std::generate(sequence.begin(), sequence.end(), [&] { return random.Next(count); });
+
+      runner.Run(name,
+                 [&](uint64_t n)
+                 {
+                   for (uint64_t i = 0; i < n; i++)
+                   {
+                     sink = sink + cache.CreateOrGetCachedFramebuffer(renderInfos[sequence[i % sequence.size()]]);
+                   }
+                 });
+    }
+  }
+
+  void BenchSamplerCache(Runner& runner)
+  {
+    for (uint32_t count : {16u, 256u})
+    {
+      auto states = std::vector<Fwog::SamplerState>(count);
+      for (uint32_t i = 0; i < count; i++)
+      {
+        states[i].lodBias = static_cast<float>(i) / 16;
+        states[i].minFilter = i % 2 == 0 ? Fwog::Filter::LINEAR : Fwog::Filter::NEAREST;
+        states[i].addressModeU = i % 3 == 0 ? Fwog::AddressMode::REPEAT : Fwog::AddressMode::CLAMP_TO_EDGE;
+      }
+
+      runner.Run("sampler_cache/hit/" + std::to_string(count),
+                 [&](uint64_t n)
+                 {
+                   for (uint64_t i = 0; i < n; i++)
+                   {
+                     sink = sink + Fwog::Sampler(states[i % count]).Handle();
+                   }
+                 });
+    }
+  }
+
+  void BenchVertexArrayCache(Runner& runner)
+  {
+    for (uint32_t count : {1u, 64u})
+    {
+      auto inputStates = std::vector<Fwog::detail::VertexInputStateOwning>(count);
+      for (uint32_t i = 0; i < count; i++)
+      {
+        inputStates[i].vertexBindingDescriptions = {
+          {.location = 0, .binding = 0, .format = Fwog::Format::R32G32B32_FLOAT, .offset = 0},
+          {.location = 1, .binding = 0, .format = Fwog::Format::R32G32_FLOAT, .offset = 12 + 4 * i},
+        };
+      }
+
+      // Hold a reference to each layout so the loop never destroys its VAO
+      auto& cache = Fwog::detail::context->vaoCache;
+      for (const auto& inputState : inputStates)
+      {
+        cache.Acquire(inputState);
+      }
+
+      runner.Run("vertex_array_cache/hit/" + std::to_string(count),
+                 [&](uint64_t n)
+                 {
+                   for (uint64_t i = 0; i < n; i++)
+                   {
+                     sink = sink + cache.Acquire(inputStates[i % count]).id;
+                     cache.Release(inputStates[i % count]);
+                   }
+                 });
+
+      for (const auto& inputState : inputStates)
+      {
+        cache.Release(inputState);
+      }
+    }
+  }
+
+  void BenchTextureChurn(Runner& runner)
+  {
+    for (uint32_t size : {64u, 1024u})
+    {
+      runner.Run("texture_churn/" + std::to_string(size) + "x" + std::to_string(size),
+                 [size](uint64_t n)
+                 {
+                   for (uint64_t i = 0; i < n; i++)
+                   {
+                     auto texture = Fwog::CreateTexture2D({size, size}, Fwog::Format::R8G8B8A8_UNORM);
+                     sink = sink + texture.Handle();
+                   }
+                 });
+    }
+  }
+
+  void BenchBufferUpdate(Runner& runner)
+  {
+    for (uint64_t size : {uint64_t(256), uint64_t(64) << 10, uint64_t(4) << 20})
+    {
+      auto buffer = Fwog::Buffer(size, Fwog::BufferStorageFlag::DYNAMIC_STORAGE);
+      auto data = std::vector<std::byte>(size, std::byte{1});
+
+      runner.Run("buffer_update/" + std::to_string(size),
+                 [&](uint64_t n)
+                 {
+                   for (uint64_t i = 0; i < n; i++)
+                   {
+                     buffer.UpdateData(std::span<const std::byte>(data));
+                   }
+                 },
+                 size);
+    }
+  }
+
+  void BenchDraw(Runner& runner, const Target& target)
+  {
+    auto vertexShader = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER, vertexSource);
+    auto vertexInputShader = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER, vertexInputSource);
+    auto fragmentShader = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER, fragmentSource);
+    auto otherFragmentShader = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER, otherFragmentSource);
+
+    auto pipeline = Fwog::GraphicsPipeline({.vertexShader = &vertexShader, .fragmentShader = &fragmentShader});
+    auto otherPipeline =
+      Fwog::GraphicsPipeline({.vertexShader = &vertexShader, .fragmentShader = &otherFragmentShader});
+
+    const auto binding = Fwog::VertexInputBindingDescription{
+      .location = 0,
+      .binding = 0,
+      .format = Fwog::Format::R32G32B32_FLOAT,
+      .offset = 0,
+    };
+    auto vertexInputPipeline = Fwog::GraphicsPipeline({
+      .vertexShader = &vertexInputShader,
+      .fragmentShader = &fragmentShader,
+      .vertexInputState = {{&binding, 1}},
+    });
+
+    const float vertices[9] = {};
+    auto vertexBuffers = std::vector<Fwog::Buffer>();
+    vertexBuffers.emplace_back(Fwog::TriviallyCopyableByteSpan(vertices));
+    vertexBuffers.emplace_back(Fwog::TriviallyCopyableByteSpan(vertices));
+
+    runner.Run("draw/same_state",
+               [&](uint64_t n)
+               {
+                 Fwog::Render(target.renderInfo,
+                              [&]
+                              {
+                                Fwog::Cmd::BindGraphicsPipeline(pipeline);
+                                for (uint64_t i = 0; i < n; i++)
+                                {
+                                  Fwog::Cmd::Draw(3, 1, 0, 0);
+                                }
+                              });
+               });
+
+    runner.Run("draw/vertex_buffer_switch",
+               [&](uint64_t n)
+               {
+                 Fwog::Render(target.renderInfo,
+                              [&]
+                              {
+                                Fwog::Cmd::BindGraphicsPipeline(vertexInputPipeline);
+                                for (uint64_t i = 0; i < n; i++)
+                                {
+                                  Fwog::Cmd::BindVertexBuffer(0, vertexBuffers[i % 2], 0, sizeof(float) * 3);
+                                  Fwog::Cmd::Draw(3, 1, 0, 0);
+                                }
+                              });
+               });
+
+    runner.Run("draw/pipeline_switch",
+               [&](uint64_t n)
+               {
+                 Fwog::Render(target.renderInfo,
+                              [&]
+                              {
+                                for (uint64_t i = 0; i < n; i++)
+                                {
+                                  Fwog::Cmd::BindGraphicsPipeline(i % 2 == 0 ? pipeline : otherPipeline);
+                                  Fwog::Cmd::Draw(3, 1, 0, 0);
+                                }
+                              });
+               });
+  }
+} // namespace
+
+int main(int argc, char** argv)
+{
+  auto filter = std::string();
+  double minTimeMs = 100;
+  bool csv = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--csv") == 0)
+    {
+      csv = true;
+    }
+    else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+    {
+      filter = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+    {
+      minTimeMs = std::max(std::strtod(argv[++i], nullptr), 1.0);
+    }
+    else
+    {
+      std::fprintf(stderr, "Usage: %s [--filter <substring>] [--min-time <ms> = 100] [--csv]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  auto headlessContext = Fwog::HeadlessContext();
+  Fwog::Initialize();
+
+  {
+    auto runner = Runner(filter, minTimeMs);
+    const auto target = Target();
+
+    // Progress is written to stderr, so stdout only contains the results
+    BenchPipelineBind(runner, target);
+    BenchFramebufferCache(runner);
+    BenchSamplerCache(runner);
+    BenchVertexArrayCache(runner);
+    BenchTextureChurn(runner);
+    BenchBufferUpdate(runner);
+    BenchDraw(runner, target);
+
+    if (csv)
+    {
+      std::printf("benchmark,batch_size,ns_per_op,ops_per_second,bytes_per_second\n");
+      for (const auto& result : runner.Results())
+      {
+        std::printf("%s,%llu,%.3f,%.1f,",
+                    result.name.c_str(),
+                    static_cast<unsigned long long>(result.batchSize),
+                    result.nsPerOp,
+                    1e9 / result.nsPerOp);
+        if (result.bytesPerOp > 0)
+        {
+          std::printf("%.1f", result.bytesPerOp * 1e9 / result.nsPerOp);
+        }
+        std::printf("\n");
+      }
+    }
+    else
+    {
+      std::printf("Renderer: %s\n\n", Fwog::GetDeviceProperties().renderer.data());
+      std::printf("%-32s %14s %16s %14s\n", "benchmark", "ns/op", "ops/s", "MiB/s");
+      for (const auto& result : runner.Results())
+      {
+        std::printf("%-32s %14.2f %16.0f", result.name.c_str(), result.nsPerOp, 1e9 / result.nsPerOp);
+        if (result.bytesPerOp > 0)
+        {
+          std::printf(" %14.1f", result.bytesPerOp * 1e9 / result.nsPerOp / (1 << 20));
+        }
+        std::printf("\n");
+      }
+    }
+  }
+
+  Fwog::Terminate();
+  return 0;
+}
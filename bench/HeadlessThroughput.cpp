@@ -0,0 +1,155 @@
+// Measures how many frames per second can be rendered and read back without a window, using a HeadlessContext and an
+// OffscreenSwapchain. Each frame shades every pixel of the swapchain with a procedural pattern and is read back to
+// memory, as a batch renderer would before encoding the frames.
+//
+// The same frames are rendered with different numbers of swapchain images:
+// - 1 image: each frame waits for its readback before the next one is rendered, like rendering and calling glReadPixels
+// - 2 and 3 images: readbacks are pipelined, so the GPU renders the next frames while earlier ones are read back
+// A run without readback shows the cost of rendering alone.
+//
+// Usage: fwog_bench_headless_throughput [frames = 200] [width = 1280] [height = 720]
+
+#include <Fwog/Buffer.h>
+#include <Fwog/Context.h>
+#include <Fwog/HeadlessContext.h>
+#include <Fwog/OffscreenSwapchain.h>
+#include <Fwog/Pipeline.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Shader.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+
+#include <glad/gl.h>
+
+namespace
+{
+  constexpr const char* vertexSource = R"(
+#version 450 core
+layout(location = 0) out vec2 v_uv;
+void main()
+{
+  vec2 pos = vec2(gl_VertexID == 1 ? 3.0 : -1.0, gl_VertexID == 2 ? 3.0 : -1.0);
+  v_uv = pos * 0.5 + 0.5;
+  gl_Position = vec4(pos, 0.0, 1.0);
+}
+)";
+
+  constexpr const char* fragmentSource = R"(
+#version 450 core
+layout(location = 0) in vec2 v_uv;
+layout(location = 0) out vec4 o_color;
+layout(binding = 0, std140) uniform Frame { float u_time; };
+void main()
+{
+  vec2 p = v_uv * 8.0;
+  float v = 0.0;
+  for (int i = 1; i <= 8; i++)
+  {
+    v += sin(p.x * float(i) + u_time) * cos(p.y * float(i) - u_time) / float(i);
+  }
+  o_color = vec4(0.5 + 0.5 * sin(v + vec3(0.0, 2.0, 4.0)), 1.0);
+}
+)";
+
+  struct Result
+  {
+    double framesPerSecond;
+    uint64_t checksum;
+  };
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const uint32_t frameCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 200;
+  const uint32_t width = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 1280;
+  const uint32_t height = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 720;
+
+  auto headlessContext = Fwog::HeadlessContext();
+  Fwog::Initialize();
+
+  {
+    auto vertexShader = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER, vertexSource);
+    auto fragmentShader = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER, fragmentSource);
+    auto pipeline = Fwog::GraphicsPipeline({.vertexShader = &vertexShader, .fragmentShader = &fragmentShader});
+    auto frameUniforms = Fwog::TypedBuffer<float>(Fwog::BufferStorageFlag::DYNAMIC_STORAGE);
+
+    // Renders frameCount frames and returns the rate at which they were rendered and delivered
+    auto run = [&](uint32_t imageCount, bool readback)
+    {
+      uint64_t checksum = 0;
+      uint64_t framesDelivered = 0;
+      auto swapchain = std::optional<Fwog::OffscreenSwapchain>();
+      swapchain.emplace(Fwog::OffscreenSwapchainCreateInfo{
+        .extent = {width, height},
+        .depthStencilFormat = std::nullopt,
+        .imageCount = imageCount,
+        .onFrameReady = !readback ? nullptr :
+                                    std::function<void(const Fwog::OffscreenFrame&)>(
+                                      [&](const Fwog::OffscreenFrame& frame)
+                                      {
+                                        // Touch one texel per row, like a consumer copying the frame out would
+                                        for (uint32_t y = 0; y < frame.extent.height; y++)
+                                        {
+                                          checksum += static_cast<uint8_t>(frame.pixels[y * frame.extent.width * 4]);
+                                        }
+                                        framesDelivered++;
+                                      }),
+      });
+
+      auto start = std::chrono::steady_clock::now();
+      for (uint32_t i = 0; i < frameCount; i++)
+      {
+        frameUniforms.UpdateData(i * 0.05f);
+        Fwog::RenderToSwapchain(
+          {
+            .viewport = {.drawRect = {{0, 0}, {width, height}}},
+            .colorLoadOp = Fwog::AttachmentLoadOp::DONT_CARE,
+            .depthLoadOp = Fwog::AttachmentLoadOp::DONT_CARE,
+            .stencilLoadOp = Fwog::AttachmentLoadOp::DONT_CARE,
+          },
+          [&]
+          {
+            Fwog::Cmd::BindGraphicsPipeline(pipeline);
+            Fwog::Cmd::BindUniformBuffer(0, frameUniforms);
+            Fwog::Cmd::Draw(3, 1, 0, 0);
+          });
+        swapchain->Present();
+      }
+      swapchain->Flush();
+      glFinish();
+      const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      if (readback && framesDelivered != frameCount)
+      {
+        std::fprintf(stderr, "Expected %u frames to be delivered, got %llu\n", frameCount, (unsigned long long)framesDelivered);
+        std::exit(1);
+      }
+      return Result{frameCount / seconds, checksum};
+    };
+
+    std::printf("Renderer: %s\n", Fwog::GetDeviceProperties().renderer.data());
+    std::printf("Frames: %u, resolution: %ux%u\n\n", frameCount, width, height);
+    std::printf("%-24s %12s %12s\n", "mode", "frames/s", "checksum");
+
+    // Warm up shader variants and allocations
+    run(1, true);
+
+    const auto noReadback = run(3, false);
+    std::printf("%-24s %12.1f %12s\n", "no readback", noReadback.framesPerSecond, "-");
+    for (uint32_t imageCount : {1u, 2u, 3u})
+    {
+      const auto result = run(imageCount, true);
+      std::printf("%-24s %12.1f %12llu\n",
+                  imageCount == 1 ? "readback, 1 image" : imageCount == 2 ? "readback, 2 images" : "readback, 3 images",
+                  result.framesPerSecond,
+                  static_cast<unsigned long long>(result.checksum));
+    }
+  }
+
+  Fwog::Terminate();
+  return 0;
+}
@@ -0,0 +1,270 @@
+// Measures how command recording scales when a scene's draws are split into CommandBuffer segments that are recorded
+// on worker threads, then executed in order on the GL thread.
+//
+// Usage: fwog_bench_parallel_recording [drawCount = 100000] [iterations = 5]
+
+#include <Fwog/Buffer.h>
+#include <Fwog/CommandBuffer.h>
+#include <Fwog/Context.h>
+#include <Fwog/HeadlessContext.h>
+#include <Fwog/Pipeline.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Shader.h>
+#include <Fwog/Texture.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <glad/gl.h>
+
+namespace
+{
+  constexpr const char* vertexSource = R"(
+#version 450 core
+layout(location = 0) in vec3 a_pos;
+layout(binding = 0, std140) uniform ObjectUniforms { mat4 u_model; };
+void main() { gl_Position = u_model * vec4(a_pos, 1.0); }
+)";
+
+  constexpr const char* fragmentSource = R"(
+#version 450 core
+layout(binding = 0) uniform sampler2D s_albedo;
+layout(location = 0) out vec4 o_color;
+void main() { o_color = texture(s_albedo, vec2(0.5)); }
+)";
+
+  constexpr uint32_t meshCount = 16;
+  constexpr uint32_t materialCount = 8;
+  constexpr uint32_t indicesPerMesh = 36;
+  constexpr uint32_t verticesPerMesh = 24;
+
+  struct Mesh
+  {
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+  };
+
+  struct Object
+  {
+    uint32_t mesh;
+    uint32_t material;
+  };
+
+  // Everything needed to record the synthetic scene. Recording only reads from this, so it can be shared by threads.
+  struct Scene
+  {
+    std::optional<Fwog::GraphicsPipeline> pipeline;
+    std::optional<Fwog::Buffer> vertexBuffer;
+    std::optional<Fwog::Buffer> indexBuffer;
+    std::optional<Fwog::Buffer> objectUniforms;
+    std::vector<Fwog::Texture> materials;
+    std::optional<Fwog::Sampler> sampler;
+    std::vector<Mesh> meshes;
+    std::vector<Object> objects;
+    uint64_t objectUniformStride{};
+  };
+
+  Scene CreateScene(uint32_t drawCount)
+  {
+    Scene scene;
+
+    auto vertexShader = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER, vertexSource);
+    auto fragmentShader = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER, fragmentSource);
+    auto binding = Fwog::VertexInputBindingDescription{
+      .location = 0,
+      .binding = 0,
+      .format = Fwog::Format::R32G32B32_FLOAT,
+      .offset = 0,
+    };
+    auto colorAttachment = Fwog::ColorBlendAttachmentState{};
+    scene.pipeline.emplace(Fwog::GraphicsPipelineInfo{
+      .vertexShader = &vertexShader,
+      .fragmentShader = &fragmentShader,
+      .vertexInputState = {{&binding, 1}},
+      .colorBlendState = {.attachments = {&colorAttachment, 1}},
+    });
+
+    // The contents of the geometry don't matter, only the number of commands does
+    auto vertices = std::vector<float>(meshCount * verticesPerMesh * 3, 0.0f);
+    auto indices = std::vector<uint32_t>(meshCount * indicesPerMesh);
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+      indices[i] = static_cast<uint32_t>(i % verticesPerMesh);
+    }
+    scene.vertexBuffer.emplace(std::span<const float>(vertices));
+    scene.indexBuffer.emplace(std::span<const uint32_t>(indices));
+
+    for (uint32_t i = 0; i < meshCount; i++)
+    {
+      scene.meshes.push_back({i * indicesPerMesh, static_cast<int32_t>(i * verticesPerMesh)});
+    }
+
+    for (uint32_t i = 0; i < materialCount; i++)
+    {
+      scene.materials.push_back(Fwog::CreateTexture2D({1, 1}, Fwog::Format::R8G8B8A8_UNORM));
+    }
+    scene.sampler.emplace(Fwog::SamplerState{});
+
+    const auto alignment = static_cast<uint64_t>(Fwog::GetDeviceProperties().limits.uniformBufferOffsetAlignment);
+    scene.objectUniformStride = (64 + alignment - 1) / alignment * alignment;
+    scene.objectUniforms.emplace(scene.objectUniformStride * drawCount);
+
+    // Deterministic pseudo-random mesh and material assignment
+    uint32_t state = 12345;
+    auto next = [&state]
+    {
+      state = state * 1664525u + 1013904223u;
+      return state >> 8;
+    };
+    for (uint32_t i = 0; i < drawCount; i++)
+    {
+      scene.objects.push_back({next() % meshCount, next() % materialCount});
+    }
+
+    return scene;
+  }
+
+  // Records draws [first, last) into a segment. Each segment starts by binding all the state it needs, so segments
+  // can be executed in any order, though they are executed in order here.
+  void RecordSegment(const Scene& scene, Fwog::CommandBuffer& commandBuffer, size_t first, size_t last)
+  {
+    commandBuffer.Reset();
+    commandBuffer.BindGraphicsPipeline(*scene.pipeline);
+    commandBuffer.BindVertexBuffer(0, *scene.vertexBuffer, 0, 3 * sizeof(float));
+    commandBuffer.BindIndexBuffer(*scene.indexBuffer, Fwog::IndexType::UNSIGNED_INT);
+
+    for (size_t i = first; i < last; i++)
+    {
+      const auto& object = scene.objects[i];
+      const auto& mesh = scene.meshes[object.mesh];
+      commandBuffer.BindUniformBuffer(0, *scene.objectUniforms, i * scene.objectUniformStride, 64);
+      commandBuffer.BindSampledImage(0, scene.materials[object.material], *scene.sampler);
+      commandBuffer.DrawIndexed(indicesPerMesh, 1, mesh.firstIndex, mesh.vertexOffset, 0);
+    }
+  }
+
+  // The same commands as RecordSegment, but issued directly on the GL thread
+  void DrawImmediate(const Scene& scene)
+  {
+    Fwog::Cmd::BindGraphicsPipeline(*scene.pipeline);
+    Fwog::Cmd::BindVertexBuffer(0, *scene.vertexBuffer, 0, 3 * sizeof(float));
+    Fwog::Cmd::BindIndexBuffer(*scene.indexBuffer, Fwog::IndexType::UNSIGNED_INT);
+
+    for (size_t i = 0; i < scene.objects.size(); i++)
+    {
+      const auto& object = scene.objects[i];
+      const auto& mesh = scene.meshes[object.mesh];
+      Fwog::Cmd::BindUniformBuffer(0, *scene.objectUniforms, i * scene.objectUniformStride, 64);
+      Fwog::Cmd::BindSampledImage(0, scene.materials[object.material], *scene.sampler);
+      Fwog::Cmd::DrawIndexed(indicesPerMesh, 1, mesh.firstIndex, mesh.vertexOffset, 0);
+    }
+  }
+
+  double Median(std::vector<double> samples)
+  {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+  }
+
+  template<class Func>
+  double TimeMs(Func func)
+  {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const uint32_t drawCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 100'000;
+  const uint32_t iterations = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 5;
+
+  auto headlessContext = Fwog::HeadlessContext();
+  Fwog::Initialize();
+
+  {
+    auto scene = CreateScene(drawCount);
+    auto target = Fwog::CreateTexture2D({64, 64}, Fwog::Format::R8G8B8A8_UNORM);
+    auto colorAttachment = Fwog::RenderColorAttachment{.texture = target, .loadOp = Fwog::AttachmentLoadOp::DONT_CARE};
+    auto renderInfo = Fwog::RenderInfo{.colorAttachments = {&colorAttachment, 1}};
+
+    std::printf("Renderer: %s\n", Fwog::GetDeviceProperties().renderer.data());
+    std::printf("Draws: %u, iterations: %u, hardware threads: %u\n\n",
+                drawCount,
+                iterations,
+                std::thread::hardware_concurrency());
+
+    // Baseline: calling Cmd:: functions directly on the GL thread
+    auto immediateSamples = std::vector<double>();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+      immediateSamples.push_back(TimeMs([&] { Fwog::Render(renderInfo, [&] { DrawImmediate(scene); }); }));
+      glFinish();
+    }
+    const double immediateMs = Median(immediateSamples);
+    std::printf("Immediate Cmd:: submission: %8.2f ms (%6.2f M draws/s)\n\n", immediateMs, drawCount / immediateMs / 1e3);
+
+    auto threadCounts = std::vector<uint32_t>{1, 2, 4, 8};
+    if (auto hw = std::thread::hardware_concurrency(); hw > 8)
+    {
+      threadCounts.push_back(hw);
+    }
+
+    std::printf("%8s %14s %14s %10s %14s\n", "threads", "record (ms)", "M draws/s", "speedup", "execute (ms)");
+
+    double singleThreadRecordMs = 0;
+    for (uint32_t threadCount : threadCounts)
+    {
+      auto segments = std::vector<Fwog::CommandBuffer>(threadCount);
+      auto recordSamples = std::vector<double>();
+      auto executeSamples = std::vector<double>();
+
+      for (uint32_t i = 0; i < iterations; i++)
+      {
+        recordSamples.push_back(TimeMs(
+          [&]
+          {
+            auto threads = std::vector<std::thread>();
+            for (uint32_t t = 0; t < threadCount; t++)
+            {
+              const size_t first = size_t(drawCount) * t / threadCount;
+              const size_t last = size_t(drawCount) * (t + 1) / threadCount;
+              threads.emplace_back([&, t, first, last] { RecordSegment(scene, segments[t], first, last); });
+            }
+            for (auto& thread : threads)
+            {
+              thread.join();
+            }
+          }));
+
+        executeSamples.push_back(
+          TimeMs([&] { Fwog::Render(renderInfo, [&] { Fwog::Cmd::ExecuteCommandBuffers(segments); }); }));
+        glFinish();
+      }
+
+      const double recordMs = Median(recordSamples);
+      if (threadCount == 1)
+      {
+        singleThreadRecordMs = recordMs;
+      }
+
+      std::printf("%8u %14.2f %14.2f %9.2fx %14.2f\n",
+                  threadCount,
+                  recordMs,
+                  drawCount / recordMs / 1e3,
+                  singleThreadRecordMs / recordMs,
+                  Median(executeSamples));
+    }
+  }
+
+  Fwog::Terminate();
+  return 0;
+}
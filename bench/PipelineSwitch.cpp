@@ -0,0 +1,363 @@
+// Measures the cost of switching between graphics pipelines.
+//
+// Two sets of pipelines are used: one where every fixed-function field is random, and one where pipelines are
+// variations of a common state that differ in one or two fields (closer to a real renderer). For each set, a sequence
+// of random pipeline pairs is switched between in three ways:
+// - field-wise: comparing every field of the two pipelines' info, as BindGraphicsPipeline did before pipelines were
+//   packed into state blocks
+// - packed: diffing the pipelines' packed state blocks
+// - bind: calling Cmd::BindGraphicsPipeline, which includes the cost of the GL calls that are emitted
+//
+// Usage: fwog_bench_pipeline_switch [switchCount = 1000000]
+
+#include <Fwog/Context.h>
+#include <Fwog/HeadlessContext.h>
+#include <Fwog/Pipeline.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Shader.h>
+#include <Fwog/Texture.h>
+#include <Fwog/detail/PipelineManager.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <glad/gl.h>
+
+namespace
+{
+  constexpr const char* vertexSource = R"(
+#version 450 core
+void main() { gl_Position = vec4(0.0, 0.0, 0.0, 1.0); }
+)";
+
+  constexpr const char* fragmentSource = R"(
+#version 450 core
+layout(location = 0) out vec4 o_color;
+void main() { o_color = vec4(1.0); }
+)";
+
+  constexpr uint32_t pipelineCount = 64;
+
+  class Random
+  {
+  public:
+    uint32_t Next(uint32_t bound)
+    {
+      state_ = state_ * 1664525u + 1013904223u;
+      return (state_ >> 8) % bound;
+    }
+
+    bool Bool()
+    {
+      return Next(2) == 1;
+    }
+
+  private:
+    uint32_t state_ = 12345;
+  };
+
+  // Storage for the spans in GraphicsPipelineInfo
+  struct PipelineDesc
+  {
+    Fwog::GraphicsPipelineInfo info{};
+    std::vector<Fwog::ColorBlendAttachmentState> attachments;
+  };
+
+  void Randomize(Random& random, PipelineDesc& desc)
+  {
+    auto& info = desc.info;
+    info.inputAssemblyState.primitiveRestartEnable = random.Bool();
+    info.rasterizationState = {
+      .depthClampEnable = random.Bool(),
+      .polygonMode = static_cast<Fwog::PolygonMode>(random.Next(3)),
+      .cullMode = static_cast<Fwog::CullMode>(random.Next(4)),
+      .frontFace = static_cast<Fwog::FrontFace>(random.Next(2)),
+      .depthBiasEnable = random.Bool(),
+      .depthBiasConstantFactor = static_cast<float>(random.Next(4)),
+      .depthBiasSlopeFactor = static_cast<float>(random.Next(4)),
+      .lineWidth = 1,
+      .pointSize = static_cast<float>(1 + random.Next(4)),
+    };
+    info.multisampleState = {
+      .sampleShadingEnable = random.Bool(),
+      .minSampleShading = random.Bool() ? 1.0f : 0.5f,
+      .sampleMask = random.Bool() ? 0xFFFFFFFF : 0xF,
+      .alphaToCoverageEnable = random.Bool(),
+      .alphaToOneEnable = random.Bool(),
+    };
+    info.depthState = {
+      .depthTestEnable = random.Bool(),
+      .depthWriteEnable = random.Bool(),
+      .depthCompareOp = static_cast<Fwog::CompareOp>(random.Next(8)),
+    };
+    auto randomStencilOpState = [&random]
+    {
+      return Fwog::StencilOpState{
+        .passOp = static_cast<Fwog::StencilOp>(random.Next(8)),
+        .failOp = static_cast<Fwog::StencilOp>(random.Next(8)),
+        .depthFailOp = static_cast<Fwog::StencilOp>(random.Next(8)),
+        .compareOp = static_cast<Fwog::CompareOp>(random.Next(8)),
+        .compareMask = random.Next(256),
+        .writeMask = random.Next(256),
+        .reference = random.Next(256),
+      };
+    };
+    info.stencilState = {
+      .stencilTestEnable = random.Bool(),
+      .front = randomStencilOpState(),
+      .back = randomStencilOpState(),
+    };
+
+    desc.attachments.resize(1 + random.Next(3));
+    for (auto& attachment : desc.attachments)
+    {
+      attachment = {
+        .blendEnable = random.Bool(),
+        .srcColorBlendFactor = static_cast<Fwog::BlendFactor>(random.Next(15)),
+        .dstColorBlendFactor = static_cast<Fwog::BlendFactor>(random.Next(15)),
+        .colorBlendOp = static_cast<Fwog::BlendOp>(random.Next(5)),
+        .srcAlphaBlendFactor = static_cast<Fwog::BlendFactor>(random.Next(15)),
+        .dstAlphaBlendFactor = static_cast<Fwog::BlendFactor>(random.Next(15)),
+        .alphaBlendOp = static_cast<Fwog::BlendOp>(random.Next(5)),
+        .colorWriteMask = Fwog::ColorComponentFlags(random.Next(16)),
+      };
+    }
+    info.colorBlendState.logicOpEnable = random.Bool();
+    info.colorBlendState.logicOp = static_cast<Fwog::LogicOp>(random.Next(16));
+    for (auto& constant : info.colorBlendState.blendConstants)
+    {
+      constant = random.Next(2) * 0.5f;
+    }
+  }
+
+  // Changes one or two fields of a typical opaque pipeline
+  void Vary(Random& random, PipelineDesc& desc)
+  {
+    auto& info = desc.info;
+    info.depthState = {.depthTestEnable = true, .depthWriteEnable = true, .depthCompareOp = Fwog::CompareOp::LESS};
+    desc.attachments = {Fwog::ColorBlendAttachmentState{}};
+
+    const uint32_t changes = 1 + random.Next(2);
+    for (uint32_t i = 0; i < changes; i++)
+    {
+      switch (random.Next(6))
+      {
+      case 0: info.rasterizationState.cullMode = static_cast<Fwog::CullMode>(random.Next(4)); break;
+      case 1: info.rasterizationState.polygonMode = static_cast<Fwog::PolygonMode>(random.Next(3)); break;
+      case 2: info.depthState.depthWriteEnable = random.Bool(); break;
+      case 3: info.depthState.depthCompareOp = static_cast<Fwog::CompareOp>(random.Next(8)); break;
+      case 4: info.rasterizationState.depthBiasEnable = random.Bool(); break;
+      case 5:
+        desc.attachments[0].blendEnable = true;
+        desc.attachments[0].srcColorBlendFactor = Fwog::BlendFactor::SRC_ALPHA;
+        desc.attachments[0].dstColorBlendFactor = Fwog::BlendFactor::ONE_MINUS_SRC_ALPHA;
+        break;
+      }
+    }
+  }
+
+  // The comparisons BindGraphicsPipeline made before pipelines had packed state blocks. Returns the number of GL call
+  // groups that would be emitted.
+  uint32_t FieldwiseDiff(const Fwog::detail::GraphicsPipelineInfoOwning& next,
+                         const Fwog::detail::GraphicsPipelineInfoOwning& last)
+  {
+    uint32_t dirty = 0;
+    auto check = [&dirty](bool changed) { dirty += changed; };
+
+    check(next.inputAssemblyState.primitiveRestartEnable != last.inputAssemblyState.primitiveRestartEnable);
+    if (next.tessellationState.patchControlPoints > 0)
+    {
+      check(next.tessellationState.patchControlPoints != last.tessellationState.patchControlPoints);
+    }
+
+    const auto& rs = next.rasterizationState;
+    const auto& lrs = last.rasterizationState;
+    check(rs.depthClampEnable != lrs.depthClampEnable);
+    check(rs.polygonMode != lrs.polygonMode);
+    check(rs.cullMode != lrs.cullMode);
+    check(rs.frontFace != lrs.frontFace);
+    check(rs.depthBiasEnable != lrs.depthBiasEnable);
+    check(rs.depthBiasSlopeFactor != lrs.depthBiasSlopeFactor ||
+          rs.depthBiasConstantFactor != lrs.depthBiasConstantFactor);
+    check(rs.lineWidth != lrs.lineWidth);
+    check(rs.pointSize != lrs.pointSize);
+
+    const auto& ms = next.multisampleState;
+    const auto& lms = last.multisampleState;
+    check(ms.sampleShadingEnable != lms.sampleShadingEnable);
+    check(ms.minSampleShading != lms.minSampleShading);
+    check(ms.sampleMask != lms.sampleMask);
+    check(ms.alphaToCoverageEnable != lms.alphaToCoverageEnable);
+    check(ms.alphaToOneEnable != lms.alphaToOneEnable);
+
+    const auto& ds = next.depthState;
+    const auto& lds = last.depthState;
+    check(ds.depthTestEnable != lds.depthTestEnable);
+    if (ds.depthTestEnable)
+    {
+      check(ds.depthWriteEnable != lds.depthWriteEnable);
+      check(ds.depthCompareOp != lds.depthCompareOp);
+    }
+
+    const auto& ss = next.stencilState;
+    const auto& lss = last.stencilState;
+    check(ss.stencilTestEnable != lss.stencilTestEnable);
+    if (ss.stencilTestEnable)
+    {
+      check(!lss.stencilTestEnable || ss.front != lss.front);
+      check(!lss.stencilTestEnable || ss.back != lss.back);
+    }
+
+    const auto& cb = next.colorBlendState;
+    const auto& lcb = last.colorBlendState;
+    if (cb.logicOpEnable != lcb.logicOpEnable)
+    {
+      check(true);
+      check(!lcb.logicOpEnable || (cb.logicOpEnable && cb.logicOp != lcb.logicOp));
+    }
+    check(std::memcmp(cb.blendConstants, lcb.blendConstants, sizeof(cb.blendConstants)) != 0);
+    check(cb.attachments.empty() != lcb.attachments.empty());
+    for (size_t i = 0; i < cb.attachments.size(); i++)
+    {
+      check(i >= lcb.attachments.size() || !(cb.attachments[i] == lcb.attachments[i]));
+    }
+
+    return dirty;
+  }
+
+  double Median(std::vector<double> samples)
+  {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+  }
+
+  template<class Func>
+  double TimeNsPerSwitch(uint32_t switchCount, Func func)
+  {
+    auto samples = std::vector<double>();
+    for (int i = 0; i < 5; i++)
+    {
+      auto start = std::chrono::steady_clock::now();
+      func();
+      samples.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                        switchCount);
+    }
+    return Median(samples);
+  }
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const uint32_t switchCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1'000'000;
+
+  auto headlessContext = Fwog::HeadlessContext();
+  Fwog::Initialize();
+
+  {
+    auto vertexShader = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER, vertexSource);
+    auto fragmentShader = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER, fragmentSource);
+    auto target = Fwog::CreateTexture2D({64, 64}, Fwog::Format::R8G8B8A8_UNORM);
+    auto colorAttachment = Fwog::RenderColorAttachment{.texture = target, .loadOp = Fwog::AttachmentLoadOp::DONT_CARE};
+    auto renderInfo = Fwog::RenderInfo{.colorAttachments = {&colorAttachment, 1}};
+
+    std::printf("Renderer: %s\n", Fwog::GetDeviceProperties().renderer.data());
+    std::printf("Pipelines: %u, switches: %u\n\n", pipelineCount, switchCount);
+    std::printf("%-10s %18s %18s %18s %16s\n", "set", "field-wise (ns)", "packed (ns)", "bind (ns)", "dirty groups");
+
+    for (bool similar : {false, true})
+    {
+      auto random = Random();
+      auto descs = std::vector<PipelineDesc>(pipelineCount);
+      auto pipelines = std::vector<Fwog::GraphicsPipeline>();
+      auto states = std::vector<const Fwog::detail::GraphicsPipelineInfoOwning*>();
+      pipelines.reserve(pipelineCount);
+      for (auto& desc : descs)
+      {
+        if (similar)
+        {
+          Vary(random, desc);
+        }
+        else
+        {
+          Randomize(random, desc);
+        }
+        desc.info.vertexShader = &vertexShader;
+        desc.info.fragmentShader = &fragmentShader;
+        desc.info.colorBlendState.attachments = desc.attachments;
+        pipelines.emplace_back(desc.info);
+      }
+
+      // Pointers to pipeline state are invalidated when pipelines are created, so get them after creating all of them
+      for (const auto& pipeline : pipelines)
+      {
+        states.push_back(Fwog::detail::GetGraphicsPipelineInternal(pipeline.RegistryHandle()));
+      }
+
+      // Consecutive pipelines in the sequence are always different, otherwise the switch would be skipped entirely
+      auto sequence = std::vector<uint32_t>(switchCount + 1);
+      for (uint32_t i = 1; i < sequence.size(); i++)
+      {
+        sequence[i] = (sequence[i - 1] + 1 + random.Next(pipelineCount - 1)) % pipelineCount;
+      }
+
+      uint64_t fieldwiseDirty = 0;
+      const double fieldwiseNs = TimeNsPerSwitch(switchCount,
+                                                 [&]
+                                                 {
+                                                   fieldwiseDirty = 0;
+                                                   for (uint32_t i = 1; i < sequence.size(); i++)
+                                                   {
+                                                     fieldwiseDirty +=
+                                                       FieldwiseDiff(*states[sequence[i]], *states[sequence[i - 1]]);
+                                                   }
+                                                 });
+
+      uint64_t packedDirty = 0;
+      const double packedNs = TimeNsPerSwitch(switchCount,
+                                              [&]
+                                              {
+                                                packedDirty = 0;
+                                                for (uint32_t i = 1; i < sequence.size(); i++)
+                                                {
+                                                  packedDirty += std::popcount(Fwog::detail::DiffPipelineStateBlocks(
+                                                    states[sequence[i]]->stateBlock,
+                                                    states[sequence[i - 1]]->stateBlock));
+                                                }
+                                              });
+
+      const double bindNs = TimeNsPerSwitch(switchCount,
+                                            [&]
+                                            {
+                                              Fwog::Render(renderInfo,
+                                                           [&]
+                                                           {
+                                                             for (uint32_t i = 1; i < sequence.size(); i++)
+                                                             {
+                                                               Fwog::Cmd::BindGraphicsPipeline(pipelines[sequence[i]]);
+                                                             }
+                                                           });
+                                              glFinish();
+                                            });
+
+      std::printf("%-10s %18.2f %18.2f %18.2f %7.2f / %6.2f\n",
+                  similar ? "similar" : "random",
+                  fieldwiseNs,
+                  packedNs,
+                  bindNs,
+                  double(fieldwiseDirty) / switchCount,
+                  double(packedDirty) / switchCount);
+    }
+
+    std::printf("\n\"dirty groups\" is the average number of changed groups per switch found by the field-wise "
+                "comparison / changed words found by the packed diff.\n");
+  }
+
+  Fwog::Terminate();
+  return 0;
+}
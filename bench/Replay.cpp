@@ -0,0 +1,150 @@
+// Replays a frame captured with Fwog::BeginCapture and Fwog::EndCapture, and reports the CPU time spent submitting
+// each pass. The frame is replayed on a headless context, so this can run on machines without a display (Mesa's
+// llvmpipe works). The GPU is waited on between frames so its work does not overlap with the next frame's submission.
+//
+// Usage: fwog_replay <capture file> [iterations = 100] [--csv]
+
+#include <Fwog/Capture.h>
+#include <Fwog/Context.h>
+#include <Fwog/Exception.h>
+#include <Fwog/HeadlessContext.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <glad/gl.h>
+
+namespace
+{
+  constexpr uint32_t warmupIterations = 5;
+
+  struct Statistics
+  {
+    std::string name;
+    double total = 0;
+    double min = std::numeric_limits<double>::max();
+    double max = 0;
+
+    void Add(double milliseconds)
+    {
+      total += milliseconds;
+      min = std::min(min, milliseconds);
+      max = std::max(max, milliseconds);
+    }
+  };
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::fprintf(stderr, "Usage: %s <capture file> [iterations = 100] [--csv]\n", argv[0]);
+    return 1;
+  }
+
+  uint32_t iterations = 100;
+  bool csv = false;
+  for (int i = 2; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--csv") == 0)
+    {
+      csv = true;
+    }
+    else
+    {
+      iterations = std::max(static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10)), 1u);
+    }
+  }
+
+  auto file = std::ifstream(argv[1], std::ios::binary);
+  if (!file)
+  {
+    std::fprintf(stderr, "Failed to open %s\n", argv[1]);
+    return 1;
+  }
+  const auto chars = std::vector<char>(std::istreambuf_iterator<char>(file), {});
+  auto capture = std::vector<std::byte>(chars.size());
+  std::memcpy(capture.data(), chars.data(), chars.size());
+
+  auto headlessContext = Fwog::HeadlessContext();
+  Fwog::Initialize();
+
+  int result = 0;
+  try
+  {
+    auto replayer = Fwog::CaptureReplayer(capture);
+    for (const auto& function : replayer.GetUnrecordedCalls())
+    {
+      std::fprintf(stderr, "Warning: the capture called %s, which is not replayed\n", function.c_str());
+    }
+
+    for (uint32_t i = 0; i < warmupIterations; i++)
+    {
+      replayer.ReplayFrame();
+      glFinish();
+    }
+
+    // Passes are replayed in the same order every frame, so their timings are matched by index
+    auto frame = Statistics{.name = "frame"};
+    auto passes = std::vector<Statistics>();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+      const auto timing = replayer.ReplayFrame();
+      glFinish();
+
+      frame.Add(timing.cpuMilliseconds);
+      passes.resize(timing.passes.size());
+      for (size_t j = 0; j < timing.passes.size(); j++)
+      {
+        passes[j].name = timing.passes[j].name.empty() ? "(unnamed)" : timing.passes[j].name;
+        passes[j].Add(timing.passes[j].cpuMilliseconds);
+      }
+    }
+
+    if (csv)
+    {
+      std::printf("pass,index,avg_ms,min_ms,max_ms\n");
+      for (size_t j = 0; j < passes.size(); j++)
+      {
+        std::printf("%s,%zu,%.6f,%.6f,%.6f\n",
+                    passes[j].name.c_str(),
+                    j,
+                    passes[j].total / iterations,
+                    passes[j].min,
+                    passes[j].max);
+      }
+      std::printf("frame,,%.6f,%.6f,%.6f\n", frame.total / iterations, frame.min, frame.max);
+    }
+    else
+    {
+      std::printf("Renderer: %s\n", Fwog::GetDeviceProperties().renderer.data());
+      std::printf("Capture: %s (%zu bytes), iterations: %u\n\n", argv[1], capture.size(), iterations);
+      std::printf("%-4s %-40s %12s %12s %12s\n", "#", "pass", "avg (ms)", "min (ms)", "max (ms)");
+      for (size_t j = 0; j < passes.size(); j++)
+      {
+        std::printf("%-4zu %-40s %12.4f %12.4f %12.4f\n",
+                    j,
+                    passes[j].name.c_str(),
+                    passes[j].total / iterations,
+                    passes[j].min,
+                    passes[j].max);
+      }
+      std::printf("%-4s %-40s %12.4f %12.4f %12.4f\n", "", "frame", frame.total / iterations, frame.min, frame.max);
+    }
+  }
+  catch (const Fwog::Exception& exception)
+  {
+    std::fprintf(stderr, "Failed to replay %s: %s\n", argv[1], exception.what());
+    result = 1;
+  }
+
+  Fwog::Terminate();
+  return result;
+}
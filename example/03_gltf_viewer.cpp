@@ -9,6 +9,7 @@
 #include <Fwog/Shader.h>
 #include <Fwog/Texture.h>
 #include <Fwog/Timer.h>
+#include <Fwog/UploadRing.h>
 
 #ifdef FWOG_FSR2_ENABLE
   #include "src/ffx-fsr2-api/ffx_fsr2.h"
@@ -230,6 +231,8 @@ private:
   void OnRender(double dt) override;
   void OnGui(double dt) override;
 
+  void BindMaterialUniforms(const Utility::GpuMaterial& material);
+
   // constants
   static constexpr int gShadowmapWidth = 2048;
   static constexpr int gShadowmapHeight = 2048;
@@ -284,9 +287,14 @@ private:
   Fwog::TypedBuffer<GlobalUniforms> globalUniformsBuffer;
   Fwog::TypedBuffer<ShadingUniforms> shadingUniformsBuffer;
   Fwog::TypedBuffer<ShadowUniforms> shadowUniformsBuffer;
-  Fwog::TypedBuffer<Utility::GpuMaterial> materialUniformsBuffer;
   Fwog::TypedBuffer<glm::mat4> rsmUniforms;
 
+  // Per-draw uniforms
+  Fwog::UploadRing uploadRing;
+
+  // Holds the material of each draw that no longer fits in the ring's region for the frame
+  Fwog::TypedBuffer<Utility::GpuMaterial> materialUniformsBuffer;
+
   Fwog::GraphicsPipeline scenePipeline;
   Fwog::GraphicsPipeline rsmScenePipeline;
   Fwog::GraphicsPipeline shadingPipeline;
@@ -340,8 +348,8 @@ GltfViewerApplication::GltfViewerApplication(const Application::CreateInfo& crea
     globalUniformsBuffer(Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
     shadingUniformsBuffer(Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
     shadowUniformsBuffer(shadowUniforms, Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
-    materialUniformsBuffer(Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
     rsmUniforms(Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
+    materialUniformsBuffer(Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
     // Create the pipelines used in the application
     scenePipeline(CreateScenePipeline()),
     rsmScenePipeline(CreateShadowPipeline()),
@@ -512,6 +520,8 @@ static glm::vec2 GetJitterOffset(uint32_t frameIndex, uint32_t renderWidth, uint
 
 void GltfViewerApplication::OnRender([[maybe_unused]] double dt)
 {
+  uploadRing.BeginFrame();
+
   std::swap(frame.gDepth, frame.gDepthPrev);
   std::swap(frame.gNormal, frame.gNormalPrev);
 
@@ -603,14 +613,13 @@ void GltfViewerApplication::OnRender([[maybe_unused]] double dt)
     {
       Fwog::Cmd::BindGraphicsPipeline(scenePipeline);
       Fwog::Cmd::BindUniformBuffer(0, globalUniformsBuffer);
-      Fwog::Cmd::BindUniformBuffer(2, materialUniformsBuffer);
 
       Fwog::Cmd::BindStorageBuffer(1, *meshUniformBuffer);
       for (uint32_t i = 0; i < static_cast<uint32_t>(scene.meshes.size()); i++)
       {
         const auto& mesh = scene.meshes[i];
         const auto& material = scene.materials[mesh.materialIdx];
-        materialUniformsBuffer.UpdateData(material.gpuMaterial);
+        BindMaterialUniforms(material.gpuMaterial);
         if (material.gpuMaterial.flags & Utility::MaterialFlagBit::HAS_BASE_COLOR_TEXTURE)
         {
           const auto& textureSampler = material.albedoTextureSampler.value();
@@ -652,14 +661,13 @@ void GltfViewerApplication::OnRender([[maybe_unused]] double dt)
       Fwog::Cmd::BindGraphicsPipeline(rsmScenePipeline);
       Fwog::Cmd::BindUniformBuffer(0, rsmUniforms);
       Fwog::Cmd::BindUniformBuffer(1, shadingUniformsBuffer);
-      Fwog::Cmd::BindUniformBuffer(2, materialUniformsBuffer);
 
       Fwog::Cmd::BindStorageBuffer(1, *meshUniformBuffer, 0);
       for (uint32_t i = 0; i < static_cast<uint32_t>(scene.meshes.size()); i++)
       {
         const auto& mesh = scene.meshes[i];
         const auto& material = scene.materials[mesh.materialIdx];
-        materialUniformsBuffer.UpdateData(material.gpuMaterial);
+        BindMaterialUniforms(material.gpuMaterial);
         if (material.gpuMaterial.flags & Utility::MaterialFlagBit::HAS_BASE_COLOR_TEXTURE)
         {
           const auto& textureSampler = material.albedoTextureSampler.value();
@@ -847,6 +855,21 @@ void GltfViewerApplication::OnRender([[maybe_unused]] double dt)
         Fwog::Cmd::Draw(3, 1, 0, 0);
       }
     });
+
+  uploadRing.EndFrame();
+}
+
+void GltfViewerApplication::BindMaterialUniforms(const Utility::GpuMaterial& material)
+{
+  if (const auto materialUniforms = uploadRing.Upload(material))
+  {
+    Fwog::Cmd::BindUniformBuffer(2, *materialUniforms.buffer, materialUniforms.offset, materialUniforms.size);
+    return;
+  }
+
+  // The ring is full, so fall back to updating a buffer the GPU may still be reading
+  materialUniformsBuffer.UpdateData(material);
+  Fwog::Cmd::BindUniformBuffer(2, materialUniformsBuffer);
 }
 
 void GltfViewerApplication::OnGui([[maybe_unused]] double dt)
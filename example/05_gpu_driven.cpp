@@ -1,6 +1,7 @@
 #include "common/Application.h"
 #include "common/SceneLoader.h"
 
+#include <Fwog/BindlessTable.h>
 #include <Fwog/Buffer.h>
 #include <Fwog/Pipeline.h>
 #include <Fwog/Rendering.h>
@@ -53,7 +54,7 @@
  * - Dynamic uniform buffers
  * - Memory barriers
  * + Indirect drawing
- * + Bindless textures
+ * + Bindless textures, indexed through a BindlessTable
  *
  * TODO: frustum culling
  * TODO: hi-z occlusion culling
@@ -207,6 +208,7 @@ private:
 
   // Scene
   Utility::SceneBindless scene;
+  Fwog::BindlessTable bindlessTable;
   std::vector<Fwog::DrawIndexedIndirectCommand> drawCommands;
   std::optional<Fwog::TypedBuffer<Fwog::DrawIndexedIndirectCommand>> drawCommandsBuffer;
   std::optional<Fwog::TypedBuffer<Utility::Vertex>> vertexBuffer;
@@ -231,11 +233,12 @@ GpuDrivenApplication::GpuDrivenApplication(const Application::CreateInfo& create
 
   if (!filename)
   {
-    success = Utility::LoadModelFromFileBindless(scene, "models/simple_scene.glb", glm::mat4{.5}, true);
+    success = Utility::LoadModelFromFileBindless(scene, bindlessTable, "models/simple_scene.glb", glm::mat4{.5}, true);
   }
   else
   {
-    success = Utility::LoadModelFromFileBindless(scene, *filename, glm::scale(glm::vec3{scale}), binary);
+    success =
+      Utility::LoadModelFromFileBindless(scene, bindlessTable, *filename, glm::scale(glm::vec3{scale}), binary);
   }
 
   if (!success)
@@ -305,6 +308,9 @@ void GpuDrivenApplication::OnRender([[maybe_unused]] double dt)
   mainCameraUniforms.cameraPos = glm::vec4(mainCamera.position, 0.0);
   globalUniformsBuffer.UpdateData(mainCameraUniforms);
 
+  // Make the handles of newly loaded textures resident and upload them
+  bindlessTable.Flush();
+
   auto gDepthAttachment = Fwog::RenderDepthStencilAttachment{
     .texture = frame.gDepth.value(),
     .loadOp = Fwog::AttachmentLoadOp::CLEAR,
@@ -325,13 +331,14 @@ void GpuDrivenApplication::OnRender([[maybe_unused]] double dt)
     },
     [&]
     {
-      Fwog::MemoryBarrier(Fwog::MemoryBarrierBit::COMMAND_BUFFER_BIT | Fwog::MemoryBarrierBit::SHADER_STORAGE_BIT);
-
+      // The barrier for reading the draw commands written in the culling pass is inserted automatically, since that
+      // pass binds them with write access
       Fwog::Cmd::BindUniformBuffer(0, globalUniformsBuffer);
       Fwog::Cmd::BindStorageBuffer(0, meshUniformBuffer.value());
       Fwog::Cmd::BindStorageBuffer(1, materialsBuffer.value());
       Fwog::Cmd::BindStorageBuffer(2, boundingBoxesBuffer.value());
       Fwog::Cmd::BindStorageBuffer(3, objectIndicesBuffer.value());
+      Fwog::Cmd::BindStorageBuffer(5, bindlessTable.GetBuffer());
 
       Fwog::Cmd::BindGraphicsPipeline(scenePipeline);
       Fwog::Cmd::BindVertexBuffer(0, vertexBuffer.value(), 0, sizeof(Utility::Vertex));
@@ -369,7 +376,7 @@ void GpuDrivenApplication::OnRender([[maybe_unused]] double dt)
         Fwog::Cmd::BindStorageBuffer(1, materialsBuffer.value());
         Fwog::Cmd::BindStorageBuffer(2, boundingBoxesBuffer.value());
         Fwog::Cmd::BindStorageBuffer(3, objectIndicesBuffer.value());
-        Fwog::Cmd::BindStorageBuffer(4, drawCommandsBuffer.value());
+        Fwog::Cmd::BindStorageBuffer(4, drawCommandsBuffer.value(), 0, Fwog::WHOLE_BUFFER, Fwog::AccessType::READ_WRITE);
 
         // Draw visible bounding boxes.
         Fwog::Cmd::BindGraphicsPipeline(boundingBoxCullingPipeline);
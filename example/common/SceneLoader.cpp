@@ -654,7 +654,11 @@ namespace Utility
     return true;
   }
 
-  bool LoadModelFromFileBindless(SceneBindless& scene, std::string_view fileName, glm::mat4 rootTransform, bool binary)
+  bool LoadModelFromFileBindless(SceneBindless& scene,
+                                 Fwog::BindlessTable& bindlessTable,
+                                 std::string_view fileName,
+                                 glm::mat4 rootTransform,
+                                 bool binary)
   {
     FWOG_ASSERT(scene.textures.size() == scene.samplers.size());
     const auto baseMaterialIndex = static_cast<uint32_t>(scene.materials.size());
@@ -689,13 +693,17 @@ namespace Utility
       GpuMaterialBindless bindlessMaterial{
         .flags = material.gpuMaterial.flags,
         .alphaCutoff = material.gpuMaterial.alphaCutoff,
-        .baseColorTextureHandle = 0,
+        .baseColorTextureIndex = 0,
         .baseColorFactor = material.gpuMaterial.baseColorFactor,
       };
       if (material.gpuMaterial.flags & MaterialFlagBit::HAS_BASE_COLOR_TEXTURE)
       {
         auto& [texture, sampler] = material.albedoTextureSampler.value();
-        bindlessMaterial.baseColorTextureHandle = texture.GetBindlessHandle(Fwog::Sampler(sampler));
+        bindlessMaterial.baseColorTextureIndex = bindlessTable.Acquire(texture, Fwog::Sampler(sampler));
+
+        // The table refers to the texture by its handle, so it must outlive the loaded scene
+        scene.textures.emplace_back(std::move(texture));
+        scene.samplers.emplace_back(sampler);
       }
       scene.materials.emplace_back(bindlessMaterial);
     }
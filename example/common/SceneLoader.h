@@ -1,5 +1,6 @@
 #pragma once
 #include <Fwog/detail/Flags.h>
+#include <Fwog/BindlessTable.h>
 #include <Fwog/Buffer.h>
 #include <Fwog/Texture.h>
 
@@ -54,7 +55,8 @@ namespace Utility
   {
     MaterialFlags flags{};
     float alphaCutoff{};
-    uint64_t baseColorTextureHandle{};
+    uint32_t baseColorTextureIndex{}; // Index into the BindlessTable's buffer
+    uint32_t pad01{};
     glm::vec4 baseColorFactor{};
   };
 
@@ -105,6 +107,7 @@ namespace Utility
     bool binary = false);
 
   bool LoadModelFromFileBindless(SceneBindless& scene, 
+    Fwog::BindlessTable& bindlessTable,
     std::string_view fileName, 
     glm::mat4 rootTransform = glm::mat4{ 1 }, 
     bool binary = false);
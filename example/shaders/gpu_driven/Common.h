@@ -13,7 +13,8 @@ struct Material
 {
   uint flags;
   float alphaCutoff;
-  uvec2 baseColorTextureHandle;
+  uint baseColorTextureIndex;
+  uint pad01;
   vec4 baseColorFactor;
 };
 
@@ -71,4 +72,10 @@ layout(binding = 4, std430) writeonly restrict buffer DrawCommandsBuffer
   DrawIndexedIndirectCommand drawCommands[];
 };
 
+// Bindless texture handles, managed by a Fwog::BindlessTable. Indexed with material.baseColorTextureIndex
+layout(binding = 5, std430) readonly restrict buffer BindlessTexturesBuffer
+{
+  uvec2 textureHandles[];
+};
+
 #endif // GPU_COMMON_H
\ No newline at end of file
@@ -18,7 +18,7 @@ void main()
   vec4 color = material.baseColorFactor.rgba;
   if ((material.flags & HAS_BASE_COLOR_TEXTURE) != 0)
   {
-    sampler2D samp = sampler2D(material.baseColorTextureHandle);
+    sampler2D samp = sampler2D(textureHandles[material.baseColorTextureIndex]);
     color *= texture(samp, v_uv).rgba;
   }
   
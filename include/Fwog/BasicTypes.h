@@ -479,11 +479,23 @@ namespace Fwog
     FRAMEBUFFER_BIT    = 1 << 9,  // GL_FRAMEBUFFER_BARRIER_BIT
     SHADER_STORAGE_BIT = 1 << 10, // GL_SHADER_STORAGE_BARRIER_BIT
     QUERY_COUNTER_BIT  = 1 << 11, // GL_QUERY_BUFFER_BARRIER_BIT
+    PIXEL_BUFFER_BIT   = 1 << 12, // GL_PIXEL_BUFFER_BARRIER_BIT
     ALL_BITS = static_cast<uint32_t>(-1),
     // TODO: add more bits as necessary
   };
   FWOG_DECLARE_FLAG_TYPE(MemoryBarrierBits, MemoryBarrierBit, uint32_t)
 
+  /// @brief Specifies how shaders access a storage buffer or image
+  ///
+  /// Resources bound with write access are assumed to be written by every draw or dispatch that they are bound for.
+  /// Fwog uses this to insert the memory barriers that later commands reading them need.
+  enum class AccessType : uint32_t
+  {
+    READ_ONLY,
+    WRITE_ONLY,
+    READ_WRITE,
+  };
+
   enum class StencilOp : uint32_t
   {
     KEEP                = 0,
@@ -0,0 +1,154 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/Texture.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Fwog
+{
+  struct BindlessTableCreateInfo
+  {
+    /// @brief The number of handles the buffer can hold before it is reallocated
+    uint32_t initialCapacity = 1024;
+
+    /// @brief The number of handles to keep resident, or zero for no limit
+    ///
+    /// When more handles are resident after a Flush, the least recently used ones are made non-resident. Handles that
+    /// were used since the previous Flush are never made non-resident, so a frame that uses more handles than the
+    /// limit can exceed it.
+    uint32_t maxResidentHandles = 0;
+  };
+
+  struct BindlessTableStatistics
+  {
+    /// @brief Texture-sampler pairs in the table, resident or not
+    uint32_t handleCount = 0;
+    uint32_t residentHandleCount = 0;
+
+    /// @brief Calls to glMakeTextureHandleResidentARB and glMakeTextureHandleNonResidentARB
+    uint64_t makeResidentCount = 0;
+    uint64_t makeNonResidentCount = 0;
+  };
+
+  /// @brief A buffer of bindless texture handles that shaders index into
+  ///
+  /// Each texture-sampler pair added to the table gets a stable index into a GPU buffer of handles, which shaders can
+  /// store instead of the handles themselves (e.g., in a material) and use to construct a sampler. Acquiring the same
+  /// pair again returns the same index. Indices are freed when the pair is released as many times as it was acquired.
+  ///
+  /// Making handles resident or non-resident and uploading them is deferred until Flush, so it is done in batches
+  /// once per frame. The buffer holds zero in place of handles that aren't resident.
+  ///
+  /// Usage:
+  /// @code
+  /// auto table = Fwog::BindlessTable();
+  /// material.baseColorTextureIndex = table.Acquire(texture, sampler);
+  /// ...
+  /// // Once per frame, before rendering
+  /// table.Flush();
+  /// Fwog::Cmd::BindStorageBuffer(5, table.GetBuffer());
+  /// @endcode
+  /// @code
+  /// // GLSL
+  /// layout(binding = 5, std430) readonly buffer BindlessTextures { uvec2 textureHandles[]; };
+  /// ...
+  /// sampler2D samp = sampler2D(textureHandles[material.baseColorTextureIndex]);
+  /// @endcode
+  ///
+  /// With a residency budget (see BindlessTableCreateInfo::maxResidentHandles), call MarkUsed for every index that
+  /// will be used in a frame before calling Flush.
+  ///
+  /// @note Only available if GL_ARB_bindless_texture is supported
+  /// @note Every texture must outlive its entries in the table
+  /// @note Texture::GetBindlessHandle must not be used for pairs in the table, as a handle can't be made resident twice
+  class BindlessTable
+  {
+  public:
+    explicit BindlessTable(const BindlessTableCreateInfo& createInfo = {});
+    BindlessTable(const BindlessTable&) = delete;
+    BindlessTable& operator=(const BindlessTable&) = delete;
+
+    /// @brief Makes every resident handle non-resident
+    ~BindlessTable();
+
+    /// @brief Gets the index of the handle for a texture and sampler, adding it to the table if it isn't in it
+    ///
+    /// The handle is made resident and uploaded by the next Flush. Each call must be matched by a call to Release.
+    [[nodiscard]] uint32_t Acquire(const Texture& texture, const Sampler& sampler);
+
+    /// @brief Releases an index returned by Acquire
+    ///
+    /// When an index has been released as many times as it was acquired, the next Flush makes its handle non-resident,
+    /// after which the index can be returned by Acquire for another pair.
+    void Release(uint32_t index);
+
+    /// @brief Requests that a handle be resident during the current frame
+    ///
+    /// Makes the handle resident at the next Flush if it was evicted, and keeps it from being evicted until the Flush
+    /// after that. Acquire marks the handle it returns as used.
+    void MarkUsed(uint32_t index);
+
+    /// @brief Applies the residency changes requested since the last call and uploads the handles that changed
+    ///
+    /// Call once per frame, before rendering with the table.
+    void Flush();
+
+    /// @brief The buffer of handles, indexed by the indices returned by Acquire
+    /// @note The buffer is replaced when the table outgrows it, so bind it after calling Flush
+    [[nodiscard]] const TypedBuffer<uint64_t>& GetBuffer() const noexcept
+    {
+      return buffer_;
+    }
+
+    /// @brief The handle at an index, whether or not it is resident
+    [[nodiscard]] uint64_t GetHandle(uint32_t index) const;
+
+    [[nodiscard]] bool IsResident(uint32_t index) const;
+
+    [[nodiscard]] const BindlessTableStatistics& GetStatistics() const noexcept
+    {
+      return statistics_;
+    }
+
+  private:
+    struct Entry
+    {
+      // Zero if the entry is free
+      uint64_t handle;
+
+      // The texture and sampler, identifying the entry in indices_
+      uint64_t key;
+      uint32_t refCount;
+      uint64_t lastUsedFrame;
+      bool isResident;
+    };
+
+    void MakeResident(uint32_t index);
+    void MakeNonResident(uint32_t index);
+
+    // Sets the value the buffer should hold at an index, which is uploaded by the next Flush
+    void SetSlot(uint32_t index, uint64_t value);
+
+    uint32_t maxResidentHandles_;
+    uint64_t frame_ = 1;
+
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> freeEntries_;
+    std::unordered_map<uint64_t, uint32_t> indices_;
+
+    // Entries whose residency may need to change at the next Flush
+    std::vector<uint32_t> pendingResident_;
+    std::vector<uint32_t> pendingRelease_;
+
+    // A copy of the buffer's contents, and the range of it that changed since the last upload
+    std::vector<uint64_t> slots_;
+    uint32_t dirtyBegin_ = UINT32_MAX;
+    uint32_t dirtyEnd_ = 0;
+
+    TypedBuffer<uint64_t> buffer_;
+    BindlessTableStatistics statistics_;
+  };
+} // namespace Fwog
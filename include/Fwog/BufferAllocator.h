@@ -0,0 +1,136 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/detail/OffsetAllocator.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Fwog
+{
+  struct BufferAllocatorCreateInfo
+  {
+    /// @brief The size of each backing buffer, in bytes. Allocations larger than this get a buffer of their own.
+    uint32_t blockSize = 64 * 1024 * 1024;
+
+    BufferStorageFlags storageFlags = BufferStorageFlag::DYNAMIC_STORAGE;
+
+    /// @brief The minimum alignment of every allocation, in bytes. If zero, the larger of the device's uniform and
+    /// storage buffer offset alignments is used, so any allocation can be bound as either.
+    uint32_t alignment = 0;
+  };
+
+  /// @brief A range of a buffer owned by a BufferAllocator
+  struct BufferAllocation
+  {
+    Buffer* buffer = nullptr;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+
+    /// @brief Identifies the allocation across defragmentation
+    uint32_t id = UINT32_MAX;
+
+    explicit operator bool() const noexcept
+    {
+      return buffer != nullptr;
+    }
+  };
+
+  struct BufferAllocatorStatistics
+  {
+    uint32_t blockCount = 0;
+    uint32_t allocationCount = 0;
+
+    /// @brief The total size of the backing buffers, in bytes
+    uint64_t capacity = 0;
+
+    /// @brief Bytes covered by allocations, including alignment padding
+    uint64_t usedBytes = 0;
+    uint64_t freeBytes = 0;
+    uint64_t largestFreeRegion = 0;
+
+    /// @brief One minus the ratio of the largest free region to all free space. Zero when the free space is a single
+    /// region.
+    float fragmentation = 0;
+  };
+
+  /// @brief Sub-allocates ranges of large buffers
+  ///
+  /// Creating a buffer per mesh or per uniform block is slow and forces a buffer binding change between draws. This
+  /// allocator packs many small allocations into a few large buffers. Allocation and free take constant time
+  /// regardless of the number of live allocations.
+  ///
+  /// Usage:
+  /// @code
+  /// auto allocator = BufferAllocator({.blockSize = 16 * 1024 * 1024});
+  /// auto vertices = allocator.Allocate(sizeof(Vertex) * vertexCount, sizeof(Vertex));
+  /// vertices.buffer->UpdateData(vertexData, vertices.offset);
+  /// Cmd::BindVertexBuffer(0, *vertices.buffer, vertices.offset, sizeof(Vertex));
+  /// ...
+  /// allocator.Free(vertices);
+  /// @endcode
+  class BufferAllocator
+  {
+  public:
+    explicit BufferAllocator(const BufferAllocatorCreateInfo& createInfo = {});
+    BufferAllocator(const BufferAllocator&) = delete;
+    BufferAllocator& operator=(const BufferAllocator&) = delete;
+
+    /// @brief Allocates a range of a backing buffer, creating a new backing buffer if none has enough space
+    /// @param alignment The alignment of the offset, in bytes. Need not be a power of two. The offset is also aligned
+    /// to the allocator's minimum alignment.
+    [[nodiscard]] BufferAllocation Allocate(uint64_t size, uint64_t alignment = 0);
+
+    void Free(const BufferAllocation& allocation);
+
+    /// @brief Gets the current location of an allocation
+    [[nodiscard]] BufferAllocation Get(uint32_t id) const;
+
+    /// @brief Moves every allocation into as few backing buffers as possible and destroys the old ones
+    /// @return The allocations that were moved, with their new locations. Their ids are unchanged.
+    /// @note The allocations are copied on the GPU, so no readback occurs. Both the old and new buffers exist while
+    /// copying.
+    std::vector<BufferAllocation> Defragment();
+
+    /// @brief Destroys backing buffers that have no allocations
+    void ReleaseEmptyBlocks();
+
+    [[nodiscard]] BufferAllocatorStatistics GetStatistics() const;
+
+    [[nodiscard]] uint32_t Alignment() const noexcept
+    {
+      return alignment_;
+    }
+
+  private:
+    struct Block
+    {
+      Buffer buffer;
+      detail::OffsetAllocator allocator;
+      uint32_t allocationCount;
+    };
+
+    struct Record
+    {
+      uint32_t block;
+      uint32_t node;
+      uint64_t offset;
+      uint64_t size;
+      uint64_t alignment;
+      bool isLive;
+    };
+
+    BufferAllocation MakeAllocation(uint32_t id) const;
+    bool TryAllocate(uint32_t block, uint64_t size, uint64_t alignment, Record& record);
+    uint32_t CreateBlock(uint64_t minSize);
+
+    BufferAllocatorCreateInfo createInfo_;
+    uint32_t alignment_;
+
+    std::vector<std::unique_ptr<Block>> blocks_;
+    std::vector<Record> records_;
+    std::vector<uint32_t> freeIds_;
+    uint32_t allocationCount_ = 0;
+  };
+} // namespace Fwog
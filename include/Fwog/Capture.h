@@ -0,0 +1,124 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/Pipeline.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Texture.h>
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Fwog
+{
+  /// @brief Starts recording the Fwog calls made on this thread
+  ///
+  /// Rendering and compute scopes, Cmd:: calls (including those of executed command buffers), buffer and texture
+  /// updates, texture clears, buffer copies, blits, and barriers are recorded. Buffers, textures, samplers, and
+  /// pipelines are recorded when they are first used, along with the contents of buffers at that point. The contents
+  /// of buffers with BufferStorageFlag::MAP_MEMORY are read when the capture ends instead, since they can be written at
+  /// any time.
+  ///
+  /// The result can be replayed with CaptureReplayer (or the fwog_replay tool) to measure the CPU cost of submitting a
+  /// real frame without the application that produced it.
+  ///
+  /// These calls are not recorded: CopyTexture, CopyBufferToTexture, CopyTextureToBuffer,
+  /// Texture::UpdateCompressedImage, Texture::GenMipmaps, and Buffer::ClearSubData. The capture notes which of them
+  /// were called, and CaptureReplayer::GetUnrecordedCalls lists them, since the replayed frame differs from the
+  /// captured one.
+  ///
+  /// @note The contents of textures that existed before the capture began are not recorded, and texture views are
+  /// replayed as independent textures
+  void BeginCapture();
+
+  /// @brief Stops recording and returns the capture
+  ///
+  /// Usage:
+  /// @code
+  /// Fwog::BeginCapture();
+  /// RenderFrame();
+  /// auto capture = Fwog::EndCapture();
+  /// std::ofstream("frame.fwogcap", std::ios::binary).write(reinterpret_cast<const char*>(capture.data()), capture.size());
+  /// @endcode
+  [[nodiscard]] std::vector<std::byte> EndCapture();
+
+  struct ReplayPassTiming
+  {
+    std::string name;
+
+    /// @brief CPU time spent submitting the pass, from the start of its scope to the end
+    double cpuMilliseconds;
+  };
+
+  struct ReplayFrameTiming
+  {
+    std::vector<ReplayPassTiming> passes;
+
+    /// @brief CPU time spent submitting the whole frame, including work outside of passes
+    double cpuMilliseconds;
+  };
+
+  /// @brief Replays a frame recorded with BeginCapture and EndCapture
+  ///
+  /// The objects used by the frame are created when the replayer is constructed. Each call to ReplayFrame then submits
+  /// the frame's commands through the same code paths that the application used.
+  ///
+  /// Swapchain rendering is replayed to the current swapchain: the default framebuffer, or an OffscreenSwapchain.
+  class CaptureReplayer
+  {
+  public:
+    /// @throws Exception if the capture is malformed or was made with an incompatible version of Fwog
+    explicit CaptureReplayer(std::span<const std::byte> capture);
+    CaptureReplayer(const CaptureReplayer&) = delete;
+    CaptureReplayer& operator=(const CaptureReplayer&) = delete;
+
+    /// @brief Submits the captured frame and measures the CPU time of each pass
+    ReplayFrameTiming ReplayFrame();
+
+    /// @brief Gets the names of the functions that were called during the capture, but could not be recorded
+    ///
+    /// If any, the replayed frame is incomplete and does not match the captured one. See BeginCapture.
+    [[nodiscard]] std::span<const std::string> GetUnrecordedCalls() const noexcept
+    {
+      return unrecordedCalls_;
+    }
+
+  private:
+    struct Pass
+    {
+      std::string name;
+      std::optional<Viewport> viewport;
+      std::vector<RenderColorAttachment> colorAttachments;
+      std::optional<RenderDepthStencilAttachment> depthAttachment;
+      std::optional<RenderDepthStencilAttachment> stencilAttachment;
+      SwapchainRenderInfo swapchainRenderInfo;
+    };
+
+    struct Operation
+    {
+      uint32_t type;
+
+      // The pass of a BEGIN_* record, or the offset of the payload in frame_
+      uint32_t index;
+      uint32_t size;
+    };
+
+    void CreateObject(uint32_t type, std::span<const std::byte> payload);
+    void AddOperation(uint32_t type, std::span<const std::byte> payload);
+
+    std::vector<Buffer> buffers_;
+    std::vector<Texture> textures_;
+    std::vector<Sampler> samplers_;
+    std::vector<GraphicsPipeline> graphicsPipelines_;
+    std::vector<ComputePipeline> computePipelines_;
+
+    std::vector<Pass> passes_;
+    std::vector<Operation> operations_;
+    std::vector<std::string> unrecordedCalls_;
+
+    // Payloads of the frame's records, with capture IDs replaced by the handles of the replayer's objects
+    std::vector<std::byte> frame_;
+  };
+} // namespace Fwog
@@ -0,0 +1,170 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/BasicTypes.h>
+#include <Fwog/Rendering.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Fwog
+{
+  namespace detail
+  {
+    enum class CommandType : uint16_t;
+  } // namespace detail
+
+  /// @brief A list of commands that can be recorded ahead of time and executed later, any number of times
+  ///
+  /// Each member function mirrors the Cmd:: function of the same name, but instead of calling into OpenGL, it appends
+  /// a compact, trivially copyable encoding of the command to a linear arena. Recording does not touch the OpenGL
+  /// context or any global state, so it can be done before a rendering or compute scope begins, and different command
+  /// buffers can be recorded on different threads at the same time. See Cmd::ExecuteCommandBuffers.
+  ///
+  /// Commands are validated as they are recorded where possible. Validation that depends on the state of the context
+  /// (e.g., whether the command is valid in the current scope) happens when the command buffer is executed.
+  ///
+  /// Execute a command buffer with Cmd::ExecuteCommandBuffer. Executed commands go through the same state
+  /// deduplication as calling the Cmd:: functions directly.
+  ///
+  /// @note Only the OpenGL handles of objects are recorded. Every object referenced by a command buffer must outlive
+  /// every execution of it.
+  class CommandBuffer
+  {
+  public:
+    CommandBuffer() = default;
+
+    /// @brief Records Cmd::BindGraphicsPipeline
+    void BindGraphicsPipeline(const GraphicsPipeline& pipeline);
+
+    /// @brief Records Cmd::BindComputePipeline
+    void BindComputePipeline(const ComputePipeline& pipeline);
+
+    /// @brief Records Cmd::SetViewport
+    void SetViewport(const Viewport& viewport);
+
+    /// @brief Records Cmd::SetScissor
+    void SetScissor(const Rect2D& scissor);
+
+    /// @brief Records Cmd::Draw
+    void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
+
+    /// @brief Records Cmd::DrawIndexed
+    void DrawIndexed(uint32_t indexCount,
+                     uint32_t instanceCount,
+                     uint32_t firstIndex,
+                     int32_t vertexOffset,
+                     uint32_t firstInstance);
+
+    /// @brief Records Cmd::DrawIndirect
+    void DrawIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset, uint32_t drawCount, uint32_t stride);
+
+    /// @brief Records Cmd::DrawIndirectCount
+    void DrawIndirectCount(const Buffer& commandBuffer,
+                           uint64_t commandBufferOffset,
+                           const Buffer& countBuffer,
+                           uint64_t countBufferOffset,
+                           uint32_t maxDrawCount,
+                           uint32_t stride);
+
+    /// @brief Records Cmd::DrawIndexedIndirect
+    void DrawIndexedIndirect(const Buffer& commandBuffer,
+                             uint64_t commandBufferOffset,
+                             uint32_t drawCount,
+                             uint32_t stride);
+
+    /// @brief Records Cmd::DrawIndexedIndirectCount
+    void DrawIndexedIndirectCount(const Buffer& commandBuffer,
+                                  uint64_t commandBufferOffset,
+                                  const Buffer& countBuffer,
+                                  uint64_t countBufferOffset,
+                                  uint32_t maxDrawCount,
+                                  uint32_t stride);
+
+    /// @brief Records Cmd::BindVertexBuffer
+    void BindVertexBuffer(uint32_t bindingIndex, const Buffer& buffer, uint64_t offset, uint64_t stride);
+
+    /// @brief Records Cmd::BindIndexBuffer
+    void BindIndexBuffer(const Buffer& buffer, IndexType indexType);
+
+    /// @brief Records Cmd::BindUniformBuffer
+    ///
+    /// WHOLE_BUFFER is resolved to the size of the buffer at the time of recording.
+    void BindUniformBuffer(uint32_t index, const Buffer& buffer, uint64_t offset = 0, uint64_t size = WHOLE_BUFFER);
+
+    /// @brief Records Cmd::BindStorageBuffer
+    ///
+    /// WHOLE_BUFFER is resolved to the size of the buffer at the time of recording.
+    void BindStorageBuffer(uint32_t index,
+                           const Buffer& buffer,
+                           uint64_t offset = 0,
+                           uint64_t size = WHOLE_BUFFER,
+                           AccessType access = AccessType::READ_ONLY);
+
+    /// @brief Records Cmd::BindSampledImage
+    void BindSampledImage(uint32_t index, const Texture& texture, const Sampler& sampler);
+
+    /// @brief Records Cmd::BindImage
+    void BindImage(uint32_t index, const Texture& texture, uint32_t level, AccessType access = AccessType::READ_WRITE);
+
+    /// @brief Records Cmd::Dispatch
+    void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
+
+    /// @brief Records Cmd::Dispatch
+    void Dispatch(Extent3D groupCount);
+
+    /// @brief Records Cmd::DispatchInvocations
+    ///
+    /// The number of workgroups is computed when the command is executed, using the compute pipeline bound at that time.
+    void DispatchInvocations(uint32_t invocationCountX, uint32_t invocationCountY, uint32_t invocationCountZ);
+
+    /// @brief Records Cmd::DispatchInvocations
+    ///
+    /// The number of workgroups is computed when the command is executed, using the compute pipeline bound at that time.
+    void DispatchInvocations(Extent3D invocationCount);
+
+    /// @brief Records Cmd::DispatchIndirect
+    void DispatchIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset);
+
+    /// @brief Removes all recorded commands, but keeps the arena's memory for reuse
+    void Reset() noexcept;
+
+    [[nodiscard]] bool IsEmpty() const noexcept
+    {
+      return commandCount_ == 0;
+    }
+
+    /// @brief Gets the number of recorded commands
+    [[nodiscard]] size_t CommandCount() const noexcept
+    {
+      return commandCount_;
+    }
+
+    /// @brief Gets the size, in bytes, of the encoded commands
+    [[nodiscard]] size_t SizeBytes() const noexcept
+    {
+      return data_.size();
+    }
+
+  private:
+    friend void Cmd::ExecuteCommandBuffer(const CommandBuffer& commandBuffer);
+    friend class RenderQueue;
+
+    enum class PipelineKind
+    {
+      NONE,
+      GRAPHICS,
+      COMPUTE,
+    };
+
+    template<class T>
+    void Record(detail::CommandType type, const T& payload);
+
+    std::vector<std::byte> data_;
+    size_t commandCount_{};
+
+    // The kind of the last pipeline recorded into this command buffer. Used to catch draws recorded after a compute
+    // pipeline and vice versa.
+    PipelineKind pipelineKind_ = PipelineKind::NONE;
+  };
+} // namespace Fwog
@@ -102,6 +102,7 @@ namespace Fwog
   {
     bool bindlessTextures{}; // GL_ARB_bindless_texture
     bool shaderSubgroup{}; // GL_KHR_shader_subgroup
+    bool parallelShaderCompile{}; // GL_KHR_parallel_shader_compile
   };
 
   struct DeviceProperties
@@ -116,12 +117,100 @@ namespace Fwog
     DeviceFeatures features;
   };
 
+  struct CacheStatistics
+  {
+    uint64_t hits;
+
+    /// @brief Each miss creates a GL object
+    uint64_t misses;
+  };
+
+  /// @brief Counts of the work Fwog did since the last call to ResetFrameStatistics
+  ///
+  /// Counters are only incremented when FWOG_ENABLE_STATISTICS is defined (see the CMake option of the same name).
+  /// Otherwise, every counter stays zero.
+  struct FrameStatistics
+  {
+    // Submitted work. Indirect draws and dispatches are counted, but not their arguments.
+    uint64_t drawCalls;
+    uint64_t dispatchCalls;
+    uint64_t vertices; // Sum of vertexCount of non-indexed draws
+    uint64_t indices;  // Sum of indexCount of indexed draws
+    uint64_t instances;
+
+    // Pipeline binds that changed GL state, and binds of the pipeline that was already bound
+    uint64_t pipelineBinds;
+    uint64_t pipelineBindsElided;
+
+    // GL calls other than draws and dispatches, by category
+    uint64_t glStateCalls;    // Fixed-function state, viewports, scissors, and write masks
+    uint64_t glBindCalls;     // Programs, vertex arrays, framebuffers, buffers, textures, samplers, and images
+    uint64_t glClearCalls;    // Clears and invalidations of attachments
+    uint64_t glBarrierCalls;  // Memory and texture barriers
+    uint64_t glTransferCalls; // Copies and blits between resources
+
+    CacheStatistics framebufferCache;
+    CacheStatistics vertexArrayCache;
+    CacheStatistics samplerCache;
+
+    // Bytes uploaded to buffers from client memory, at creation and with Buffer::UpdateData
+    uint64_t bufferBytesUploaded;
+  };
+
+  /// @brief How graphics pipelines share vertex array objects (VAOs)
+  ///
+  /// Each unique vertex input layout gets one VAO, which every graphics pipeline with that layout shares. Unlike
+  /// FrameStatistics, these numbers describe the pipelines that currently exist and are always available.
+  struct VertexArrayStatistics
+  {
+    uint32_t vertexArrays;               // Unique vertex input layouts
+    uint32_t pipelines;                  // Graphics pipelines, which reference one VAO each
+    uint32_t maxPipelinesPerVertexArray; // Pipelines sharing the most shared VAO
+  };
+
+  /// @brief How the program cache (see ContextInitializeInfo::programCachePath) has been used since Initialize
+  struct ProgramCacheStatistics
+  {
+    uint64_t hits;   // Programs loaded from binaries
+    uint64_t misses; // Programs linked from source, including ones whose binaries were rejected
+
+    /// @brief Binaries the driver refused to load
+    uint64_t rejectedBinaries;
+
+    /// @brief Shaders created without being compiled, as they were part of a cached program
+    uint64_t skippedShaderCompiles;
+
+    /// @brief Estimated time spared by hits and skipped shader compiles, based on how long compiling took when the
+    /// programs were cached
+    double millisecondsSaved;
+  };
+
   struct ContextInitializeInfo
   {
     /// @brief Callback for logging verbose messages about Fwog's internal state.
     /// Currently, only OpenGL object creation and destruction are logged.
     /// This callback can be useful for analyzing how Fwog implicitly creates objects.
     void (*verboseMessageCallback)(const char* message) = nullptr;
+
+    /// @brief The maximum number of framebuffer objects to keep for rendering to and blitting textures
+    ///
+    /// Fwog creates a framebuffer for each combination of attachments it renders to. Applications that keep creating
+    /// new render targets can limit the number of framebuffers, in which case the least recently used one is destroyed
+    /// to make room for a new one. Zero means no limit.
+    uint32_t maxCachedFramebuffers = 0;
+
+    /// @brief Path of a file that stores linked programs between runs, or empty to not cache programs
+    ///
+    /// Programs are stored as binaries from glGetProgramBinary, keyed on the stages and sources of their shaders.
+    /// When a pipeline is created from the same shaders in a later run, its program is loaded with glProgramBinary
+    /// instead of being compiled and linked, and its shaders are not compiled when created. The file is read by
+    /// Initialize and written by Terminate or SaveProgramCache. It is ignored if it was written with a different
+    /// driver, and binaries that the driver rejects are compiled from source.
+    ///
+    /// @note Shaders that skipped compilation don't throw ShaderCompilationException, as their sources are known to
+    /// compile. They are compiled if they are used by a pipeline that isn't in the cache.
+    /// @note Ignored by CreateWorkerContext
+    std::string_view programCachePath = {};
   };
 
   /// @brief Initializes Fwog's internal structures
@@ -135,6 +224,26 @@ namespace Fwog
   /// Call at program exit or before Initialize is called again.
   void Terminate();
 
+  /// @brief Initializes Fwog's internal structures for a worker thread
+  ///
+  /// Call on a worker thread after making current an OpenGL context that shares objects with the context Fwog was
+  /// initialized with. Buffers, textures, samplers, and shaders can then be created and updated on the worker thread,
+  /// so loading does not compete with rendering on the main thread.
+  ///
+  /// To hand resources to the main thread, signal a Fence on the worker thread after the last command that creates or
+  /// updates them, and wait for it on the main thread before using them. Signaling a fence on a worker context flushes
+  /// it, so the fence is guaranteed to be reached.
+  ///
+  /// @note Pipelines, rendering, and compute scopes are only available on the main thread
+  /// @note Buffers and textures destroyed on a worker thread are deleted by the main thread at the start of its next
+  /// rendering or compute scope, so the main thread never sees their names reused while it may still have them bound
+  void CreateWorkerContext(const ContextInitializeInfo& contextInfo = {});
+
+  /// @brief Destroys Fwog's internal structures for a worker thread
+  ///
+  /// Call on the worker thread before its OpenGL context is destroyed or made not current.
+  void DestroyWorkerContext();
+
   /// @brief Invalidates assumptions Fwog has made about the OpenGL context state
   ///
   /// Call when OpenGL context state has been changed outside of Fwog (e.g., when using raw OpenGL or using an external
@@ -146,4 +255,23 @@ namespace Fwog
   /// @return A DeviceProperties struct containing information about the OpenGL context and device limits
   /// @note This call can replace most calls to glGet.
   const DeviceProperties& GetDeviceProperties();
+
+  /// @brief Query the work counted since the last call to ResetFrameStatistics
+  /// @note Each thread with a context has its own statistics
+  const FrameStatistics& GetFrameStatistics();
+
+  /// @brief Zeroes every counter. Call once per frame to get per-frame numbers.
+  void ResetFrameStatistics();
+
+  /// @brief Query how many VAOs the graphics pipelines use and how much they are shared
+  VertexArrayStatistics GetVertexArrayStatistics();
+
+  /// @brief Writes the program cache to its file if programs were added to it
+  ///
+  /// Terminate saves the cache, but saving earlier (e.g., after loading) keeps it if the program exits abnormally.
+  /// @return False if the file could not be written
+  bool SaveProgramCache();
+
+  /// @brief Query how many programs were loaded from the program cache and how much time it saved
+  ProgramCacheStatistics GetProgramCacheStatistics();
 } // namespace Fwog
\ No newline at end of file
@@ -1,9 +1,24 @@
 #pragma once
 #include <Fwog/Config.h>
+#include <Fwog/detail/SlotMap.h>
 #include <cstdint>
+#include <deque>
 
 namespace Fwog
 {
+  /// @brief The result of waiting for a fence
+  enum class FenceStatus
+  {
+    /// @brief The fence was signaled, or was never inserted into the command stream
+    SIGNALED,
+
+    /// @brief The timeout expired before the fence was signaled
+    TIMEOUT,
+  };
+
+  /// @brief Waits for a fence indefinitely
+  constexpr inline uint64_t FENCE_WAIT_FOREVER = UINT64_MAX;
+
   /// @brief An object used for CPU-GPU synchronization
   class Fence
   {
@@ -16,16 +31,119 @@ namespace Fwog
     ~Fence();
 
     /// @brief Inserts a fence into the command stream
+    /// @note The fence must not be pending
     void Signal();
 
-    /// @brief Waits for the fence to be signaled and returns
-    /// @return How long (in nanoseconds) the fence blocked
-    /// @todo Add timeout parameter
-    uint64_t Wait();
+    /// @brief Checks whether the fence has been signaled without blocking
+    /// @return True if the fence was signaled, or if it is not pending
+    ///
+    /// Once the fence has been observed to be signaled, it is no longer pending and can be signaled again.
+    [[nodiscard]] bool IsSignaled();
+
+    /// @brief Waits for the fence to be signaled
+    /// @param timeoutNs The maximum time to wait, in nanoseconds. Zero polls the fence.
+    /// @param blockedNs If not null, receives how long (in nanoseconds) the call blocked
+    FenceStatus Wait(uint64_t timeoutNs = FENCE_WAIT_FOREVER, uint64_t* blockedNs = nullptr);
+
+    /// @brief Returns true if the fence was signaled and has not been observed to be signaled yet
+    [[nodiscard]] bool IsPending() const noexcept
+    {
+      return sync_ != nullptr;
+    }
 
   private:
     void DeleteSync();
 
     void* sync_{};
   };
-} // namespace Fwog
\ No newline at end of file
+
+  /// @brief Holds many fences that are addressed by handles
+  ///
+  /// Sync objects can only be signaled once, so a fence per frame, upload, or readback means a sync object is created
+  /// and deleted for each. This pool deletes sync objects as soon as they are observed to be signaled and reuses their
+  /// slots. Handles to fences that have been observed to be signaled are recognized with a comparison instead of a GL
+  /// call, which makes frequent checks cheap.
+  class FencePool
+  {
+  public:
+    FencePool() = default;
+    FencePool(const FencePool&) = delete;
+    FencePool& operator=(const FencePool&) = delete;
+
+    /// @brief Inserts a fence into the command stream
+    /// @return A handle to the fence. Never zero.
+    [[nodiscard]] uint64_t Signal();
+
+    /// @brief Checks whether a fence has been signaled without blocking
+    [[nodiscard]] bool IsSignaled(uint64_t fence);
+
+    FenceStatus Wait(uint64_t fence, uint64_t timeoutNs = FENCE_WAIT_FOREVER);
+
+    /// @brief Deletes a fence that is no longer needed without waiting for it
+    void Release(uint64_t fence);
+
+    /// @brief Returns the number of fences that have not been observed to be signaled
+    [[nodiscard]] size_t PendingCount() const noexcept
+    {
+      return fences_.Size();
+    }
+
+  private:
+    detail::SlotMap<Fence> fences_;
+  };
+
+  /// @brief A monotonically increasing counter that is advanced by the GPU
+  ///
+  /// Each call to Signal inserts a fence and returns the value the counter will have once the GPU has executed the
+  /// commands submitted before it. This makes tracking frames in flight a matter of comparing integers.
+  ///
+  /// Usage:
+  /// @code
+  /// // Wait until the GPU is at most two frames behind
+  /// if (frameValue > 2)
+  /// {
+  ///   timeline.Wait(frameValue - 2);
+  /// }
+  /// ...
+  /// frameValue = timeline.Signal();
+  /// @endcode
+  class Timeline
+  {
+  public:
+    Timeline() = default;
+    Timeline(const Timeline&) = delete;
+    Timeline& operator=(const Timeline&) = delete;
+
+    /// @brief Inserts a fence into the command stream
+    /// @return The value the counter will reach when the fence is signaled
+    uint64_t Signal();
+
+    /// @brief Polls pending fences and returns the value of the counter
+    [[nodiscard]] uint64_t GetCompletedValue();
+
+    /// @brief Returns true if the counter has reached the value
+    [[nodiscard]] bool IsCompleted(uint64_t value);
+
+    /// @brief Waits until the counter has reached the value
+    FenceStatus Wait(uint64_t value, uint64_t timeoutNs = FENCE_WAIT_FOREVER);
+
+    /// @brief Returns the value returned by the last call to Signal
+    [[nodiscard]] uint64_t GetLastSignaledValue() const noexcept
+    {
+      return lastSignaledValue_;
+    }
+
+  private:
+    struct PendingFence
+    {
+      uint64_t value;
+      Fence fence;
+    };
+
+    uint64_t completedValue_ = 0;
+    uint64_t lastSignaledValue_ = 0;
+
+    // Ordered by value. Fences are signaled in submission order, so only the oldest needs to be polled.
+    std::deque<PendingFence> pending_;
+  };
+} // namespace Fwog
@@ -0,0 +1,174 @@
+#pragma once
+#include <Fwog/Config.h>
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Fwog
+{
+  struct GpuProfilerCreateInfo
+  {
+    /// @brief The number of frames after which results are read. Results that are not available by then are dropped
+    /// instead of stalling.
+    uint32_t latencyFrames = 4;
+
+    /// @brief Zones beyond this number in a frame are not timed on the GPU
+    uint32_t maxZonesPerFrame = 256;
+
+    /// @brief The number of resolved frames to keep for GetFrames and ExportChromeTrace
+    uint32_t historyFrames = 120;
+  };
+
+  /// @brief A timed region of a frame
+  ///
+  /// Times are in nanoseconds since the profiler was created. GPU times are converted to the CPU clock, so the two can
+  /// be compared.
+  struct GpuProfilerZone
+  {
+    std::string name;
+
+    /// @brief Index of the enclosing zone in the frame, or UINT32_MAX for top-level zones
+    uint32_t parent;
+    uint32_t depth;
+
+    uint64_t cpuBeginNs;
+    uint64_t cpuEndNs;
+    uint64_t gpuBeginNs;
+    uint64_t gpuEndNs;
+
+    /// @brief False if the zone exceeded maxZonesPerFrame, in which case its GPU times are zero
+    bool hasGpuTime;
+
+    [[nodiscard]] double GpuMilliseconds() const noexcept
+    {
+      return static_cast<double>(gpuEndNs - gpuBeginNs) / 1e6;
+    }
+
+    [[nodiscard]] double CpuMilliseconds() const noexcept
+    {
+      return static_cast<double>(cpuEndNs - cpuBeginNs) / 1e6;
+    }
+  };
+
+  struct GpuProfilerFrame
+  {
+    uint64_t frameIndex;
+    uint64_t cpuBeginNs;
+    uint64_t cpuEndNs;
+
+    /// @brief Zones in the order they began, so every zone precedes the zones nested in it
+    std::vector<GpuProfilerZone> zones;
+
+    /// @brief Finds the first zone with the name, or returns null
+    [[nodiscard]] const GpuProfilerZone* FindZone(std::string_view name) const;
+
+    /// @brief Returns the indices of the zones directly nested in a zone. Pass UINT32_MAX for top-level zones.
+    [[nodiscard]] std::vector<uint32_t> GetChildren(uint32_t zone) const;
+  };
+
+  /// @brief Times nested regions of frames on the CPU and GPU
+  ///
+  /// While a frame is being profiled, every named rendering scope, compute scope, pipeline, and ScopedDebugMarker
+  /// becomes a zone, nested as they are. Zones can also be added with PushZone and PopZone.
+  ///
+  /// GPU times come from timestamp queries drawn from one pool shared by all zones. The results of a frame are read
+  /// latencyFrames frames later, when the GPU has usually finished it, so profiling does not stall. Results that are
+  /// still not available are dropped.
+  ///
+  /// Usage:
+  /// @code
+  /// profiler.BeginFrame();
+  /// Fwog::Render({.name = "Shadows", ...}, ...);
+  /// ...
+  /// profiler.EndFrame();
+  ///
+  /// if (const auto* frame = profiler.GetLatestFrame())
+  /// {
+  ///   if (const auto* shadows = frame->FindZone("Shadows"))
+  ///   {
+  ///     printf("Shadows took %f ms\n", shadows->GpuMilliseconds());
+  ///   }
+  /// }
+  /// @endcode
+  class GpuProfiler
+  {
+  public:
+    explicit GpuProfiler(const GpuProfilerCreateInfo& createInfo = {});
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+    ~GpuProfiler();
+
+    /// @brief Resolves finished frames and starts profiling a frame
+    /// @note Only one profiler can profile a frame at a time
+    void BeginFrame();
+
+    /// @brief Stops profiling the current frame
+    void EndFrame();
+
+    /// @brief Begins a zone nested in the current zone
+    void PushZone(std::string_view name);
+
+    /// @brief Ends the current zone
+    void PopZone();
+
+    /// @brief Returns the most recently resolved frame, or null if no frame has been resolved
+    [[nodiscard]] const GpuProfilerFrame* GetLatestFrame() const noexcept
+    {
+      return history_.empty() ? nullptr : &history_.back();
+    }
+
+    /// @brief Returns the resolved frames that are kept, oldest first
+    [[nodiscard]] const std::deque<GpuProfilerFrame>& GetFrames() const noexcept
+    {
+      return history_;
+    }
+
+    /// @brief Returns the number of frames whose results were not available in time
+    [[nodiscard]] uint64_t GetDroppedFrameCount() const noexcept
+    {
+      return droppedFrames_;
+    }
+
+    /// @brief Returns the kept frames in the Chrome trace event format
+    ///
+    /// Open the result in chrome://tracing or Perfetto. CPU and GPU zones are shown as separate threads.
+    [[nodiscard]] std::string ExportChromeTrace() const;
+
+  private:
+    struct PendingFrame
+    {
+      GpuProfilerFrame frame{};
+      uint32_t timedZoneCount = 0;
+
+      // The most recently written query. It becomes available after every other query of the frame.
+      uint32_t lastQuery = 0;
+
+      // A GPU timestamp taken at the start of the frame and the CPU time it corresponds to
+      int64_t gpuReference = 0;
+      uint64_t cpuReference = 0;
+      bool isPending = false;
+    };
+
+    uint64_t Now() const;
+    uint32_t GetQueryIndex(uint32_t zone) const;
+    bool TryResolve(PendingFrame& pending);
+
+    uint32_t latencyFrames_;
+    uint32_t maxZonesPerFrame_;
+    uint32_t historyFrames_;
+    uint64_t epoch_;
+
+    // Two timestamp queries per zone for each frame in flight
+    std::vector<uint32_t> queries_;
+    std::vector<PendingFrame> frames_;
+    uint64_t frameIndex_ = 0;
+    bool isRecording_ = false;
+    std::vector<uint32_t> zoneStack_;
+
+    std::deque<GpuProfilerFrame> history_;
+    uint64_t droppedFrames_ = 0;
+  };
+} // namespace Fwog
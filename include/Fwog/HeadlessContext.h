@@ -0,0 +1,76 @@
+#pragma once
+#include <Fwog/Config.h>
+
+#include <cstdint>
+#include <optional>
+
+namespace Fwog
+{
+  class HeadlessContext;
+
+  struct HeadlessContextCreateInfo
+  {
+    /// @brief Selects a GPU through EGL_EXT_platform_device, by its index in the list returned by eglQueryDevicesEXT
+    ///
+    /// Useful on render nodes with several GPUs. If empty, Mesa's surfaceless platform is used when available, and the
+    /// default display otherwise.
+    std::optional<uint32_t> deviceIndex;
+
+    /// @brief Creates a debug context, so messages are delivered to glDebugMessageCallback
+    bool debug = false;
+
+    /// @brief A context to share objects with
+    ///
+    /// Contexts that share objects with the one Fwog was initialized with can be made current on worker threads and
+    /// used with CreateWorkerContext.
+    const HeadlessContext* shareContext = nullptr;
+  };
+
+  /// @brief An OpenGL context that is not associated with a window
+  ///
+  /// Initialize expects an OpenGL context to be current, which applications usually get from a windowing library.
+  /// This creates one through EGL instead, so Fwog can run on machines without a display, such as render nodes and CI
+  /// runners. The context renders without a surface when the implementation supports it (EGL_KHR_surfaceless_context)
+  /// and to a 1x1 pbuffer otherwise. Either way, the default framebuffer cannot be read, so use an OffscreenSwapchain
+  /// to render to the "swapchain".
+  ///
+  /// The context is made current on the calling thread and OpenGL functions are loaded, after which Initialize can be
+  /// called.
+  ///
+  /// Usage:
+  /// @code
+  /// auto headlessContext = Fwog::HeadlessContext();
+  /// Fwog::Initialize();
+  /// ...
+  /// Fwog::Terminate();
+  /// @endcode
+  ///
+  /// @note Only available when Fwog is built with FWOG_HEADLESS
+  class HeadlessContext
+  {
+  public:
+    /// @throws Exception if EGL has no display, or the display cannot create an OpenGL 4.5+ core context
+    explicit HeadlessContext(const HeadlessContextCreateInfo& createInfo = {});
+    ~HeadlessContext();
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    /// @brief Makes the context current on the calling thread
+    /// @note A context can only be current on one thread at a time
+    void MakeCurrent();
+
+    /// @brief Makes no context current on the calling thread, so this context can be made current on another
+    void ReleaseCurrent();
+
+  private:
+    void Destroy();
+
+    void* display_{};
+    void* config_{};
+    void* context_{};
+    void* surface_{};
+
+    // Contexts that share objects also share a display, which is only terminated by the context that initialized it
+    bool ownsDisplay_ = false;
+  };
+} // namespace Fwog
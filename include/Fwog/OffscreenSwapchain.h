@@ -0,0 +1,138 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/BasicTypes.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/Fence.h>
+#include <Fwog/Texture.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Fwog
+{
+  /// @brief A frame that was presented to an OffscreenSwapchain and read back
+  struct OffscreenFrame
+  {
+    /// @brief The number of frames that were presented before this one
+    uint64_t frameIndex;
+
+    Extent2D extent;
+
+    /// @brief The image, as 8-bit RGBA texels in rows from bottom to top, without padding between rows
+    /// @note Only valid during the callback
+    std::span<const std::byte> pixels;
+  };
+
+  struct OffscreenSwapchainCreateInfo
+  {
+    Extent2D extent = {};
+
+    /// @brief The format of the color images
+    ///
+    /// sRGB by default, like the default framebuffer of most windows, so SwapchainRenderInfo::enableSrgb has the same
+    /// effect
+    Format format = Format::R8G8B8A8_SRGB;
+
+    /// @brief The format of the depth-stencil images, or std::nullopt for none
+    std::optional<Format> depthStencilFormat = Format::D24_UNORM_S8_UINT;
+
+    /// @brief The number of images to cycle through
+    ///
+    /// With more than one image, the readback of a frame overlaps with rendering the next ones, and Present only waits
+    /// when it reuses an image whose readback has not finished. With one image, every frame waits for its readback.
+    uint32_t imageCount = 3;
+
+    /// @brief Called with each frame once it has been read back, in the order frames were presented
+    ///
+    /// If empty, frames are not read back.
+    std::function<void(const OffscreenFrame&)> onFrameReady;
+  };
+
+  /// @brief A set of textures that replaces the default framebuffer as the target of swapchain rendering
+  ///
+  /// While the swapchain exists, RenderToSwapchain and BlitTextureToSwapchain target its current image instead of the
+  /// default framebuffer. This makes code written for a window usable without one, e.g., with a HeadlessContext.
+  ///
+  /// For batch rendering, frames can be rendered back-to-back: presenting a frame only queues the readback of its
+  /// image, which is delivered to onFrameReady once the GPU has finished it, so the GPU is kept busy with the following
+  /// frames in the meantime.
+  ///
+  /// Usage:
+  /// @code
+  /// auto swapchain = Fwog::OffscreenSwapchain({
+  ///   .extent = {1920, 1080},
+  ///   .onFrameReady = [](const Fwog::OffscreenFrame& frame) { WriteImage(frame.frameIndex, frame.pixels); },
+  /// });
+  /// for (uint32_t i = 0; i < frameCount; i++)
+  /// {
+  ///   Fwog::RenderToSwapchain(...);
+  ///   swapchain.Present();
+  /// }
+  /// swapchain.Flush();
+  /// @endcode
+  ///
+  /// @note Only one offscreen swapchain can exist per context
+  class OffscreenSwapchain
+  {
+  public:
+    explicit OffscreenSwapchain(const OffscreenSwapchainCreateInfo& createInfo);
+    OffscreenSwapchain(const OffscreenSwapchain&) = delete;
+    OffscreenSwapchain& operator=(const OffscreenSwapchain&) = delete;
+
+    /// @brief Makes the default framebuffer the target of swapchain rendering again
+    /// @note Frames that have not been delivered are discarded. Call Flush first to receive them.
+    ~OffscreenSwapchain();
+
+    /// @brief Ends the current frame and makes the next image current
+    ///
+    /// Queues the readback of the current image. If the next image's previous frame has not been delivered yet, this
+    /// waits for its readback and delivers it (along with any older frames).
+    void Present();
+
+    /// @brief Delivers the frames whose readback has finished, without blocking
+    void Poll();
+
+    /// @brief Waits for every presented frame to be read back and delivers them
+    void Flush();
+
+    /// @brief The image that swapchain rendering currently targets
+    [[nodiscard]] const Texture& GetCurrentImage() const noexcept
+    {
+      return images_[current_].color;
+    }
+
+    /// @brief The number of frames presented so far
+    [[nodiscard]] uint64_t GetFrameCount() const noexcept
+    {
+      return frameCount_;
+    }
+
+  private:
+    struct Image
+    {
+      Texture color;
+      std::optional<Texture> depthStencil;
+      uint32_t framebuffer{};
+      std::optional<Buffer> readback;
+      Fence fence = Fence();
+      uint64_t frameIndex{};
+    };
+
+    // Delivers the frames before endFrame in the order they were presented. Without waiting, stops at the first frame
+    // whose readback has not finished.
+    void Deliver(bool wait, uint64_t endFrame);
+
+    Extent2D extent_;
+    std::function<void(const OffscreenFrame&)> onFrameReady_;
+    std::vector<Image> images_;
+    uint32_t current_ = 0;
+    uint64_t frameCount_ = 0;
+
+    // The oldest presented frame that has not been delivered
+    uint64_t nextFrameToDeliver_ = 0;
+  };
+} // namespace Fwog
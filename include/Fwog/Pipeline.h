@@ -22,6 +22,8 @@ namespace Fwog
     uint32_t binding;  // glVertexArrayAttribBinding
     Format format;     // glVertexArrayAttribFormat
     uint32_t offset;   // glVertexArrayAttribFormat
+
+    bool operator==(const VertexInputBindingDescription&) const noexcept = default;
   };
 
   struct VertexInputState
@@ -163,7 +165,17 @@ namespace Fwog
       return id_;
     }
 
+    /// @brief Gets the handle that identifies the pipeline's state internally (e.g., in command buffers)
+    [[nodiscard]] uint64_t RegistryHandle() const
+    {
+      return registryHandle_;
+    }
+
   private:
+    friend class PendingGraphicsPipeline;
+    explicit GraphicsPipeline(uint64_t registryHandle);
+
+    uint64_t registryHandle_;
     uint64_t id_;
   };
 
@@ -192,10 +204,94 @@ namespace Fwog
       return id_;
     }
 
+    /// @brief Gets the handle that identifies the pipeline's state internally (e.g., in command buffers)
+    [[nodiscard]] uint64_t RegistryHandle() const
+    {
+      return registryHandle_;
+    }
+
   private:
+    friend class PendingComputePipeline;
+    explicit ComputePipeline(uint64_t registryHandle);
+
+    uint64_t registryHandle_;
     uint64_t id_;
     Extent3D workgroupSize_;
   };
 
+  /// @brief A graphics pipeline whose program is being compiled without blocking the calling thread
+  ///
+  /// Constructing a GraphicsPipeline waits for the driver to link its program. With GL_KHR_parallel_shader_compile,
+  /// linking instead happens on driver threads until the program is queried, so many pipelines can be compiled at once
+  /// by constructing a pending pipeline for each, then calling Get on each when it's needed or when IsReady is true.
+  /// Without the extension, pipelines are compiled when Get is called.
+  ///
+  /// Usage:
+  /// @code
+  /// auto vs = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER, vsSource, Fwog::ShaderCompileMode::DEFERRED);
+  /// auto fs = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER, fsSource, Fwog::ShaderCompileMode::DEFERRED);
+  /// auto pending = Fwog::PendingGraphicsPipeline({.vertexShader = &vs, .fragmentShader = &fs});
+  /// ...
+  /// if (pending.IsReady())
+  /// {
+  ///   pipeline = pending.Get();
+  /// }
+  /// @endcode
+  ///
+  /// @note The shaders can be destroyed once the pending pipeline has been constructed
+  class PendingGraphicsPipeline
+  {
+  public:
+    /// @brief Starts compiling the pipeline
+    explicit PendingGraphicsPipeline(const GraphicsPipelineInfo& info);
+
+    /// @brief Abandons the pipeline if Get was not called
+    ~PendingGraphicsPipeline();
+    PendingGraphicsPipeline(PendingGraphicsPipeline&& old) noexcept;
+    PendingGraphicsPipeline& operator=(PendingGraphicsPipeline&& old) noexcept;
+    PendingGraphicsPipeline(const PendingGraphicsPipeline&) = delete;
+    PendingGraphicsPipeline& operator=(const PendingGraphicsPipeline&) = delete;
+
+    /// @brief Returns whether Get can be called without blocking
+    /// @note Always true if GL_KHR_parallel_shader_compile is not supported
+    [[nodiscard]] bool IsReady() const;
+
+    /// @brief Waits for the pipeline to be compiled and returns it. May only be called once.
+    /// @throws PipelineCompilationException, which includes the errors of shaders created with
+    /// ShaderCompileMode::DEFERRED
+    [[nodiscard]] GraphicsPipeline Get();
+
+  private:
+    uint64_t pendingHandle_;
+  };
+
+  /// @brief A compute pipeline whose program is being compiled without blocking the calling thread
+  ///
+  /// See PendingGraphicsPipeline.
+  class PendingComputePipeline
+  {
+  public:
+    /// @brief Starts compiling the pipeline
+    explicit PendingComputePipeline(const ComputePipelineInfo& info);
+
+    /// @brief Abandons the pipeline if Get was not called
+    ~PendingComputePipeline();
+    PendingComputePipeline(PendingComputePipeline&& old) noexcept;
+    PendingComputePipeline& operator=(PendingComputePipeline&& old) noexcept;
+    PendingComputePipeline(const PendingComputePipeline&) = delete;
+    PendingComputePipeline& operator=(const PendingComputePipeline&) = delete;
+
+    /// @brief Returns whether Get can be called without blocking
+    /// @note Always true if GL_KHR_parallel_shader_compile is not supported
+    [[nodiscard]] bool IsReady() const;
+
+    /// @brief Waits for the pipeline to be compiled and returns it. May only be called once.
+    /// @throws PipelineCompilationException
+    [[nodiscard]] ComputePipeline Get();
+
+  private:
+    uint64_t pendingHandle_;
+  };
+
   // clang-format on
 } // namespace Fwog
\ No newline at end of file
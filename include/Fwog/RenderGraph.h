@@ -0,0 +1,237 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/Texture.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Fwog
+{
+  class RenderGraph;
+
+  /// @brief A version of a texture in a RenderGraph
+  ///
+  /// Every write to a texture produces a new version, so reading a version makes a pass depend on the pass that wrote it.
+  struct RenderGraphTexture
+  {
+    uint32_t resource = UINT32_MAX;
+    uint32_t version = 0;
+  };
+
+  /// @brief A version of a buffer in a RenderGraph
+  struct RenderGraphBuffer
+  {
+    uint32_t resource = UINT32_MAX;
+    uint32_t version = 0;
+  };
+
+  /// @brief How a pass accesses a resource. Determines the memory barriers inserted before the pass
+  enum class RenderGraphUsage : uint32_t
+  {
+    SAMPLED,                  // Texture fetches
+    UNIFORM_BUFFER,           // Uniform buffer loads
+    STORAGE,                  // Storage buffer or image loads and stores
+    VERTEX_BUFFER,            // Vertex attribute fetches
+    INDEX_BUFFER,             // Index fetches
+    INDIRECT_BUFFER,          // Indirect command arguments
+    COLOR_ATTACHMENT,         // Rendering (including clears) to a color attachment
+    DEPTH_STENCIL_ATTACHMENT, // Rendering (including clears) to a depth or stencil attachment
+    TRANSFER,                 // Copies, blits, clears, and uploads
+  };
+
+  /// @brief Statistics about the last compilation of a RenderGraph
+  struct RenderGraphStatistics
+  {
+    uint32_t passCount = 0;
+    uint32_t culledPassCount = 0;
+
+    /// @brief Transient textures used by passes that were not culled
+    uint32_t transientTextureCount = 0;
+
+    /// @brief Textures that back the transient textures. Transient textures share a physical texture when their
+    /// create infos are equal and their lifetimes do not overlap
+    uint32_t physicalTextureCount = 0;
+
+    /// @brief Physical textures that had to be created, rather than reused from the previous compilation
+    uint32_t physicalTexturesCreated = 0;
+  };
+
+  /// @brief Gives passes access to the textures and buffers backing the resources of a RenderGraph
+  class RenderGraphResources
+  {
+  public:
+    [[nodiscard]] Texture& GetTexture(RenderGraphTexture texture) const;
+    [[nodiscard]] Buffer& GetBuffer(RenderGraphBuffer buffer) const;
+
+  private:
+    friend class RenderGraph;
+    explicit RenderGraphResources(RenderGraph& graph) : graph_(&graph) {}
+    RenderGraph* graph_;
+  };
+
+  /// @brief Declares the resources that a pass reads and writes
+  class RenderGraphPassBuilder
+  {
+  public:
+    /// @brief Declares that the pass reads a version of a texture
+    /// @return The same version
+    RenderGraphTexture Read(RenderGraphTexture texture, RenderGraphUsage usage);
+
+    /// @brief Declares that the pass writes a texture
+    /// @param texture The latest version of the texture
+    /// @return The version that the pass produces
+    ///
+    /// Each version can only be written once. Writing a version that was not produced by a pass (e.g., a newly created
+    /// texture) does not make the pass depend on any other pass.
+    RenderGraphTexture Write(RenderGraphTexture texture, RenderGraphUsage usage);
+
+    RenderGraphBuffer Read(RenderGraphBuffer buffer, RenderGraphUsage usage);
+    RenderGraphBuffer Write(RenderGraphBuffer buffer, RenderGraphUsage usage);
+
+    /// @brief Prevents the pass from being culled, e.g. because it renders to the swapchain
+    void SetSideEffects();
+
+  private:
+    friend class RenderGraph;
+    RenderGraphPassBuilder(RenderGraph& graph, uint32_t pass) : graph_(&graph), pass_(pass) {}
+    RenderGraph* graph_;
+    uint32_t pass_;
+  };
+
+  /// @brief Orders passes from the resources they declare, culls passes whose results are unused, inserts memory
+  /// barriers, and shares the storage of transient textures
+  ///
+  /// Passes are ordered so that each pass runs after the passes that wrote the versions it reads, and before the passes
+  /// that write over them. Among passes that don't depend on each other, the order in which they were added is kept.
+  ///
+  /// A pass is culled unless it has side effects, writes an imported resource, or writes a version that is read or
+  /// written by a pass that is not culled.
+  ///
+  /// Transient textures are created by the graph. They only exist during the passes that use them, so transient
+  /// textures with the same create info and disjoint lifetimes are backed by the same texture. Backing textures are
+  /// kept until a compilation no longer needs them, so rebuilding the same graph every frame doesn't create textures.
+  ///
+  /// Usage:
+  /// @code
+  /// auto albedo = graph.CreateTexture(gbufferInfo, "Albedo");
+  /// auto swapchain = graph.ImportTexture(outputTexture, "Output");
+  /// auto scene = graph.AddPass("Scene", [&](const RenderGraphResources& resources) {
+  ///   auto attachment = RenderColorAttachment{.texture = resources.GetTexture(albedo), ...};
+  ///   Fwog::Render({.colorAttachments = {&attachment, 1}}, [&] { ... });
+  /// });
+  /// albedo = scene.Write(albedo, RenderGraphUsage::COLOR_ATTACHMENT);
+  /// auto shading = graph.AddPass("Shading", [&](const RenderGraphResources& resources) { ... });
+  /// shading.Read(albedo, RenderGraphUsage::SAMPLED);
+  /// swapchain = shading.Write(swapchain, RenderGraphUsage::COLOR_ATTACHMENT);
+  /// graph.Execute();
+  /// graph.Clear();
+  /// @endcode
+  ///
+  /// Since passes are executed after they are declared, callbacks should capture handles by reference.
+  class RenderGraph
+  {
+  public:
+    using ExecuteFunc = std::function<void(const RenderGraphResources&)>;
+
+    RenderGraph() = default;
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    /// @brief Declares a texture whose storage is managed by the graph
+    [[nodiscard]] RenderGraphTexture CreateTexture(const TextureCreateInfo& createInfo, std::string_view name = "");
+
+    /// @brief Declares a texture that outlives the graph. Passes that write it are never culled
+    [[nodiscard]] RenderGraphTexture ImportTexture(Texture& texture, std::string_view name = "");
+
+    /// @brief Declares a buffer that outlives the graph. Passes that write it are never culled
+    [[nodiscard]] RenderGraphBuffer ImportBuffer(Buffer& buffer, std::string_view name = "");
+
+    /// @brief Adds a pass
+    /// @param name The name of the pass
+    /// @param execute A callback that records the pass's commands (typically a Fwog::Render or Fwog::Compute scope)
+    /// @return A builder for declaring the resources the pass uses
+    RenderGraphPassBuilder AddPass(std::string_view name, ExecuteFunc execute);
+
+    /// @brief Orders and culls passes and assigns storage to transient textures
+    ///
+    /// Called by Execute if the graph has changed since it was last compiled.
+    void Compile();
+
+    /// @brief Executes the passes that were not culled in order
+    void Execute();
+
+    /// @brief Removes all passes and resources, but keeps the textures backing transient textures for reuse
+    void Clear();
+
+    [[nodiscard]] const RenderGraphStatistics& GetStatistics() const noexcept
+    {
+      return statistics_;
+    }
+
+  private:
+    friend class RenderGraphResources;
+    friend class RenderGraphPassBuilder;
+
+    struct Resource
+    {
+      std::string name;
+      bool isTexture;
+
+      // Only one of these is set for imported resources
+      Texture* importedTexture = nullptr;
+      Buffer* importedBuffer = nullptr;
+
+      // Transient textures
+      TextureCreateInfo createInfo{};
+      uint32_t physicalTexture = UINT32_MAX;
+
+      // Pass that wrote each version, or UINT32_MAX for versions that weren't written by a pass
+      std::vector<uint32_t> writers = {UINT32_MAX};
+
+      // Positions of the first and last pass that use the resource in the execution order
+      uint32_t firstUse = UINT32_MAX;
+      uint32_t lastUse = 0;
+    };
+
+    struct Access
+    {
+      uint32_t resource;
+      uint32_t version;
+      RenderGraphUsage usage;
+      bool isWrite;
+    };
+
+    struct Pass
+    {
+      std::string name;
+      ExecuteFunc execute;
+      std::vector<Access> accesses;
+      bool hasSideEffects = false;
+    };
+
+    struct PhysicalTexture
+    {
+      TextureCreateInfo createInfo;
+      Texture texture;
+
+      // Position in the execution order after which the texture is free
+      uint32_t freeAfter;
+      bool isUsed;
+    };
+
+    uint32_t AddAccess(uint32_t pass, uint32_t resource, uint32_t version, RenderGraphUsage usage, bool isWrite);
+    uint32_t GetHandle(const Access& access) const;
+    void IssueBarriers(const Pass& pass);
+
+    std::vector<Resource> resources_;
+    std::vector<Pass> passes_;
+    std::vector<uint32_t> executionOrder_;
+    std::vector<PhysicalTexture> physicalTextures_;
+    bool isCompiled_ = false;
+    RenderGraphStatistics statistics_;
+  };
+} // namespace Fwog
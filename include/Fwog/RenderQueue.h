@@ -0,0 +1,127 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/CommandBuffer.h>
+
+#include <concepts>
+#include <cstdint>
+#include <vector>
+
+namespace Fwog
+{
+  /// @brief Counts how the order of packets affected state changes in the last call to RenderQueue::Submit
+  ///
+  /// A change is counted whenever a field of the sort key differs from the previous packet's (the first packet always
+  /// counts as a change). "Avoided" is the number of changes that would have happened if the packets were submitted in
+  /// the order they were enqueued, minus the number of changes after sorting. It is negative when sorting by a more
+  /// significant field splits up runs of a less significant one.
+  struct RenderQueueStatistics
+  {
+    uint32_t packetCount = 0;
+    uint32_t pipelineChanges = 0;
+    int64_t pipelineChangesAvoided = 0;
+    uint32_t vertexInputChanges = 0;
+    int64_t vertexInputChangesAvoided = 0;
+    uint32_t materialChanges = 0;
+    int64_t materialChangesAvoided = 0;
+  };
+
+  /// @brief Collects draw packets and submits them sorted by a 64-bit key
+  ///
+  /// Each packet is a sequence of commands (typically binds followed by a draw) recorded into a CommandBuffer. When the
+  /// queue is submitted, packets are sorted by their keys with a stable radix sort and executed in order. The Cmd::
+  /// functions skip redundant state changes, so packets that share a pipeline, vertex input state, or material end up
+  /// next to each other and the redundant changes between them collapse.
+  ///
+  /// Like CommandBuffer, enqueuing packets does not touch the OpenGL context.
+  ///
+  /// Usage:
+  /// @code
+  /// queue.Enqueue(RenderQueue::MakeSortKey(pipelineId, vertexInputId, materialId, depth), [&](CommandBuffer& cmd) {
+  ///   cmd.BindGraphicsPipeline(pipeline);
+  ///   cmd.BindSampledImage(0, albedo, sampler);
+  ///   cmd.DrawIndexed(indexCount, 1, firstIndex, vertexOffset, 0);
+  /// });
+  /// ...
+  /// Fwog::Render(renderInfo, [&] { queue.Submit(); });
+  /// queue.Clear();
+  /// @endcode
+  class RenderQueue
+  {
+  public:
+    /// @brief Builds a sort key from the state that is most expensive to change to the least
+    /// @param pipeline An ID for the pipeline used by the packet
+    /// @param vertexInput An ID for the vertex input state (or vertex/index buffers) used by the packet
+    /// @param material An ID for the textures and other resources used by the packet
+    /// @param depth Quantized depth. Packets that share the rest of their state are submitted in increasing depth
+    /// (front to back if depth increases away from the camera)
+    ///
+    /// The IDs are chosen by the application. They only need to be equal for packets that share the same state.
+    [[nodiscard]] static constexpr uint64_t MakeSortKey(uint16_t pipeline,
+                                                        uint16_t vertexInput,
+                                                        uint16_t material,
+                                                        uint16_t depth) noexcept
+    {
+      return uint64_t(pipeline) << PIPELINE_SHIFT | uint64_t(vertexInput) << VERTEX_INPUT_SHIFT |
+             uint64_t(material) << MATERIAL_SHIFT | uint64_t(depth) << DEPTH_SHIFT;
+    }
+
+    /// @brief Records a packet
+    /// @param sortKey The key that determines the order in which packets are submitted. See MakeSortKey
+    /// @param func A callback that records the packet's commands into the provided CommandBuffer
+    template<std::invocable<CommandBuffer&> Func>
+    void Enqueue(uint64_t sortKey, Func func)
+    {
+      const auto begin = commands_.SizeBytes();
+      func(commands_);
+      packets_.push_back({sortKey, begin, commands_.SizeBytes()});
+    }
+
+    /// @brief Sorts the packets and executes them
+    ///
+    /// Valid in rendering scopes. The packets are kept, so the queue can be submitted again until Clear is called.
+    void Submit();
+
+    /// @brief Removes all packets, but keeps memory for reuse
+    void Clear() noexcept;
+
+    [[nodiscard]] size_t PacketCount() const noexcept
+    {
+      return packets_.size();
+    }
+
+    /// @brief Gets the statistics of the last call to Submit
+    [[nodiscard]] const RenderQueueStatistics& GetStatistics() const noexcept
+    {
+      return statistics_;
+    }
+
+  private:
+    static constexpr uint32_t PIPELINE_SHIFT = 48;
+    static constexpr uint32_t VERTEX_INPUT_SHIFT = 32;
+    static constexpr uint32_t MATERIAL_SHIFT = 16;
+    static constexpr uint32_t DEPTH_SHIFT = 0;
+
+    struct Packet
+    {
+      uint64_t sortKey;
+
+      // Byte range of the packet's commands in commands_
+      size_t begin;
+      size_t end;
+    };
+
+    struct SortEntry
+    {
+      uint64_t sortKey;
+      uint32_t packet;
+    };
+
+    void Sort();
+
+    CommandBuffer commands_;
+    std::vector<Packet> packets_;
+    std::vector<SortEntry> sorted_;
+    std::vector<SortEntry> scratch_;
+    RenderQueueStatistics statistics_;
+  };
+} // namespace Fwog
@@ -18,6 +18,7 @@ namespace Fwog
   class Buffer;
   struct GraphicsPipeline;
   struct ComputePipeline;
+  class CommandBuffer;
 
   // Minimal reference wrapper type. Didn't want to pull in <functional> just for this
   template <class T>
@@ -237,6 +238,10 @@ namespace Fwog
   /// 
   /// This call is used to ensure that incoherent writes (SSBO writes and image stores) from a shader
   /// are reflected in subsequent accesses.
+  ///
+  /// Barriers for writes to storage buffers and images that were bound with write access are inserted automatically
+  /// before the commands that consume them, so this is only needed for writes Fwog cannot see (e.g., through bindless
+  /// handles or storage buffers bound as read-only).
   void MemoryBarrier(MemoryBarrierBits accessBits); // glMemoryBarrier
 
   /// @brief Allows subsequent draw commands to read the result of texels written in a previous draw operation
@@ -304,6 +309,7 @@ namespace Fwog
   };
 
   /// @brief Copies buffer data into a texture
+  /// @note Block-compressed data must be tightly packed. Its format and type are those of the texture.
   void CopyBufferToTexture(const CopyBufferToTextureInfo& copy);
 
   /// @brief Functions that set pipeline state, binds resources, or issues draws or dispatches
@@ -435,9 +441,15 @@ namespace Fwog
     void BindUniformBuffer(uint32_t index, const Buffer& buffer, uint64_t offset = 0, uint64_t size = WHOLE_BUFFER);
     
     /// @brief Binds a range within a buffer as a storage buffer
+    /// @param access How shaders access the buffer. If it is written, later commands that read it are preceded by the
+    /// memory barriers they need
     ///
     /// Similar to glBindBufferRange(GL_SHADER_STORAGE_BUFFER, ...)
-    void BindStorageBuffer(uint32_t index, const Buffer& buffer, uint64_t offset = 0, uint64_t size = WHOLE_BUFFER);
+    void BindStorageBuffer(uint32_t index,
+                           const Buffer& buffer,
+                           uint64_t offset = 0,
+                           uint64_t size = WHOLE_BUFFER,
+                           AccessType access = AccessType::READ_ONLY);
 
     /// @brief Binds a texture and a sampler to a texture unit
     ///
@@ -445,9 +457,11 @@ namespace Fwog
     void BindSampledImage(uint32_t index, const Texture& texture, const Sampler& sampler);
 
     /// @brief Binds a texture to an image unit
+    /// @param access How shaders access the image. If it is written, later commands that read it are preceded by the
+    /// memory barriers they need
     ///
     /// Similar to glBindImageTexture{s}
-    void BindImage(uint32_t index, const Texture& texture, uint32_t level);
+    void BindImage(uint32_t index, const Texture& texture, uint32_t level, AccessType access = AccessType::READ_WRITE);
 
     /// @brief Invokes a compute shader
     /// @param groupCountX The number of local workgroups to dispatch in the X dimension
@@ -488,6 +502,20 @@ namespace Fwog
     /// Valid in compute scopes.
     void DispatchIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset);
 
+    /// @brief Executes the commands recorded in a CommandBuffer
+    /// @param commandBuffer The commands to execute
+    ///
+    /// Equivalent to calling the recorded Cmd:: functions in order. Valid in the scopes that the recorded commands
+    /// are valid in.
+    void ExecuteCommandBuffer(const CommandBuffer& commandBuffer);
+
+    /// @brief Executes the commands recorded in several CommandBuffers, one after another
+    /// @param commandBuffers The command buffers to execute, in the order they will be executed
+    ///
+    /// State set by one command buffer (e.g., the bound pipeline) carries over to the next, so a long list of commands
+    /// can be split into segments that are recorded on different threads, then executed here in a deterministic order.
+    void ExecuteCommandBuffers(std::span<const CommandBuffer> commandBuffers);
+
     // clang-format on
   } // namespace Cmd
 } // namespace Fwog
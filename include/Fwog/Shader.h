@@ -5,6 +5,17 @@
 
 namespace Fwog
 {
+  class Shader;
+
+  namespace detail
+  {
+    uint64_t GetSourceHash(const Shader& shader);
+
+    // Compiles a shader that skipped compilation because the program cache knew it. Must be called before the shader
+    // is linked.
+    void CompileIfSkipped(const Shader& shader);
+  } // namespace detail
+
   enum class PipelineStage
   {
     VERTEX_SHADER,
@@ -14,6 +25,16 @@ namespace Fwog
     COMPUTE_SHADER
   };
 
+  enum class ShaderCompileMode
+  {
+    /// @brief Wait for the shader to compile and check for errors
+    BLOCKING,
+
+    /// @brief Let the driver compile the shader in the background (with GL_KHR_parallel_shader_compile). Errors are
+    /// reported when a pipeline that uses the shader fails to compile.
+    DEFERRED,
+  };
+
   /// @brief A shader object to be used in one or more GraphicsPipeline or ComputePipeline objects
   class Shader
   {
@@ -21,8 +42,11 @@ namespace Fwog
     /// @brief Constructs the shader
     /// @param stage A pipeline stage
     /// @param source A GLSL source string
-    /// @throws ShaderCompilationException if the shader is malformed
-    explicit Shader(PipelineStage stage, std::string_view source);
+    /// @param compileMode Whether to wait for the shader to compile
+    /// @throws ShaderCompilationException if the shader is malformed and compileMode is BLOCKING
+    explicit Shader(PipelineStage stage,
+                    std::string_view source,
+                    ShaderCompileMode compileMode = ShaderCompileMode::BLOCKING);
     Shader(const Shader&) = delete;
     Shader(Shader&& old) noexcept;
     Shader& operator=(const Shader&) = delete;
@@ -37,6 +61,13 @@ namespace Fwog
     }
 
   private:
+    friend uint64_t detail::GetSourceHash(const Shader& shader);
+    friend void detail::CompileIfSkipped(const Shader& shader);
+
     uint32_t id_{};
+
+    // Identifies the stage and source in the program cache
+    uint64_t sourceHash_{};
+    bool isCompileSkipped_{};
   };
 } // namespace Fwog
\ No newline at end of file
@@ -168,7 +168,8 @@ namespace Fwog
     /// @brief Generates and makes resident a bindless handle from the image and a sampler. Only available if GL_ARB_bindless_texture is supported
     /// @param sampler The sampler to bind to the texture
     /// @return A bindless texture handle that can be placed in a buffer and used to construct a combined texture sampler in a shader
-    /// @todo Improve this
+    /// @note Only one handle can be made resident per texture, and it stays resident until the texture is destroyed.
+    /// Use a BindlessTable to manage handles for many texture-sampler pairs and their residency.
     [[nodiscard]] uint64_t GetBindlessHandle(Sampler sampler);
 
     [[nodiscard]] const TextureCreateInfo& GetCreateInfo() const noexcept
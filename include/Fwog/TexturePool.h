@@ -0,0 +1,143 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Texture.h>
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+template<>
+struct std::hash<Fwog::TextureCreateInfo>
+{
+  std::size_t operator()(const Fwog::TextureCreateInfo& k) const noexcept;
+};
+
+namespace Fwog
+{
+  class TexturePool;
+
+  /// @brief A texture borrowed from a TexturePool
+  ///
+  /// The texture is returned to the pool when this object is destroyed or reset.
+  class PooledTexture
+  {
+  public:
+    PooledTexture() = default;
+    PooledTexture(PooledTexture&& old) noexcept;
+    PooledTexture& operator=(PooledTexture&& old) noexcept;
+    PooledTexture(const PooledTexture&) = delete;
+    PooledTexture& operator=(const PooledTexture&) = delete;
+    ~PooledTexture();
+
+    /// @brief Returns the texture to the pool early
+    void Reset();
+
+    [[nodiscard]] Texture& Get() const;
+
+    Texture& operator*() const
+    {
+      return Get();
+    }
+
+    Texture* operator->() const
+    {
+      return &Get();
+    }
+
+    explicit operator bool() const noexcept
+    {
+      return pool_ != nullptr;
+    }
+
+  private:
+    friend class TexturePool;
+    PooledTexture(TexturePool& pool, uint32_t entry) : pool_(&pool), entry_(entry) {}
+
+    TexturePool* pool_ = nullptr;
+    uint32_t entry_ = 0;
+  };
+
+  struct TexturePoolStatistics
+  {
+    /// @brief Acquisitions that reused a texture
+    uint64_t reuseCount = 0;
+    uint64_t createCount = 0;
+    uint64_t destroyCount = 0;
+
+    /// @brief Textures owned by the pool, including the ones in use
+    uint32_t textureCount = 0;
+    uint32_t texturesInUse = 0;
+  };
+
+  /// @brief Recycles textures with equal create infos
+  ///
+  /// Creating and destroying textures is expensive, and destroying a texture also destroys the cached framebuffers it
+  /// was attached to. Textures acquired from a pool are returned to it instead of being destroyed, and handed out again
+  /// by the next acquisition with the same create info. Since a recycled texture is the same GL object, its cached
+  /// framebuffers stay valid.
+  ///
+  /// Textures that have not been acquired for a number of frames are destroyed, so the pool does not hold on to e.g.
+  /// render targets of a resolution that is no longer used.
+  ///
+  /// Usage:
+  /// @code
+  /// // Once per frame
+  /// pool.NextFrame();
+  ///
+  /// auto bloom = pool.Acquire(bloomInfo, "Bloom");
+  /// auto attachment = RenderColorAttachment{.texture = *bloom};
+  /// ...
+  /// // The texture is returned to the pool when bloom goes out of scope
+  /// @endcode
+  class TexturePool
+  {
+  public:
+    /// @param maxIdleFrames The number of calls to NextFrame after which textures that weren't acquired are destroyed
+    explicit TexturePool(uint32_t maxIdleFrames = 3);
+    TexturePool(const TexturePool&) = delete;
+    TexturePool& operator=(const TexturePool&) = delete;
+    ~TexturePool();
+
+    /// @brief Gets a texture that isn't in use, or creates one if there are none
+    /// @param name An optional name for viewing the resource in a graphics debugger. Only applied to new textures
+    [[nodiscard]] PooledTexture Acquire(const TextureCreateInfo& createInfo, std::string_view name = "");
+
+    /// @brief Advances the frame counter and destroys textures that have been idle for too long
+    void NextFrame();
+
+    /// @brief Destroys every texture that isn't in use
+    void Clear();
+
+    [[nodiscard]] const TexturePoolStatistics& GetStatistics() const noexcept
+    {
+      return statistics_;
+    }
+
+  private:
+    friend class PooledTexture;
+
+    struct Entry
+    {
+      Texture texture;
+      uint64_t lastUsedFrame;
+      bool isInUse;
+    };
+
+    void Release(uint32_t entry);
+    void Destroy(uint32_t entry);
+
+    uint32_t maxIdleFrames_;
+    uint64_t frame_ = 0;
+
+    // Null entries are free slots, so the indices held by PooledTexture stay valid
+    std::vector<std::unique_ptr<Entry>> entries_;
+    std::vector<uint32_t> freeSlots_;
+
+    // Entries that aren't in use, most recently released last
+    std::unordered_map<TextureCreateInfo, std::vector<uint32_t>> available_;
+
+    TexturePoolStatistics statistics_;
+  };
+} // namespace Fwog
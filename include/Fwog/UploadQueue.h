@@ -0,0 +1,182 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/BasicTypes.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/Fence.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+namespace Fwog
+{
+  class Texture;
+
+  struct UploadQueueCreateInfo
+  {
+    /// @brief The size of each staging buffer, in bytes. A single row of a texture upload, or a slice of a 3D or array
+    /// texture upload, must fit in one (see UploadQueue::UploadTexture).
+    uint32_t stagingBufferSize = 16 * 1024 * 1024;
+
+    /// @brief The number of staging buffers. Staging buffers are reused once the GPU has finished copying from them.
+    uint32_t stagingBufferCount = 3;
+
+    /// @brief The maximum number of bytes to copy per call to Process. If zero, there is no limit.
+    uint64_t bytesPerFrame = 0;
+
+    /// @brief The maximum time to spend per call to Process, in milliseconds. If zero, there is no limit.
+    double millisecondsPerFrame = 0;
+  };
+
+  /// @brief Parameters for UploadQueue::UploadTexture
+  struct TextureUploadInfo
+  {
+    Texture& texture;
+    uint32_t level = 0;
+    Offset3D offset = {};
+    Extent3D extent = {};
+
+    /// @brief Ignored for block-compressed textures
+    UploadFormat format = UploadFormat::INFER_FORMAT;
+
+    /// @brief Ignored for block-compressed textures
+    UploadType type = UploadType::INFER_TYPE;
+
+    /// @brief Tightly packed texels or blocks covering \p extent, with no padding between rows regardless of their size.
+    /// Must remain valid until the upload is complete.
+    std::span<const std::byte> data;
+  };
+
+  /// @brief Parameters for UploadQueue::UploadBuffer
+  struct BufferUploadInfo
+  {
+    Buffer& buffer;
+    uint64_t offset = 0;
+
+    /// @brief Must remain valid until the upload is complete
+    std::span<const std::byte> data;
+  };
+
+  /// @brief Identifies an upload made with an UploadQueue
+  struct UploadHandle
+  {
+    uint64_t id = 0;
+  };
+
+  struct UploadQueueStatistics
+  {
+    uint64_t bytesUploaded = 0;
+
+    /// @brief Bytes copied by the most recent call to Process or Flush
+    uint64_t bytesLastProcess = 0;
+
+    /// @brief Uploads that are not complete yet
+    uint64_t pendingUploads = 0;
+  };
+
+  /// @brief Uploads textures and buffers over multiple frames through staging buffers
+  ///
+  /// Uploading from client memory with Texture::UpdateImage or Buffer::UpdateData blocks until the driver has copied
+  /// the data, which stalls the frame when uploading many large textures. Uploads made with this queue are instead
+  /// copied into persistently mapped staging buffers a bit at a time by Process, which respects a per-frame byte and
+  /// time budget. The GPU then copies the data from the staging buffers to its destination.
+  ///
+  /// Large uploads are split by rows, block rows, or slices, so they can be spread over multiple frames. Uploads
+  /// complete in the order they were made.
+  ///
+  /// Usage:
+  /// @code
+  /// auto handle = queue.UploadTexture({.texture = texture, .extent = texture.Extent(), .data = pixels});
+  /// ...
+  /// // Once per frame
+  /// queue.Process();
+  /// if (queue.IsComplete(handle))
+  /// {
+  ///   // The texture can be used and pixels can be freed
+  /// }
+  /// @endcode
+  class UploadQueue
+  {
+  public:
+    explicit UploadQueue(const UploadQueueCreateInfo& createInfo = {});
+    UploadQueue(const UploadQueue&) = delete;
+    UploadQueue& operator=(const UploadQueue&) = delete;
+
+    /// @throws Exception if a row, block row, or slice of the upload is larger than a staging buffer
+    [[nodiscard]] UploadHandle UploadTexture(const TextureUploadInfo& info);
+    [[nodiscard]] UploadHandle UploadBuffer(const BufferUploadInfo& info);
+
+    /// @brief Copies pending uploads to staging buffers within the budget and retires finished staging buffers
+    ///
+    /// Never waits for the GPU. If every staging buffer is still in use, no data is copied.
+    void Process();
+
+    /// @brief Completes every pending upload, ignoring the budget and waiting for the GPU
+    void Flush();
+
+    /// @brief Returns true if the GPU has finished copying the upload to its destination
+    [[nodiscard]] bool IsComplete(UploadHandle handle) const noexcept
+    {
+      return handle.id <= completedId_;
+    }
+
+    [[nodiscard]] const UploadQueueStatistics& GetStatistics() const noexcept
+    {
+      return statistics_;
+    }
+
+  private:
+    struct Request
+    {
+      uint64_t id;
+      Texture* texture;
+      Buffer* buffer;
+      uint64_t bufferOffset;
+      uint32_t level;
+      Offset3D offset;
+      Extent3D extent;
+      UploadFormat format;
+      UploadType type;
+      std::span<const std::byte> data;
+
+      // Requests are copied in units of rows, block rows, slices, or bytes
+      uint64_t unitCount;
+      uint64_t unitSize;
+      uint64_t unitsDone;
+    };
+
+    struct StagingBuffer
+    {
+      Buffer buffer;
+      Fence fence;
+
+      // The newest request that completes when the GPU is done with the buffer
+      uint64_t lastRequestId;
+    };
+
+    void ProcessInternal(uint64_t maxBytes, double maxMilliseconds, bool wait);
+    void RetireStagingBuffers(bool waitForOldest);
+    void Submit(StagingBuffer& staging);
+    void CopyUnits(const Request& request, const StagingBuffer& staging, uint64_t stagingOffset, uint64_t unitCount);
+
+    uint64_t stagingBufferSize_;
+    uint64_t bytesPerFrame_;
+    double millisecondsPerFrame_;
+
+    std::vector<StagingBuffer> stagingBuffers_;
+
+    // The staging buffer being filled, and the oldest staging buffer that has been submitted
+    uint32_t current_ = 0;
+    uint32_t oldestSubmitted_ = 0;
+    uint32_t submittedCount_ = 0;
+    uint64_t stagingHead_ = 0;
+
+    std::deque<Request> requests_;
+    uint64_t nextId_ = 1;
+    uint64_t completedId_ = 0;
+
+    UploadQueueStatistics statistics_;
+  };
+} // namespace Fwog
@@ -0,0 +1,117 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/Fence.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Fwog
+{
+  struct UploadRingCreateInfo
+  {
+    /// @brief The number of bytes that can be uploaded per frame
+    uint32_t frameSize = 4 * 1024 * 1024;
+
+    /// @brief The number of frames that may be in flight. Writing to a region waits for the GPU to finish the frame
+    /// that last used it.
+    uint32_t frameCount = 3;
+  };
+
+  /// @brief Data written to an UploadRing
+  struct UploadAllocation
+  {
+    const Buffer* buffer = nullptr;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+
+    /// @brief Mapped memory of the allocation. Writes are visible to subsequent commands without a barrier.
+    void* data = nullptr;
+
+    explicit operator bool() const noexcept
+    {
+      return buffer != nullptr;
+    }
+  };
+
+  struct UploadRingStatistics
+  {
+    /// @brief Bytes allocated in the current frame, including alignment padding
+    uint64_t bytesUsed = 0;
+
+    /// @brief The largest value of bytesUsed at the end of a frame
+    uint64_t peakBytesUsed = 0;
+  };
+
+  /// @brief A persistently mapped buffer for data that changes every frame, such as uniforms
+  ///
+  /// Updating a buffer the GPU may still be reading with Buffer::UpdateData forces the driver to either stall or copy
+  /// the data. This ring has a region for each frame in flight, so data is instead written to memory the GPU is
+  /// guaranteed to be done with, and bound by offset. An upload then costs a memcpy.
+  ///
+  /// Allocations are aligned to the device's uniform and storage buffer offset alignments, so they can be bound as
+  /// either.
+  ///
+  /// Usage:
+  /// @code
+  /// ring.BeginFrame();
+  /// ...
+  /// for (const auto& mesh : meshes)
+  /// {
+  ///   auto material = ring.Upload(mesh.material);
+  ///   Cmd::BindUniformBuffer(2, *material.buffer, material.offset, material.size);
+  ///   Cmd::DrawIndexed(...);
+  /// }
+  /// ...
+  /// ring.EndFrame();
+  /// @endcode
+  class UploadRing
+  {
+  public:
+    explicit UploadRing(const UploadRingCreateInfo& createInfo = {});
+    UploadRing(const UploadRing&) = delete;
+    UploadRing& operator=(const UploadRing&) = delete;
+
+    /// @brief Switches to the next frame's region, waiting for the GPU to finish reading it if necessary
+    void BeginFrame();
+
+    /// @brief Marks the end of the commands that read the current frame's region
+    void EndFrame();
+
+    /// @brief Allocates memory in the current frame's region
+    /// @param alignment The alignment of the offset, in bytes. Must be a power of two. The offset is also aligned
+    /// to the device's buffer offset alignments.
+    /// @return An empty allocation if the allocation does not fit in the remaining space of the region. The region is
+    /// left unchanged, so smaller allocations may still succeed.
+    [[nodiscard]] UploadAllocation Allocate(uint64_t size, uint64_t alignment = 0);
+
+    /// @brief Allocates memory in the current frame's region and copies data to it
+    /// @return An empty allocation, without copying the data, if the allocation does not fit in the remaining space of
+    /// the region
+    UploadAllocation Upload(TriviallyCopyableByteSpan data, uint64_t alignment = 0);
+
+    [[nodiscard]] const Buffer& GetBuffer() const noexcept
+    {
+      return buffer_;
+    }
+
+    [[nodiscard]] const UploadRingStatistics& GetStatistics() const noexcept
+    {
+      return statistics_;
+    }
+
+  private:
+    uint32_t frameSize_;
+    uint32_t frameCount_;
+    uint32_t alignment_;
+    Buffer buffer_;
+
+    uint32_t frame_ = 0;
+    uint64_t head_ = 0;
+    bool isRecording_ = false;
+
+    std::vector<Fence> fences_;
+
+    UploadRingStatistics statistics_;
+  };
+} // namespace Fwog
@@ -81,4 +81,6 @@ namespace Fwog::detail
   GLenum StencilOpToGL(StencilOp op);
 
   GLbitfield BarrierBitsToGL(MemoryBarrierBits bits);
+
+  GLenum AccessTypeToGL(AccessType access);
 } // namespace Fwog::detail
@@ -0,0 +1,102 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/BasicTypes.h>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include FWOG_OPENGL_HEADER
+
+namespace Fwog::detail
+{
+  // Infers the glMemoryBarrier calls needed between incoherent shader writes and the commands that consume them.
+  //
+  // Writes are stamped with a serial number per buffer or texture. Each kind of barrier (one per MemoryBarrierBit)
+  // remembers the serial at which it was last issued, so a resource must be covered by a barrier of some kind before
+  // it is consumed that way if and only if it was written after that barrier was last issued. Consumers call Require*
+  // for each resource they access, then Flush to issue a single glMemoryBarrier with the union of the required bits.
+  //
+  // Only writes that the user declared are tracked (storage buffers and images bound with write access). Other
+  // incoherent writes, e.g. through bindless handles, still need a manual MemoryBarrier.
+  class BarrierTracker
+  {
+  public:
+    // Call after a command that may have written the resource in a shader
+    void RecordBufferWrite(GLuint buffer);
+    void RecordTextureWrite(GLuint texture);
+
+    // Returns true if some write hasn't been made visible to consumers of this kind yet.
+    // Used to skip looking at the resources of a command when no barrier of this kind can be needed.
+    [[nodiscard]] bool IsPending(MemoryBarrierBit kind) const noexcept
+    {
+      return lastWrite_ > lastBarrier_[KindIndex(kind)];
+    }
+
+    void RequireBuffer(GLuint buffer, MemoryBarrierBit kind) noexcept
+    {
+      if (buffer < bufferWrites_.size() && bufferWrites_[buffer] > lastBarrier_[KindIndex(kind)])
+      {
+        requiredBits_ |= static_cast<uint32_t>(kind);
+      }
+    }
+
+    void RequireTexture(GLuint texture, MemoryBarrierBit kind) noexcept
+    {
+      texture = GetStorage(texture);
+      if (texture < textureWrites_.size() && textureWrites_[texture] > lastBarrier_[KindIndex(kind)])
+      {
+        requiredBits_ |= static_cast<uint32_t>(kind);
+      }
+    }
+
+    // Issues the barriers required since the last call, if any
+    void Flush()
+    {
+      if (requiredBits_ != 0)
+      {
+        IssueRequiredBarriers();
+      }
+    }
+
+    // Call when barriers are issued by the user
+    void OnMemoryBarrier(MemoryBarrierBits bits);
+
+    // Views share the storage of their parent, so writes through either must be visible through both
+    void AddTextureView(GLuint view, GLuint parent);
+
+    // Call when a buffer or texture is deleted, since its name may be recycled
+    void RemoveBuffer(GLuint buffer);
+    void RemoveTexture(GLuint texture);
+
+  private:
+    static constexpr size_t KIND_COUNT = 13;
+
+    static uint32_t KindIndex(MemoryBarrierBit kind) noexcept
+    {
+      return static_cast<uint32_t>(std::countr_zero(static_cast<uint32_t>(kind)));
+    }
+
+    GLuint GetStorage(GLuint texture) const noexcept
+    {
+      return texture < textureStorage_.size() && textureStorage_[texture] != 0 ? textureStorage_[texture] : texture;
+    }
+
+    void IssueRequiredBarriers();
+
+    // Serial of the next write. Incremented whenever barriers are issued.
+    uint64_t serial_ = 1;
+    uint64_t lastWrite_ = 0;
+    std::array<uint64_t, KIND_COUNT> lastBarrier_{};
+    uint32_t requiredBits_ = 0;
+
+    // Serial of the last write to each buffer and texture, indexed by GL name. 0 if it hasn't been written.
+    std::vector<uint64_t> bufferWrites_;
+    std::vector<uint64_t> textureWrites_;
+
+    // The texture that owns the storage of each view, indexed by GL name. 0 for textures that aren't views.
+    std::vector<GLuint> textureStorage_;
+  };
+} // namespace Fwog::detail
@@ -0,0 +1,126 @@
+#pragma once
+#include <Fwog/Config.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include FWOG_OPENGL_HEADER
+
+namespace Fwog::detail
+{
+  // Arguments for glBindBufferRange
+  struct BufferRangeBinding
+  {
+    GLuint buffer{};
+    GLintptr offset{};
+    GLsizeiptr size{};
+
+    bool operator==(const BufferRangeBinding&) const noexcept = default;
+  };
+
+  // Arguments for glVertexArrayVertexBuffer
+  struct VertexBufferBinding
+  {
+    GLuint buffer{};
+    GLintptr offset{};
+    GLsizei stride{};
+
+    bool operator==(const VertexBufferBinding&) const noexcept = default;
+  };
+
+  // Arguments for glBindImageTexture. layered is always GL_TRUE and layer is always 0.
+  struct ImageBinding
+  {
+    GLuint texture{};
+    GLint level{};
+    GLenum access = GL_READ_WRITE;
+    GLenum format{};
+
+    bool operator==(const ImageBinding&) const noexcept = default;
+  };
+
+  // Shadow state for one class of indexed bindings (e.g., uniform buffers or texture units).
+  // `bound` mirrors what GL currently has bound, while `pending` holds what the user last requested.
+  // The two only differ inside of the dirty range [dirtyBegin, dirtyEnd), which is flushed to GL right before the next
+  // draw or dispatch. Flushing emits at most one (multi-bind) GL call per binding class.
+  template<class T>
+  struct BindingSlots
+  {
+    std::vector<T> bound;
+    std::vector<T> pending;
+    uint32_t dirtyBegin = UINT32_MAX;
+    uint32_t dirtyEnd = 0;
+
+    // One past the highest slot that has been set since the last reset. Lets code that looks at every bound resource
+    // (e.g., barrier inference) skip the unused tail of the slots.
+    uint32_t usedEnd = 0;
+
+    explicit BindingSlots(size_t count = 0) : bound(count), pending(count) {}
+
+    void Set(uint32_t index, const T& value)
+    {
+      FWOG_ASSERT(index < pending.size() && "Binding index exceeds device limits");
+      pending[index] = value;
+      usedEnd = std::max(usedEnd, index + 1);
+
+      // Nothing needs to be done if the slot is clean and GL already has the value bound
+      if (value == bound[index] && (index < dirtyBegin || index >= dirtyEnd))
+      {
+        return;
+      }
+
+      dirtyBegin = std::min(dirtyBegin, index);
+      dirtyEnd = std::max(dirtyEnd, index + 1);
+    }
+
+    [[nodiscard]] bool IsDirty() const noexcept
+    {
+      return dirtyBegin < dirtyEnd;
+    }
+
+    // Finds the smallest range [first, last] inside the dirty range where pending and bound differ.
+    // Returns false if every dirty slot turned out to already be bound.
+    bool GetChangedRange(uint32_t& first, uint32_t& last) const
+    {
+      first = dirtyEnd;
+      for (uint32_t i = dirtyBegin; i < dirtyEnd; i++)
+      {
+        if (pending[i] != bound[i])
+        {
+          first = std::min(first, i);
+          last = i;
+        }
+      }
+      return first != dirtyEnd;
+    }
+
+    // Call after the dirty range has been sent to GL
+    void MarkClean()
+    {
+      if (IsDirty())
+      {
+        std::copy(pending.begin() + dirtyBegin, pending.begin() + dirtyEnd, bound.begin() + dirtyBegin);
+      }
+      dirtyBegin = UINT32_MAX;
+      dirtyEnd = 0;
+    }
+
+    // Call when every slot is known to be unbound in GL
+    void Reset()
+    {
+      std::fill(bound.begin(), bound.end(), T{});
+      std::fill(pending.begin(), pending.end(), T{});
+      dirtyBegin = UINT32_MAX;
+      dirtyEnd = 0;
+      usedEnd = 0;
+    }
+  };
+
+  // Bindings that are part of vertex array object state. Each cached VAO owns one of these.
+  struct VertexArrayBindings
+  {
+    BindingSlots<VertexBufferBinding> vertexBuffers;
+    GLuint indexBuffer{};
+  };
+} // namespace Fwog::detail
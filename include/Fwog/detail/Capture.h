@@ -0,0 +1,236 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/detail/Commands.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Fwog::detail
+{
+  // Capture file format.
+  // A CaptureFileHeader is followed by records, each a CaptureRecordHeader and its payload. Records that create objects
+  // come first, followed by the records of the captured frame. Payloads are packed without padding, and structs are
+  // stored with their in-memory layout, so captures can only be replayed by a build of Fwog with the same version.
+  //
+  // Objects are identified by capture IDs, which count from 1 for each kind of object in the order of their creation
+  // records. 0 means no object.
+  constexpr char CAPTURE_MAGIC[8] = {'F', 'W', 'O', 'G', 'C', 'A', 'P', '\0'};
+  constexpr uint32_t CAPTURE_VERSION = 2;
+
+  struct CaptureFileHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordCount;
+  };
+
+  enum class CaptureRecordType : uint32_t
+  {
+    // Object creation
+    CREATE_BUFFER,
+    CREATE_TEXTURE,
+    CREATE_SAMPLER,
+    CREATE_GRAPHICS_PIPELINE,
+    CREATE_COMPUTE_PIPELINE,
+
+    // Frame
+    BEGIN_SWAPCHAIN_RENDERING,
+    BEGIN_RENDERING,
+    END_RENDERING,
+    BEGIN_COMPUTE,
+    END_COMPUTE,
+    COMMANDS, // Encoded like a CommandBuffer, with capture IDs in place of handles
+    UPDATE_BUFFER,
+    UPDATE_TEXTURE,
+    COPY_BUFFER,
+    MEMORY_BARRIER,
+    TEXTURE_BARRIER,
+    BLIT_TEXTURE, // A target of 0 is the swapchain
+    CLEAR_TEXTURE,
+    UNRECORDED_CALL, // The name of a function that was called during the capture, but cannot be replayed
+  };
+
+  struct CaptureRecordHeader
+  {
+    CaptureRecordType type;
+    uint32_t size;
+  };
+
+  // Calls a function on each object handle in the payload of an encoded command, so handles can be replaced with
+  // capture IDs and back. The function is called with a CaptureRecordType naming the kind of object and a reference to
+  // the handle.
+  template<class Fn>
+  void ForEachCommandHandle(CommandType type, std::byte* payload, Fn&& fn)
+  {
+    auto visit = [&]<class T>(T& command, auto... members)
+    {
+      std::memcpy(&command, payload, sizeof(T));
+      (fn(members.first, command.*(members.second)), ...);
+      std::memcpy(payload, &command, sizeof(T));
+    };
+    auto member = [](CaptureRecordType kind, auto pointer) { return std::pair{kind, pointer}; };
+    constexpr auto BUFFER = CaptureRecordType::CREATE_BUFFER;
+
+    switch (type)
+    {
+    case CommandType::BIND_GRAPHICS_PIPELINE:
+    {
+      BindGraphicsPipelineCommand command;
+      visit(command, member(CaptureRecordType::CREATE_GRAPHICS_PIPELINE, &BindGraphicsPipelineCommand::pipeline));
+      break;
+    }
+    case CommandType::BIND_COMPUTE_PIPELINE:
+    {
+      BindComputePipelineCommand command;
+      visit(command, member(CaptureRecordType::CREATE_COMPUTE_PIPELINE, &BindComputePipelineCommand::pipeline));
+      break;
+    }
+    case CommandType::BIND_VERTEX_BUFFER:
+    {
+      BindVertexBufferCommand command;
+      visit(command, member(BUFFER, &BindVertexBufferCommand::buffer));
+      break;
+    }
+    case CommandType::BIND_INDEX_BUFFER:
+    {
+      BindIndexBufferCommand command;
+      visit(command, member(BUFFER, &BindIndexBufferCommand::buffer));
+      break;
+    }
+    case CommandType::BIND_UNIFORM_BUFFER:
+    case CommandType::BIND_STORAGE_BUFFER:
+    {
+      // Storage buffer commands begin with the same range as uniform buffer commands
+      BindBufferRangeCommand command;
+      visit(command, member(BUFFER, &BindBufferRangeCommand::buffer));
+      break;
+    }
+    case CommandType::BIND_SAMPLED_IMAGE:
+    {
+      BindSampledImageCommand command;
+      visit(command,
+            member(CaptureRecordType::CREATE_TEXTURE, &BindSampledImageCommand::texture),
+            member(CaptureRecordType::CREATE_SAMPLER, &BindSampledImageCommand::sampler));
+      break;
+    }
+    case CommandType::BIND_IMAGE:
+    {
+      BindImageCommand command;
+      visit(command, member(CaptureRecordType::CREATE_TEXTURE, &BindImageCommand::texture));
+      break;
+    }
+    case CommandType::DRAW_INDIRECT:
+    case CommandType::DRAW_INDEXED_INDIRECT:
+    {
+      DrawIndirectCommand command;
+      visit(command, member(BUFFER, &DrawIndirectCommand::commandBuffer));
+      break;
+    }
+    case CommandType::DRAW_INDIRECT_COUNT:
+    case CommandType::DRAW_INDEXED_INDIRECT_COUNT:
+    {
+      DrawIndirectCountCommand command;
+      visit(command,
+            member(BUFFER, &DrawIndirectCountCommand::commandBuffer),
+            member(BUFFER, &DrawIndirectCountCommand::countBuffer));
+      break;
+    }
+    case CommandType::DISPATCH_INDIRECT:
+    {
+      DispatchIndirectCommand command;
+      visit(command, member(BUFFER, &DispatchIndirectCommand::commandBuffer));
+      break;
+    }
+    default: break;
+    }
+  }
+
+  // Records the Fwog calls made on a context while it is current (see BeginCapture).
+  // Objects that existed before the capture began are recorded when they are first used.
+  class CaptureWriter
+  {
+  public:
+    void RecordCommand(CommandType type, const void* payload, uint16_t size);
+    void RecordBeginSwapchainRendering(const SwapchainRenderInfo& renderInfo);
+    void RecordBeginRendering(const RenderInfo& renderInfo);
+    void RecordEndRendering();
+    void RecordBeginCompute(std::string_view name);
+    void RecordEndCompute();
+    void RecordBufferUpdate(uint32_t buffer, uint64_t offset, const void* data, uint64_t size);
+    void RecordTextureUpdate(const Texture& texture, const TextureUpdateInfo& info);
+    void RecordCopyBuffer(const CopyBufferInfo& copy);
+    void RecordMemoryBarrier(MemoryBarrierBits accessBits);
+    void RecordTextureBarrier();
+    void RecordBlitTexture(const Texture& source,
+                           const Texture* target,
+                           Offset3D sourceOffset,
+                           Offset3D targetOffset,
+                           Extent3D sourceExtent,
+                           Extent3D targetExtent,
+                           Filter filter,
+                           AspectMask aspect);
+    void RecordTextureClear(const Texture& texture, const TextureClearInfo& info);
+
+    // Notes that a function the capture cannot record was called, so the replay will differ from the captured frame.
+    // Each function is recorded once.
+    void RecordUnrecordedCall(std::string_view function);
+
+    // Called when an object is destroyed, as its handle may be reused for another object
+    void ForgetBuffer(uint32_t buffer);
+    void ForgetTexture(uint32_t texture);
+
+    // Returns the capture file
+    std::vector<std::byte> Finish();
+
+  private:
+    // Returns the capture ID of an object, recording it first if this is its first use
+    uint32_t ReferenceBuffer(uint32_t buffer);
+    uint32_t ReferenceTexture(uint32_t texture);
+    uint32_t ReferenceSampler(uint32_t sampler);
+    uint32_t ReferenceGraphicsPipeline(uint64_t pipeline);
+    uint32_t ReferenceComputePipeline(uint64_t pipeline);
+
+    // Starts a record in the object or frame stream and returns its offset. The payload is appended to the same
+    // stream, after which the record must be ended.
+    size_t BeginRecord(std::vector<std::byte>& stream, CaptureRecordType type);
+    void EndRecord(std::vector<std::byte>& stream, size_t start);
+    void EndCommands();
+
+    // Object records are kept separate from the frame, so they can be written first
+    std::vector<std::byte> objects_;
+    std::vector<std::byte> frame_;
+    uint32_t recordCount_ = 0;
+
+    // Offset of the COMMANDS record at the end of the frame stream, if the last record is one
+    std::optional<size_t> commandsStart_;
+
+    std::unordered_map<uint32_t, uint32_t> bufferIds_;
+    std::unordered_map<uint32_t, uint32_t> textureIds_;
+    std::unordered_map<uint32_t, uint32_t> samplerIds_;
+    std::unordered_map<uint64_t, uint32_t> graphicsPipelineIds_;
+    std::unordered_map<uint64_t, uint32_t> computePipelineIds_;
+    uint32_t nextBufferId_ = 1;
+    uint32_t nextTextureId_ = 1;
+
+    // The contents of mapped buffers can be written at any time without Fwog knowing, so they are read at the end of
+    // the capture (or when the buffer is destroyed) into space reserved in their CREATE_BUFFER record.
+    struct MappedBuffer
+    {
+      uint32_t buffer;
+      size_t dataOffset;
+      uint64_t size;
+    };
+    std::vector<MappedBuffer> mappedBuffers_;
+
+    std::vector<std::string_view> unrecordedCalls_;
+
+    void ReadMappedBuffer(const MappedBuffer& mapped);
+  };
+} // namespace Fwog::detail
@@ -0,0 +1,191 @@
+#pragma once
+#include <Fwog/Rendering.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Fwog::detail
+{
+  // Versions of the Cmd:: functions that take raw handles instead of objects.
+  // Cmd:: functions and CommandBuffer replay both go through these, so they share validation and state deduplication.
+  // Validation that needs the objects themselves (e.g., mip level counts) happens before these are called.
+  void BindGraphicsPipelineInternal(uint64_t pipeline);
+  void BindComputePipelineInternal(uint64_t pipeline, Extent3D workgroupSize);
+  void BindVertexBufferInternal(uint32_t bindingIndex, uint32_t buffer, uint64_t offset, uint64_t stride);
+  void BindIndexBufferInternal(uint32_t buffer, IndexType indexType);
+  void DrawIndirectInternal(uint32_t commandBuffer, uint64_t commandBufferOffset, uint32_t drawCount, uint32_t stride);
+  void DrawIndirectCountInternal(uint32_t commandBuffer,
+                                 uint64_t commandBufferOffset,
+                                 uint32_t countBuffer,
+                                 uint64_t countBufferOffset,
+                                 uint32_t maxDrawCount,
+                                 uint32_t stride);
+  void DrawIndexedIndirectInternal(uint32_t commandBuffer,
+                                   uint64_t commandBufferOffset,
+                                   uint32_t drawCount,
+                                   uint32_t stride);
+  void DrawIndexedIndirectCountInternal(uint32_t commandBuffer,
+                                        uint64_t commandBufferOffset,
+                                        uint32_t countBuffer,
+                                        uint64_t countBufferOffset,
+                                        uint32_t maxDrawCount,
+                                        uint32_t stride);
+  void BindUniformBufferInternal(uint32_t index, uint32_t buffer, uint64_t offset, uint64_t size);
+  void BindStorageBufferInternal(uint32_t index, uint32_t buffer, uint64_t offset, uint64_t size, AccessType access);
+  void BindSampledImageInternal(uint32_t index, uint32_t texture, uint32_t sampler);
+  void BindImageInternal(uint32_t index, uint32_t texture, uint32_t level, Format format, AccessType access);
+  void DispatchIndirectInternal(uint32_t commandBuffer, uint64_t commandBufferOffset);
+
+  // Executes a range of encoded commands. The range must start and end on command boundaries.
+  void ExecuteCommandsInternal(std::span<const std::byte> commands);
+
+  // Encoding used by CommandBuffer.
+  // Each command is a CommandHeader followed by its POD payload. Commands are packed without padding, so payloads
+  // must be copied out with memcpy before they are read.
+  enum class CommandType : uint16_t
+  {
+    BIND_GRAPHICS_PIPELINE,
+    BIND_COMPUTE_PIPELINE,
+    SET_VIEWPORT,
+    SET_SCISSOR,
+    BIND_VERTEX_BUFFER,
+    BIND_INDEX_BUFFER,
+    BIND_UNIFORM_BUFFER,
+    BIND_STORAGE_BUFFER,
+    BIND_SAMPLED_IMAGE,
+    BIND_IMAGE,
+    DRAW,
+    DRAW_INDEXED,
+    DRAW_INDIRECT,
+    DRAW_INDIRECT_COUNT,
+    DRAW_INDEXED_INDIRECT,
+    DRAW_INDEXED_INDIRECT_COUNT,
+    DISPATCH,
+    DISPATCH_INVOCATIONS,
+    DISPATCH_INDIRECT,
+  };
+
+  struct CommandHeader
+  {
+    CommandType type;
+
+    // Size of the payload that follows the header
+    uint16_t size;
+  };
+
+  struct BindGraphicsPipelineCommand
+  {
+    uint64_t pipeline;
+  };
+
+  struct BindComputePipelineCommand
+  {
+    uint64_t pipeline;
+    Extent3D workgroupSize;
+  };
+
+  struct SetViewportCommand
+  {
+    Viewport viewport;
+  };
+
+  struct SetScissorCommand
+  {
+    Rect2D scissor;
+  };
+
+  struct BindVertexBufferCommand
+  {
+    uint32_t bindingIndex;
+    uint32_t buffer;
+    uint64_t offset;
+    uint64_t stride;
+  };
+
+  struct BindIndexBufferCommand
+  {
+    uint32_t buffer;
+    IndexType indexType;
+  };
+
+  // The size is resolved when recording, so it is never WHOLE_BUFFER.
+  struct BindBufferRangeCommand
+  {
+    uint32_t index;
+    uint32_t buffer;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  struct BindStorageBufferCommand
+  {
+    BindBufferRangeCommand range;
+    AccessType access;
+  };
+
+  struct BindSampledImageCommand
+  {
+    uint32_t index;
+    uint32_t texture;
+    uint32_t sampler;
+  };
+
+  struct BindImageCommand
+  {
+    uint32_t index;
+    uint32_t texture;
+    uint32_t level;
+    Format format;
+    AccessType access;
+  };
+
+  struct DrawCommand
+  {
+    uint32_t vertexCount;
+    uint32_t instanceCount;
+    uint32_t firstVertex;
+    uint32_t firstInstance;
+  };
+
+  struct DrawIndexedCommand
+  {
+    uint32_t indexCount;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t firstInstance;
+  };
+
+  // Used for both DrawIndirect and DrawIndexedIndirect
+  struct DrawIndirectCommand
+  {
+    uint32_t commandBuffer;
+    uint32_t drawCount;
+    uint64_t commandBufferOffset;
+    uint32_t stride;
+  };
+
+  // Used for both DrawIndirectCount and DrawIndexedIndirectCount
+  struct DrawIndirectCountCommand
+  {
+    uint32_t commandBuffer;
+    uint32_t countBuffer;
+    uint64_t commandBufferOffset;
+    uint64_t countBufferOffset;
+    uint32_t maxDrawCount;
+    uint32_t stride;
+  };
+
+  // Used for both Dispatch and DispatchInvocations
+  struct DispatchCommand
+  {
+    Extent3D count;
+  };
+
+  struct DispatchIndirectCommand
+  {
+    uint32_t commandBuffer;
+    uint64_t commandBufferOffset;
+  };
+} // namespace Fwog::detail
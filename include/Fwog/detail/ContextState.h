@@ -2,26 +2,36 @@
 #include <Fwog/Context.h>
 
 #include <Fwog/BasicTypes.h>
+#include <Fwog/detail/BarrierTracker.h>
+#include <Fwog/detail/BindingState.h>
+#include <Fwog/detail/Capture.h>
 #include <Fwog/detail/FramebufferCache.h>
 #include <Fwog/detail/PipelineManager.h>
-#include <Fwog/detail/SamplerCache.h>
 #include <Fwog/detail/VertexArrayCache.h>
 
 #include <sstream>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include FWOG_OPENGL_HEADER
 
-namespace Fwog::detail
+namespace Fwog
 {
-  constexpr int MAX_COLOR_ATTACHMENTS = 8;
+  class GpuProfiler;
+}
 
+namespace Fwog::detail
+{
   struct ContextState
   {
     DeviceProperties properties;
 
     void (*verboseMessageCallback)(const char*) = nullptr;
 
+    // True for contexts created with CreateWorkerContext, which may only create and update resources
+    bool isWorkerContext = false;
+
     // Used for scope error checking
     bool isComputeActive = false;
     bool isRendering = false;
@@ -32,21 +42,34 @@ namespace Fwog::detail
     // Currently unused
     bool isRenderingToSwapchain = false;
 
+    // The framebuffer that swapchain rendering targets. 0 (the default framebuffer) unless an OffscreenSwapchain exists.
+    uint32_t swapchainFbo = 0;
+
     // True during a render or compute scope that has a name.
     bool isScopedDebugGroupPushed = false;
 
     // True when a pipeline with a name is bound during a render or compute scope.
     bool isPipelineDebugGroupPushed = false;
 
+    // The profiler between its BeginFrame and EndFrame. Debug groups are also pushed to it as zones.
+    GpuProfiler* profiler = nullptr;
+
+    // Records calls between BeginCapture and EndCapture
+    std::unique_ptr<CaptureWriter> capture;
+
+    // Incremented with FWOG_COUNT
+    FrameStatistics statistics{};
+
     // True during SwapchainRendering scopes that disable sRGB.
     // This is needed since regular Rendering scopes always have framebuffer sRGB enabled
     // (the user uses framebuffer attachments to decide if they want the linear->sRGB conversion).
     bool srgbWasDisabled = false;
 
-    // Stores a pointer to the previously bound graphics pipeline state. This is used for state deduplication.
-    // A shared_ptr is needed as the user can delete pipelines at any time, but we need to ensure it stays alive until
-    // the next pipeline is bound.
-    std::shared_ptr<const detail::GraphicsPipelineInfoOwning> lastGraphicsPipeline{};
+    // Handle of the previously bound graphics pipeline. This is used for state deduplication.
+    // The user can delete pipelines at any time, but the state of this one needs to stay alive until the next pipeline
+    // is bound, so destroying it is deferred until then (see SetLastGraphicsPipelineInternal).
+    uint64_t lastGraphicsPipeline = 0;
+    bool isLastGraphicsPipelineDestroyed = false;
     bool lastPipelineWasCompute = false;
 
     Extent3D lastComputePipelineWorkgroupSize{};
@@ -67,6 +90,28 @@ namespace Fwog::detail
     GLuint currentVao = 0;
     GLuint currentFbo = 0;
 
+    // Shadow state for resource bindings. Bind* commands only update these, and the changes are flushed to GL right
+    // before the next draw or dispatch. This lets redundant binds be skipped and the rest be batched into multi-binds.
+    BindingSlots<BufferRangeBinding> uniformBuffers;
+    BindingSlots<BufferRangeBinding> storageBuffers;
+    BindingSlots<GLuint> textureUnits;
+    BindingSlots<GLuint> samplerUnits;
+    BindingSlots<ImageBinding> imageUnits;
+
+    // Whether each storage buffer slot was bound with write access. Writes to these buffers (and to images bound with
+    // write access) are recorded in the barrier tracker after every draw or dispatch.
+    std::vector<bool> storageBufferWritable;
+    uint32_t storageBufferWritableEnd = 0;
+
+    // Points into the VAO cache. Null until a graphics pipeline has been bound.
+    VertexArrayBindings* currentVertexArrayBindings = nullptr;
+
+    // Scratch arrays for multi-bind calls (glBindBuffersRange etc.), which take their arguments as parallel arrays.
+    std::vector<GLuint> scratchNames;
+    std::vector<GLintptr> scratchOffsets;
+    std::vector<GLsizeiptr> scratchSizes;
+    std::vector<GLsizei> scratchStrides;
+
     // These persist until another Pipeline is bound.
     // They are not used for state deduplication, as they are arguments for GL draw calls.
     PrimitiveTopology currentTopology{};
@@ -74,14 +119,58 @@ namespace Fwog::detail
 
     detail::FramebufferCache fboCache;
     detail::VertexArrayCache vaoCache;
-    detail::SamplerCache samplerCache;
-  } inline* context = nullptr;
+    detail::BarrierTracker barrierTracker;
+  } inline thread_local* context = nullptr; // Each thread with a current context has its own state
+
+// Adds to a counter of the current context's FrameStatistics. The arguments are not evaluated unless
+// FWOG_ENABLE_STATISTICS is defined.
+#ifdef FWOG_ENABLE_STATISTICS
+  #define FWOG_COUNT(counter, n) (::Fwog::detail::context->statistics.counter += (n))
+#else
+  #define FWOG_COUNT(counter, n) ((void)0)
+#endif
 
   // Clears all resource bindings.
-  // This is called at the beginning of rendering/compute scopes 
-  // or when the pipeline state has been invalidated, but only in debug mode.
+  // This is called at the beginning of rendering/compute scopes in debug mode, and whenever the pipeline state has been
+  // invalidated, as the binding shadow state must then be brought back in sync with GL.
   void ZeroResourceBindings();
 
+  // Must be called when a buffer or texture is deleted. GL unbinds deleted objects, and their names may be recycled,
+  // so the binding shadow state must not consider them bound anymore.
+  void RemoveBufferBindings(GLuint buffer);
+  void RemoveTextureBindings(GLuint texture);
+
+  // Deletes a buffer or texture and removes it from the current context's state. On worker contexts, deletion is
+  // deferred to the main context instead (see DeferredDeletions).
+  void DestroyBuffer(GLuint buffer, bool isMapped);
+  void DestroyTexture(GLuint texture, uint64_t bindlessHandle);
+
+  // Buffers and textures destroyed on worker contexts. The main context refers to objects by name in its binding
+  // shadow state, barrier tracker, and caches, and GL recycles the names of deleted objects. If a worker deleted an
+  // object, a new object could get its name while the main context still considered it bound. Instead, the main
+  // context deletes these objects at the start of its next rendering or compute scope, and when it is terminated.
+  struct DeferredDeletions
+  {
+    struct DeferredBuffer
+    {
+      GLuint buffer;
+      bool isMapped;
+    };
+
+    struct DeferredTexture
+    {
+      GLuint texture;
+      uint64_t bindlessHandle;
+    };
+
+    std::mutex mutex;
+    std::vector<DeferredBuffer> buffers;
+    std::vector<DeferredTexture> textures;
+  } inline gDeferredDeletions;
+
+  // Deletes the objects that worker contexts destroyed. Only called on the main context.
+  void ProcessDeferredDeletions();
+
   // Prints a formatted message to a stringstream, then
   // invokes the message callback with the formatted message
   template<class... Args>
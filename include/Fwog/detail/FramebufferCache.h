@@ -1,28 +1,26 @@
 #pragma once
 #include "Fwog/Rendering.h"
 #include "Fwog/Texture.h"
+#include "Fwog/detail/PipelineStateBlock.h"
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <unordered_map>
 #include <vector>
-#include <optional>
 
 namespace Fwog::detail
 {
-  struct TextureProxy
+  // Identifies a framebuffer by the handles of its attachments. Handles are enough to tell textures apart, since the
+  // framebuffers that reference a texture are destroyed along with it (see FramebufferCache::RemoveTexture).
+  struct FramebufferKey
   {
-    TextureCreateInfo createInfo;
-    uint32_t id;
+    std::array<uint32_t, MAX_COLOR_ATTACHMENTS> colorAttachments{};
+    uint32_t colorAttachmentCount = 0;
+    uint32_t depthAttachment = 0;
+    uint32_t stencilAttachment = 0;
 
-    bool operator==(const TextureProxy&) const noexcept = default;
-  };
-
-  struct RenderAttachments
-  {
-    std::vector<TextureProxy> colorAttachments{};
-    std::optional<TextureProxy> depthAttachment{};
-    std::optional<TextureProxy> stencilAttachment{};
-
-    bool operator==(const RenderAttachments& rhs) const;
+    bool operator==(const FramebufferKey&) const noexcept = default;
   };
 
   class FramebufferCache
@@ -38,7 +36,7 @@ namespace Fwog::detail
 
     [[nodiscard]] std::size_t Size() const
     {
-      return framebufferCacheKey_.size();
+      return size_;
     }
 
     void Clear();
@@ -48,10 +46,49 @@ namespace Fwog::detail
       Clear();
     }
 
-    void RemoveTexture(const Texture& texture);
+    // Destroys the framebuffers that reference a texture. Must be called when a texture is deleted, as its handle may
+    // be reused.
+    void RemoveTexture(uint32_t texture);
+
+    // Limits the number of cached framebuffers. When a framebuffer is created at the limit, the least recently used
+    // one is destroyed. Zero means no limit. Otherwise, the limit is at least 2, so blits can use two framebuffers.
+    void SetCapacity(uint32_t maxFramebuffers);
 
   private:
-    std::vector<RenderAttachments> framebufferCacheKey_;
-    std::vector<uint32_t> framebufferCacheValue_;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Entry
+    {
+      FramebufferKey key;
+      size_t hash;
+
+      // 0 if the entry is free
+      uint32_t fbo;
+
+      // Neighbors in the LRU list, from most to least recently used. Free entries are linked through next.
+      uint32_t prev;
+      uint32_t next;
+    };
+
+    [[nodiscard]] uint32_t Find(const FramebufferKey& key, size_t hash) const;
+    uint32_t Insert(const FramebufferKey& key, size_t hash, uint32_t fbo);
+    void Erase(uint32_t entry);
+    void Grow();
+    void Unlink(uint32_t entry);
+    void LinkFront(uint32_t entry);
+
+    std::vector<Entry> entries_;
+    uint32_t freeEntries_ = NONE;
+    size_t size_ = 0;
+
+    // Open-addressed table of entry indices with linear probing. Its size is a power of two, and at most half full.
+    std::vector<uint32_t> slots_;
+
+    uint32_t mostRecent_ = NONE;
+    uint32_t leastRecent_ = NONE;
+    uint32_t capacity_ = 0;
+
+    // The entries whose framebuffers reference each texture, so destroying a texture does not search every entry
+    std::unordered_map<uint32_t, std::vector<uint32_t>> textureEntries_;
   };
 } // namespace Fwog::detail
@@ -0,0 +1,119 @@
+// Derived from OffsetAllocator by Sebastian Aaltonen (https://github.com/sebbbi/OffsetAllocator), under this license:
+//
+// MIT License
+//
+// Copyright (c) 2023 Sebastian Aaltonen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include <Fwog/Config.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Fwog::detail
+{
+  // A two-level segregated fit (TLSF) allocator for ranges of a 32-bit address space. It hands out offsets rather
+  // than memory, so it can manage the storage of GPU buffers.
+  //
+  // Free ranges are kept in 256 bins whose sizes follow a small floating point format (5-bit exponent, 3-bit
+  // mantissa), so the bins cover every size with at most 12.5% waste. A bitmask of non-empty bins per exponent and a
+  // bitmask of non-empty exponents let both allocation and free find a bin with a couple of bit scans: O(1) regardless
+  // of the number of allocations. Freed ranges are merged with free neighbors immediately.
+  class OffsetAllocator
+  {
+  public:
+    static constexpr uint32_t NO_SPACE = UINT32_MAX;
+
+    struct Allocation
+    {
+      uint32_t offset = NO_SPACE;
+
+      // Pass to Free. NO_SPACE if the allocation failed.
+      uint32_t node = NO_SPACE;
+    };
+
+    struct StorageReport
+    {
+      uint32_t totalFreeSpace;
+      uint32_t largestFreeRegion;
+    };
+
+    explicit OffsetAllocator(uint32_t size = 0);
+
+    [[nodiscard]] Allocation Allocate(uint32_t size);
+    void Free(uint32_t node);
+
+    // Returns the smallest size not less than size that is guaranteed to fit in a free range of its own size.
+    // Sizes between bins are rounded up when allocating, so e.g. an allocation of the whole space may not fit otherwise.
+    static uint32_t RoundUpToBinSize(uint32_t size);
+
+    // Frees every allocation
+    void Reset(uint32_t size);
+
+    [[nodiscard]] StorageReport GetStorageReport() const;
+
+    [[nodiscard]] uint32_t Size() const noexcept
+    {
+      return size_;
+    }
+
+    [[nodiscard]] uint32_t AllocationSize(uint32_t node) const noexcept
+    {
+      return nodes_[node].size;
+    }
+
+  private:
+    static constexpr uint32_t TOP_BIN_COUNT = 32;
+    static constexpr uint32_t BINS_PER_LEAF = 8;
+    static constexpr uint32_t LEAF_BIN_COUNT = TOP_BIN_COUNT * BINS_PER_LEAF;
+    static constexpr uint32_t UNUSED = UINT32_MAX;
+
+    struct Node
+    {
+      uint32_t offset = 0;
+      uint32_t size = 0;
+
+      // Nodes in the same bin
+      uint32_t binListPrev = UNUSED;
+      uint32_t binListNext = UNUSED;
+
+      // Nodes that are adjacent in the address space
+      uint32_t neighborPrev = UNUSED;
+      uint32_t neighborNext = UNUSED;
+
+      bool isUsed = false;
+    };
+
+    uint32_t InsertNodeIntoBin(uint32_t size, uint32_t offset);
+    void RemoveNodeFromBin(uint32_t node);
+
+    uint32_t size_ = 0;
+    uint32_t freeStorage_ = 0;
+
+    uint32_t usedBinsTop_ = 0;
+    std::array<uint8_t, TOP_BIN_COUNT> usedBins_{};
+    std::array<uint32_t, LEAF_BIN_COUNT> binHeads_{};
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> freeNodes_;
+  };
+} // namespace Fwog::detail
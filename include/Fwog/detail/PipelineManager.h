@@ -1,15 +1,20 @@
 #pragma once
 #include <Fwog/Pipeline.h>
-#include <memory>
+#include <Fwog/detail/PipelineStateBlock.h>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace Fwog::detail
 {
+  struct CachedVertexArray;
+
   // owning versions of pipeline info structs so we don't lose references
   struct VertexInputStateOwning
   {
     std::vector<VertexInputBindingDescription> vertexBindingDescriptions;
+
+    bool operator==(const VertexInputStateOwning&) const noexcept = default;
   };
 
   struct ColorBlendStateOwning
@@ -22,6 +27,7 @@ namespace Fwog::detail
 
   struct GraphicsPipelineInfoOwning
   {
+    uint32_t program;
     std::string name;
     InputAssemblyState inputAssemblyState;
     VertexInputStateOwning vertexInputState;
@@ -31,18 +37,46 @@ namespace Fwog::detail
     DepthState depthState;
     StencilState stencilState;
     ColorBlendStateOwning colorBlendState;
+
+    // The state above, packed for fast comparison when binding the pipeline
+    PipelineStateBlock stateBlock;
+
+    // The VAO for vertexInputState, acquired from the main context's VertexArrayCache when the pipeline is compiled
+    CachedVertexArray* vertexArray;
   };
 
   struct ComputePipelineInfoOwning
   {
+    uint32_t program;
     std::string name;
   };
 
+  // Pipelines are stored in slot maps and identified by their generational handles (see SlotMap).
+  // Get*PipelineInternal returns null for handles of destroyed pipelines. The returned pointers are invalidated when
+  // another pipeline of the same kind is compiled.
   uint64_t CompileGraphicsPipelineInternal(const GraphicsPipelineInfo& info);
-  std::shared_ptr<const GraphicsPipelineInfoOwning> GetGraphicsPipelineInternal(uint64_t pipeline);
+  const GraphicsPipelineInfoOwning* GetGraphicsPipelineInternal(uint64_t pipeline);
   void DestroyGraphicsPipelineInternal(uint64_t pipeline);
 
+  // Sets the graphics pipeline that the next bound pipeline's state is compared against (0 for none).
+  // A pipeline that is destroyed while it is the last bound one keeps its state until it is replaced here.
+  void SetLastGraphicsPipelineInternal(uint64_t pipeline);
+
   uint64_t CompileComputePipelineInternal(const ComputePipelineInfo& info);
-  std::shared_ptr<const ComputePipelineInfoOwning> GetComputePipelineInternal(uint64_t pipeline);
+  const ComputePipelineInfoOwning* GetComputePipelineInternal(uint64_t pipeline);
   void DestroyComputePipelineInternal(uint64_t pipeline);
+
+  // Non-blocking compilation. Begin*PipelineInternal starts linking the program and returns a handle to the pending
+  // pipeline, which is kept in a separate slot map until Finish*PipelineInternal waits for the link to complete, checks
+  // it, and moves the pipeline into the map of compiled pipelines. Finish*PipelineInternal consumes the pending handle
+  // even if it throws. Abandon*PipelineInternal deletes a pending pipeline that will never be finished.
+  uint64_t BeginGraphicsPipelineInternal(const GraphicsPipelineInfo& info);
+  bool IsGraphicsPipelineReadyInternal(uint64_t pendingPipeline);
+  uint64_t FinishGraphicsPipelineInternal(uint64_t pendingPipeline);
+  void AbandonGraphicsPipelineInternal(uint64_t pendingPipeline);
+
+  uint64_t BeginComputePipelineInternal(const ComputePipelineInfo& info);
+  bool IsComputePipelineReadyInternal(uint64_t pendingPipeline);
+  uint64_t FinishComputePipelineInternal(uint64_t pendingPipeline);
+  void AbandonComputePipelineInternal(uint64_t pendingPipeline);
 } // namespace Fwog::detail
\ No newline at end of file
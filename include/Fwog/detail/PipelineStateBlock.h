@@ -0,0 +1,119 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Pipeline.h>
+
+#include <array>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+  #include <emmintrin.h>
+  #define FWOG_PIPELINE_STATE_BLOCK_SSE2
+#endif
+
+namespace Fwog::detail
+{
+  constexpr int MAX_COLOR_ATTACHMENTS = 8;
+
+  // The fixed-function state of a graphics pipeline, packed into 32 words when the pipeline is created.
+  // Each word (or contiguous range of words) holds the arguments of one GL call, so the state that changes between two
+  // pipelines can be found by comparing their blocks word by word (see DiffPipelineStateBlocks) instead of comparing
+  // every field of the pipeline info.
+  //
+  // Write masks (glDepthMask, glStencilMaskSeparate, glColorMaski) are not part of the block, since they can also be
+  // changed by the clears at the start of rendering. They are tracked separately in the context.
+  struct PipelineStateBlock
+  {
+    // Index of each word in the block. Groups that take more than one word are contiguous.
+    enum Word : uint32_t
+    {
+      ENABLES,              // EnableBit for every capability toggled with glEnable/glDisable
+      POLYGON_MODE,         // glPolygonMode
+      CULL_FACE,            // glCullFace
+      FRONT_FACE,           // glFrontFace
+      DEPTH_BIAS_SLOPE,     // glPolygonOffset (factor)
+      DEPTH_BIAS_CONSTANT,  // glPolygonOffset (units)
+      LINE_WIDTH,           // glLineWidth
+      POINT_SIZE,           // glPointSize
+      PATCH_CONTROL_POINTS, // glPatchParameteri(GL_PATCH_VERTICES)
+      MIN_SAMPLE_SHADING,   // glMinSampleShading
+      SAMPLE_MASK,          // glSampleMaski
+      DEPTH_FUNC,           // glDepthFunc
+      LOGIC_OP,             // glLogicOp
+
+      // glBlendColor (4 words)
+      BLEND_CONSTANTS,
+
+      // glStencilOpSeparate + glStencilFuncSeparate (3 words per face: packed ops and func, reference, compare mask)
+      STENCIL_FRONT = BLEND_CONSTANTS + 4,
+      STENCIL_BACK = STENCIL_FRONT + 3,
+
+      // glBlendFuncSeparatei + glBlendEquationSeparatei (1 word per attachment)
+      BLEND_ATTACHMENTS = STENCIL_BACK + 3,
+
+      WORD_COUNT = 32,
+    };
+
+    static_assert(BLEND_ATTACHMENTS + MAX_COLOR_ATTACHMENTS <= WORD_COUNT);
+
+    // Bits of the ENABLES word
+    enum EnableBit : uint32_t
+    {
+      PRIMITIVE_RESTART_BIT = 1 << 0,
+      DEPTH_CLAMP_BIT = 1 << 1,
+      CULL_FACE_BIT = 1 << 2,
+      POLYGON_OFFSET_FILL_BIT = 1 << 3,
+      POLYGON_OFFSET_LINE_BIT = 1 << 4,
+      POLYGON_OFFSET_POINT_BIT = 1 << 5,
+      SAMPLE_SHADING_BIT = 1 << 6,
+      SAMPLE_MASK_BIT = 1 << 7,
+      SAMPLE_ALPHA_TO_COVERAGE_BIT = 1 << 8,
+      SAMPLE_ALPHA_TO_ONE_BIT = 1 << 9,
+      DEPTH_TEST_BIT = 1 << 10,
+      STENCIL_TEST_BIT = 1 << 11,
+      COLOR_LOGIC_OP_BIT = 1 << 12,
+      BLEND_BIT = 1 << 13,
+      ENABLE_BIT_COUNT = 14,
+    };
+
+    // Masks of the words of each multi-word group in a dirty mask returned by DiffPipelineStateBlocks
+    static constexpr uint32_t DEPTH_BIAS_WORDS = 0b11u << DEPTH_BIAS_SLOPE;
+    static constexpr uint32_t BLEND_CONSTANTS_WORDS = 0b1111u << BLEND_CONSTANTS;
+    static constexpr uint32_t STENCIL_FRONT_WORDS = 0b111u << STENCIL_FRONT;
+    static constexpr uint32_t STENCIL_BACK_WORDS = 0b111u << STENCIL_BACK;
+    static constexpr uint32_t BLEND_ATTACHMENTS_WORDS = ((1u << MAX_COLOR_ATTACHMENTS) - 1) << BLEND_ATTACHMENTS;
+
+    // Value of the words of blend attachments that the pipeline doesn't have
+    static constexpr uint32_t UNUSED_ATTACHMENT = UINT32_MAX;
+
+    alignas(16) std::array<uint32_t, WORD_COUNT> words{};
+  };
+
+  static_assert(sizeof(PipelineStateBlock) == PipelineStateBlock::WORD_COUNT * sizeof(uint32_t));
+
+  // Packs the state of a pipeline into a block. Every field that affects a GL call is encoded losslessly, so two blocks
+  // are equal if and only if the state they were made from would result in the same GL calls.
+  PipelineStateBlock MakePipelineStateBlock(const GraphicsPipelineInfo& info);
+
+  // Returns a mask where bit i is set if word i of the blocks differs
+  inline uint32_t DiffPipelineStateBlocks(const PipelineStateBlock& a, const PipelineStateBlock& b) noexcept
+  {
+#ifdef FWOG_PIPELINE_STATE_BLOCK_SSE2
+    // Compare four words at a time, then gather the sign bit of each lane of the result
+    uint32_t equal = 0;
+    for (uint32_t i = 0; i < PipelineStateBlock::WORD_COUNT; i += 4)
+    {
+      const auto va = _mm_load_si128(reinterpret_cast<const __m128i*>(a.words.data() + i));
+      const auto vb = _mm_load_si128(reinterpret_cast<const __m128i*>(b.words.data() + i));
+      equal |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(va, vb)))) << i;
+    }
+    return ~equal;
+#else
+    uint32_t dirty = 0;
+    for (uint32_t i = 0; i < PipelineStateBlock::WORD_COUNT; i++)
+    {
+      dirty |= static_cast<uint32_t>(a.words[i] != b.words[i]) << i;
+    }
+    return dirty;
+#endif
+  }
+} // namespace Fwog::detail
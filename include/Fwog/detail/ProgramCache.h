@@ -0,0 +1,105 @@
+#pragma once
+#include "Fwog/Context.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Fwog::detail
+{
+  // Identifies a shader by its stage (a GLenum) and source. Stable between runs, unlike std::hash.
+  uint64_t HashShaderSource(uint32_t stage, std::string_view source);
+
+  // Identifies a program by the hashes of its shaders, in the order they are attached
+  uint64_t HashProgramShaders(std::span<const uint64_t> shaderHashes);
+
+  // Keeps binaries of linked programs in a file between runs (see ContextInitializeInfo::programCachePath).
+  //
+  // Besides programs, the cache remembers the shaders they were linked from. Those are known to compile, so shaders
+  // with the same source can skip compilation when created, and are only compiled if a program that isn't cached
+  // needs them.
+  //
+  // Shader functions may be called from any thread, and do nothing while the cache is closed. The others must be called
+  // on the main thread.
+  class ProgramCache
+  {
+  public:
+    ProgramCache() = default;
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+
+    // Reads the file at path, if it exists and was written by the same driver
+    void Open(std::string_view path, const DeviceProperties& properties);
+
+    // Writes the file if programs were stored since it was read or last written. Returns false if writing failed.
+    bool Save();
+
+    // Saves and empties the cache. Lookups miss until it is opened again.
+    void Close();
+
+    [[nodiscard]] bool IsOpen() const noexcept
+    {
+      return isOpen_;
+    }
+
+    // Returns whether a shader can be created without being compiled
+    bool SkipShaderCompile(uint64_t shaderHash);
+
+    // Records how long a shader took to compile, which is saved if it is linked into a program that is stored
+    void RecordShaderCompile(uint64_t shaderHash, std::chrono::nanoseconds duration);
+
+    // Records that a shader which skipped compilation had to be compiled after all
+    void RecordSkippedShaderCompiled(uint64_t shaderHash);
+
+    // Creates a program from the binary cached for a key. Returns 0 if there is none or the driver rejected it.
+    uint32_t LoadProgram(uint64_t key);
+
+    // Adds the binary of a linked program, which must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+    // linkDuration is how long creating the program took, excluding compiling its shaders.
+    void StoreProgram(uint64_t key,
+                      uint32_t program,
+                      std::span<const uint64_t> shaderHashes,
+                      std::chrono::nanoseconds linkDuration);
+
+    [[nodiscard]] ProgramCacheStatistics GetStatistics() const;
+
+  private:
+    struct ProgramEntry
+    {
+      uint32_t binaryFormat;
+      uint32_t linkMicroseconds;
+      std::vector<std::byte> binary;
+    };
+
+    bool Read();
+
+    bool isOpen_ = false;
+    bool isDirty_ = false;
+    std::string path_;
+
+    // Hash of the driver's vendor, renderer, and version strings, which binaries are only valid for
+    uint64_t driverHash_ = 0;
+
+    // Shaders that were linked into cached programs, and how many microseconds each took to compile
+    std::unordered_map<uint64_t, uint32_t> shaders_;
+
+    // Compile times of the shaders created in this run that aren't in shaders_ yet
+    std::unordered_map<uint64_t, uint32_t> pendingShaders_;
+
+    std::unordered_map<uint64_t, ProgramEntry> programs_;
+
+    ProgramCacheStatistics statistics_{};
+
+    // Serializes access from threads that create shaders
+    mutable std::mutex mutex_;
+  };
+
+  // The process-wide program cache. It is opened by Initialize and closed by Terminate.
+  inline ProgramCache gProgramCache;
+} // namespace Fwog::detail
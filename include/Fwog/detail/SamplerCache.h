@@ -1,34 +1,79 @@
 #pragma once
 #include "Fwog/BasicTypes.h"
 #include "Fwog/Texture.h"
-#include <unordered_map>
 
-template<>
-struct std::hash<Fwog::SamplerState>
-{
-  std::size_t operator()(const Fwog::SamplerState& k) const noexcept;
-};
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 namespace Fwog::detail
 {
+  // Packs the fields of a SamplerState that affect sampling into 64 bits. Filters and enums are stored in bitfields,
+  // and LODs are clamped to [-16, 16) (enough for every mip of the largest textures) and rounded to multiples of 1/256.
+  // States that sample identically have the same key, and no key is zero.
+  uint64_t PackSamplerState(const SamplerState& samplerState);
+
+  // The canonical state of a key, which samplers are created with
+  SamplerState UnpackSamplerState(uint64_t key);
+
+  // Owns a sampler for each distinct SamplerState. Samplers are shared by every context in a share group, so one cache
+  // serves the main context, worker contexts, and threads that record command buffers.
+  //
+  // Lookups of cached states don't lock or touch the GL context, so they can happen on any thread. Creating a sampler
+  // requires a context on the calling thread.
   class SamplerCache
   {
   public:
     SamplerCache() = default;
     SamplerCache(const SamplerCache&) = delete;
     SamplerCache& operator=(const SamplerCache&) = delete;
-    SamplerCache(SamplerCache&&) noexcept = default;
-    SamplerCache& operator=(SamplerCache&&) noexcept = default;
-    ~SamplerCache()
-    {
-      Clear();
-    }
 
     Sampler CreateOrGetCachedTextureSampler(const SamplerState& samplerState);
     [[nodiscard]] size_t Size() const;
+
+    // Returns the state that a sampler of the cache was created with. This is a linear search.
+    [[nodiscard]] std::optional<SamplerState> FindSamplerState(uint32_t sampler) const;
+
+    // Destroys every sampler. Must not be called while other threads use the cache.
     void Clear();
 
   private:
-    std::unordered_map<SamplerState, Sampler> samplerCache_;
+    struct Slot
+    {
+      // Zero if the slot is empty. Published after sampler, so a reader that sees the key also sees the sampler.
+      std::atomic<uint64_t> key;
+      std::atomic<uint32_t> sampler;
+    };
+
+    // Open-addressed with linear probing. Its size is a power of two, and at most half full.
+    struct Table
+    {
+      explicit Table(size_t size) : slots(std::make_unique<Slot[]>(size)), mask(size - 1) {}
+
+      std::unique_ptr<Slot[]> slots;
+      size_t mask;
+    };
+
+    // Returns 0 if the key is not in the table
+    static uint32_t Find(const Table& table, uint64_t key);
+    static void Insert(Table& table, uint64_t key, uint32_t sampler);
+
+    // The table that lookups start from. Slots are never removed from it, and it is only replaced by a larger copy.
+    std::atomic<Table*> table_ = nullptr;
+
+    // Every table that has been the current one. Older tables are kept, as readers may still be probing them.
+    std::vector<std::unique_ptr<Table>> tables_;
+
+    std::atomic<size_t> size_ = 0;
+
+    // Serializes the creation of samplers
+    std::mutex mutex_;
   };
-} // namespace Fwog::detail
\ No newline at end of file
+
+  // The process-wide sampler cache. It is cleared by Terminate.
+  inline SamplerCache gSamplerCache;
+} // namespace Fwog::detail
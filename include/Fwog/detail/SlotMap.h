@@ -0,0 +1,92 @@
+#pragma once
+#include <Fwog/Config.h>
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace Fwog::detail
+{
+  // A dense array of values addressed by generational handles.
+  // A handle stores the index of its slot in the low 32 bits and the slot's generation in the high 32 bits. The
+  // generation of a slot is incremented whenever its value is erased, so handles to erased values are detected instead
+  // of aliasing whatever value reuses the slot. Handles are never 0, so 0 can be used as a null handle.
+  //
+  // Lookups are an index and a comparison: no hashing and no reference counting.
+  // Pointers returned by Get are invalidated by Insert.
+  template<class T>
+  class SlotMap
+  {
+  public:
+    uint64_t Insert(T value)
+    {
+      uint32_t index;
+      if (!freeList_.empty())
+      {
+        index = freeList_.back();
+        freeList_.pop_back();
+      }
+      else
+      {
+        index = static_cast<uint32_t>(slots_.size());
+        slots_.emplace_back();
+      }
+
+      auto& slot = slots_[index];
+      slot.value.emplace(std::move(value));
+      slot.generation++;
+      return MakeHandle(index, slot.generation);
+    }
+
+    // Returns null if the handle doesn't refer to a value in the map
+    [[nodiscard]] T* Get(uint64_t handle) noexcept
+    {
+      const auto index = static_cast<uint32_t>(handle);
+      if (index >= slots_.size() || slots_[index].generation != static_cast<uint32_t>(handle >> 32))
+      {
+        return nullptr;
+      }
+      return &*slots_[index].value;
+    }
+
+    // Returns false if the handle doesn't refer to a value in the map
+    bool Erase(uint64_t handle)
+    {
+      if (!Get(handle))
+      {
+        return false;
+      }
+
+      const auto index = static_cast<uint32_t>(handle);
+      auto& slot = slots_[index];
+      slot.value.reset();
+      slot.generation++;
+      freeList_.push_back(index);
+      return true;
+    }
+
+    [[nodiscard]] size_t Size() const noexcept
+    {
+      return slots_.size() - freeList_.size();
+    }
+
+  private:
+    struct Slot
+    {
+      std::optional<T> value;
+
+      // Incremented when a value is inserted and when it is erased, so it is odd while the slot is occupied and
+      // handles (which always have an odd generation) never match an empty slot
+      uint32_t generation = 0;
+    };
+
+    static uint64_t MakeHandle(uint32_t index, uint32_t generation) noexcept
+    {
+      return static_cast<uint64_t>(generation) << 32 | index;
+    }
+
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> freeList_;
+  };
+} // namespace Fwog::detail
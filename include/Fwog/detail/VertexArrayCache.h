@@ -1,12 +1,31 @@
 #pragma once
+#include <Fwog/detail/BindingState.h>
+#include <Fwog/detail/PipelineManager.h>
+
 #include <cstddef>
 #include <cstdint>
 #include <unordered_map>
 
 namespace Fwog::detail
 {
-  struct VertexInputStateOwning;
+  struct CachedVertexArray
+  {
+    uint32_t id{};
 
+    // Vertex and index buffer bindings are VAO state, so they are shadowed per VAO
+    VertexArrayBindings bindings;
+
+    // The number of graphics pipelines that reference this VAO
+    uint32_t pipelineCount{};
+  };
+
+  struct VertexInputStateHash
+  {
+    size_t operator()(const VertexInputStateOwning& inputState) const;
+  };
+
+  // Owns a VAO for each unique vertex input layout. Graphics pipelines acquire the VAO of their layout when they are
+  // created and release it when they are destroyed, so binding a pipeline doesn't need to look it up.
   class VertexArrayCache
   {
   public:
@@ -21,7 +40,12 @@ namespace Fwog::detail
       Clear();
     }
 
-    uint32_t CreateOrGetCachedVertexArray(const VertexInputStateOwning& inputState);
+    // Returns the VAO for a layout, creating it if no pipeline with an equal layout exists.
+    // The reference stays valid until the VAO is released by every pipeline that acquired it.
+    CachedVertexArray& Acquire(const VertexInputStateOwning& inputState);
+
+    // Destroys the VAO for a layout when the last pipeline that acquired it releases it
+    void Release(const VertexInputStateOwning& inputState);
 
     [[nodiscard]] size_t Size() const
     {
@@ -30,7 +54,23 @@ namespace Fwog::detail
 
     void Clear();
 
+    // Detaches a buffer that is about to be deleted from every cached VAO.
+    // Deleting a buffer only detaches it from the currently bound VAO, so the others would keep referencing its storage.
+    void RemoveBuffer(uint32_t buffer);
+
+    // Visits each cached VAO, e.g., to gather statistics
+    template<class Fn>
+    void ForEach(Fn&& fn) const
+    {
+      for (const auto& [_, vao] : vertexArrayCache_)
+      {
+        fn(vao);
+      }
+    }
+
   private:
-    std::unordered_map<size_t, uint32_t> vertexArrayCache_;
+    // Keyed by the whole layout rather than its hash, so layouts whose hashes collide don't share a VAO.
+    // Nodes don't move when the map is rehashed, which keeps references handed out by Acquire valid.
+    std::unordered_map<VertexInputStateOwning, CachedVertexArray, VertexInputStateHash> vertexArrayCache_;
   };
 } // namespace Fwog::detail
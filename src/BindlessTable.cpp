@@ -0,0 +1,200 @@
+#include <Fwog/BindlessTable.h>
+#include <Fwog/detail/ContextState.h>
+#include FWOG_OPENGL_HEADER
+
+#include <algorithm>
+
+namespace Fwog
+{
+  BindlessTable::BindlessTable(const BindlessTableCreateInfo& createInfo)
+    : maxResidentHandles_(createInfo.maxResidentHandles),
+      slots_(std::max(createInfo.initialCapacity, 1u), 0),
+      buffer_(std::span<const uint64_t>(slots_), BufferStorageFlag::DYNAMIC_STORAGE)
+  {
+    FWOG_ASSERT(detail::context->properties.features.bindlessTextures && "GL_ARB_bindless_texture is not supported");
+  }
+
+  BindlessTable::~BindlessTable()
+  {
+    for (uint32_t i = 0; i < static_cast<uint32_t>(entries_.size()); i++)
+    {
+      if (entries_[i].isResident)
+      {
+        glMakeTextureHandleNonResidentARB(entries_[i].handle);
+      }
+    }
+  }
+
+  uint32_t BindlessTable::Acquire(const Texture& texture, const Sampler& sampler)
+  {
+    const auto key = uint64_t(detail::GetHandle(texture)) << 32 | sampler.Handle();
+    if (auto it = indices_.find(key); it != indices_.end())
+    {
+      entries_[it->second].refCount++;
+      MarkUsed(it->second);
+      return it->second;
+    }
+
+    // Handles are unique to each texture-sampler pair and stay valid as long as the texture exists, so GL returns the
+    // same handle if the pair was in the table before
+    const auto handle = glGetTextureSamplerHandleARB(detail::GetHandle(texture), sampler.Handle());
+    FWOG_ASSERT(handle != 0 && "Failed to create texture sampler handle.");
+
+    uint32_t index;
+    if (!freeEntries_.empty())
+    {
+      index = freeEntries_.back();
+      freeEntries_.pop_back();
+    }
+    else
+    {
+      index = static_cast<uint32_t>(entries_.size());
+      entries_.emplace_back();
+    }
+
+    entries_[index] = {.handle = handle, .key = key, .refCount = 1, .lastUsedFrame = 0, .isResident = false};
+    indices_.emplace(key, index);
+    statistics_.handleCount++;
+    MarkUsed(index);
+    return index;
+  }
+
+  void BindlessTable::Release(uint32_t index)
+  {
+    FWOG_ASSERT(index < entries_.size() && entries_[index].refCount > 0);
+    if (--entries_[index].refCount == 0)
+    {
+      pendingRelease_.push_back(index);
+    }
+  }
+
+  void BindlessTable::MarkUsed(uint32_t index)
+  {
+    FWOG_ASSERT(index < entries_.size() && entries_[index].handle != 0);
+    auto& entry = entries_[index];
+    if (entry.lastUsedFrame == frame_)
+    {
+      return;
+    }
+
+    entry.lastUsedFrame = frame_;
+    if (!entry.isResident)
+    {
+      pendingResident_.push_back(index);
+    }
+  }
+
+  void BindlessTable::Flush()
+  {
+    // Entries can be acquired again after they are released, in which case they are kept
+    for (auto index : pendingRelease_)
+    {
+      auto& entry = entries_[index];
+      if (entry.handle == 0 || entry.refCount > 0)
+      {
+        continue;
+      }
+
+      if (entry.isResident)
+      {
+        MakeNonResident(index);
+      }
+      indices_.erase(entry.key);
+      entry = {};
+      freeEntries_.push_back(index);
+      statistics_.handleCount--;
+    }
+    pendingRelease_.clear();
+
+    for (auto index : pendingResident_)
+    {
+      if (entries_[index].handle != 0 && !entries_[index].isResident)
+      {
+        MakeResident(index);
+      }
+    }
+    pendingResident_.clear();
+
+    // Evict the least recently used handles that weren't used this frame
+    if (maxResidentHandles_ != 0 && statistics_.residentHandleCount > maxResidentHandles_)
+    {
+      auto candidates = std::vector<uint32_t>();
+      for (uint32_t i = 0; i < static_cast<uint32_t>(entries_.size()); i++)
+      {
+        if (entries_[i].isResident && entries_[i].lastUsedFrame < frame_)
+        {
+          candidates.push_back(i);
+        }
+      }
+
+      const auto evictCount = std::min<size_t>(statistics_.residentHandleCount - maxResidentHandles_, candidates.size());
+      auto lessRecentlyUsed = [this](uint32_t a, uint32_t b)
+      {
+        return entries_[a].lastUsedFrame < entries_[b].lastUsedFrame;
+      };
+      std::partial_sort(candidates.begin(), candidates.begin() + evictCount, candidates.end(), lessRecentlyUsed);
+      for (size_t i = 0; i < evictCount; i++)
+      {
+        MakeNonResident(candidates[i]);
+      }
+    }
+
+    if (slots_.size() * sizeof(uint64_t) > buffer_.Size())
+    {
+      buffer_ = TypedBuffer<uint64_t>(std::span<const uint64_t>(slots_), BufferStorageFlag::DYNAMIC_STORAGE);
+    }
+    else if (dirtyBegin_ < dirtyEnd_)
+    {
+      buffer_.UpdateData(std::span<const uint64_t>(slots_.data() + dirtyBegin_, dirtyEnd_ - dirtyBegin_), dirtyBegin_);
+    }
+
+    dirtyBegin_ = UINT32_MAX;
+    dirtyEnd_ = 0;
+    frame_++;
+  }
+
+  uint64_t BindlessTable::GetHandle(uint32_t index) const
+  {
+    FWOG_ASSERT(index < entries_.size());
+    return entries_[index].handle;
+  }
+
+  bool BindlessTable::IsResident(uint32_t index) const
+  {
+    FWOG_ASSERT(index < entries_.size());
+    return entries_[index].isResident;
+  }
+
+  void BindlessTable::MakeResident(uint32_t index)
+  {
+    auto& entry = entries_[index];
+    glMakeTextureHandleResidentARB(entry.handle);
+    entry.isResident = true;
+    statistics_.residentHandleCount++;
+    statistics_.makeResidentCount++;
+    SetSlot(index, entry.handle);
+  }
+
+  void BindlessTable::MakeNonResident(uint32_t index)
+  {
+    auto& entry = entries_[index];
+    glMakeTextureHandleNonResidentARB(entry.handle);
+    entry.isResident = false;
+    statistics_.residentHandleCount--;
+    statistics_.makeNonResidentCount++;
+    SetSlot(index, 0);
+  }
+
+  void BindlessTable::SetSlot(uint32_t index, uint64_t value)
+  {
+    // The buffer is replaced with a copy of the slots at the next Flush if they no longer fit
+    if (index >= slots_.size())
+    {
+      slots_.resize(std::max<size_t>(slots_.size() * 2, index + 1), 0);
+    }
+
+    slots_[index] = value;
+    dirtyBegin_ = std::min(dirtyBegin_, index);
+    dirtyEnd_ = std::max(dirtyEnd_, index + 1);
+  }
+} // namespace Fwog
@@ -12,6 +12,7 @@ namespace Fwog
     GLbitfield glflags = detail::BufferStorageFlagsToGL(storageFlags);
     glCreateBuffers(1, &id_);
     glNamedBufferStorage(id_, size_, data, glflags);
+    FWOG_COUNT(bufferBytesUploaded, data ? size : 0);
     if (storageFlags & BufferStorageFlag::MAP_MEMORY)
     {
       // GL_MAP_UNSYNCHRONIZED_BIT should be used if the user can map and unmap buffers at their own will
@@ -50,12 +51,7 @@ namespace Fwog
     if (id_)
     {
       detail::InvokeVerboseMessageCallback("Destroyed buffer with handle ", id_);
-
-      if (mappedMemory_)
-      {
-        glUnmapNamedBuffer(id_);
-      }
-      glDeleteBuffers(1, &id_);
+      detail::DestroyBuffer(id_, mappedMemory_ != nullptr);
     }
   }
 
@@ -69,11 +65,31 @@ namespace Fwog
     FWOG_ASSERT((storageFlags_ & BufferStorageFlag::DYNAMIC_STORAGE) &&
                 "UpdateData can only be called on buffers created with the DYNAMIC_STORAGE flag");
     FWOG_ASSERT(size + offset <= Size());
+
+    if (detail::context->capture)
+    {
+      detail::context->capture->RecordBufferUpdate(id_, offset, data, size);
+    }
+
+    auto& barrierTracker = detail::context->barrierTracker;
+    barrierTracker.RequireBuffer(id_, MemoryBarrierBit::BUFFER_UPDATE_BIT);
+    barrierTracker.Flush();
+
+    FWOG_COUNT(bufferBytesUploaded, size);
     glNamedBufferSubData(id_, static_cast<GLuint>(offset), static_cast<GLuint>(size), data);
   }
 
   void Buffer::ClearSubData(const BufferClearInfo& clear)
   {
+    if (detail::context->capture)
+    {
+      detail::context->capture->RecordUnrecordedCall("Buffer::ClearSubData");
+    }
+
+    auto& barrierTracker = detail::context->barrierTracker;
+    barrierTracker.RequireBuffer(id_, MemoryBarrierBit::BUFFER_UPDATE_BIT);
+    barrierTracker.Flush();
+
     glClearNamedBufferSubData(id_,
                               detail::FormatToGL(clear.internalFormat),
                               clear.offset,
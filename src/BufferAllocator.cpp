@@ -0,0 +1,232 @@
+#include <Fwog/BufferAllocator.h>
+#include <Fwog/Context.h>
+#include <Fwog/Rendering.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace Fwog
+{
+  namespace
+  {
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+      return (value + alignment - 1) / alignment * alignment;
+    }
+  } // namespace
+
+  BufferAllocator::BufferAllocator(const BufferAllocatorCreateInfo& createInfo) : createInfo_(createInfo)
+  {
+    alignment_ = createInfo.alignment;
+    if (alignment_ == 0)
+    {
+      const auto& limits = GetDeviceProperties().limits;
+      alignment_ = static_cast<uint32_t>(
+        std::max({1, limits.uniformBufferOffsetAlignment, limits.shaderStorageBufferOffsetAlignment}));
+    }
+  }
+
+  BufferAllocation BufferAllocator::Allocate(uint64_t size, uint64_t alignment)
+  {
+    FWOG_ASSERT(size > 0);
+
+    // Every size is padded to the minimum alignment, so every offset the offset allocators return is aligned to it
+    const auto effectiveAlignment = alignment != 0 ? std::lcm(alignment, uint64_t(alignment_)) : alignment_;
+
+    auto record = Record{.alignment = effectiveAlignment, .isLive = true};
+    bool allocated = false;
+    for (uint32_t i = 0; i < blocks_.size() && !allocated; i++)
+    {
+      allocated = blocks_[i] && TryAllocate(i, size, effectiveAlignment, record);
+    }
+
+    if (!allocated)
+    {
+      const auto block = CreateBlock(AlignUp(size, alignment_) + effectiveAlignment - alignment_);
+      allocated = TryAllocate(block, size, effectiveAlignment, record);
+      FWOG_ASSERT(allocated);
+    }
+
+    uint32_t id;
+    if (!freeIds_.empty())
+    {
+      id = freeIds_.back();
+      freeIds_.pop_back();
+      records_[id] = record;
+    }
+    else
+    {
+      id = static_cast<uint32_t>(records_.size());
+      records_.push_back(record);
+    }
+
+    allocationCount_++;
+    return MakeAllocation(id);
+  }
+
+  bool BufferAllocator::TryAllocate(uint32_t block, uint64_t size, uint64_t alignment, Record& record)
+  {
+    const auto paddedSize = AlignUp(size, alignment_) + alignment - alignment_;
+    if (paddedSize > UINT32_MAX)
+    {
+      return false;
+    }
+
+    auto& b = *blocks_[block];
+    const auto allocation = b.allocator.Allocate(static_cast<uint32_t>(paddedSize));
+    if (allocation.node == detail::OffsetAllocator::NO_SPACE)
+    {
+      return false;
+    }
+
+    b.allocationCount++;
+    record.block = block;
+    record.node = allocation.node;
+    record.offset = AlignUp(allocation.offset, alignment);
+    record.size = size;
+    return true;
+  }
+
+  uint32_t BufferAllocator::CreateBlock(uint64_t minSize)
+  {
+    FWOG_ASSERT(minSize <= UINT32_MAX);
+    const auto size = std::max(createInfo_.blockSize,
+                               detail::OffsetAllocator::RoundUpToBinSize(static_cast<uint32_t>(minSize)));
+    auto block = std::make_unique<Block>(Block{Buffer(size, createInfo_.storageFlags), detail::OffsetAllocator(size), 0});
+
+    // Reuse the slot of a released block so the indices held by records stay valid
+    if (auto it = std::find(blocks_.begin(), blocks_.end(), nullptr); it != blocks_.end())
+    {
+      *it = std::move(block);
+      return static_cast<uint32_t>(it - blocks_.begin());
+    }
+
+    blocks_.push_back(std::move(block));
+    return static_cast<uint32_t>(blocks_.size() - 1);
+  }
+
+  void BufferAllocator::Free(const BufferAllocation& allocation)
+  {
+    FWOG_ASSERT(allocation.id < records_.size() && records_[allocation.id].isLive);
+    auto& record = records_[allocation.id];
+    FWOG_ASSERT(allocation.buffer == &blocks_[record.block]->buffer && "The allocation was moved by Defragment");
+
+    auto& block = *blocks_[record.block];
+    block.allocator.Free(record.node);
+    block.allocationCount--;
+    record.isLive = false;
+    freeIds_.push_back(allocation.id);
+    allocationCount_--;
+  }
+
+  BufferAllocation BufferAllocator::MakeAllocation(uint32_t id) const
+  {
+    const auto& record = records_[id];
+    return {&blocks_[record.block]->buffer, record.offset, record.size, id};
+  }
+
+  BufferAllocation BufferAllocator::Get(uint32_t id) const
+  {
+    FWOG_ASSERT(id < records_.size() && records_[id].isLive);
+    return MakeAllocation(id);
+  }
+
+  std::vector<BufferAllocation> BufferAllocator::Defragment()
+  {
+    // Copying within a buffer is undefined when the ranges overlap, so allocations are packed into new buffers instead
+    auto ids = std::vector<uint32_t>();
+    ids.reserve(allocationCount_);
+    for (uint32_t id = 0; id < records_.size(); id++)
+    {
+      if (records_[id].isLive)
+      {
+        ids.push_back(id);
+      }
+    }
+
+    // Keep allocations in their current order to preserve locality
+    std::sort(ids.begin(),
+              ids.end(),
+              [this](uint32_t a, uint32_t b)
+              {
+                return std::pair(records_[a].block, records_[a].offset) <
+                       std::pair(records_[b].block, records_[b].offset);
+              });
+
+    auto oldBlocks = std::move(blocks_);
+    blocks_.clear();
+
+    auto moved = std::vector<BufferAllocation>();
+    moved.reserve(ids.size());
+    for (auto id : ids)
+    {
+      auto& record = records_[id];
+      const auto& source = oldBlocks[record.block]->buffer;
+      const auto sourceOffset = record.offset;
+
+      auto newRecord = record;
+      const auto lastBlock = static_cast<uint32_t>(blocks_.size() - 1);
+      bool allocated = !blocks_.empty() && TryAllocate(lastBlock, record.size, record.alignment, newRecord);
+      if (!allocated)
+      {
+        const auto block = CreateBlock(AlignUp(record.size, alignment_) + record.alignment - alignment_);
+        allocated = TryAllocate(block, record.size, record.alignment, newRecord);
+        FWOG_ASSERT(allocated);
+      }
+      record = newRecord;
+
+      CopyBuffer({
+        .source = source,
+        .target = blocks_[record.block]->buffer,
+        .sourceOffset = sourceOffset,
+        .targetOffset = record.offset,
+        .size = record.size,
+      });
+      moved.push_back(MakeAllocation(id));
+    }
+
+    return moved;
+  }
+
+  void BufferAllocator::ReleaseEmptyBlocks()
+  {
+    for (auto& block : blocks_)
+    {
+      if (block && block->allocationCount == 0)
+      {
+        block.reset();
+      }
+    }
+
+    while (!blocks_.empty() && !blocks_.back())
+    {
+      blocks_.pop_back();
+    }
+  }
+
+  BufferAllocatorStatistics BufferAllocator::GetStatistics() const
+  {
+    auto statistics = BufferAllocatorStatistics{.allocationCount = allocationCount_};
+    for (const auto& block : blocks_)
+    {
+      if (!block)
+      {
+        continue;
+      }
+
+      const auto report = block->allocator.GetStorageReport();
+      statistics.blockCount++;
+      statistics.capacity += block->allocator.Size();
+      statistics.freeBytes += report.totalFreeSpace;
+      statistics.largestFreeRegion = std::max<uint64_t>(statistics.largestFreeRegion, report.largestFreeRegion);
+    }
+
+    statistics.usedBytes = statistics.capacity - statistics.freeBytes;
+    if (statistics.freeBytes > 0)
+    {
+      statistics.fragmentation =
+        1.0f - static_cast<float>(statistics.largestFreeRegion) / static_cast<float>(statistics.freeBytes);
+    }
+    return statistics;
+  }
+} // namespace Fwog
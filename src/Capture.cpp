@@ -0,0 +1,1160 @@
+#include <Fwog/Buffer.h>
+#include <Fwog/Capture.h>
+#include <Fwog/Exception.h>
+#include <Fwog/Shader.h>
+#include <Fwog/detail/ApiToEnum.h>
+#include <Fwog/detail/Capture.h>
+#include <Fwog/detail/ContextState.h>
+#include <Fwog/detail/PipelineManager.h>
+#include <Fwog/detail/SamplerCache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <type_traits>
+
+#include FWOG_OPENGL_HEADER
+
+namespace Fwog
+{
+  namespace
+  {
+    using detail::CaptureRecordType;
+
+    template<class T>
+    void Write(std::vector<std::byte>& stream, const T& value)
+    {
+      static_assert(std::is_trivially_copyable_v<T>);
+      const auto offset = stream.size();
+      stream.resize(offset + sizeof(T));
+      std::memcpy(stream.data() + offset, &value, sizeof(T));
+    }
+
+    void WriteBytes(std::vector<std::byte>& stream, const void* data, size_t size)
+    {
+      const auto offset = stream.size();
+      stream.resize(offset + size);
+      if (size > 0)
+      {
+        std::memcpy(stream.data() + offset, data, size);
+      }
+    }
+
+    void WriteString(std::vector<std::byte>& stream, std::string_view string)
+    {
+      Write(stream, static_cast<uint32_t>(string.size()));
+      WriteBytes(stream, string.data(), string.size());
+    }
+
+    void WriteClearColor(std::vector<std::byte>& stream, const ClearColorValue& clearValue)
+    {
+      Write(stream, static_cast<uint32_t>(clearValue.data.index()));
+      std::visit([&stream](const auto& color) { Write(stream, color); }, clearValue.data);
+    }
+
+    // Reads the values written by the functions above, throwing if the data ends before a value does
+    class Reader
+    {
+    public:
+      explicit Reader(std::span<const std::byte> data) : data_(data) {}
+
+      template<class T>
+      T Read()
+      {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, Take(sizeof(T)).data(), sizeof(T));
+        return value;
+      }
+
+      std::span<const std::byte> Take(size_t size)
+      {
+        if (size > data_.size() - offset_)
+        {
+          throw Exception("The capture is truncated");
+        }
+        offset_ += size;
+        return data_.subspan(offset_ - size, size);
+      }
+
+      std::span<const std::byte> TakeRest()
+      {
+        return Take(data_.size() - offset_);
+      }
+
+      std::string ReadString()
+      {
+        const auto size = Read<uint32_t>();
+        const auto bytes = Take(size);
+        return std::string(reinterpret_cast<const char*>(bytes.data()), size);
+      }
+
+      ClearColorValue ReadClearColor()
+      {
+        ClearColorValue clearValue;
+        switch (Read<uint32_t>())
+        {
+        case 0: clearValue.data = Read<std::array<float, 4>>(); break;
+        case 1: clearValue.data = Read<std::array<uint32_t, 4>>(); break;
+        case 2: clearValue.data = Read<std::array<int32_t, 4>>(); break;
+        default: throw Exception("The capture contains an invalid clear color");
+        }
+        return clearValue;
+      }
+
+    private:
+      std::span<const std::byte> data_;
+      size_t offset_ = 0;
+    };
+
+    // Returns the object with a capture ID
+    template<class T>
+    T& GetObject(std::vector<T>& objects, uint32_t id)
+    {
+      if (id == 0 || id > objects.size())
+      {
+        throw Exception("The capture references an object that it does not create");
+      }
+      return objects[id - 1];
+    }
+
+    uint64_t GetPixelSize(GLenum format, GLenum type)
+    {
+      // Packed types store a whole pixel
+      switch (type)
+      {
+      case GL_UNSIGNED_BYTE_3_3_2:
+      case GL_UNSIGNED_BYTE_2_3_3_REV: return 1;
+      case GL_UNSIGNED_SHORT_5_6_5:
+      case GL_UNSIGNED_SHORT_5_6_5_REV:
+      case GL_UNSIGNED_SHORT_4_4_4_4:
+      case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+      case GL_UNSIGNED_SHORT_5_5_5_1:
+      case GL_UNSIGNED_SHORT_1_5_5_5_REV: return 2;
+      case GL_UNSIGNED_INT_8_8_8_8:
+      case GL_UNSIGNED_INT_8_8_8_8_REV:
+      case GL_UNSIGNED_INT_10_10_10_2:
+      case GL_UNSIGNED_INT_2_10_10_10_REV: return 4;
+      default: break;
+      }
+
+      uint64_t componentSize{};
+      switch (type)
+      {
+      case GL_UNSIGNED_BYTE:
+      case GL_BYTE: componentSize = 1; break;
+      case GL_UNSIGNED_SHORT:
+      case GL_SHORT:
+      case GL_HALF_FLOAT: componentSize = 2; break;
+      case GL_UNSIGNED_INT:
+      case GL_INT:
+      case GL_FLOAT: componentSize = 4; break;
+      default: FWOG_UNREACHABLE; return 0;
+      }
+
+      switch (format)
+      {
+      case GL_RED:
+      case GL_RED_INTEGER:
+      case GL_DEPTH_COMPONENT:
+      case GL_STENCIL_INDEX: return componentSize;
+      case GL_RG:
+      case GL_RG_INTEGER:
+      case GL_DEPTH_STENCIL: return componentSize * 2;
+      case GL_RGB:
+      case GL_BGR:
+      case GL_RGB_INTEGER:
+      case GL_BGR_INTEGER: return componentSize * 3;
+      case GL_RGBA:
+      case GL_BGRA:
+      case GL_RGBA_INTEGER:
+      case GL_BGRA_INTEGER: return componentSize * 4;
+      default: FWOG_UNREACHABLE; return 0;
+      }
+    }
+
+    // Returns the size of a pixel uploaded to a texture, inferring the format and type like Texture does
+    uint64_t GetUploadPixelSize(const Texture& texture, UploadFormat uploadFormat, UploadType uploadType)
+    {
+      const auto textureFormat = texture.GetCreateInfo().format;
+      const auto format = uploadFormat == UploadFormat::INFER_FORMAT
+                            ? detail::UploadFormatToGL(detail::FormatToUploadFormat(textureFormat))
+                            : detail::UploadFormatToGL(uploadFormat);
+      const auto type = uploadType == UploadType::INFER_TYPE ? detail::FormatToTypeGL(textureFormat)
+                                                             : detail::UploadTypeToGL(uploadType);
+      return GetPixelSize(format, type);
+    }
+
+    // Returns the number of bytes that Texture::UpdateImage reads from the pixels of an update
+    uint64_t GetTextureUpdateSize(const Texture& texture, const TextureUpdateInfo& info)
+    {
+      const auto dimension = detail::ImageTypeToDimension(texture.GetCreateInfo().imageType);
+      const uint64_t width = info.extent.width;
+      const uint64_t height = dimension >= 2 ? info.extent.height : 1;
+      const uint64_t depth = dimension == 3 ? info.extent.depth : 1;
+      if (width == 0 || height == 0 || depth == 0)
+      {
+        return 0;
+      }
+
+      // Fwog leaves GL_UNPACK_ALIGNMENT at its default of 4
+      const auto pixelSize = GetUploadPixelSize(texture, info.format, info.type);
+      const uint64_t rowLength = info.rowLength != 0 ? info.rowLength : width;
+      const uint64_t imageHeight = info.imageHeight != 0 ? info.imageHeight : height;
+      const auto rowSize = (rowLength * pixelSize + 3) & ~uint64_t(3);
+      return rowSize * imageHeight * (depth - 1) + rowSize * (height - 1) + width * pixelSize;
+    }
+
+    ImageType ImageTypeFromGL(GLint target)
+    {
+      for (uint32_t i = 0; i <= static_cast<uint32_t>(ImageType::TEX_2D_MULTISAMPLE_ARRAY); i++)
+      {
+        if (detail::ImageTypeToGL(static_cast<ImageType>(i)) == target)
+        {
+          return static_cast<ImageType>(i);
+        }
+      }
+      FWOG_UNREACHABLE;
+      return {};
+    }
+
+    Format FormatFromGL(GLint internalFormat)
+    {
+      for (uint32_t i = 1; i <= static_cast<uint32_t>(Format::BC7_RGBA_SRGB); i++)
+      {
+        if (detail::FormatToGL(static_cast<Format>(i)) == internalFormat)
+        {
+          return static_cast<Format>(i);
+        }
+      }
+      FWOG_UNREACHABLE;
+      return {};
+    }
+
+    PipelineStage PipelineStageFromGL(GLint type)
+    {
+      switch (type)
+      {
+      case GL_VERTEX_SHADER: return PipelineStage::VERTEX_SHADER;
+      case GL_TESS_CONTROL_SHADER: return PipelineStage::TESSELLATION_CONTROL_SHADER;
+      case GL_TESS_EVALUATION_SHADER: return PipelineStage::TESSELLATION_EVALUATION_SHADER;
+      case GL_FRAGMENT_SHADER: return PipelineStage::FRAGMENT_SHADER;
+      case GL_COMPUTE_SHADER: return PipelineStage::COMPUTE_SHADER;
+      default: FWOG_UNREACHABLE; return {};
+      }
+    }
+
+    // Writes the stage and source of each shader attached to a program
+    void WriteShaders(std::vector<std::byte>& stream, GLuint program)
+    {
+      GLint count{};
+      glGetProgramiv(program, GL_ATTACHED_SHADERS, &count);
+      auto shaders = std::vector<GLuint>(count);
+      glGetAttachedShaders(program, count, nullptr, shaders.data());
+
+      Write(stream, static_cast<uint32_t>(count));
+      for (auto shader : shaders)
+      {
+        GLint type{};
+        GLint length{};
+        glGetShaderiv(shader, GL_SHADER_TYPE, &type);
+        glGetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &length);
+
+        auto source = std::string(std::max(length, 1), '\0');
+        GLsizei written{};
+        glGetShaderSource(shader, static_cast<GLsizei>(source.size()), &written, source.data());
+        source.resize(written);
+
+        Write(stream, PipelineStageFromGL(type));
+        WriteString(stream, source);
+      }
+    }
+
+    std::vector<std::pair<PipelineStage, Shader>> ReadShaders(Reader& reader)
+    {
+      auto shaders = std::vector<std::pair<PipelineStage, Shader>>();
+      const auto count = reader.Read<uint32_t>();
+      for (uint32_t i = 0; i < count; i++)
+      {
+        const auto stage = reader.Read<PipelineStage>();
+        if (static_cast<uint32_t>(stage) > static_cast<uint32_t>(PipelineStage::COMPUTE_SHADER))
+        {
+          throw Exception("The capture contains an invalid shader stage");
+        }
+        shaders.emplace_back(stage, Shader(stage, reader.ReadString()));
+      }
+      return shaders;
+    }
+
+    template<class T>
+    std::vector<T> ReadArray(Reader& reader)
+    {
+      const auto count = reader.Read<uint32_t>();
+      const auto bytes = reader.Take(count * sizeof(T));
+      auto array = std::vector<T>(count);
+      std::memcpy(array.data(), bytes.data(), bytes.size());
+      return array;
+    }
+
+    std::optional<RenderDepthStencilAttachment> ReadDepthStencilAttachment(Reader& reader, std::vector<Texture>& textures)
+    {
+      if (!reader.Read<bool>())
+      {
+        return std::nullopt;
+      }
+      const Texture& texture = GetObject(textures, reader.Read<uint32_t>());
+      const auto loadOp = reader.Read<AttachmentLoadOp>();
+      return RenderDepthStencilAttachment{
+        .texture = texture,
+        .loadOp = loadOp,
+        .clearValue = reader.Read<ClearDepthStencilValue>(),
+      };
+    }
+  } // namespace
+
+  void BeginCapture()
+  {
+    FWOG_ASSERT(detail::context != nullptr && "Fwog has not been initialized");
+    FWOG_ASSERT(!detail::context->capture && "A capture is already in progress");
+    FWOG_ASSERT(!detail::context->isRendering && !detail::context->isComputeActive &&
+                "Captures cannot begin in a rendering or compute scope");
+    detail::context->capture = std::make_unique<detail::CaptureWriter>();
+  }
+
+  std::vector<std::byte> EndCapture()
+  {
+    FWOG_ASSERT(detail::context->capture && "BeginCapture must be called before ending a capture");
+    FWOG_ASSERT(!detail::context->isRendering && !detail::context->isComputeActive &&
+                "Captures cannot end in a rendering or compute scope");
+    auto capture = detail::context->capture->Finish();
+    detail::context->capture.reset();
+    return capture;
+  }
+
+  namespace detail
+  {
+    void CaptureWriter::RecordCommand(CommandType type, const void* payload, uint16_t size)
+    {
+      if (!commandsStart_)
+      {
+        commandsStart_ = BeginRecord(frame_, CaptureRecordType::COMMANDS);
+      }
+
+      Write(frame_, CommandHeader{.type = type, .size = size});
+      const auto offset = frame_.size();
+      WriteBytes(frame_, payload, size);
+
+      // Referencing objects only appends to objects_, so the payload stays in place
+      ForEachCommandHandle(type,
+                           frame_.data() + offset,
+                           [this](CaptureRecordType kind, auto& handle)
+                           {
+                             using Handle = std::remove_reference_t<decltype(handle)>;
+                             switch (kind)
+                             {
+                             case CaptureRecordType::CREATE_BUFFER:
+                               handle = static_cast<Handle>(ReferenceBuffer(static_cast<uint32_t>(handle)));
+                               break;
+                             case CaptureRecordType::CREATE_TEXTURE:
+                               handle = static_cast<Handle>(ReferenceTexture(static_cast<uint32_t>(handle)));
+                               break;
+                             case CaptureRecordType::CREATE_SAMPLER:
+                               handle = static_cast<Handle>(ReferenceSampler(static_cast<uint32_t>(handle)));
+                               break;
+                             case CaptureRecordType::CREATE_GRAPHICS_PIPELINE:
+                               handle = static_cast<Handle>(ReferenceGraphicsPipeline(handle));
+                               break;
+                             case CaptureRecordType::CREATE_COMPUTE_PIPELINE:
+                               handle = static_cast<Handle>(ReferenceComputePipeline(handle));
+                               break;
+                             default: FWOG_UNREACHABLE;
+                             }
+                           });
+    }
+
+    void CaptureWriter::RecordBeginSwapchainRendering(const SwapchainRenderInfo& renderInfo)
+    {
+      EndCommands();
+      const auto start = BeginRecord(frame_, CaptureRecordType::BEGIN_SWAPCHAIN_RENDERING);
+      WriteString(frame_, renderInfo.name);
+      Write(frame_, renderInfo.viewport);
+      Write(frame_, renderInfo.colorLoadOp);
+      WriteClearColor(frame_, renderInfo.clearColorValue);
+      Write(frame_, renderInfo.depthLoadOp);
+      Write(frame_, renderInfo.clearDepthValue);
+      Write(frame_, renderInfo.stencilLoadOp);
+      Write(frame_, renderInfo.clearStencilValue);
+      Write(frame_, renderInfo.enableSrgb);
+      EndRecord(frame_, start);
+    }
+
+    void CaptureWriter::RecordBeginRendering(const RenderInfo& renderInfo)
+    {
+      EndCommands();
+      const auto start = BeginRecord(frame_, CaptureRecordType::BEGIN_RENDERING);
+      WriteString(frame_, renderInfo.name);
+      Write(frame_, renderInfo.viewport.has_value());
+      if (renderInfo.viewport)
+      {
+        Write(frame_, *renderInfo.viewport);
+      }
+
+      Write(frame_, static_cast<uint32_t>(renderInfo.colorAttachments.size()));
+      for (const auto& attachment : renderInfo.colorAttachments)
+      {
+        Write(frame_, ReferenceTexture(GetHandle(attachment.texture.get())));
+        Write(frame_, attachment.loadOp);
+        WriteClearColor(frame_, attachment.clearValue);
+      }
+
+      for (const auto* attachment : {&renderInfo.depthAttachment, &renderInfo.stencilAttachment})
+      {
+        Write(frame_, attachment->has_value());
+        if (*attachment)
+        {
+          Write(frame_, ReferenceTexture(GetHandle((*attachment)->texture.get())));
+          Write(frame_, (*attachment)->loadOp);
+          Write(frame_, (*attachment)->clearValue);
+        }
+      }
+      EndRecord(frame_, start);
+    }
+
+    void CaptureWriter::RecordEndRendering()
+    {
+      EndCommands();
+      EndRecord(frame_, BeginRecord(frame_, CaptureRecordType::END_RENDERING));
+    }
+
+    void CaptureWriter::RecordBeginCompute(std::string_view name)
+    {
+      EndCommands();
+      const auto start = BeginRecord(frame_, CaptureRecordType::BEGIN_COMPUTE);
+      WriteString(frame_, name);
+      EndRecord(frame_, start);
+    }
+
+    void CaptureWriter::RecordEndCompute()
+    {
+      EndCommands();
+      EndRecord(frame_, BeginRecord(frame_, CaptureRecordType::END_COMPUTE));
+    }
+
+    void CaptureWriter::RecordBufferUpdate(uint32_t buffer, uint64_t offset, const void* data, uint64_t size)
+    {
+      EndCommands();
+      const auto id = ReferenceBuffer(buffer);
+      const auto start = BeginRecord(frame_, CaptureRecordType::UPDATE_BUFFER);
+      Write(frame_, id);
+      Write(frame_, offset);
+      WriteBytes(frame_, data, size);
+      EndRecord(frame_, start);
+    }
+
+    void CaptureWriter::RecordTextureUpdate(const Texture& texture, const TextureUpdateInfo& info)
+    {
+      EndCommands();
+      const auto id = ReferenceTexture(GetHandle(texture));
+      auto storedInfo = info;
+      storedInfo.pixels = nullptr;
+
+      const auto start = BeginRecord(frame_, CaptureRecordType::UPDATE_TEXTURE);
+      Write(frame_, id);
+      Write(frame_, storedInfo);
+      WriteBytes(frame_, info.pixels, GetTextureUpdateSize(texture, info));
+      EndRecord(frame_, start);
+    }
+
+    void CaptureWriter::RecordCopyBuffer(const CopyBufferInfo& copy)
+    {
+      EndCommands();
+      const auto size = copy.size == WHOLE_BUFFER ? copy.source.Size() - copy.sourceOffset : copy.size;
+      const auto source = ReferenceBuffer(copy.source.Handle());
+      const auto target = ReferenceBuffer(copy.target.Handle());
+
+      const auto start = BeginRecord(frame_, CaptureRecordType::COPY_BUFFER);
+      Write(frame_, source);
+      Write(frame_, target);
+      Write(frame_, static_cast<uint64_t>(copy.sourceOffset));
+      Write(frame_, static_cast<uint64_t>(copy.targetOffset));
+      Write(frame_, static_cast<uint64_t>(size));
+      EndRecord(frame_, start);
+    }
+
+    void CaptureWriter::RecordMemoryBarrier(MemoryBarrierBits accessBits)
+    {
+      EndCommands();
+      const auto start = BeginRecord(frame_, CaptureRecordType::MEMORY_BARRIER);
+      Write(frame_, accessBits);
+      EndRecord(frame_, start);
+    }
+
+    void CaptureWriter::RecordTextureBarrier()
+    {
+      EndCommands();
+      EndRecord(frame_, BeginRecord(frame_, CaptureRecordType::TEXTURE_BARRIER));
+    }
+
+    void CaptureWriter::RecordBlitTexture(const Texture& source,
+                                          const Texture* target,
+                                          Offset3D sourceOffset,
+                                          Offset3D targetOffset,
+                                          Extent3D sourceExtent,
+                                          Extent3D targetExtent,
+                                          Filter filter,
+                                          AspectMask aspect)
+    {
+      EndCommands();
+      const auto sourceId = ReferenceTexture(GetHandle(source));
+      const auto targetId = target ? ReferenceTexture(GetHandle(*target)) : 0;
+
+      const auto start = BeginRecord(frame_, CaptureRecordType::BLIT_TEXTURE);
+      Write(frame_, sourceId);
+      Write(frame_, targetId);
+      Write(frame_, sourceOffset);
+      Write(frame_, targetOffset);
+      Write(frame_, sourceExtent);
+      Write(frame_, targetExtent);
+      Write(frame_, filter);
+      Write(frame_, aspect);
+      EndRecord(frame_, start);
+    }
+
+    void CaptureWriter::RecordTextureClear(const Texture& texture, const TextureClearInfo& info)
+    {
+      EndCommands();
+      const auto id = ReferenceTexture(GetHandle(texture));
+      auto storedInfo = info;
+      storedInfo.data = nullptr;
+
+      // The clear value is a single pixel, or absent to clear with zeroes
+      const auto start = BeginRecord(frame_, CaptureRecordType::CLEAR_TEXTURE);
+      Write(frame_, id);
+      Write(frame_, storedInfo);
+      if (info.data)
+      {
+        WriteBytes(frame_, info.data, GetUploadPixelSize(texture, info.format, info.type));
+      }
+      EndRecord(frame_, start);
+    }
+
+    void CaptureWriter::RecordUnrecordedCall(std::string_view function)
+    {
+      if (std::find(unrecordedCalls_.begin(), unrecordedCalls_.end(), function) != unrecordedCalls_.end())
+      {
+        return;
+      }
+      unrecordedCalls_.push_back(function);
+
+      EndCommands();
+      const auto start = BeginRecord(frame_, CaptureRecordType::UNRECORDED_CALL);
+      WriteString(frame_, function);
+      EndRecord(frame_, start);
+    }
+
+    void CaptureWriter::ForgetBuffer(uint32_t buffer)
+    {
+      auto it = std::find_if(mappedBuffers_.begin(),
+                             mappedBuffers_.end(),
+                             [buffer](const MappedBuffer& mapped) { return mapped.buffer == buffer; });
+      if (it != mappedBuffers_.end())
+      {
+        ReadMappedBuffer(*it);
+        mappedBuffers_.erase(it);
+      }
+      bufferIds_.erase(buffer);
+    }
+
+    void CaptureWriter::ForgetTexture(uint32_t texture)
+    {
+      textureIds_.erase(texture);
+    }
+
+    std::vector<std::byte> CaptureWriter::Finish()
+    {
+      EndCommands();
+      for (const auto& mapped : mappedBuffers_)
+      {
+        ReadMappedBuffer(mapped);
+      }
+      mappedBuffers_.clear();
+
+      auto header = CaptureFileHeader{.magic = {}, .version = CAPTURE_VERSION, .recordCount = recordCount_};
+      std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+
+      auto file = std::vector<std::byte>();
+      file.reserve(sizeof(header) + objects_.size() + frame_.size());
+      Write(file, header);
+      file.insert(file.end(), objects_.begin(), objects_.end());
+      file.insert(file.end(), frame_.begin(), frame_.end());
+      return file;
+    }
+
+    uint32_t CaptureWriter::ReferenceBuffer(uint32_t buffer)
+    {
+      if (buffer == 0)
+      {
+        return 0;
+      }
+      if (auto it = bufferIds_.find(buffer); it != bufferIds_.end())
+      {
+        return it->second;
+      }
+
+      GLint64 size{};
+      GLint glFlags{};
+      glGetNamedBufferParameteri64v(buffer, GL_BUFFER_SIZE, &size);
+      glGetNamedBufferParameteriv(buffer, GL_BUFFER_STORAGE_FLAGS, &glFlags);
+
+      uint32_t flags = 0;
+      flags |= (glFlags & GL_DYNAMIC_STORAGE_BIT) ? static_cast<uint32_t>(BufferStorageFlag::DYNAMIC_STORAGE) : 0;
+      flags |= (glFlags & GL_CLIENT_STORAGE_BIT) ? static_cast<uint32_t>(BufferStorageFlag::CLIENT_STORAGE) : 0;
+      flags |= (glFlags & GL_MAP_PERSISTENT_BIT) ? static_cast<uint32_t>(BufferStorageFlag::MAP_MEMORY) : 0;
+
+      const auto start = BeginRecord(objects_, CaptureRecordType::CREATE_BUFFER);
+      Write(objects_, static_cast<uint64_t>(size));
+      Write(objects_, flags);
+      const auto dataOffset = objects_.size();
+      objects_.resize(dataOffset + size);
+      if (glFlags & GL_MAP_PERSISTENT_BIT)
+      {
+        mappedBuffers_.push_back({buffer, dataOffset, static_cast<uint64_t>(size)});
+      }
+      else
+      {
+        glGetNamedBufferSubData(buffer, 0, static_cast<GLsizeiptr>(size), objects_.data() + dataOffset);
+      }
+      EndRecord(objects_, start);
+
+      const auto id = nextBufferId_++;
+      bufferIds_.emplace(buffer, id);
+      return id;
+    }
+
+    uint32_t CaptureWriter::ReferenceTexture(uint32_t texture)
+    {
+      if (texture == 0)
+      {
+        return 0;
+      }
+      if (auto it = textureIds_.find(texture); it != textureIds_.end())
+      {
+        return it->second;
+      }
+
+      GLint target{};
+      GLint levels{};
+      GLint internalFormat{};
+      GLint width{};
+      GLint height{};
+      GLint depth{};
+      GLint samples{};
+      glGetTextureParameteriv(texture, GL_TEXTURE_TARGET, &target);
+      glGetTextureParameteriv(texture, GL_TEXTURE_IMMUTABLE_LEVELS, &levels);
+      glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+      glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_WIDTH, &width);
+      glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_HEIGHT, &height);
+      glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_DEPTH, &depth);
+      glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_SAMPLES, &samples);
+
+      // Array layers are stored in the last dimension, as they are by the Texture constructor
+      auto createInfo = TextureCreateInfo{
+        .imageType = ImageTypeFromGL(target),
+        .format = FormatFromGL(internalFormat),
+        .extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1},
+        .mipLevels = static_cast<uint32_t>(levels),
+        .arrayLayers = 1,
+        .sampleCount = static_cast<SampleCount>(std::max(samples, 1)),
+      };
+      switch (createInfo.imageType)
+      {
+      case ImageType::TEX_1D_ARRAY:
+        createInfo.extent.height = 1;
+        createInfo.arrayLayers = static_cast<uint32_t>(height);
+        break;
+      case ImageType::TEX_2D_ARRAY:
+      case ImageType::TEX_CUBEMAP_ARRAY:
+      case ImageType::TEX_2D_MULTISAMPLE_ARRAY: createInfo.arrayLayers = static_cast<uint32_t>(depth); break;
+      case ImageType::TEX_3D: createInfo.extent.depth = static_cast<uint32_t>(depth); break;
+      default: break;
+      }
+
+      const auto start = BeginRecord(objects_, CaptureRecordType::CREATE_TEXTURE);
+      Write(objects_, createInfo);
+      EndRecord(objects_, start);
+
+      const auto id = nextTextureId_++;
+      textureIds_.emplace(texture, id);
+      return id;
+    }
+
+    uint32_t CaptureWriter::ReferenceSampler(uint32_t sampler)
+    {
+      if (sampler == 0)
+      {
+        return 0;
+      }
+      if (auto it = samplerIds_.find(sampler); it != samplerIds_.end())
+      {
+        return it->second;
+      }
+
+      // Every sampler comes from the sampler cache, which never destroys them, so IDs are never reused
+      const auto samplerState = detail::gSamplerCache.FindSamplerState(sampler);
+      FWOG_ASSERT(samplerState && "The sampler was not created by Fwog");
+      if (!samplerState)
+      {
+        return 0;
+      }
+
+      const auto start = BeginRecord(objects_, CaptureRecordType::CREATE_SAMPLER);
+      Write(objects_, *samplerState);
+      EndRecord(objects_, start);
+
+      const auto id = static_cast<uint32_t>(samplerIds_.size() + 1);
+      samplerIds_.emplace(sampler, id);
+      return id;
+    }
+
+    uint32_t CaptureWriter::ReferenceGraphicsPipeline(uint64_t pipeline)
+    {
+      if (auto it = graphicsPipelineIds_.find(pipeline); it != graphicsPipelineIds_.end())
+      {
+        return it->second;
+      }
+
+      // Pipeline handles are generational, so they are never reused
+      const auto* info = GetGraphicsPipelineInternal(pipeline);
+      FWOG_ASSERT(info);
+
+      const auto start = BeginRecord(objects_, CaptureRecordType::CREATE_GRAPHICS_PIPELINE);
+      WriteString(objects_, info->name);
+      WriteShaders(objects_, info->program);
+      Write(objects_, info->inputAssemblyState);
+      const auto& bindings = info->vertexInputState.vertexBindingDescriptions;
+      Write(objects_, static_cast<uint32_t>(bindings.size()));
+      WriteBytes(objects_, bindings.data(), bindings.size() * sizeof(bindings[0]));
+      Write(objects_, info->tessellationState);
+      Write(objects_, info->rasterizationState);
+      Write(objects_, info->multisampleState);
+      Write(objects_, info->depthState);
+      Write(objects_, info->stencilState);
+      const auto& colorBlend = info->colorBlendState;
+      Write(objects_, colorBlend.logicOpEnable);
+      Write(objects_, colorBlend.logicOp);
+      Write(objects_, static_cast<uint32_t>(colorBlend.attachments.size()));
+      WriteBytes(objects_, colorBlend.attachments.data(), colorBlend.attachments.size() * sizeof(colorBlend.attachments[0]));
+      Write(objects_, colorBlend.blendConstants);
+      EndRecord(objects_, start);
+
+      const auto id = static_cast<uint32_t>(graphicsPipelineIds_.size() + 1);
+      graphicsPipelineIds_.emplace(pipeline, id);
+      return id;
+    }
+
+    uint32_t CaptureWriter::ReferenceComputePipeline(uint64_t pipeline)
+    {
+      if (auto it = computePipelineIds_.find(pipeline); it != computePipelineIds_.end())
+      {
+        return it->second;
+      }
+
+      const auto* info = GetComputePipelineInternal(pipeline);
+      FWOG_ASSERT(info);
+
+      const auto start = BeginRecord(objects_, CaptureRecordType::CREATE_COMPUTE_PIPELINE);
+      WriteString(objects_, info->name);
+      WriteShaders(objects_, info->program);
+      EndRecord(objects_, start);
+
+      const auto id = static_cast<uint32_t>(computePipelineIds_.size() + 1);
+      computePipelineIds_.emplace(pipeline, id);
+      return id;
+    }
+
+    size_t CaptureWriter::BeginRecord(std::vector<std::byte>& stream, CaptureRecordType type)
+    {
+      const auto start = stream.size();
+      Write(stream, CaptureRecordHeader{.type = type, .size = 0});
+      recordCount_++;
+      return start;
+    }
+
+    void CaptureWriter::EndRecord(std::vector<std::byte>& stream, size_t start)
+    {
+      const auto size = stream.size() - start - sizeof(CaptureRecordHeader);
+      FWOG_ASSERT(size <= UINT32_MAX);
+      const auto size32 = static_cast<uint32_t>(size);
+      std::memcpy(stream.data() + start + offsetof(CaptureRecordHeader, size), &size32, sizeof(size32));
+    }
+
+    void CaptureWriter::EndCommands()
+    {
+      if (commandsStart_)
+      {
+        EndRecord(frame_, *commandsStart_);
+        commandsStart_.reset();
+      }
+    }
+
+    void CaptureWriter::ReadMappedBuffer(const MappedBuffer& mapped)
+    {
+      glGetNamedBufferSubData(mapped.buffer,
+                              0,
+                              static_cast<GLsizeiptr>(mapped.size),
+                              objects_.data() + mapped.dataOffset);
+    }
+  } // namespace detail
+
+  CaptureReplayer::CaptureReplayer(std::span<const std::byte> capture)
+  {
+    auto reader = Reader(capture);
+    const auto header = reader.Read<detail::CaptureFileHeader>();
+    if (std::memcmp(header.magic, detail::CAPTURE_MAGIC, sizeof(detail::CAPTURE_MAGIC)) != 0)
+    {
+      throw Exception("The data is not a Fwog capture");
+    }
+    if (header.version != detail::CAPTURE_VERSION)
+    {
+      throw Exception("The capture has version " + std::to_string(header.version) + ", but version " +
+                      std::to_string(detail::CAPTURE_VERSION) + " is required");
+    }
+
+    for (uint32_t i = 0; i < header.recordCount; i++)
+    {
+      const auto recordHeader = reader.Read<detail::CaptureRecordHeader>();
+      const auto payload = reader.Take(recordHeader.size);
+      if (recordHeader.type <= CaptureRecordType::CREATE_COMPUTE_PIPELINE)
+      {
+        CreateObject(static_cast<uint32_t>(recordHeader.type), payload);
+      }
+      else if (recordHeader.type == CaptureRecordType::UNRECORDED_CALL)
+      {
+        unrecordedCalls_.push_back(Reader(payload).ReadString());
+      }
+      else if (recordHeader.type <= CaptureRecordType::CLEAR_TEXTURE)
+      {
+        AddOperation(static_cast<uint32_t>(recordHeader.type), payload);
+      }
+      else
+      {
+        throw Exception("The capture contains an unknown record");
+      }
+    }
+  }
+
+  void CaptureReplayer::CreateObject(uint32_t type, std::span<const std::byte> payload)
+  {
+    auto reader = Reader(payload);
+    switch (static_cast<CaptureRecordType>(type))
+    {
+    case CaptureRecordType::CREATE_BUFFER:
+    {
+      const auto size = reader.Read<uint64_t>();
+      const auto flags = BufferStorageFlags(reader.Read<uint32_t>());
+      buffers_.emplace_back(reader.Take(size), flags);
+      break;
+    }
+    case CaptureRecordType::CREATE_TEXTURE: textures_.emplace_back(reader.Read<TextureCreateInfo>()); break;
+    case CaptureRecordType::CREATE_SAMPLER: samplers_.emplace_back(reader.Read<SamplerState>()); break;
+    case CaptureRecordType::CREATE_GRAPHICS_PIPELINE:
+    {
+      const auto name = reader.ReadString();
+      const auto shaders = ReadShaders(reader);
+      auto info = GraphicsPipelineInfo{.name = name};
+      for (const auto& [stage, shader] : shaders)
+      {
+        switch (stage)
+        {
+        case PipelineStage::VERTEX_SHADER: info.vertexShader = &shader; break;
+        case PipelineStage::TESSELLATION_CONTROL_SHADER: info.tessellationControlShader = &shader; break;
+        case PipelineStage::TESSELLATION_EVALUATION_SHADER: info.tessellationEvaluationShader = &shader; break;
+        case PipelineStage::FRAGMENT_SHADER: info.fragmentShader = &shader; break;
+        default: throw Exception("The capture contains a graphics pipeline with a compute shader");
+        }
+      }
+
+      info.inputAssemblyState = reader.Read<InputAssemblyState>();
+      const auto bindings = ReadArray<VertexInputBindingDescription>(reader);
+      info.vertexInputState.vertexBindingDescriptions = bindings;
+      info.tessellationState = reader.Read<TessellationState>();
+      info.rasterizationState = reader.Read<RasterizationState>();
+      info.multisampleState = reader.Read<MultisampleState>();
+      info.depthState = reader.Read<DepthState>();
+      info.stencilState = reader.Read<StencilState>();
+      info.colorBlendState.logicOpEnable = reader.Read<bool>();
+      info.colorBlendState.logicOp = reader.Read<LogicOp>();
+      const auto attachments = ReadArray<ColorBlendAttachmentState>(reader);
+      info.colorBlendState.attachments = attachments;
+      const auto blendConstants = reader.Read<std::array<float, 4>>();
+      std::copy(blendConstants.begin(), blendConstants.end(), info.colorBlendState.blendConstants);
+
+      graphicsPipelines_.emplace_back(info);
+      break;
+    }
+    case CaptureRecordType::CREATE_COMPUTE_PIPELINE:
+    {
+      const auto name = reader.ReadString();
+      const auto shaders = ReadShaders(reader);
+      if (shaders.size() != 1 || shaders[0].first != PipelineStage::COMPUTE_SHADER)
+      {
+        throw Exception("The capture contains a compute pipeline without a compute shader");
+      }
+      computePipelines_.emplace_back(ComputePipelineInfo{.name = name, .shader = &shaders[0].second});
+      break;
+    }
+    default: FWOG_UNREACHABLE;
+    }
+  }
+
+  void CaptureReplayer::AddOperation(uint32_t type, std::span<const std::byte> payload)
+  {
+    auto reader = Reader(payload);
+    switch (static_cast<CaptureRecordType>(type))
+    {
+    case CaptureRecordType::BEGIN_SWAPCHAIN_RENDERING:
+    {
+      auto& pass = passes_.emplace_back();
+      pass.name = reader.ReadString();
+      auto& renderInfo = pass.swapchainRenderInfo;
+      renderInfo.viewport = reader.Read<Viewport>();
+      renderInfo.colorLoadOp = reader.Read<AttachmentLoadOp>();
+      renderInfo.clearColorValue = reader.ReadClearColor();
+      renderInfo.depthLoadOp = reader.Read<AttachmentLoadOp>();
+      renderInfo.clearDepthValue = reader.Read<float>();
+      renderInfo.stencilLoadOp = reader.Read<AttachmentLoadOp>();
+      renderInfo.clearStencilValue = reader.Read<int32_t>();
+      renderInfo.enableSrgb = reader.Read<bool>();
+      operations_.push_back({type, static_cast<uint32_t>(passes_.size() - 1), 0});
+      return;
+    }
+    case CaptureRecordType::BEGIN_RENDERING:
+    {
+      auto& pass = passes_.emplace_back();
+      pass.name = reader.ReadString();
+      if (reader.Read<bool>())
+      {
+        pass.viewport = reader.Read<Viewport>();
+      }
+
+      const auto colorCount = reader.Read<uint32_t>();
+      for (uint32_t i = 0; i < colorCount; i++)
+      {
+        const Texture& texture = GetObject(textures_, reader.Read<uint32_t>());
+        const auto loadOp = reader.Read<AttachmentLoadOp>();
+        pass.colorAttachments.push_back({.texture = texture, .loadOp = loadOp, .clearValue = reader.ReadClearColor()});
+      }
+      pass.depthAttachment = ReadDepthStencilAttachment(reader, textures_);
+      pass.stencilAttachment = ReadDepthStencilAttachment(reader, textures_);
+      operations_.push_back({type, static_cast<uint32_t>(passes_.size() - 1), 0});
+      return;
+    }
+    case CaptureRecordType::BEGIN_COMPUTE:
+    {
+      passes_.emplace_back().name = reader.ReadString();
+      operations_.push_back({type, static_cast<uint32_t>(passes_.size() - 1), 0});
+      return;
+    }
+    default: break;
+    }
+
+    const auto offset = frame_.size();
+    frame_.insert(frame_.end(), payload.begin(), payload.end());
+    operations_.push_back({type, static_cast<uint32_t>(offset), static_cast<uint32_t>(payload.size())});
+
+    if (static_cast<CaptureRecordType>(type) != CaptureRecordType::COMMANDS)
+    {
+      return;
+    }
+
+    // Replace capture IDs with the handles of the replayer's objects, so the commands can be executed directly
+    auto* data = frame_.data() + offset;
+    auto* end = data + payload.size();
+    while (data < end)
+    {
+      detail::CommandHeader header;
+      if (static_cast<size_t>(end - data) < sizeof(header))
+      {
+        throw Exception("The capture is truncated");
+      }
+      std::memcpy(&header, data, sizeof(header));
+      data += sizeof(header);
+      if (header.type > detail::CommandType::DISPATCH_INDIRECT || header.size > static_cast<size_t>(end - data))
+      {
+        throw Exception("The capture contains an invalid command");
+      }
+
+      detail::ForEachCommandHandle(header.type,
+                                   data,
+                                   [this](CaptureRecordType kind, auto& handle)
+                                   {
+                                     using Handle = std::remove_reference_t<decltype(handle)>;
+                                     const auto id = static_cast<uint32_t>(handle);
+                                     if (id == 0)
+                                     {
+                                       return;
+                                     }
+
+                                     switch (kind)
+                                     {
+                                     case CaptureRecordType::CREATE_BUFFER:
+                                       handle = static_cast<Handle>(GetObject(buffers_, id).Handle());
+                                       break;
+                                     case CaptureRecordType::CREATE_TEXTURE:
+                                       handle = static_cast<Handle>(GetObject(textures_, id).Handle());
+                                       break;
+                                     case CaptureRecordType::CREATE_SAMPLER:
+                                       handle = static_cast<Handle>(GetObject(samplers_, id).Handle());
+                                       break;
+                                     case CaptureRecordType::CREATE_GRAPHICS_PIPELINE:
+                                       handle = static_cast<Handle>(GetObject(graphicsPipelines_, id).RegistryHandle());
+                                       break;
+                                     case CaptureRecordType::CREATE_COMPUTE_PIPELINE:
+                                       handle = static_cast<Handle>(GetObject(computePipelines_, id).RegistryHandle());
+                                       break;
+                                     default: FWOG_UNREACHABLE;
+                                     }
+                                   });
+      data += header.size;
+    }
+  }
+
+  ReplayFrameTiming CaptureReplayer::ReplayFrame()
+  {
+    using Clock = std::chrono::steady_clock;
+    const auto toMilliseconds = [](Clock::duration duration)
+    { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+    auto timing = ReplayFrameTiming{};
+    timing.passes.reserve(passes_.size());
+    const auto frameStart = Clock::now();
+    auto passStart = frameStart;
+    const Pass* currentPass = nullptr;
+
+    for (const auto& operation : operations_)
+    {
+      // The index of operations that begin passes is not an offset
+      const auto payload = [this, &operation] { return Reader(std::span(frame_).subspan(operation.index, operation.size)); };
+      switch (static_cast<CaptureRecordType>(operation.type))
+      {
+      case CaptureRecordType::BEGIN_SWAPCHAIN_RENDERING:
+      {
+        currentPass = &passes_[operation.index];
+        passStart = Clock::now();
+        auto renderInfo = currentPass->swapchainRenderInfo;
+        renderInfo.name = currentPass->name;
+        detail::BeginSwapchainRendering(renderInfo);
+        break;
+      }
+      case CaptureRecordType::BEGIN_RENDERING:
+      {
+        currentPass = &passes_[operation.index];
+        passStart = Clock::now();
+        const auto renderInfo = RenderInfo{
+          .name = currentPass->name,
+          .viewport = currentPass->viewport,
+          .colorAttachments = currentPass->colorAttachments,
+          .depthAttachment = currentPass->depthAttachment,
+          .stencilAttachment = currentPass->stencilAttachment,
+        };
+        detail::BeginRendering(renderInfo);
+        break;
+      }
+      case CaptureRecordType::BEGIN_COMPUTE:
+        currentPass = &passes_[operation.index];
+        passStart = Clock::now();
+        detail::BeginCompute(currentPass->name);
+        break;
+      case CaptureRecordType::END_RENDERING:
+      case CaptureRecordType::END_COMPUTE:
+        if (!currentPass)
+        {
+          throw Exception("The capture ends a pass that it does not begin");
+        }
+        if (static_cast<CaptureRecordType>(operation.type) == CaptureRecordType::END_RENDERING)
+        {
+          detail::EndRendering();
+        }
+        else
+        {
+          detail::EndCompute();
+        }
+        timing.passes.push_back({currentPass->name, toMilliseconds(Clock::now() - passStart)});
+        currentPass = nullptr;
+        break;
+      case CaptureRecordType::COMMANDS: detail::ExecuteCommandsInternal(payload().TakeRest()); break;
+      case CaptureRecordType::UPDATE_BUFFER:
+      {
+        auto reader = payload();
+        auto& buffer = GetObject(buffers_, reader.Read<uint32_t>());
+        const auto offset = reader.Read<uint64_t>();
+        buffer.UpdateData(reader.TakeRest(), offset);
+        break;
+      }
+      case CaptureRecordType::UPDATE_TEXTURE:
+      {
+        auto reader = payload();
+        auto& texture = GetObject(textures_, reader.Read<uint32_t>());
+        auto info = reader.Read<TextureUpdateInfo>();
+        info.pixels = reader.TakeRest().data();
+        texture.UpdateImage(info);
+        break;
+      }
+      case CaptureRecordType::COPY_BUFFER:
+      {
+        auto reader = payload();
+        const auto& source = GetObject(buffers_, reader.Read<uint32_t>());
+        auto& target = GetObject(buffers_, reader.Read<uint32_t>());
+        const auto sourceOffset = reader.Read<uint64_t>();
+        const auto targetOffset = reader.Read<uint64_t>();
+        CopyBuffer({
+          .source = source,
+          .target = target,
+          .sourceOffset = sourceOffset,
+          .targetOffset = targetOffset,
+          .size = reader.Read<uint64_t>(),
+        });
+        break;
+      }
+      case CaptureRecordType::MEMORY_BARRIER: MemoryBarrier(payload().Read<MemoryBarrierBits>()); break;
+      case CaptureRecordType::TEXTURE_BARRIER: TextureBarrier(); break;
+      case CaptureRecordType::BLIT_TEXTURE:
+      {
+        auto reader = payload();
+        const auto& source = GetObject(textures_, reader.Read<uint32_t>());
+        const auto targetId = reader.Read<uint32_t>();
+        const auto sourceOffset = reader.Read<Offset3D>();
+        const auto targetOffset = reader.Read<Offset3D>();
+        const auto sourceExtent = reader.Read<Extent3D>();
+        const auto targetExtent = reader.Read<Extent3D>();
+        const auto filter = reader.Read<Filter>();
+        const auto aspect = reader.Read<AspectMask>();
+        if (targetId == 0)
+        {
+          BlitTextureToSwapchain(source, sourceOffset, targetOffset, sourceExtent, targetExtent, filter, aspect);
+        }
+        else
+        {
+          const auto& target = GetObject(textures_, targetId);
+          BlitTexture(source, target, sourceOffset, targetOffset, sourceExtent, targetExtent, filter, aspect);
+        }
+        break;
+      }
+      case CaptureRecordType::CLEAR_TEXTURE:
+      {
+        auto reader = payload();
+        auto& texture = GetObject(textures_, reader.Read<uint32_t>());
+        auto info = reader.Read<TextureClearInfo>();
+        const auto clearValue = reader.TakeRest();
+        info.data = clearValue.empty() ? nullptr : clearValue.data();
+        texture.ClearImage(info);
+        break;
+      }
+      default: FWOG_UNREACHABLE;
+      }
+    }
+
+    timing.cpuMilliseconds = toMilliseconds(Clock::now() - frameStart);
+    return timing;
+  }
+} // namespace Fwog
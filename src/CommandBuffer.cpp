@@ -0,0 +1,418 @@
+#include <Fwog/Buffer.h>
+#include <Fwog/CommandBuffer.h>
+#include <Fwog/Pipeline.h>
+#include <Fwog/Texture.h>
+#include <Fwog/detail/Commands.h>
+
+#include <cstring>
+#include <type_traits>
+
+namespace Fwog
+{
+  namespace
+  {
+    template<class T>
+    T ReadPayload(const std::byte* data, const detail::CommandHeader& header)
+    {
+      FWOG_ASSERT(header.size == sizeof(T));
+      T payload;
+      std::memcpy(&payload, data, sizeof(T));
+      return payload;
+    }
+  } // namespace
+
+  template<class T>
+  void CommandBuffer::Record(detail::CommandType type, const T& payload)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(sizeof(T) <= UINT16_MAX);
+
+    const auto header = detail::CommandHeader{.type = type, .size = static_cast<uint16_t>(sizeof(T))};
+    const auto offset = data_.size();
+    data_.resize(offset + sizeof(header) + sizeof(T));
+    std::memcpy(data_.data() + offset, &header, sizeof(header));
+    std::memcpy(data_.data() + offset + sizeof(header), &payload, sizeof(T));
+    commandCount_++;
+  }
+
+  void CommandBuffer::BindGraphicsPipeline(const GraphicsPipeline& pipeline)
+  {
+    FWOG_ASSERT(pipeline.RegistryHandle() != 0);
+
+    pipelineKind_ = PipelineKind::GRAPHICS;
+    Record(detail::CommandType::BIND_GRAPHICS_PIPELINE, detail::BindGraphicsPipelineCommand{pipeline.RegistryHandle()});
+  }
+
+  void CommandBuffer::BindComputePipeline(const ComputePipeline& pipeline)
+  {
+    FWOG_ASSERT(pipeline.RegistryHandle() != 0);
+
+    pipelineKind_ = PipelineKind::COMPUTE;
+    Record(detail::CommandType::BIND_COMPUTE_PIPELINE,
+           detail::BindComputePipelineCommand{pipeline.RegistryHandle(), pipeline.WorkgroupSize()});
+  }
+
+  void CommandBuffer::SetViewport(const Viewport& viewport)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::COMPUTE);
+
+    Record(detail::CommandType::SET_VIEWPORT, detail::SetViewportCommand{viewport});
+  }
+
+  void CommandBuffer::SetScissor(const Rect2D& scissor)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::COMPUTE);
+
+    Record(detail::CommandType::SET_SCISSOR, detail::SetScissorCommand{scissor});
+  }
+
+  void CommandBuffer::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::COMPUTE && "Cannot draw with a compute pipeline");
+
+    Record(detail::CommandType::DRAW, detail::DrawCommand{vertexCount, instanceCount, firstVertex, firstInstance});
+  }
+
+  void CommandBuffer::DrawIndexed(uint32_t indexCount,
+                                  uint32_t instanceCount,
+                                  uint32_t firstIndex,
+                                  int32_t vertexOffset,
+                                  uint32_t firstInstance)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::COMPUTE && "Cannot draw with a compute pipeline");
+
+    Record(detail::CommandType::DRAW_INDEXED,
+           detail::DrawIndexedCommand{indexCount, instanceCount, firstIndex, vertexOffset, firstInstance});
+  }
+
+  void CommandBuffer::DrawIndirect(const Buffer& commandBuffer,
+                                   uint64_t commandBufferOffset,
+                                   uint32_t drawCount,
+                                   uint32_t stride)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::COMPUTE && "Cannot draw with a compute pipeline");
+    FWOG_ASSERT(commandBufferOffset < commandBuffer.Size());
+
+    Record(detail::CommandType::DRAW_INDIRECT,
+           detail::DrawIndirectCommand{commandBuffer.Handle(), drawCount, commandBufferOffset, stride});
+  }
+
+  void CommandBuffer::DrawIndirectCount(const Buffer& commandBuffer,
+                                        uint64_t commandBufferOffset,
+                                        const Buffer& countBuffer,
+                                        uint64_t countBufferOffset,
+                                        uint32_t maxDrawCount,
+                                        uint32_t stride)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::COMPUTE && "Cannot draw with a compute pipeline");
+    FWOG_ASSERT(commandBufferOffset < commandBuffer.Size());
+    FWOG_ASSERT(countBufferOffset < countBuffer.Size());
+
+    Record(detail::CommandType::DRAW_INDIRECT_COUNT,
+           detail::DrawIndirectCountCommand{commandBuffer.Handle(),
+                                            countBuffer.Handle(),
+                                            commandBufferOffset,
+                                            countBufferOffset,
+                                            maxDrawCount,
+                                            stride});
+  }
+
+  void CommandBuffer::DrawIndexedIndirect(const Buffer& commandBuffer,
+                                          uint64_t commandBufferOffset,
+                                          uint32_t drawCount,
+                                          uint32_t stride)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::COMPUTE && "Cannot draw with a compute pipeline");
+    FWOG_ASSERT(commandBufferOffset < commandBuffer.Size());
+
+    Record(detail::CommandType::DRAW_INDEXED_INDIRECT,
+           detail::DrawIndirectCommand{commandBuffer.Handle(), drawCount, commandBufferOffset, stride});
+  }
+
+  void CommandBuffer::DrawIndexedIndirectCount(const Buffer& commandBuffer,
+                                               uint64_t commandBufferOffset,
+                                               const Buffer& countBuffer,
+                                               uint64_t countBufferOffset,
+                                               uint32_t maxDrawCount,
+                                               uint32_t stride)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::COMPUTE && "Cannot draw with a compute pipeline");
+    FWOG_ASSERT(commandBufferOffset < commandBuffer.Size());
+    FWOG_ASSERT(countBufferOffset < countBuffer.Size());
+
+    Record(detail::CommandType::DRAW_INDEXED_INDIRECT_COUNT,
+           detail::DrawIndirectCountCommand{commandBuffer.Handle(),
+                                            countBuffer.Handle(),
+                                            commandBufferOffset,
+                                            countBufferOffset,
+                                            maxDrawCount,
+                                            stride});
+  }
+
+  void CommandBuffer::BindVertexBuffer(uint32_t bindingIndex, const Buffer& buffer, uint64_t offset, uint64_t stride)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::COMPUTE);
+    FWOG_ASSERT(offset < buffer.Size());
+
+    Record(detail::CommandType::BIND_VERTEX_BUFFER,
+           detail::BindVertexBufferCommand{bindingIndex, buffer.Handle(), offset, stride});
+  }
+
+  void CommandBuffer::BindIndexBuffer(const Buffer& buffer, IndexType indexType)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::COMPUTE);
+
+    Record(detail::CommandType::BIND_INDEX_BUFFER, detail::BindIndexBufferCommand{buffer.Handle(), indexType});
+  }
+
+  void CommandBuffer::BindUniformBuffer(uint32_t index, const Buffer& buffer, uint64_t offset, uint64_t size)
+  {
+    if (size == WHOLE_BUFFER)
+    {
+      size = buffer.Size() - offset;
+    }
+
+    FWOG_ASSERT(offset + size <= buffer.Size());
+
+    Record(detail::CommandType::BIND_UNIFORM_BUFFER,
+           detail::BindBufferRangeCommand{index, buffer.Handle(), offset, size});
+  }
+
+  void CommandBuffer::BindStorageBuffer(uint32_t index,
+                                        const Buffer& buffer,
+                                        uint64_t offset,
+                                        uint64_t size,
+                                        AccessType access)
+  {
+    if (size == WHOLE_BUFFER)
+    {
+      size = buffer.Size() - offset;
+    }
+
+    FWOG_ASSERT(offset + size <= buffer.Size());
+
+    Record(detail::CommandType::BIND_STORAGE_BUFFER,
+           detail::BindStorageBufferCommand{{index, buffer.Handle(), offset, size}, access});
+  }
+
+  void CommandBuffer::BindSampledImage(uint32_t index, const Texture& texture, const Sampler& sampler)
+  {
+    Record(detail::CommandType::BIND_SAMPLED_IMAGE,
+           detail::BindSampledImageCommand{index, const_cast<Texture&>(texture).Handle(), sampler.Handle()});
+  }
+
+  void CommandBuffer::BindImage(uint32_t index, const Texture& texture, uint32_t level, AccessType access)
+  {
+    FWOG_ASSERT(level < texture.GetCreateInfo().mipLevels);
+
+    Record(detail::CommandType::BIND_IMAGE,
+           detail::BindImageCommand{index,
+                                    const_cast<Texture&>(texture).Handle(),
+                                    level,
+                                    texture.GetCreateInfo().format,
+                                    access});
+  }
+
+  void CommandBuffer::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+  {
+    Dispatch(Extent3D{groupCountX, groupCountY, groupCountZ});
+  }
+
+  void CommandBuffer::Dispatch(Extent3D groupCount)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::GRAPHICS && "Cannot dispatch with a graphics pipeline");
+
+    Record(detail::CommandType::DISPATCH, detail::DispatchCommand{groupCount});
+  }
+
+  void CommandBuffer::DispatchInvocations(uint32_t invocationCountX, uint32_t invocationCountY, uint32_t invocationCountZ)
+  {
+    DispatchInvocations(Extent3D{invocationCountX, invocationCountY, invocationCountZ});
+  }
+
+  void CommandBuffer::DispatchInvocations(Extent3D invocationCount)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::GRAPHICS && "Cannot dispatch with a graphics pipeline");
+
+    Record(detail::CommandType::DISPATCH_INVOCATIONS, detail::DispatchCommand{invocationCount});
+  }
+
+  void CommandBuffer::DispatchIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset)
+  {
+    FWOG_ASSERT(pipelineKind_ != PipelineKind::GRAPHICS && "Cannot dispatch with a graphics pipeline");
+    FWOG_ASSERT(commandBufferOffset < commandBuffer.Size());
+
+    Record(detail::CommandType::DISPATCH_INDIRECT,
+           detail::DispatchIndirectCommand{commandBuffer.Handle(), commandBufferOffset});
+  }
+
+  void CommandBuffer::Reset() noexcept
+  {
+    data_.clear();
+    commandCount_ = 0;
+    pipelineKind_ = PipelineKind::NONE;
+  }
+
+  namespace detail
+  {
+    void ExecuteCommandsInternal(std::span<const std::byte> commands)
+    {
+      const std::byte* data = commands.data();
+      const std::byte* end = data + commands.size();
+
+      while (data < end)
+      {
+        CommandHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        data += sizeof(header);
+
+        switch (header.type)
+        {
+        case CommandType::BIND_GRAPHICS_PIPELINE:
+        {
+          auto cmd = ReadPayload<BindGraphicsPipelineCommand>(data, header);
+          BindGraphicsPipelineInternal(cmd.pipeline);
+          break;
+        }
+        case CommandType::BIND_COMPUTE_PIPELINE:
+        {
+          auto cmd = ReadPayload<BindComputePipelineCommand>(data, header);
+          BindComputePipelineInternal(cmd.pipeline, cmd.workgroupSize);
+          break;
+        }
+        case CommandType::SET_VIEWPORT:
+        {
+          auto cmd = ReadPayload<SetViewportCommand>(data, header);
+          Cmd::SetViewport(cmd.viewport);
+          break;
+        }
+        case CommandType::SET_SCISSOR:
+        {
+          auto cmd = ReadPayload<SetScissorCommand>(data, header);
+          Cmd::SetScissor(cmd.scissor);
+          break;
+        }
+        case CommandType::BIND_VERTEX_BUFFER:
+        {
+          auto cmd = ReadPayload<BindVertexBufferCommand>(data, header);
+          BindVertexBufferInternal(cmd.bindingIndex, cmd.buffer, cmd.offset, cmd.stride);
+          break;
+        }
+        case CommandType::BIND_INDEX_BUFFER:
+        {
+          auto cmd = ReadPayload<BindIndexBufferCommand>(data, header);
+          BindIndexBufferInternal(cmd.buffer, cmd.indexType);
+          break;
+        }
+        case CommandType::BIND_UNIFORM_BUFFER:
+        {
+          auto cmd = ReadPayload<BindBufferRangeCommand>(data, header);
+          BindUniformBufferInternal(cmd.index, cmd.buffer, cmd.offset, cmd.size);
+          break;
+        }
+        case CommandType::BIND_STORAGE_BUFFER:
+        {
+          auto cmd = ReadPayload<BindStorageBufferCommand>(data, header);
+          BindStorageBufferInternal(cmd.range.index, cmd.range.buffer, cmd.range.offset, cmd.range.size, cmd.access);
+          break;
+        }
+        case CommandType::BIND_SAMPLED_IMAGE:
+        {
+          auto cmd = ReadPayload<BindSampledImageCommand>(data, header);
+          BindSampledImageInternal(cmd.index, cmd.texture, cmd.sampler);
+          break;
+        }
+        case CommandType::BIND_IMAGE:
+        {
+          auto cmd = ReadPayload<BindImageCommand>(data, header);
+          BindImageInternal(cmd.index, cmd.texture, cmd.level, cmd.format, cmd.access);
+          break;
+        }
+        case CommandType::DRAW:
+        {
+          auto cmd = ReadPayload<DrawCommand>(data, header);
+          Cmd::Draw(cmd.vertexCount, cmd.instanceCount, cmd.firstVertex, cmd.firstInstance);
+          break;
+        }
+        case CommandType::DRAW_INDEXED:
+        {
+          auto cmd = ReadPayload<DrawIndexedCommand>(data, header);
+          Cmd::DrawIndexed(cmd.indexCount, cmd.instanceCount, cmd.firstIndex, cmd.vertexOffset, cmd.firstInstance);
+          break;
+        }
+        case CommandType::DRAW_INDIRECT:
+        {
+          auto cmd = ReadPayload<DrawIndirectCommand>(data, header);
+          DrawIndirectInternal(cmd.commandBuffer, cmd.commandBufferOffset, cmd.drawCount, cmd.stride);
+          break;
+        }
+        case CommandType::DRAW_INDIRECT_COUNT:
+        {
+          auto cmd = ReadPayload<DrawIndirectCountCommand>(data, header);
+          DrawIndirectCountInternal(cmd.commandBuffer,
+                                    cmd.commandBufferOffset,
+                                    cmd.countBuffer,
+                                    cmd.countBufferOffset,
+                                    cmd.maxDrawCount,
+                                    cmd.stride);
+          break;
+        }
+        case CommandType::DRAW_INDEXED_INDIRECT:
+        {
+          auto cmd = ReadPayload<DrawIndirectCommand>(data, header);
+          DrawIndexedIndirectInternal(cmd.commandBuffer, cmd.commandBufferOffset, cmd.drawCount, cmd.stride);
+          break;
+        }
+        case CommandType::DRAW_INDEXED_INDIRECT_COUNT:
+        {
+          auto cmd = ReadPayload<DrawIndirectCountCommand>(data, header);
+          DrawIndexedIndirectCountInternal(cmd.commandBuffer,
+                                           cmd.commandBufferOffset,
+                                           cmd.countBuffer,
+                                           cmd.countBufferOffset,
+                                           cmd.maxDrawCount,
+                                           cmd.stride);
+          break;
+        }
+        case CommandType::DISPATCH:
+        {
+          auto cmd = ReadPayload<DispatchCommand>(data, header);
+          Cmd::Dispatch(cmd.count);
+          break;
+        }
+        case CommandType::DISPATCH_INVOCATIONS:
+        {
+          auto cmd = ReadPayload<DispatchCommand>(data, header);
+          Cmd::DispatchInvocations(cmd.count);
+          break;
+        }
+        case CommandType::DISPATCH_INDIRECT:
+        {
+          auto cmd = ReadPayload<DispatchIndirectCommand>(data, header);
+          DispatchIndirectInternal(cmd.commandBuffer, cmd.commandBufferOffset);
+          break;
+        }
+        default: FWOG_UNREACHABLE;
+        }
+
+        data += header.size;
+      }
+    }
+  } // namespace detail
+
+  namespace Cmd
+  {
+    void ExecuteCommandBuffer(const CommandBuffer& commandBuffer)
+    {
+      detail::ExecuteCommandsInternal(commandBuffer.data_);
+    }
+
+    void ExecuteCommandBuffers(std::span<const CommandBuffer> commandBuffers)
+    {
+      for (const auto& commandBuffer : commandBuffers)
+      {
+        ExecuteCommandBuffer(commandBuffer);
+      }
+    }
+  } // namespace Cmd
+} // namespace Fwog
@@ -1,33 +1,162 @@
 #include <Fwog/Context.h>
 #include <Fwog/detail/ContextState.h>
+#include <Fwog/detail/ProgramCache.h>
+#include <Fwog/detail/SamplerCache.h>
 #include FWOG_OPENGL_HEADER
 
+#include <algorithm>
+
 namespace Fwog
 {
   namespace detail
   {
     void ZeroResourceBindings()
     {
-      auto& limits = Fwog::detail::context->properties.limits;
-      for (int i = 0; i < limits.maxImageUnits; i++)
+      auto count = [](const auto& slots) { return static_cast<GLsizei>(slots.bound.size()); };
+
+      // Passing null to the multi-bind functions unbinds every slot in the range
+      glBindBuffersRange(GL_UNIFORM_BUFFER, 0, count(context->uniformBuffers), nullptr, nullptr, nullptr);
+      glBindBuffersRange(GL_SHADER_STORAGE_BUFFER, 0, count(context->storageBuffers), nullptr, nullptr, nullptr);
+      glBindTextures(0, count(context->textureUnits), nullptr);
+      glBindSamplers(0, count(context->samplerUnits), nullptr);
+      glBindImageTextures(0, count(context->imageUnits), nullptr);
+
+      context->uniformBuffers.Reset();
+      context->storageBuffers.Reset();
+      context->textureUnits.Reset();
+      context->samplerUnits.Reset();
+      context->imageUnits.Reset();
+
+      std::fill(context->storageBufferWritable.begin(), context->storageBufferWritable.end(), false);
+      context->storageBufferWritableEnd = 0;
+    }
+
+    void RemoveBufferBindings(GLuint buffer)
+    {
+      for (auto* slots : {&context->uniformBuffers, &context->storageBuffers})
       {
-        glBindImageTexture(i, 0, 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA32F);
+        for (size_t i = 0; i < slots->bound.size(); i++)
+        {
+          if (slots->bound[i].buffer == buffer)
+          {
+            slots->bound[i] = {};
+          }
+          if (slots->pending[i].buffer == buffer)
+          {
+            slots->pending[i] = {};
+          }
+        }
       }
 
-      for (int i = 0; i < limits.maxCombinedShaderStorageBlocks; i++)
+      context->vaoCache.RemoveBuffer(buffer);
+      context->barrierTracker.RemoveBuffer(buffer);
+    }
+
+    void RemoveTextureBindings(GLuint texture)
+    {
+      auto& textureUnits = context->textureUnits;
+      for (size_t i = 0; i < textureUnits.bound.size(); i++)
       {
-        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, i, 0, 0, 0);
+        if (textureUnits.bound[i] == texture)
+        {
+          textureUnits.bound[i] = 0;
+        }
+        if (textureUnits.pending[i] == texture)
+        {
+          textureUnits.pending[i] = 0;
+        }
       }
 
-      for (int i = 0; i < limits.maxCombinedUniformBlocks; i++)
+      auto& imageUnits = context->imageUnits;
+      for (size_t i = 0; i < imageUnits.bound.size(); i++)
       {
-        glBindBufferRange(GL_UNIFORM_BUFFER, i, 0, 0, 0);
+        if (imageUnits.bound[i].texture == texture)
+        {
+          imageUnits.bound[i] = {};
+        }
+        if (imageUnits.pending[i].texture == texture)
+        {
+          imageUnits.pending[i] = {};
+        }
       }
 
-      for (int i = 0; i < limits.maxCombinedTextureImageUnits; i++)
+      context->barrierTracker.RemoveTexture(texture);
+    }
+
+    void DestroyBuffer(GLuint buffer, bool isMapped)
+    {
+      if (context->isWorkerContext)
       {
-        glBindTextureUnit(i, 0);
-        glBindSampler(i, 0);
+        RemoveBufferBindings(buffer);
+        auto lock = std::lock_guard(gDeferredDeletions.mutex);
+        gDeferredDeletions.buffers.push_back({buffer, isMapped});
+        return;
+      }
+
+      // Mapped buffers are read by the capture, so it must forget them before they are unmapped
+      if (context->capture)
+      {
+        context->capture->ForgetBuffer(buffer);
+      }
+
+      if (isMapped)
+      {
+        glUnmapNamedBuffer(buffer);
+      }
+      glDeleteBuffers(1, &buffer);
+      RemoveBufferBindings(buffer);
+    }
+
+    void DestroyTexture(GLuint texture, uint64_t bindlessHandle)
+    {
+      if (context->isWorkerContext)
+      {
+        RemoveTextureBindings(texture);
+        auto lock = std::lock_guard(gDeferredDeletions.mutex);
+        gDeferredDeletions.textures.push_back({texture, bindlessHandle});
+        return;
+      }
+
+      // Residency is per-context, and bindless handles are made resident on the main context
+      if (bindlessHandle != 0)
+      {
+        glMakeTextureHandleNonResidentARB(bindlessHandle);
+      }
+
+      if (context->capture)
+      {
+        context->capture->ForgetTexture(texture);
+      }
+      glDeleteTextures(1, &texture);
+      // Ensure that the texture is no longer referenced in the FBO cache
+      context->fboCache.RemoveTexture(texture);
+      RemoveTextureBindings(texture);
+    }
+
+    void ProcessDeferredDeletions()
+    {
+      FWOG_ASSERT(!context->isWorkerContext);
+
+      auto buffers = std::vector<DeferredDeletions::DeferredBuffer>();
+      auto textures = std::vector<DeferredDeletions::DeferredTexture>();
+      {
+        auto lock = std::lock_guard(gDeferredDeletions.mutex);
+        if (gDeferredDeletions.buffers.empty() && gDeferredDeletions.textures.empty())
+        {
+          return;
+        }
+        buffers.swap(gDeferredDeletions.buffers);
+        textures.swap(gDeferredDeletions.textures);
+      }
+
+      for (auto [buffer, isMapped] : buffers)
+      {
+        DestroyBuffer(buffer, isMapped);
+      }
+
+      for (auto [texture, bindlessHandle] : textures)
+      {
+        DestroyTexture(texture, bindlessHandle);
       }
     }
   } // namespace detail
@@ -130,6 +259,11 @@ namespace Fwog
         features.bindlessTextures = true;
       }
 
+      if (extensionString == "GL_KHR_parallel_shader_compile")
+      {
+        features.parallelShaderCompile = true;
+      }
+
       if (extensionString == "GL_KHR_shader_subgroup")
       {
         features.shaderSubgroup = true;
@@ -157,12 +291,48 @@ namespace Fwog
     }
   }
 
-  void Initialize(const ContextInitializeInfo& contextInfo)
+  static void CreateContextState(const ContextInitializeInfo& contextInfo)
   {
-    FWOG_ASSERT(detail::context == nullptr && "Fwog has already been initialized");
     detail::context = new Fwog::detail::ContextState;
     detail::context->verboseMessageCallback = contextInfo.verboseMessageCallback;
+    detail::context->fboCache.SetCapacity(contextInfo.maxCachedFramebuffers);
     QueryGlDeviceProperties(Fwog::detail::context->properties);
+
+    // Let the driver use as many threads as it wants to compile shaders in the background
+    if (detail::context->properties.features.parallelShaderCompile)
+    {
+      glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+
+    const auto& limits = detail::context->properties.limits;
+    detail::context->uniformBuffers = detail::BindingSlots<detail::BufferRangeBinding>(limits.maxUniformBufferBindings);
+    detail::context->storageBuffers = detail::BindingSlots<detail::BufferRangeBinding>(limits.maxShaderStorageBufferBindings);
+    detail::context->textureUnits = detail::BindingSlots<GLuint>(limits.maxCombinedTextureImageUnits);
+    detail::context->samplerUnits = detail::BindingSlots<GLuint>(limits.maxCombinedTextureImageUnits);
+    detail::context->imageUnits = detail::BindingSlots<detail::ImageBinding>(limits.maxImageUnits);
+    detail::context->storageBufferWritable.resize(limits.maxShaderStorageBufferBindings);
+
+    auto maxSlots = std::max({limits.maxUniformBufferBindings,
+                              limits.maxShaderStorageBufferBindings,
+                              limits.maxCombinedTextureImageUnits,
+                              limits.maxImageUnits,
+                              limits.maxVertexAttribBindings});
+    detail::context->scratchNames.resize(maxSlots);
+    detail::context->scratchOffsets.resize(maxSlots);
+    detail::context->scratchSizes.resize(maxSlots);
+    detail::context->scratchStrides.resize(maxSlots);
+  }
+
+  void Initialize(const ContextInitializeInfo& contextInfo)
+  {
+    FWOG_ASSERT(detail::context == nullptr && "Fwog has already been initialized");
+    CreateContextState(contextInfo);
+
+    if (!contextInfo.programCachePath.empty())
+    {
+      detail::gProgramCache.Open(contextInfo.programCachePath, detail::context->properties);
+    }
+
     glDisable(GL_DITHER);
     glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
   }
@@ -170,6 +340,25 @@ namespace Fwog
   void Terminate()
   {
     FWOG_ASSERT(Fwog::detail::context && "Fwog has already been terminated");
+    FWOG_ASSERT(!detail::context->isWorkerContext && "Use DestroyWorkerContext on worker threads");
+    detail::ProcessDeferredDeletions();
+    detail::SetLastGraphicsPipelineInternal(0);
+    detail::gSamplerCache.Clear();
+    detail::gProgramCache.Close();
+    delete Fwog::detail::context;
+    Fwog::detail::context = nullptr;
+  }
+
+  void CreateWorkerContext(const ContextInitializeInfo& contextInfo)
+  {
+    FWOG_ASSERT(detail::context == nullptr && "Fwog has already been initialized on this thread");
+    CreateContextState(contextInfo);
+    detail::context->isWorkerContext = true;
+  }
+
+  void DestroyWorkerContext()
+  {
+    FWOG_ASSERT(detail::context && detail::context->isWorkerContext && "This thread has no worker context");
     delete Fwog::detail::context;
     Fwog::detail::context = nullptr;
   }
@@ -180,9 +369,8 @@ namespace Fwog
 
     FWOG_ASSERT(!context->isComputeActive && !context->isRendering);
 
-#ifdef FWOG_DEBUG
+    // The binding shadow state can no longer be trusted, so put GL and the shadow state back in sync
     detail::ZeroResourceBindings();
-#endif
 
     for (int i = 0; i < detail::MAX_COLOR_ATTACHMENTS; i++)
     {
@@ -200,7 +388,8 @@ namespace Fwog
 
     context->currentFbo = 0;
     context->currentVao = 0;
-    context->lastGraphicsPipeline.reset();
+    context->currentVertexArrayBindings = nullptr;
+    detail::SetLastGraphicsPipelineInternal(0);
     context->initViewport = true;
     context->lastScissor = {};
 
@@ -213,4 +402,37 @@ namespace Fwog
   {
     return Fwog::detail::context->properties;
   }
+
+  const FrameStatistics& GetFrameStatistics()
+  {
+    return Fwog::detail::context->statistics;
+  }
+
+  void ResetFrameStatistics()
+  {
+    Fwog::detail::context->statistics = {};
+  }
+
+  VertexArrayStatistics GetVertexArrayStatistics()
+  {
+    auto stats = VertexArrayStatistics{};
+    Fwog::detail::context->vaoCache.ForEach(
+      [&stats](const detail::CachedVertexArray& vao)
+      {
+        stats.vertexArrays++;
+        stats.pipelines += vao.pipelineCount;
+        stats.maxPipelinesPerVertexArray = std::max(stats.maxPipelinesPerVertexArray, vao.pipelineCount);
+      });
+    return stats;
+  }
+
+  bool SaveProgramCache()
+  {
+    return detail::gProgramCache.Save();
+  }
+
+  ProgramCacheStatistics GetProgramCacheStatistics()
+  {
+    return detail::gProgramCache.GetStatistics();
+  }
 } // namespace Fwog
\ No newline at end of file
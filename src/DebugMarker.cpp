@@ -1,4 +1,6 @@
 #include <Fwog/DebugMarker.h>
+#include <Fwog/GpuProfiler.h>
+#include <Fwog/detail/ContextState.h>
 #include FWOG_OPENGL_HEADER
 
 namespace Fwog
@@ -6,10 +8,18 @@ namespace Fwog
   ScopedDebugMarker::ScopedDebugMarker(const char* message)
   {
     glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, message);
+    if (detail::context->profiler)
+    {
+      detail::context->profiler->PushZone(message);
+    }
   }
 
   ScopedDebugMarker::~ScopedDebugMarker()
   {
+    if (detail::context->profiler)
+    {
+      detail::context->profiler->PopZone();
+    }
     glPopDebugGroup();
   }
 } // namespace Fwog
\ No newline at end of file
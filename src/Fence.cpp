@@ -1,5 +1,6 @@
 #include <Fwog/Fence.h>
-#include <numeric>
+#include <Fwog/detail/ContextState.h>
+#include <chrono>
 #include <utility>
 #include <new>
 #include FWOG_OPENGL_HEADER
@@ -27,24 +28,46 @@ namespace Fwog
   {
     FWOG_ASSERT(sync_ == nullptr);
     sync_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    // Waiting flushes the waiting thread's context, so the fence would never be reached if it isn't flushed here
+    if (detail::context->isWorkerContext)
+    {
+      glFlush();
+    }
   }
 
-  uint64_t Fence::Wait()
-  {
-    FWOG_ASSERT(sync_ != nullptr);
-    GLuint id;
-    glGenQueries(1, &id);
-    glBeginQuery(GL_TIME_ELAPSED, id);
-    GLenum result = glClientWaitSync(reinterpret_cast<GLsync>(sync_),
-                                     GL_SYNC_FLUSH_COMMANDS_BIT,
-                                     std::numeric_limits<GLuint64>::max());
-    FWOG_ASSERT(result == GL_CONDITION_SATISFIED);
-    glEndQuery(GL_TIME_ELAPSED);
-    uint64_t elapsed;
-    glGetQueryObjectui64v(id, GL_QUERY_RESULT, &elapsed);
-    glDeleteQueries(1, &id);
+  bool Fence::IsSignaled()
+  {
+    return Wait(0) == FenceStatus::SIGNALED;
+  }
+
+  FenceStatus Fence::Wait(uint64_t timeoutNs, uint64_t* blockedNs)
+  {
+    if (sync_ == nullptr)
+    {
+      if (blockedNs)
+      {
+        *blockedNs = 0;
+      }
+      return FenceStatus::SIGNALED;
+    }
+
+    const auto start = blockedNs ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+    const GLenum result = glClientWaitSync(reinterpret_cast<GLsync>(sync_), GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+    if (blockedNs)
+    {
+      *blockedNs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+      return FenceStatus::TIMEOUT;
+    }
+
+    FWOG_ASSERT(result == GL_CONDITION_SATISFIED || result == GL_ALREADY_SIGNALED);
     DeleteSync();
-    return elapsed;
+    return FenceStatus::SIGNALED;
   }
 
   void Fence::DeleteSync()
@@ -52,4 +75,83 @@ namespace Fwog
     glDeleteSync(reinterpret_cast<GLsync>(sync_));
     sync_ = nullptr;
   }
+
+  uint64_t FencePool::Signal()
+  {
+    auto fence = Fence();
+    fence.Signal();
+    return fences_.Insert(std::move(fence));
+  }
+
+  bool FencePool::IsSignaled(uint64_t fence)
+  {
+    return Wait(fence, 0) == FenceStatus::SIGNALED;
+  }
+
+  FenceStatus FencePool::Wait(uint64_t fence, uint64_t timeoutNs)
+  {
+    // Fences are erased once they are observed to be signaled
+    auto* f = fences_.Get(fence);
+    if (f == nullptr)
+    {
+      return FenceStatus::SIGNALED;
+    }
+
+    if (f->Wait(timeoutNs) == FenceStatus::TIMEOUT)
+    {
+      return FenceStatus::TIMEOUT;
+    }
+
+    fences_.Erase(fence);
+    return FenceStatus::SIGNALED;
+  }
+
+  void FencePool::Release(uint64_t fence)
+  {
+    fences_.Erase(fence);
+  }
+
+  uint64_t Timeline::Signal()
+  {
+    pending_.push_back({++lastSignaledValue_, Fence()});
+    pending_.back().fence.Signal();
+    return lastSignaledValue_;
+  }
+
+  uint64_t Timeline::GetCompletedValue()
+  {
+    while (!pending_.empty() && pending_.front().fence.IsSignaled())
+    {
+      completedValue_ = pending_.front().value;
+      pending_.pop_front();
+    }
+    return completedValue_;
+  }
+
+  bool Timeline::IsCompleted(uint64_t value)
+  {
+    return value <= completedValue_ || value <= GetCompletedValue();
+  }
+
+  FenceStatus Timeline::Wait(uint64_t value, uint64_t timeoutNs)
+  {
+    FWOG_ASSERT(value <= lastSignaledValue_ && "The value has not been signaled");
+    if (IsCompleted(value))
+    {
+      return FenceStatus::SIGNALED;
+    }
+
+    // Every value has a fence, so the pending fences have consecutive values
+    const auto it = pending_.begin() + static_cast<ptrdiff_t>(value - pending_.front().value);
+
+    if (it->fence.Wait(timeoutNs) == FenceStatus::TIMEOUT)
+    {
+      return FenceStatus::TIMEOUT;
+    }
+
+    // Every older fence has been signaled as well
+    completedValue_ = it->value;
+    pending_.erase(pending_.begin(), it + 1);
+    return FenceStatus::SIGNALED;
+  }
 } // namespace Fwog
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include <Fwog/GpuProfiler.h>
+#include <Fwog/detail/ContextState.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace Fwog
+{
+  namespace
+  {
+    void WriteEscaped(std::ostringstream& stream, std::string_view string)
+    {
+      for (char c : string)
+      {
+        switch (c)
+        {
+        case '"': stream << "\\\""; break;
+        case '\\': stream << "\\\\"; break;
+        case '\n': stream << "\\n"; break;
+        case '\t': stream << "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20)
+          {
+            stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+          }
+          else
+          {
+            stream << c;
+          }
+        }
+      }
+    }
+
+    void WriteEvent(std::ostringstream& stream, std::string_view name, uint32_t thread, uint64_t beginNs, uint64_t endNs)
+    {
+      stream << ",\n" << R"({"name":")";
+      WriteEscaped(stream, name);
+      stream << R"(","ph":"X","pid":0,"tid":)" << thread << R"(,"ts":)" << static_cast<double>(beginNs) / 1e3
+             << R"(,"dur":)" << static_cast<double>(endNs - beginNs) / 1e3 << "}";
+    }
+
+    uint64_t SteadyClockNs()
+    {
+      return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+    }
+  } // namespace
+
+  const GpuProfilerZone* GpuProfilerFrame::FindZone(std::string_view name) const
+  {
+    auto it = std::find_if(zones.begin(), zones.end(), [name](const auto& zone) { return zone.name == name; });
+    return it != zones.end() ? &*it : nullptr;
+  }
+
+  std::vector<uint32_t> GpuProfilerFrame::GetChildren(uint32_t zone) const
+  {
+    std::vector<uint32_t> children;
+    for (uint32_t i = 0; i < zones.size(); i++)
+    {
+      if (zones[i].parent == zone)
+      {
+        children.push_back(i);
+      }
+    }
+    return children;
+  }
+
+  GpuProfiler::GpuProfiler(const GpuProfilerCreateInfo& createInfo)
+    : latencyFrames_(createInfo.latencyFrames),
+      maxZonesPerFrame_(createInfo.maxZonesPerFrame),
+      historyFrames_(createInfo.historyFrames),
+      epoch_(SteadyClockNs()),
+      queries_(static_cast<size_t>(createInfo.latencyFrames) * createInfo.maxZonesPerFrame * 2),
+      frames_(createInfo.latencyFrames)
+  {
+    FWOG_ASSERT(latencyFrames_ > 0);
+    glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(queries_.size()), queries_.data());
+  }
+
+  GpuProfiler::~GpuProfiler()
+  {
+    if (detail::context && detail::context->profiler == this)
+    {
+      detail::context->profiler = nullptr;
+    }
+    glDeleteQueries(static_cast<GLsizei>(queries_.size()), queries_.data());
+  }
+
+  void GpuProfiler::BeginFrame()
+  {
+    FWOG_ASSERT(!isRecording_ && "EndFrame must be called before beginning another frame");
+    FWOG_ASSERT(!detail::context->profiler && "Another profiler is profiling a frame");
+    FWOG_ASSERT(!detail::context->isWorkerContext && "Cannot profile on a worker context");
+
+    // Resolve frames oldest first. The oldest frame occupies the slot of the new frame, so it is dropped if its
+    // results are not available yet. Newer frames are left for later.
+    for (uint32_t i = 0; i < latencyFrames_; i++)
+    {
+      auto& pending = frames_[(frameIndex_ + i) % latencyFrames_];
+      if (!pending.isPending)
+      {
+        continue;
+      }
+
+      if (!TryResolve(pending))
+      {
+        if (i != 0)
+        {
+          break;
+        }
+        pending.isPending = false;
+        droppedFrames_++;
+      }
+    }
+
+    auto& pending = frames_[frameIndex_ % latencyFrames_];
+    pending.frame.frameIndex = frameIndex_;
+    pending.frame.zones.clear();
+    pending.timedZoneCount = 0;
+    pending.lastQuery = 0;
+
+    // Pair a GPU timestamp with the CPU time so GPU times can be converted to the CPU clock
+    glGetInteger64v(GL_TIMESTAMP, &pending.gpuReference);
+    pending.cpuReference = Now();
+    pending.frame.cpuBeginNs = pending.cpuReference;
+
+    isRecording_ = true;
+    detail::context->profiler = this;
+  }
+
+  void GpuProfiler::EndFrame()
+  {
+    FWOG_ASSERT(isRecording_ && "BeginFrame must be called before ending a frame");
+    FWOG_ASSERT(zoneStack_.empty() && "Every zone must be popped before the frame ends");
+
+    auto& pending = frames_[frameIndex_ % latencyFrames_];
+    pending.frame.cpuEndNs = Now();
+    pending.isPending = true;
+
+    isRecording_ = false;
+    detail::context->profiler = nullptr;
+    frameIndex_++;
+  }
+
+  void GpuProfiler::PushZone(std::string_view name)
+  {
+    FWOG_ASSERT(isRecording_ && "Zones can only be pushed between BeginFrame and EndFrame");
+
+    auto& pending = frames_[frameIndex_ % latencyFrames_];
+    const auto zone = static_cast<uint32_t>(pending.frame.zones.size());
+    const bool isTimed = zone < maxZonesPerFrame_;
+
+    pending.frame.zones.push_back({
+      .name = std::string(name),
+      .parent = zoneStack_.empty() ? UINT32_MAX : zoneStack_.back(),
+      .depth = static_cast<uint32_t>(zoneStack_.size()),
+      .cpuBeginNs = Now(),
+      .cpuEndNs = 0,
+      .gpuBeginNs = 0,
+      .gpuEndNs = 0,
+      .hasGpuTime = isTimed,
+    });
+    zoneStack_.push_back(zone);
+
+    if (isTimed)
+    {
+      pending.timedZoneCount++;
+      pending.lastQuery = GetQueryIndex(zone);
+      glQueryCounter(queries_[pending.lastQuery], GL_TIMESTAMP);
+    }
+  }
+
+  void GpuProfiler::PopZone()
+  {
+    FWOG_ASSERT(!zoneStack_.empty() && "PopZone called without a matching PushZone");
+
+    auto& pending = frames_[frameIndex_ % latencyFrames_];
+    const auto zone = zoneStack_.back();
+    zoneStack_.pop_back();
+
+    if (pending.frame.zones[zone].hasGpuTime)
+    {
+      pending.lastQuery = GetQueryIndex(zone) + 1;
+      glQueryCounter(queries_[pending.lastQuery], GL_TIMESTAMP);
+    }
+    pending.frame.zones[zone].cpuEndNs = Now();
+  }
+
+  std::string GpuProfiler::ExportChromeTrace() const
+  {
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(3);
+    stream << R"({"displayTimeUnit":"ns","traceEvents":[)";
+    stream << "\n" << R"({"name":"thread_name","ph":"M","pid":0,"tid":0,"args":{"name":"CPU"}},)";
+    stream << "\n" << R"({"name":"thread_name","ph":"M","pid":0,"tid":1,"args":{"name":"GPU"}})";
+
+    for (const auto& frame : history_)
+    {
+      WriteEvent(stream, "Frame " + std::to_string(frame.frameIndex), 0, frame.cpuBeginNs, frame.cpuEndNs);
+      for (const auto& zone : frame.zones)
+      {
+        WriteEvent(stream, zone.name, 0, zone.cpuBeginNs, zone.cpuEndNs);
+        if (zone.hasGpuTime)
+        {
+          WriteEvent(stream, zone.name, 1, zone.gpuBeginNs, zone.gpuEndNs);
+        }
+      }
+    }
+
+    stream << "\n]}\n";
+    return stream.str();
+  }
+
+  uint64_t GpuProfiler::Now() const
+  {
+    return SteadyClockNs() - epoch_;
+  }
+
+  uint32_t GpuProfiler::GetQueryIndex(uint32_t zone) const
+  {
+    return static_cast<uint32_t>(frameIndex_ % latencyFrames_) * maxZonesPerFrame_ * 2 + zone * 2;
+  }
+
+  bool GpuProfiler::TryResolve(PendingFrame& pending)
+  {
+    if (pending.timedZoneCount > 0)
+    {
+      // Timestamps are written in order, so the rest are available if the last one is
+      GLint isAvailable{};
+      glGetQueryObjectiv(queries_[pending.lastQuery], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+      if (!isAvailable)
+      {
+        return false;
+      }
+    }
+
+    const auto firstQuery = static_cast<uint32_t>(pending.frame.frameIndex % latencyFrames_) * maxZonesPerFrame_ * 2;
+    const auto toCpuTime = [&pending](GLuint64 gpuTime)
+    {
+      const auto cpuTime = static_cast<int64_t>(pending.cpuReference) + static_cast<int64_t>(gpuTime) -
+                           pending.gpuReference;
+      return static_cast<uint64_t>(std::max<int64_t>(cpuTime, 0));
+    };
+
+    for (uint32_t i = 0; i < pending.timedZoneCount; i++)
+    {
+      GLuint64 begin{};
+      GLuint64 end{};
+      glGetQueryObjectui64v(queries_[firstQuery + i * 2], GL_QUERY_RESULT, &begin);
+      glGetQueryObjectui64v(queries_[firstQuery + i * 2 + 1], GL_QUERY_RESULT, &end);
+      pending.frame.zones[i].gpuBeginNs = toCpuTime(begin);
+      pending.frame.zones[i].gpuEndNs = toCpuTime(std::max(begin, end));
+    }
+
+    pending.isPending = false;
+    history_.push_back(std::move(pending.frame));
+    while (history_.size() > historyFrames_)
+    {
+      history_.pop_front();
+    }
+    return true;
+  }
+} // namespace Fwog
@@ -0,0 +1,223 @@
+#include <Fwog/HeadlessContext.h>
+#include <Fwog/Exception.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include FWOG_OPENGL_HEADER
+
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace Fwog
+{
+  namespace
+  {
+    [[noreturn]] void Fail(const std::string& what, EGLint error = eglGetError())
+    {
+      if (error == EGL_SUCCESS)
+      {
+        throw Exception(what);
+      }
+      char code[16];
+      std::snprintf(code, sizeof(code), "0x%x", error);
+      throw Exception(what + " (EGL error " + code + ")");
+    }
+
+    bool HasExtension(EGLDisplay display, const char* name)
+    {
+      const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+      if (!extensions)
+      {
+        return false;
+      }
+
+      // Match whole names, as some extension names are prefixes of others
+      const auto length = std::strlen(name);
+      for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + length, name))
+      {
+        if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    EGLDisplay GetDisplay(const HeadlessContextCreateInfo& createInfo)
+    {
+      auto getPlatformDisplay =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+      if (createInfo.deviceIndex)
+      {
+        auto queryDevices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(eglGetProcAddress("eglQueryDevicesEXT"));
+        if (!HasExtension(EGL_NO_DISPLAY, "EGL_EXT_platform_device") || !queryDevices || !getPlatformDisplay)
+        {
+          Fail("Cannot select an EGL device, since EGL_EXT_platform_device is not supported");
+        }
+
+        EGLint count = 0;
+        queryDevices(0, nullptr, &count);
+        auto devices = std::vector<EGLDeviceEXT>(count);
+        queryDevices(count, devices.data(), &count);
+        if (*createInfo.deviceIndex >= static_cast<uint32_t>(count))
+        {
+          Fail("EGL device " + std::to_string(*createInfo.deviceIndex) + " does not exist (" + std::to_string(count) +
+               " devices found)");
+        }
+        return getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices[*createInfo.deviceIndex], nullptr);
+      }
+
+      if (HasExtension(EGL_NO_DISPLAY, "EGL_MESA_platform_surfaceless") && getPlatformDisplay)
+      {
+        return getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+      }
+      return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLContext CreateContext(EGLDisplay display, EGLConfig config, EGLContext shareContext, bool debug)
+    {
+      // Fwog targets 4.6, but 4.5 implementations (e.g., llvmpipe) support everything except SPIR-V shaders
+      for (EGLint minor : {6, 5})
+      {
+        const EGLint attributes[] = {
+          EGL_CONTEXT_MAJOR_VERSION, 4,
+          EGL_CONTEXT_MINOR_VERSION, minor,
+          EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+          EGL_CONTEXT_OPENGL_DEBUG, debug ? EGL_TRUE : EGL_FALSE,
+          EGL_NONE,
+        };
+        if (auto context = eglCreateContext(display, config, shareContext, attributes))
+        {
+          return context;
+        }
+      }
+      return EGL_NO_CONTEXT;
+    }
+  } // namespace
+
+  HeadlessContext::HeadlessContext(const HeadlessContextCreateInfo& createInfo)
+  {
+    // The destructor is not called when the constructor throws, so clean up first (keeping the error that caused it)
+    auto destroyAndFail = [this](const std::string& what)
+    {
+      const auto error = eglGetError();
+      Destroy();
+      Fail(what, error);
+    };
+
+    if (const auto* share = createInfo.shareContext)
+    {
+      display_ = share->display_;
+      config_ = share->config_;
+    }
+    else
+    {
+      display_ = GetDisplay(createInfo);
+      if (display_ == EGL_NO_DISPLAY || !eglInitialize(display_, nullptr, nullptr))
+      {
+        Fail("Failed to initialize the EGL display");
+      }
+      ownsDisplay_ = true;
+
+      // Without surfaceless contexts, a pbuffer is needed to make the context current, which requires a config
+      config_ = EGL_NO_CONFIG_KHR;
+      if (!HasExtension(display_, "EGL_KHR_surfaceless_context") || !HasExtension(display_, "EGL_KHR_no_config_context"))
+      {
+        const EGLint attributes[] = {
+          EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+          EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+          EGL_RED_SIZE, 8,
+          EGL_GREEN_SIZE, 8,
+          EGL_BLUE_SIZE, 8,
+          EGL_NONE,
+        };
+        EGLint count = 0;
+        if (!eglChooseConfig(display_, attributes, &config_, 1, &count) || count == 0)
+        {
+          destroyAndFail("The EGL display has no pbuffer config");
+        }
+      }
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+      destroyAndFail("The EGL display does not support OpenGL");
+    }
+
+    context_ = CreateContext(display_,
+                             config_,
+                             createInfo.shareContext ? createInfo.shareContext->context_ : EGL_NO_CONTEXT,
+                             createInfo.debug);
+    if (context_ == EGL_NO_CONTEXT)
+    {
+      destroyAndFail("Failed to create an OpenGL 4.5+ core context");
+    }
+
+    if (config_ != EGL_NO_CONFIG_KHR)
+    {
+      const EGLint attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+      surface_ = eglCreatePbufferSurface(display_, config_, attributes);
+      if (surface_ == EGL_NO_SURFACE)
+      {
+        destroyAndFail("Failed to create a pbuffer");
+      }
+    }
+
+    if (!eglMakeCurrent(display_, surface_, surface_, context_))
+    {
+      destroyAndFail("Failed to make the headless context current");
+    }
+
+#ifdef GLAD_GL_H_
+    if (!gladLoadGL(reinterpret_cast<GLADloadfunc>(eglGetProcAddress)))
+    {
+      destroyAndFail("Failed to load OpenGL functions");
+    }
+#endif
+  }
+
+  HeadlessContext::~HeadlessContext()
+  {
+    Destroy();
+  }
+
+  void HeadlessContext::Destroy()
+  {
+    if (context_ && eglGetCurrentContext() == context_)
+    {
+      eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+    if (surface_)
+    {
+      eglDestroySurface(display_, surface_);
+      surface_ = nullptr;
+    }
+    if (context_)
+    {
+      eglDestroyContext(display_, context_);
+      context_ = nullptr;
+    }
+    if (ownsDisplay_)
+    {
+      eglTerminate(display_);
+      ownsDisplay_ = false;
+    }
+  }
+
+  void HeadlessContext::MakeCurrent()
+  {
+    if (!eglMakeCurrent(display_, surface_, surface_, context_))
+    {
+      Fail("Failed to make the headless context current");
+    }
+  }
+
+  void HeadlessContext::ReleaseCurrent()
+  {
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  }
+} // namespace Fwog
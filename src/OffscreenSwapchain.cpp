@@ -0,0 +1,135 @@
+#include <Fwog/OffscreenSwapchain.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/detail/ContextState.h>
+#include <utility>
+#include FWOG_OPENGL_HEADER
+
+namespace Fwog
+{
+  OffscreenSwapchain::OffscreenSwapchain(const OffscreenSwapchainCreateInfo& createInfo)
+    : extent_(createInfo.extent), onFrameReady_(createInfo.onFrameReady)
+  {
+    FWOG_ASSERT(detail::context != nullptr && "Fwog has not been initialized");
+    FWOG_ASSERT(detail::context->swapchainFbo == 0 && "Only one offscreen swapchain can exist per context");
+    FWOG_ASSERT(createInfo.imageCount > 0);
+    FWOG_ASSERT(!detail::context->isRendering);
+
+    const uint64_t readbackSize = uint64_t(extent_.width) * extent_.height * 4;
+
+    images_.reserve(createInfo.imageCount);
+    for (uint32_t i = 0; i < createInfo.imageCount; i++)
+    {
+      auto& image = images_.emplace_back(Image{.color = CreateTexture2D(extent_, createInfo.format, "Swapchain")});
+
+      glCreateFramebuffers(1, &image.framebuffer);
+      glNamedFramebufferTexture(image.framebuffer, GL_COLOR_ATTACHMENT0, image.color.Handle(), 0);
+
+      if (createInfo.depthStencilFormat)
+      {
+        const auto format = *createInfo.depthStencilFormat;
+        image.depthStencil = CreateTexture2D(extent_, format, "Swapchain depth-stencil");
+        const bool hasStencil = format == Format::D32_FLOAT_S8_UINT || format == Format::D24_UNORM_S8_UINT;
+        glNamedFramebufferTexture(image.framebuffer,
+                                  hasStencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                                  image.depthStencil->Handle(),
+                                  0);
+      }
+
+      detail::InvokeVerboseMessageCallback("Created framebuffer with handle ", image.framebuffer);
+
+      if (onFrameReady_)
+      {
+        image.readback.emplace(readbackSize, BufferStorageFlag::MAP_MEMORY | BufferStorageFlag::CLIENT_STORAGE);
+      }
+    }
+
+    detail::context->swapchainFbo = images_[current_].framebuffer;
+  }
+
+  OffscreenSwapchain::~OffscreenSwapchain()
+  {
+    FWOG_ASSERT(!detail::context->isRendering);
+    detail::context->swapchainFbo = 0;
+
+    for (const auto& image : images_)
+    {
+      detail::InvokeVerboseMessageCallback("Destroyed framebuffer with handle ", image.framebuffer);
+      glDeleteFramebuffers(1, &image.framebuffer);
+    }
+  }
+
+  void OffscreenSwapchain::Present()
+  {
+    FWOG_ASSERT(!detail::context->isRendering && "Cannot present while rendering");
+
+    auto& image = images_[current_];
+    image.frameIndex = frameCount_++;
+
+    if (onFrameReady_)
+    {
+      // Reading back the presented image is not part of the frame, so it is hidden from a capture in progress
+      auto capture = std::move(detail::context->capture);
+      CopyTextureToBuffer({
+        .sourceTexture = image.color,
+        .targetBuffer = *image.readback,
+        .extent = {extent_.width, extent_.height, 1},
+        .format = UploadFormat::RGBA,
+        .type = UploadType::UBYTE,
+      });
+      detail::context->capture = std::move(capture);
+      image.fence.Signal();
+    }
+
+    current_ = (current_ + 1) % static_cast<uint32_t>(images_.size());
+    detail::context->swapchainFbo = images_[current_].framebuffer;
+
+    if (onFrameReady_)
+    {
+      // The next image's readback must finish before it is rendered to again
+      if (frameCount_ - nextFrameToDeliver_ >= images_.size())
+      {
+        Deliver(true, frameCount_ - images_.size() + 1);
+      }
+      Poll();
+    }
+  }
+
+  void OffscreenSwapchain::Poll()
+  {
+    Deliver(false, frameCount_);
+  }
+
+  void OffscreenSwapchain::Flush()
+  {
+    Deliver(true, frameCount_);
+  }
+
+  void OffscreenSwapchain::Deliver(bool wait, uint64_t endFrame)
+  {
+    if (!onFrameReady_)
+    {
+      return;
+    }
+
+    for (; nextFrameToDeliver_ < endFrame; nextFrameToDeliver_++)
+    {
+      auto& image = images_[nextFrameToDeliver_ % images_.size()];
+      FWOG_ASSERT(image.frameIndex == nextFrameToDeliver_);
+
+      if (wait)
+      {
+        image.fence.Wait();
+      }
+      else if (!image.fence.IsSignaled())
+      {
+        break;
+      }
+
+      onFrameReady_({
+        .frameIndex = image.frameIndex,
+        .extent = extent_,
+        .pixels = {static_cast<const std::byte*>(image.readback->GetMappedPointer()), image.readback->Size()},
+      });
+    }
+  }
+} // namespace Fwog
@@ -10,21 +10,31 @@
 namespace Fwog
 {
   GraphicsPipeline::GraphicsPipeline(const GraphicsPipelineInfo& info)
-    : id_(detail::CompileGraphicsPipelineInternal(info))
+    : GraphicsPipeline(detail::CompileGraphicsPipelineInternal(info))
+  {
+  }
+
+  GraphicsPipeline::GraphicsPipeline(uint64_t registryHandle)
+    : registryHandle_(registryHandle),
+      id_(detail::GetGraphicsPipelineInternal(registryHandle_)->program)
   {
     detail::InvokeVerboseMessageCallback("Created graphics program with handle ", id_);
   }
 
   GraphicsPipeline::~GraphicsPipeline()
   {
-    if (id_ != 0)
+    if (registryHandle_ != 0)
     {
       detail::InvokeVerboseMessageCallback("Destroyed graphics program with handle ", id_);
-      detail::DestroyGraphicsPipelineInternal(id_);
+      detail::DestroyGraphicsPipelineInternal(registryHandle_);
     }
   }
 
-  GraphicsPipeline::GraphicsPipeline(GraphicsPipeline&& old) noexcept : id_(std::exchange(old.id_, 0)) {}
+  GraphicsPipeline::GraphicsPipeline(GraphicsPipeline&& old) noexcept
+    : registryHandle_(std::exchange(old.registryHandle_, 0)),
+      id_(std::exchange(old.id_, 0))
+  {
+  }
 
   GraphicsPipeline& GraphicsPipeline::operator=(GraphicsPipeline&& old) noexcept
   {
@@ -33,11 +43,18 @@ namespace Fwog
       return *this;
     }
 
-    id_ = std::exchange(old.id_, 0);
-    return *this;
+    this->~GraphicsPipeline();
+    return *new (this) GraphicsPipeline(std::move(old));
+  }
+
+  ComputePipeline::ComputePipeline(const ComputePipelineInfo& info)
+    : ComputePipeline(detail::CompileComputePipelineInternal(info))
+  {
   }
 
-  ComputePipeline::ComputePipeline(const ComputePipelineInfo& info) : id_(detail::CompileComputePipelineInternal(info))
+  ComputePipeline::ComputePipeline(uint64_t registryHandle)
+    : registryHandle_(registryHandle),
+      id_(detail::GetComputePipelineInternal(registryHandle_)->program)
   {
     GLint workgroupSize[3];
     glGetProgramiv(static_cast<GLuint>(id_), GL_COMPUTE_WORK_GROUP_SIZE, workgroupSize);
@@ -57,15 +74,16 @@ namespace Fwog
 
   ComputePipeline::~ComputePipeline()
   {
-    if (id_ != 0)
+    if (registryHandle_ != 0)
     {
       detail::InvokeVerboseMessageCallback("Destroyed compute program with handle ", id_);
-      detail::DestroyComputePipelineInternal(id_);
+      detail::DestroyComputePipelineInternal(registryHandle_);
     }
   }
 
   ComputePipeline::ComputePipeline(ComputePipeline&& old) noexcept
-    : id_(std::exchange(old.id_, 0)),
+    : registryHandle_(std::exchange(old.registryHandle_, 0)),
+      id_(std::exchange(old.id_, 0)),
       workgroupSize_(std::exchange(old.workgroupSize_, Extent3D{}))
   {
   }
@@ -77,7 +95,89 @@ namespace Fwog
       return *this;
     }
 
-    id_ = std::exchange(old.id_, 0);
-    return *this;
+    this->~ComputePipeline();
+    return *new (this) ComputePipeline(std::move(old));
+  }
+
+  PendingGraphicsPipeline::PendingGraphicsPipeline(const GraphicsPipelineInfo& info)
+    : pendingHandle_(detail::BeginGraphicsPipelineInternal(info))
+  {
+  }
+
+  PendingGraphicsPipeline::~PendingGraphicsPipeline()
+  {
+    if (pendingHandle_ != 0)
+    {
+      detail::AbandonGraphicsPipelineInternal(pendingHandle_);
+    }
+  }
+
+  PendingGraphicsPipeline::PendingGraphicsPipeline(PendingGraphicsPipeline&& old) noexcept
+    : pendingHandle_(std::exchange(old.pendingHandle_, 0))
+  {
+  }
+
+  PendingGraphicsPipeline& PendingGraphicsPipeline::operator=(PendingGraphicsPipeline&& old) noexcept
+  {
+    if (this == &old)
+    {
+      return *this;
+    }
+
+    this->~PendingGraphicsPipeline();
+    return *new (this) PendingGraphicsPipeline(std::move(old));
+  }
+
+  bool PendingGraphicsPipeline::IsReady() const
+  {
+    FWOG_ASSERT(pendingHandle_ != 0 && "The pipeline has already been retrieved");
+    return detail::IsGraphicsPipelineReadyInternal(pendingHandle_);
+  }
+
+  GraphicsPipeline PendingGraphicsPipeline::Get()
+  {
+    FWOG_ASSERT(pendingHandle_ != 0 && "The pipeline has already been retrieved");
+    return GraphicsPipeline(detail::FinishGraphicsPipelineInternal(std::exchange(pendingHandle_, 0)));
+  }
+
+  PendingComputePipeline::PendingComputePipeline(const ComputePipelineInfo& info)
+    : pendingHandle_(detail::BeginComputePipelineInternal(info))
+  {
+  }
+
+  PendingComputePipeline::~PendingComputePipeline()
+  {
+    if (pendingHandle_ != 0)
+    {
+      detail::AbandonComputePipelineInternal(pendingHandle_);
+    }
+  }
+
+  PendingComputePipeline::PendingComputePipeline(PendingComputePipeline&& old) noexcept
+    : pendingHandle_(std::exchange(old.pendingHandle_, 0))
+  {
+  }
+
+  PendingComputePipeline& PendingComputePipeline::operator=(PendingComputePipeline&& old) noexcept
+  {
+    if (this == &old)
+    {
+      return *this;
+    }
+
+    this->~PendingComputePipeline();
+    return *new (this) PendingComputePipeline(std::move(old));
+  }
+
+  bool PendingComputePipeline::IsReady() const
+  {
+    FWOG_ASSERT(pendingHandle_ != 0 && "The pipeline has already been retrieved");
+    return detail::IsComputePipelineReadyInternal(pendingHandle_);
+  }
+
+  ComputePipeline PendingComputePipeline::Get()
+  {
+    FWOG_ASSERT(pendingHandle_ != 0 && "The pipeline has already been retrieved");
+    return ComputePipeline(detail::FinishComputePipelineInternal(std::exchange(pendingHandle_, 0)));
   }
 } // namespace Fwog
\ No newline at end of file
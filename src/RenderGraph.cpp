@@ -0,0 +1,402 @@
+#include <Fwog/DebugMarker.h>
+#include <Fwog/RenderGraph.h>
+#include <Fwog/detail/ContextState.h>
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <queue>
+
+namespace Fwog
+{
+  // The barriers needed before a resource is accessed with the usage
+  static MemoryBarrierBits UsageToBarrierBits(RenderGraphUsage usage, bool isTexture)
+  {
+    switch (usage)
+    {
+    case RenderGraphUsage::SAMPLED: return MemoryBarrierBit::TEXTURE_FETCH_BIT;
+    case RenderGraphUsage::UNIFORM_BUFFER: return MemoryBarrierBit::UNIFORM_BUFFER_BIT;
+    case RenderGraphUsage::STORAGE:
+      return isTexture ? MemoryBarrierBit::IMAGE_ACCESS_BIT : MemoryBarrierBit::SHADER_STORAGE_BIT;
+    case RenderGraphUsage::VERTEX_BUFFER: return MemoryBarrierBit::VERTEX_BUFFER_BIT;
+    case RenderGraphUsage::INDEX_BUFFER: return MemoryBarrierBit::INDEX_BUFFER_BIT;
+    case RenderGraphUsage::INDIRECT_BUFFER: return MemoryBarrierBit::COMMAND_BUFFER_BIT;
+    case RenderGraphUsage::COLOR_ATTACHMENT:
+    case RenderGraphUsage::DEPTH_STENCIL_ATTACHMENT: return MemoryBarrierBit::FRAMEBUFFER_BIT;
+    case RenderGraphUsage::TRANSFER:
+      return isTexture ? MemoryBarrierBit::TEXTURE_UPDATE_BIT | MemoryBarrierBit::FRAMEBUFFER_BIT
+                       : MemoryBarrierBit::BUFFER_UPDATE_BIT | MemoryBarrierBit::PIXEL_BUFFER_BIT;
+    default: FWOG_UNREACHABLE; return MemoryBarrierBit::NONE;
+    }
+  }
+
+  Texture& RenderGraphResources::GetTexture(RenderGraphTexture texture) const
+  {
+    FWOG_ASSERT(texture.resource < graph_->resources_.size() && graph_->resources_[texture.resource].isTexture);
+    const auto& resource = graph_->resources_[texture.resource];
+    if (resource.importedTexture)
+    {
+      return *resource.importedTexture;
+    }
+
+    FWOG_ASSERT(resource.physicalTexture != UINT32_MAX && "The texture is not used by any pass that was executed");
+    return graph_->physicalTextures_[resource.physicalTexture].texture;
+  }
+
+  Buffer& RenderGraphResources::GetBuffer(RenderGraphBuffer buffer) const
+  {
+    FWOG_ASSERT(buffer.resource < graph_->resources_.size() && !graph_->resources_[buffer.resource].isTexture);
+    return *graph_->resources_[buffer.resource].importedBuffer;
+  }
+
+  RenderGraphTexture RenderGraphPassBuilder::Read(RenderGraphTexture texture, RenderGraphUsage usage)
+  {
+    FWOG_ASSERT(texture.resource < graph_->resources_.size() && graph_->resources_[texture.resource].isTexture);
+    graph_->AddAccess(pass_, texture.resource, texture.version, usage, false);
+    return texture;
+  }
+
+  RenderGraphTexture RenderGraphPassBuilder::Write(RenderGraphTexture texture, RenderGraphUsage usage)
+  {
+    FWOG_ASSERT(texture.resource < graph_->resources_.size() && graph_->resources_[texture.resource].isTexture);
+    return {texture.resource, graph_->AddAccess(pass_, texture.resource, texture.version, usage, true)};
+  }
+
+  RenderGraphBuffer RenderGraphPassBuilder::Read(RenderGraphBuffer buffer, RenderGraphUsage usage)
+  {
+    FWOG_ASSERT(buffer.resource < graph_->resources_.size() && !graph_->resources_[buffer.resource].isTexture);
+    graph_->AddAccess(pass_, buffer.resource, buffer.version, usage, false);
+    return buffer;
+  }
+
+  RenderGraphBuffer RenderGraphPassBuilder::Write(RenderGraphBuffer buffer, RenderGraphUsage usage)
+  {
+    FWOG_ASSERT(buffer.resource < graph_->resources_.size() && !graph_->resources_[buffer.resource].isTexture);
+    return {buffer.resource, graph_->AddAccess(pass_, buffer.resource, buffer.version, usage, true)};
+  }
+
+  void RenderGraphPassBuilder::SetSideEffects()
+  {
+    graph_->passes_[pass_].hasSideEffects = true;
+    graph_->isCompiled_ = false;
+  }
+
+  RenderGraphTexture RenderGraph::CreateTexture(const TextureCreateInfo& createInfo, std::string_view name)
+  {
+    isCompiled_ = false;
+    resources_.push_back({.name = std::string(name), .isTexture = true, .createInfo = createInfo});
+    return {static_cast<uint32_t>(resources_.size() - 1), 0};
+  }
+
+  RenderGraphTexture RenderGraph::ImportTexture(Texture& texture, std::string_view name)
+  {
+    isCompiled_ = false;
+    resources_.push_back({.name = std::string(name), .isTexture = true, .importedTexture = &texture});
+    return {static_cast<uint32_t>(resources_.size() - 1), 0};
+  }
+
+  RenderGraphBuffer RenderGraph::ImportBuffer(Buffer& buffer, std::string_view name)
+  {
+    isCompiled_ = false;
+    resources_.push_back({.name = std::string(name), .isTexture = false, .importedBuffer = &buffer});
+    return {static_cast<uint32_t>(resources_.size() - 1), 0};
+  }
+
+  RenderGraphPassBuilder RenderGraph::AddPass(std::string_view name, ExecuteFunc execute)
+  {
+    isCompiled_ = false;
+    passes_.push_back({.name = std::string(name), .execute = std::move(execute)});
+    return {*this, static_cast<uint32_t>(passes_.size() - 1)};
+  }
+
+  uint32_t RenderGraph::AddAccess(uint32_t pass, uint32_t resource, uint32_t version, RenderGraphUsage usage, bool isWrite)
+  {
+    auto& writers = resources_[resource].writers;
+    FWOG_ASSERT(version < writers.size() && "Invalid resource version");
+
+    isCompiled_ = false;
+    passes_[pass].accesses.push_back({resource, version, usage, isWrite});
+
+    if (!isWrite)
+    {
+      return version;
+    }
+
+    FWOG_ASSERT(version == writers.size() - 1 && "Only the latest version of a resource can be written");
+    writers.push_back(pass);
+    return version + 1;
+  }
+
+  uint32_t RenderGraph::GetHandle(const Access& access) const
+  {
+    const auto& resource = resources_[access.resource];
+    if (resource.importedTexture)
+    {
+      return detail::GetHandle(*resource.importedTexture);
+    }
+    if (resource.importedBuffer)
+    {
+      return resource.importedBuffer->Handle();
+    }
+    return detail::GetHandle(physicalTextures_[resource.physicalTexture].texture);
+  }
+
+  void RenderGraph::Compile()
+  {
+    const auto passCount = static_cast<uint32_t>(passes_.size());
+
+    // Passes whose results each pass consumes. Only these dependencies keep passes alive.
+    std::vector<std::vector<uint32_t>> producers(passCount);
+
+    // A pass that reads a version must also run before the pass that writes the next version
+    std::vector<std::vector<uint32_t>> successors(passCount);
+
+    for (uint32_t pass = 0; pass < passCount; pass++)
+    {
+      for (const auto& access : passes_[pass].accesses)
+      {
+        const auto& writers = resources_[access.resource].writers;
+        if (const auto producer = writers[access.version]; producer != UINT32_MAX && producer != pass)
+        {
+          producers[pass].push_back(producer);
+          successors[producer].push_back(pass);
+        }
+
+        if (!access.isWrite && access.version + 1 < writers.size() && writers[access.version + 1] != pass)
+        {
+          successors[pass].push_back(writers[access.version + 1]);
+        }
+      }
+    }
+
+    // Cull passes that neither have side effects nor contribute to a pass that does
+    auto isLive = std::vector<bool>(passCount);
+    auto stack = std::vector<uint32_t>();
+    for (uint32_t pass = 0; pass < passCount; pass++)
+    {
+      const auto& accesses = passes_[pass].accesses;
+      const bool writesImported = std::any_of(accesses.begin(),
+                                              accesses.end(),
+                                              [this](const Access& access)
+                                              {
+                                                const auto& resource = resources_[access.resource];
+                                                return access.isWrite &&
+                                                       (resource.importedTexture || resource.importedBuffer);
+                                              });
+      if (passes_[pass].hasSideEffects || writesImported)
+      {
+        isLive[pass] = true;
+        stack.push_back(pass);
+      }
+    }
+
+    while (!stack.empty())
+    {
+      const auto pass = stack.back();
+      stack.pop_back();
+      for (auto producer : producers[pass])
+      {
+        if (!isLive[producer])
+        {
+          isLive[producer] = true;
+          stack.push_back(producer);
+        }
+      }
+    }
+
+    // Topologically sort the live passes. Ready passes are taken in the order they were added, so the execution
+    // order is deterministic and matches the declaration order whenever it is valid.
+    auto predecessorCounts = std::vector<uint32_t>(passCount);
+    for (uint32_t pass = 0; pass < passCount; pass++)
+    {
+      for (auto successor : successors[pass])
+      {
+        predecessorCounts[successor] += isLive[pass] && isLive[successor];
+      }
+    }
+
+    auto ready = std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>>();
+    for (uint32_t pass = 0; pass < passCount; pass++)
+    {
+      if (isLive[pass] && predecessorCounts[pass] == 0)
+      {
+        ready.push(pass);
+      }
+    }
+
+    executionOrder_.clear();
+    while (!ready.empty())
+    {
+      const auto pass = ready.top();
+      ready.pop();
+      executionOrder_.push_back(pass);
+      for (auto successor : successors[pass])
+      {
+        if (isLive[successor] && --predecessorCounts[successor] == 0)
+        {
+          ready.push(successor);
+        }
+      }
+    }
+
+    const auto liveCount = static_cast<uint32_t>(std::count(isLive.begin(), isLive.end(), true));
+    FWOG_ASSERT(executionOrder_.size() == liveCount && "The render graph has a cycle");
+
+    // Find the lifetime of each resource in the execution order
+    for (auto& resource : resources_)
+    {
+      resource.firstUse = UINT32_MAX;
+      resource.lastUse = 0;
+      resource.physicalTexture = UINT32_MAX;
+    }
+
+    for (uint32_t i = 0; i < executionOrder_.size(); i++)
+    {
+      for (const auto& access : passes_[executionOrder_[i]].accesses)
+      {
+        auto& resource = resources_[access.resource];
+        resource.firstUse = std::min(resource.firstUse, i);
+        resource.lastUse = std::max(resource.lastUse, i);
+      }
+    }
+
+    // Assign physical textures to transient textures in the order they are first used. A physical texture can be
+    // assigned again once the lifetime of the previous transient texture it was assigned to has ended.
+    auto transients = std::vector<uint32_t>();
+    for (uint32_t i = 0; i < resources_.size(); i++)
+    {
+      const auto& resource = resources_[i];
+      if (resource.isTexture && !resource.importedTexture && resource.firstUse != UINT32_MAX)
+      {
+        transients.push_back(i);
+      }
+    }
+    std::stable_sort(transients.begin(),
+                     transients.end(),
+                     [this](uint32_t a, uint32_t b) { return resources_[a].firstUse < resources_[b].firstUse; });
+
+    for (auto& physical : physicalTextures_)
+    {
+      physical.freeAfter = UINT32_MAX;
+      physical.isUsed = false;
+    }
+
+    statistics_.physicalTexturesCreated = 0;
+    for (auto index : transients)
+    {
+      auto& resource = resources_[index];
+      auto it = std::find_if(physicalTextures_.begin(),
+                             physicalTextures_.end(),
+                             [&resource](const PhysicalTexture& physical)
+                             {
+                               return physical.createInfo == resource.createInfo &&
+                                      (physical.freeAfter == UINT32_MAX || physical.freeAfter < resource.firstUse);
+                             });
+
+      if (it == physicalTextures_.end())
+      {
+        physicalTextures_.push_back({resource.createInfo, Texture(resource.createInfo, resource.name), 0, false});
+        it = physicalTextures_.end() - 1;
+        statistics_.physicalTexturesCreated++;
+      }
+
+      it->freeAfter = resource.lastUse;
+      it->isUsed = true;
+      resource.physicalTexture = static_cast<uint32_t>(it - physicalTextures_.begin());
+    }
+
+    // Release physical textures that this graph no longer needs
+    auto remap = std::vector<uint32_t>(physicalTextures_.size());
+    uint32_t usedCount = 0;
+    for (uint32_t i = 0; i < physicalTextures_.size(); i++)
+    {
+      if (physicalTextures_[i].isUsed)
+      {
+        if (i != usedCount)
+        {
+          physicalTextures_[usedCount] = std::move(physicalTextures_[i]);
+        }
+        remap[i] = usedCount++;
+      }
+    }
+    physicalTextures_.erase(physicalTextures_.begin() + usedCount, physicalTextures_.end());
+
+    for (auto index : transients)
+    {
+      auto& resource = resources_[index];
+      resource.physicalTexture = remap[resource.physicalTexture];
+    }
+
+    statistics_.passCount = passCount;
+    statistics_.culledPassCount = passCount - liveCount;
+    statistics_.transientTextureCount = static_cast<uint32_t>(transients.size());
+    statistics_.physicalTextureCount = usedCount;
+    isCompiled_ = true;
+  }
+
+  void RenderGraph::IssueBarriers(const Pass& pass)
+  {
+    auto& barrierTracker = detail::context->barrierTracker;
+    for (const auto& access : pass.accesses)
+    {
+      const auto handle = GetHandle(access);
+      const auto isTexture = resources_[access.resource].isTexture;
+      for (auto bits = static_cast<uint32_t>(UsageToBarrierBits(access.usage, isTexture)); bits != 0; bits &= bits - 1)
+      {
+        const auto kind = static_cast<MemoryBarrierBit>(bits & (~bits + 1));
+        if (isTexture)
+        {
+          barrierTracker.RequireTexture(handle, kind);
+        }
+        else
+        {
+          barrierTracker.RequireBuffer(handle, kind);
+        }
+      }
+    }
+    barrierTracker.Flush();
+  }
+
+  void RenderGraph::Execute()
+  {
+    if (!isCompiled_)
+    {
+      Compile();
+    }
+
+    const auto resources = RenderGraphResources(*this);
+    for (auto index : executionOrder_)
+    {
+      const auto& pass = passes_[index];
+      auto marker = ScopedDebugMarker(pass.name.c_str());
+
+      // Writes are covered too: transient textures that share storage are written after the previous one was used
+      IssueBarriers(pass);
+      pass.execute(resources);
+
+      // Storage writes declared here are tracked even if the pass bound the resource as read-only
+      for (const auto& access : pass.accesses)
+      {
+        if (access.isWrite && access.usage == RenderGraphUsage::STORAGE)
+        {
+          if (resources_[access.resource].isTexture)
+          {
+            detail::context->barrierTracker.RecordTextureWrite(GetHandle(access));
+          }
+          else
+          {
+            detail::context->barrierTracker.RecordBufferWrite(GetHandle(access));
+          }
+        }
+      }
+    }
+  }
+
+  void RenderGraph::Clear()
+  {
+    resources_.clear();
+    passes_.clear();
+    executionOrder_.clear();
+    isCompiled_ = false;
+  }
+} // namespace Fwog
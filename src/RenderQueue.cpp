@@ -0,0 +1,106 @@
+#include <Fwog/RenderQueue.h>
+#include <Fwog/detail/Commands.h>
+
+#include <array>
+#include <span>
+
+namespace Fwog
+{
+  void RenderQueue::Sort()
+  {
+    const auto count = packets_.size();
+    sorted_.resize(count);
+    scratch_.resize(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      sorted_[i] = {packets_[i].sortKey, static_cast<uint32_t>(i)};
+    }
+
+    // LSD radix sort with 8-bit digits. The histograms of all digits are built in a single pass over the keys, and
+    // passes where every key has the same digit are skipped (common when only some key fields are used).
+    // The sort is stable, so packets with equal keys are submitted in the order they were enqueued.
+    constexpr size_t digitCount = sizeof(uint64_t);
+    auto histograms = std::array<std::array<uint32_t, 256>, digitCount>{};
+    for (const auto& entry : sorted_)
+    {
+      for (size_t d = 0; d < digitCount; d++)
+      {
+        histograms[d][entry.sortKey >> (d * 8) & 0xFF]++;
+      }
+    }
+
+    for (size_t d = 0; d < digitCount; d++)
+    {
+      auto& histogram = histograms[d];
+      if (count == 0 || histogram[sorted_[0].sortKey >> (d * 8) & 0xFF] == count)
+      {
+        continue;
+      }
+
+      uint32_t offset = 0;
+      for (auto& bucket : histogram)
+      {
+        const auto bucketCount = bucket;
+        bucket = offset;
+        offset += bucketCount;
+      }
+
+      for (const auto& entry : sorted_)
+      {
+        scratch_[histogram[entry.sortKey >> (d * 8) & 0xFF]++] = entry;
+      }
+
+      sorted_.swap(scratch_);
+    }
+
+    // Counts the packets whose pipeline, vertex input, or material differs from the packet before it
+    auto countChanges = [count](auto getKey, uint32_t& pipeline, uint32_t& vertexInput, uint32_t& material)
+    {
+      pipeline = vertexInput = material = 0;
+      for (size_t i = 0; i < count; i++)
+      {
+        const uint64_t changed = i == 0 ? ~uint64_t(0) : getKey(i) ^ getKey(i - 1);
+        pipeline += (changed >> PIPELINE_SHIFT & 0xFFFF) != 0;
+        vertexInput += (changed >> VERTEX_INPUT_SHIFT & 0xFFFF) != 0;
+        material += (changed >> MATERIAL_SHIFT & 0xFFFF) != 0;
+      }
+    };
+
+    statistics_.packetCount = static_cast<uint32_t>(count);
+
+    uint32_t unsortedPipeline{}, unsortedVertexInput{}, unsortedMaterial{};
+    countChanges(
+      [this](size_t i) { return packets_[i].sortKey; },
+      unsortedPipeline,
+      unsortedVertexInput,
+      unsortedMaterial);
+    countChanges(
+      [this](size_t i) { return sorted_[i].sortKey; },
+      statistics_.pipelineChanges,
+      statistics_.vertexInputChanges,
+      statistics_.materialChanges);
+
+    statistics_.pipelineChangesAvoided = int64_t(unsortedPipeline) - statistics_.pipelineChanges;
+    statistics_.vertexInputChangesAvoided = int64_t(unsortedVertexInput) - statistics_.vertexInputChanges;
+    statistics_.materialChangesAvoided = int64_t(unsortedMaterial) - statistics_.materialChanges;
+  }
+
+  void RenderQueue::Submit()
+  {
+    Sort();
+
+    const auto commands = std::span<const std::byte>(commands_.data_);
+    for (const auto& entry : sorted_)
+    {
+      const auto& packet = packets_[entry.packet];
+      detail::ExecuteCommandsInternal(commands.subspan(packet.begin, packet.end - packet.begin));
+    }
+  }
+
+  void RenderQueue::Clear() noexcept
+  {
+    commands_.Reset();
+    packets_.clear();
+  }
+} // namespace Fwog
@@ -1,13 +1,16 @@
 #include <Fwog/Buffer.h>
 #include <Fwog/Config.h>
+#include <Fwog/GpuProfiler.h>
 #include <Fwog/Pipeline.h>
 #include <Fwog/Rendering.h>
 #include <Fwog/Texture.h>
 #include <Fwog/detail/ApiToEnum.h>
+#include <Fwog/detail/Commands.h>
 #include <Fwog/detail/ContextState.h>
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cstring>
 #include <memory>
 #include <numeric>
@@ -19,12 +22,61 @@
 // helper function
 static void GLEnableOrDisable(GLenum state, GLboolean value)
 {
+  FWOG_COUNT(glStateCalls, 1);
   if (value)
     glEnable(state);
   else
     glDisable(state);
 }
 
+// The capabilities toggled by each bit of PipelineStateBlock::ENABLES, in bit order
+static constexpr GLenum gPipelineEnableBitCapabilities[] = {
+  GL_PRIMITIVE_RESTART_FIXED_INDEX,
+  GL_DEPTH_CLAMP,
+  GL_CULL_FACE,
+  GL_POLYGON_OFFSET_FILL,
+  GL_POLYGON_OFFSET_LINE,
+  GL_POLYGON_OFFSET_POINT,
+  GL_SAMPLE_SHADING,
+  GL_SAMPLE_MASK,
+  GL_SAMPLE_ALPHA_TO_COVERAGE,
+  GL_SAMPLE_ALPHA_TO_ONE,
+  GL_DEPTH_TEST,
+  GL_STENCIL_TEST,
+  GL_COLOR_LOGIC_OP,
+  GL_BLEND,
+};
+static_assert(std::size(gPipelineEnableBitCapabilities) == Fwog::detail::PipelineStateBlock::ENABLE_BIT_COUNT);
+
+// Debug groups double as profiler zones
+static void PushDebugGroup(std::string_view name)
+{
+  glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(name.size()), name.data());
+  if (Fwog::detail::context->profiler)
+  {
+    Fwog::detail::context->profiler->PushZone(name);
+  }
+}
+
+static void PopDebugGroup()
+{
+  if (Fwog::detail::context->profiler)
+  {
+    Fwog::detail::context->profiler->PopZone();
+  }
+  glPopDebugGroup();
+}
+
+// Records a command in the capture, if one is in progress
+template<class T>
+static void CaptureCommand(Fwog::detail::CommandType type, const T& payload)
+{
+  if (Fwog::detail::context->capture)
+  {
+    Fwog::detail::context->capture->RecordCommand(type, &payload, sizeof(T));
+  }
+}
+
 static size_t GetIndexSize(Fwog::IndexType indexType)
 {
   switch (indexType)
@@ -142,6 +194,7 @@ static void SetViewportInternal(const Fwog::Viewport& viewport, const Fwog::View
 {
   if (initViewport || viewport.drawRect != lastViewport.drawRect)
   {
+    FWOG_COUNT(glStateCalls, 1);
     glViewport(viewport.drawRect.offset.x,
                viewport.drawRect.offset.y,
                viewport.drawRect.extent.width,
@@ -149,14 +202,203 @@ static void SetViewportInternal(const Fwog::Viewport& viewport, const Fwog::View
   }
   if (initViewport || viewport.minDepth != lastViewport.minDepth || viewport.maxDepth != lastViewport.maxDepth)
   {
+    FWOG_COUNT(glStateCalls, 1);
     glDepthRangef(viewport.minDepth, viewport.maxDepth);
   }
   if (initViewport || viewport.depthRange != lastViewport.depthRange)
   {
+    FWOG_COUNT(glStateCalls, 1);
     glClipControl(GL_LOWER_LEFT, Fwog::detail::DepthRangeToGL(viewport.depthRange));
   }
 }
 
+static void FlushBufferRangeBindings(GLenum target, Fwog::detail::BindingSlots<Fwog::detail::BufferRangeBinding>& slots)
+{
+  using namespace Fwog::detail;
+  uint32_t first{}, last{};
+  if (slots.IsDirty() && slots.GetChangedRange(first, last))
+  {
+    for (uint32_t i = first; i <= last; i++)
+    {
+      // Unbound slots are ignored, but their size must still be positive
+      const auto& binding = slots.pending[i];
+      context->scratchNames[i - first] = binding.buffer;
+      context->scratchOffsets[i - first] = binding.offset;
+      context->scratchSizes[i - first] = binding.buffer != 0 ? binding.size : 1;
+    }
+    FWOG_COUNT(glBindCalls, 1);
+    glBindBuffersRange(target,
+                       first,
+                       last - first + 1,
+                       context->scratchNames.data(),
+                       context->scratchOffsets.data(),
+                       context->scratchSizes.data());
+  }
+  slots.MarkClean();
+}
+
+static void FlushNameBindings(void (*bindNames)(GLuint, GLsizei, const GLuint*), Fwog::detail::BindingSlots<GLuint>& slots)
+{
+  uint32_t first{}, last{};
+  if (slots.IsDirty() && slots.GetChangedRange(first, last))
+  {
+    FWOG_COUNT(glBindCalls, 1);
+    bindNames(first, last - first + 1, slots.pending.data() + first);
+  }
+  slots.MarkClean();
+}
+
+static void FlushImageBindings(Fwog::detail::BindingSlots<Fwog::detail::ImageBinding>& slots)
+{
+  using namespace Fwog::detail;
+  uint32_t first{}, last{};
+  if (slots.IsDirty() && slots.GetChangedRange(first, last))
+  {
+    // glBindImageTextures can only bind level 0 of each texture with read-write access (and the texture's own format)
+    bool canMultiBind = true;
+    for (uint32_t i = first; i <= last; i++)
+    {
+      const auto& image = slots.pending[i];
+      canMultiBind &= image.texture == 0 || (image.level == 0 && image.access == GL_READ_WRITE);
+      context->scratchNames[i - first] = image.texture;
+    }
+
+    if (canMultiBind)
+    {
+      FWOG_COUNT(glBindCalls, 1);
+      glBindImageTextures(first, last - first + 1, context->scratchNames.data());
+    }
+    else
+    {
+      for (uint32_t i = first; i <= last; i++)
+      {
+        const auto& image = slots.pending[i];
+        if (image != slots.bound[i])
+        {
+          FWOG_COUNT(glBindCalls, 1);
+          glBindImageTexture(i, image.texture, image.level, GL_TRUE, 0, image.access, image.format);
+        }
+      }
+    }
+  }
+  slots.MarkClean();
+}
+
+static void FlushVertexBufferBindings(GLuint vao, Fwog::detail::VertexArrayBindings& bindings)
+{
+  using namespace Fwog::detail;
+  auto& slots = bindings.vertexBuffers;
+  uint32_t first{}, last{};
+  if (slots.IsDirty() && slots.GetChangedRange(first, last))
+  {
+    for (uint32_t i = first; i <= last; i++)
+    {
+      context->scratchNames[i - first] = slots.pending[i].buffer;
+      context->scratchOffsets[i - first] = slots.pending[i].offset;
+      context->scratchStrides[i - first] = slots.pending[i].stride;
+    }
+
+    FWOG_COUNT(glBindCalls, 1);
+    glVertexArrayVertexBuffers(vao,
+                               first,
+                               last - first + 1,
+                               context->scratchNames.data(),
+                               context->scratchOffsets.data(),
+                               context->scratchStrides.data());
+  }
+  slots.MarkClean();
+}
+
+// Sends all binding changes made since the last draw or dispatch to GL
+static void FlushResourceBindings(bool isGraphics)
+{
+  using namespace Fwog::detail;
+  FlushBufferRangeBindings(GL_UNIFORM_BUFFER, context->uniformBuffers);
+  FlushBufferRangeBindings(GL_SHADER_STORAGE_BUFFER, context->storageBuffers);
+  FlushNameBindings(glBindTextures, context->textureUnits);
+  FlushNameBindings(glBindSamplers, context->samplerUnits);
+  FlushImageBindings(context->imageUnits);
+
+  if (isGraphics && context->currentVertexArrayBindings)
+  {
+    FlushVertexBufferBindings(context->currentVao, *context->currentVertexArrayBindings);
+  }
+}
+
+// Issues the memory barriers that the next draw or dispatch needs for the resources it reads that have pending writes.
+// commandBuffer and countBuffer are the buffers indirect commands read their arguments from (0 if there are none).
+static void FlushMemoryBarriers(bool isGraphics, GLuint commandBuffer = 0, GLuint countBuffer = 0)
+{
+  using namespace Fwog;
+  using namespace Fwog::detail;
+  auto& barrierTracker = context->barrierTracker;
+
+  // Only the bindings of barrier kinds that have pending writes need to be looked at
+  auto requireBuffers = [&barrierTracker](const auto& slots, MemoryBarrierBit kind)
+  {
+    if (barrierTracker.IsPending(kind))
+    {
+      for (uint32_t i = 0; i < slots.usedEnd; i++)
+      {
+        barrierTracker.RequireBuffer(slots.bound[i].buffer, kind);
+      }
+    }
+  };
+
+  requireBuffers(context->uniformBuffers, MemoryBarrierBit::UNIFORM_BUFFER_BIT);
+  requireBuffers(context->storageBuffers, MemoryBarrierBit::SHADER_STORAGE_BIT);
+
+  if (barrierTracker.IsPending(MemoryBarrierBit::TEXTURE_FETCH_BIT))
+  {
+    for (uint32_t i = 0; i < context->textureUnits.usedEnd; i++)
+    {
+      barrierTracker.RequireTexture(context->textureUnits.bound[i], MemoryBarrierBit::TEXTURE_FETCH_BIT);
+    }
+  }
+
+  if (barrierTracker.IsPending(MemoryBarrierBit::IMAGE_ACCESS_BIT))
+  {
+    for (uint32_t i = 0; i < context->imageUnits.usedEnd; i++)
+    {
+      barrierTracker.RequireTexture(context->imageUnits.bound[i].texture, MemoryBarrierBit::IMAGE_ACCESS_BIT);
+    }
+  }
+
+  if (isGraphics && context->currentVertexArrayBindings)
+  {
+    requireBuffers(context->currentVertexArrayBindings->vertexBuffers, MemoryBarrierBit::VERTEX_BUFFER_BIT);
+    barrierTracker.RequireBuffer(context->currentVertexArrayBindings->indexBuffer, MemoryBarrierBit::INDEX_BUFFER_BIT);
+  }
+
+  barrierTracker.RequireBuffer(commandBuffer, MemoryBarrierBit::COMMAND_BUFFER_BIT);
+  barrierTracker.RequireBuffer(countBuffer, MemoryBarrierBit::COMMAND_BUFFER_BIT);
+  barrierTracker.Flush();
+}
+
+// Records the writes that the last draw or dispatch made to storage buffers and images bound with write access
+static void RecordShaderWrites()
+{
+  using namespace Fwog::detail;
+  auto& barrierTracker = context->barrierTracker;
+
+  for (uint32_t i = 0; i < context->storageBufferWritableEnd; i++)
+  {
+    if (context->storageBufferWritable[i] && context->storageBuffers.bound[i].buffer != 0)
+    {
+      barrierTracker.RecordBufferWrite(context->storageBuffers.bound[i].buffer);
+    }
+  }
+
+  for (uint32_t i = 0; i < context->imageUnits.usedEnd; i++)
+  {
+    const auto& image = context->imageUnits.bound[i];
+    if (image.texture != 0 && image.access != GL_READ_ONLY)
+    {
+      barrierTracker.RecordTextureWrite(image.texture);
+    }
+  }
+}
+
 namespace Fwog
 {
   namespace detail
@@ -164,13 +406,20 @@ namespace Fwog
     void BeginSwapchainRendering(const SwapchainRenderInfo& renderInfo)
     {
       FWOG_ASSERT(context != nullptr && "Fwog has not been initialized");
+      FWOG_ASSERT(!context->isWorkerContext && "Cannot render on a worker context");
 
       FWOG_ASSERT(!context->isRendering && "Cannot call BeginRendering when rendering");
       FWOG_ASSERT(!context->isComputeActive && "Cannot nest compute and rendering");
+      detail::ProcessDeferredDeletions();
       context->isRendering = true;
       context->isRenderingToSwapchain = true;
       context->lastRenderInfo = nullptr;
 
+      if (context->capture)
+      {
+        context->capture->RecordBeginSwapchainRendering(renderInfo);
+      }
+
 #ifdef FWOG_DEBUG
       detail::ZeroResourceBindings();
 #endif
@@ -179,11 +428,15 @@ namespace Fwog
 
       if (!ri.name.empty())
       {
-        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(ri.name.size()), ri.name.data());
+        PushDebugGroup(ri.name);
         context->isScopedDebugGroupPushed = true;
       }
 
-      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      FWOG_COUNT(glBindCalls, 1);
+      glBindFramebuffer(GL_FRAMEBUFFER, context->swapchainFbo);
+
+      // Attachments of the default framebuffer and of framebuffer objects are named differently
+      const bool isDefaultFramebuffer = context->swapchainFbo == 0;
 
       switch (ri.colorLoadOp)
       {
@@ -193,16 +446,19 @@ namespace Fwog
         FWOG_ASSERT((std::holds_alternative<std::array<float, 4>>(ri.clearColorValue.data)));
         if (context->lastColorMask[0] != ColorComponentFlag::RGBA_BITS)
         {
+          FWOG_COUNT(glStateCalls, 1);
           glColorMaski(0, true, true, true, true);
           context->lastColorMask[0] = ColorComponentFlag::RGBA_BITS;
         }
-        glClearNamedFramebufferfv(0, GL_COLOR, 0, std::get_if<std::array<float, 4>>(&ri.clearColorValue.data)->data());
+        FWOG_COUNT(glClearCalls, 1);
+        glClearNamedFramebufferfv(context->swapchainFbo, GL_COLOR, 0, std::get_if<std::array<float, 4>>(&ri.clearColorValue.data)->data());
         break;
       }
       case AttachmentLoadOp::DONT_CARE:
       {
-        GLenum attachment = GL_COLOR;
-        glInvalidateNamedFramebufferData(0, 1, &attachment);
+        GLenum attachment = isDefaultFramebuffer ? GL_COLOR : GL_COLOR_ATTACHMENT0;
+        FWOG_COUNT(glClearCalls, 1);
+        glInvalidateNamedFramebufferData(context->swapchainFbo, 1, &attachment);
         break;
       }
       default: FWOG_UNREACHABLE;
@@ -215,16 +471,19 @@ namespace Fwog
       {
         if (context->lastDepthMask == false)
         {
+          FWOG_COUNT(glStateCalls, 1);
           glDepthMask(true);
           context->lastDepthMask = true;
         }
-        glClearNamedFramebufferfv(0, GL_DEPTH, 0, &ri.clearDepthValue);
+        FWOG_COUNT(glClearCalls, 1);
+        glClearNamedFramebufferfv(context->swapchainFbo, GL_DEPTH, 0, &ri.clearDepthValue);
         break;
       }
       case AttachmentLoadOp::DONT_CARE:
       {
-        GLenum attachment = GL_DEPTH;
-        glInvalidateNamedFramebufferData(0, 1, &attachment);
+        GLenum attachment = isDefaultFramebuffer ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+        FWOG_COUNT(glClearCalls, 1);
+        glInvalidateNamedFramebufferData(context->swapchainFbo, 1, &attachment);
         break;
       }
       default: FWOG_UNREACHABLE;
@@ -237,17 +496,20 @@ namespace Fwog
       {
         if (context->lastStencilMask[0] == false || context->lastStencilMask[1] == false)
         {
+          FWOG_COUNT(glStateCalls, 1);
           glStencilMask(true);
           context->lastStencilMask[0] = true;
           context->lastStencilMask[1] = true;
         }
-        glClearNamedFramebufferiv(0, GL_STENCIL, 0, &ri.clearStencilValue);
+        FWOG_COUNT(glClearCalls, 1);
+        glClearNamedFramebufferiv(context->swapchainFbo, GL_STENCIL, 0, &ri.clearStencilValue);
         break;
       }
       case AttachmentLoadOp::DONT_CARE:
       {
-        GLenum attachment = GL_STENCIL;
-        glInvalidateNamedFramebufferData(0, 1, &attachment);
+        GLenum attachment = isDefaultFramebuffer ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+        FWOG_COUNT(glClearCalls, 1);
+        glInvalidateNamedFramebufferData(context->swapchainFbo, 1, &attachment);
         break;
       }
       default: FWOG_UNREACHABLE;
@@ -256,6 +518,7 @@ namespace Fwog
       // Framebuffer sRGB can only be disabled in this exact function
       if (!renderInfo.enableSrgb)
       {
+        FWOG_COUNT(glStateCalls, 1);
         glDisable(GL_FRAMEBUFFER_SRGB);
         context->srgbWasDisabled = true;
       }
@@ -269,10 +532,17 @@ namespace Fwog
     void BeginRendering(const RenderInfo& renderInfo)
     {
       FWOG_ASSERT(context != nullptr && "Fwog has not been initialized");
+      FWOG_ASSERT(!context->isWorkerContext && "Cannot render on a worker context");
       FWOG_ASSERT(!context->isRendering && "Cannot call BeginRendering when rendering");
       FWOG_ASSERT(!context->isComputeActive && "Cannot nest compute and rendering");
+      detail::ProcessDeferredDeletions();
       context->isRendering = true;
 
+      if (context->capture)
+      {
+        context->capture->RecordBeginRendering(renderInfo);
+      }
+
 #ifdef FWOG_DEBUG
       detail::ZeroResourceBindings();
 #endif
@@ -288,13 +558,29 @@ namespace Fwog
 
       if (!ri.name.empty())
       {
-        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(ri.name.size()), ri.name.data());
+        PushDebugGroup(ri.name);
         context->isScopedDebugGroupPushed = true;
       }
 
       context->currentFbo = context->fboCache.CreateOrGetCachedFramebuffer(ri);
+      FWOG_COUNT(glBindCalls, 1);
       glBindFramebuffer(GL_FRAMEBUFFER, context->currentFbo);
 
+      // Attachments may have been written by shaders, and they are accessed by the clears below
+      for (const auto& attachment : ri.colorAttachments)
+      {
+        context->barrierTracker.RequireTexture(GetHandle(attachment.texture.get()), MemoryBarrierBit::FRAMEBUFFER_BIT);
+      }
+      for (const auto* attachment : {&ri.depthAttachment, &ri.stencilAttachment})
+      {
+        if (*attachment)
+        {
+          context->barrierTracker.RequireTexture(GetHandle((*attachment)->texture.get()),
+                                                 MemoryBarrierBit::FRAMEBUFFER_BIT);
+        }
+      }
+      context->barrierTracker.Flush();
+
       for (GLint i = 0; i < static_cast<GLint>(ri.colorAttachments.size()); i++)
       {
         const auto& attachment = ri.colorAttachments[i];
@@ -305,6 +591,7 @@ namespace Fwog
         {
           if (context->lastColorMask[i] != ColorComponentFlag::RGBA_BITS)
           {
+            FWOG_COUNT(glStateCalls, 1);
             glColorMaski(i, true, true, true, true);
             context->lastColorMask[i] = ColorComponentFlag::RGBA_BITS;
           }
@@ -318,10 +605,12 @@ namespace Fwog
           {
           case detail::GlBaseTypeClass::FLOAT:
             FWOG_ASSERT((std::holds_alternative<std::array<float, 4>>(ccv.data)));
+            FWOG_COUNT(glClearCalls, 1);
             glClearNamedFramebufferfv(context->currentFbo, GL_COLOR, i, std::get_if<std::array<float, 4>>(&ccv.data)->data());
             break;
           case detail::GlBaseTypeClass::SINT:
             FWOG_ASSERT((std::holds_alternative<std::array<int32_t, 4>>(ccv.data)));
+            FWOG_COUNT(glClearCalls, 1);
             glClearNamedFramebufferiv(context->currentFbo,
                                       GL_COLOR,
                                       i,
@@ -329,6 +618,7 @@ namespace Fwog
             break;
           case detail::GlBaseTypeClass::UINT:
             FWOG_ASSERT((std::holds_alternative<std::array<uint32_t, 4>>(ccv.data)));
+            FWOG_COUNT(glClearCalls, 1);
             glClearNamedFramebufferuiv(context->currentFbo,
                                        GL_COLOR,
                                        i,
@@ -341,6 +631,7 @@ namespace Fwog
         case AttachmentLoadOp::DONT_CARE:
         {
           GLenum colorAttachment = GL_COLOR_ATTACHMENT0 + i;
+          FWOG_COUNT(glClearCalls, 1);
           glInvalidateNamedFramebufferData(context->currentFbo, 1, &colorAttachment);
           break;
         }
@@ -358,16 +649,19 @@ namespace Fwog
           // clear just depth
           if (context->lastDepthMask == false)
           {
+            FWOG_COUNT(glStateCalls, 1);
             glDepthMask(true);
             context->lastDepthMask = true;
           }
 
+          FWOG_COUNT(glClearCalls, 1);
           glClearNamedFramebufferfv(context->currentFbo, GL_DEPTH, 0, &ri.depthAttachment->clearValue.depth);
           break;
         }
         case AttachmentLoadOp::DONT_CARE:
         {
           GLenum attachment = GL_DEPTH_ATTACHMENT;
+          FWOG_COUNT(glClearCalls, 1);
           glInvalidateNamedFramebufferData(context->currentFbo, 1, &attachment);
           break;
         }
@@ -385,17 +679,20 @@ namespace Fwog
           // clear just stencil
           if (context->lastStencilMask[0] == false || context->lastStencilMask[1] == false)
           {
+            FWOG_COUNT(glStateCalls, 1);
             glStencilMask(true);
             context->lastStencilMask[0] = true;
             context->lastStencilMask[1] = true;
           }
 
+          FWOG_COUNT(glClearCalls, 1);
           glClearNamedFramebufferiv(context->currentFbo, GL_STENCIL, 0, &ri.stencilAttachment->clearValue.stencil);
           break;
         }
         case AttachmentLoadOp::DONT_CARE:
         {
           GLenum attachment = GL_STENCIL_ATTACHMENT;
+          FWOG_COUNT(glClearCalls, 1);
           glInvalidateNamedFramebufferData(context->currentFbo, 1, &attachment);
           break;
         }
@@ -451,43 +748,58 @@ namespace Fwog
       context->isIndexBufferBound = false;
       context->isRenderingToSwapchain = false;
 
-      if (context->isScopedDebugGroupPushed)
+      if (context->capture)
       {
-        context->isScopedDebugGroupPushed = false;
-        glPopDebugGroup();
+        context->capture->RecordEndRendering();
       }
 
+      // The pipeline group is nested in the scope group
       if (context->isPipelineDebugGroupPushed)
       {
         context->isPipelineDebugGroupPushed = false;
-        glPopDebugGroup();
+        PopDebugGroup();
+      }
+
+      if (context->isScopedDebugGroupPushed)
+      {
+        context->isScopedDebugGroupPushed = false;
+        PopDebugGroup();
       }
 
       if (context->scissorEnabled)
       {
+        FWOG_COUNT(glStateCalls, 1);
         glDisable(GL_SCISSOR_TEST);
         context->scissorEnabled = false;
       }
 
       if (context->srgbWasDisabled)
       {
+        FWOG_COUNT(glStateCalls, 1);
         glEnable(GL_FRAMEBUFFER_SRGB);
       }
     }
 
     void BeginCompute(std::string_view name)
     {
+      FWOG_ASSERT(!context->isWorkerContext && "Cannot dispatch on a worker context");
       FWOG_ASSERT(!context->isComputeActive);
       FWOG_ASSERT(!context->isRendering && "Cannot nest compute and rendering");
+      detail::ProcessDeferredDeletions();
       context->isComputeActive = true;
 
+      if (context->capture)
+      {
+        context->capture->RecordBeginCompute(name);
+      }
+
 #ifdef FWOG_DEBUG
       detail::ZeroResourceBindings();
 #endif
 
       if (!name.empty())
       {
-        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(name.size()), name.data());
+        PushDebugGroup(name);
         context->isScopedDebugGroupPushed = true;
       }
     }
@@ -497,16 +809,22 @@ namespace Fwog
       FWOG_ASSERT(context->isComputeActive);
       context->isComputeActive = false;
 
-      if (context->isScopedDebugGroupPushed)
+      if (context->capture)
       {
-        context->isScopedDebugGroupPushed = false;
-        glPopDebugGroup();
+        context->capture->RecordEndCompute();
       }
 
+      // The pipeline group is nested in the scope group
       if (context->isPipelineDebugGroupPushed)
       {
         context->isPipelineDebugGroupPushed = false;
-        glPopDebugGroup();
+        PopDebugGroup();
+      }
+
+      if (context->isScopedDebugGroupPushed)
+      {
+        context->isScopedDebugGroupPushed = false;
+        PopDebugGroup();
       }
     }
   } // namespace detail
@@ -522,8 +840,26 @@ namespace Fwog
                    Filter filter,
                    AspectMask aspect)
   {
+    if (context->capture)
+    {
+      context->capture->RecordBlitTexture(source,
+                                          &target,
+                                          sourceOffset,
+                                          targetOffset,
+                                          sourceExtent,
+                                          targetExtent,
+                                          filter,
+                                          aspect);
+    }
+
     auto fboSource = MakeSingleTextureFbo(source, context->fboCache);
     auto fboTarget = MakeSingleTextureFbo(target, context->fboCache);
+
+    context->barrierTracker.RequireTexture(detail::GetHandle(source), MemoryBarrierBit::FRAMEBUFFER_BIT);
+    context->barrierTracker.RequireTexture(detail::GetHandle(target), MemoryBarrierBit::FRAMEBUFFER_BIT);
+    context->barrierTracker.Flush();
+
+    FWOG_COUNT(glTransferCalls, 1);
     glBlitNamedFramebuffer(fboSource,
                            fboTarget,
                            sourceOffset.x,
@@ -546,10 +882,26 @@ namespace Fwog
                               Filter filter,
                               AspectMask aspect)
   {
+    if (context->capture)
+    {
+      context->capture->RecordBlitTexture(source,
+                                          nullptr,
+                                          sourceOffset,
+                                          targetOffset,
+                                          sourceExtent,
+                                          targetExtent,
+                                          filter,
+                                          aspect);
+    }
+
     auto fbo = MakeSingleTextureFbo(source, context->fboCache);
 
+    context->barrierTracker.RequireTexture(detail::GetHandle(source), MemoryBarrierBit::FRAMEBUFFER_BIT);
+    context->barrierTracker.Flush();
+
+    FWOG_COUNT(glTransferCalls, 1);
     glBlitNamedFramebuffer(fbo,
-                           0,
+                           context->swapchainFbo,
                            sourceOffset.x,
                            sourceOffset.y,
                            sourceExtent.width,
@@ -564,6 +916,16 @@ namespace Fwog
 
   void CopyTexture(const CopyTextureInfo& copy)
   {
+    if (context->capture)
+    {
+      context->capture->RecordUnrecordedCall("CopyTexture");
+    }
+
+    context->barrierTracker.RequireTexture(detail::GetHandle(copy.source), MemoryBarrierBit::TEXTURE_UPDATE_BIT);
+    context->barrierTracker.RequireTexture(copy.target.Handle(), MemoryBarrierBit::TEXTURE_UPDATE_BIT);
+    context->barrierTracker.Flush();
+
+    FWOG_COUNT(glTransferCalls, 1);
     glCopyImageSubData(detail::GetHandle(copy.source),
                        GL_TEXTURE,
                        copy.sourceLevel,
@@ -583,22 +945,45 @@ namespace Fwog
 
   void MemoryBarrier(MemoryBarrierBits accessBits)
   {
+    if (context->capture)
+    {
+      context->capture->RecordMemoryBarrier(accessBits);
+    }
+
+    FWOG_COUNT(glBarrierCalls, 1);
     glMemoryBarrier(detail::BarrierBitsToGL(accessBits));
+    context->barrierTracker.OnMemoryBarrier(accessBits);
   }
 
   void TextureBarrier()
   {
+    if (context->capture)
+    {
+      context->capture->RecordTextureBarrier();
+    }
+
+    FWOG_COUNT(glBarrierCalls, 1);
     glTextureBarrier();
   }
 
   void CopyBuffer(const CopyBufferInfo& copy)
   {
+    if (context->capture)
+    {
+      context->capture->RecordCopyBuffer(copy);
+    }
+
     auto size = copy.size;
     if (size == WHOLE_BUFFER)
     {
       size = copy.source.Size() - copy.sourceOffset;
     }
 
+    context->barrierTracker.RequireBuffer(copy.source.Handle(), MemoryBarrierBit::BUFFER_UPDATE_BIT);
+    context->barrierTracker.RequireBuffer(copy.target.Handle(), MemoryBarrierBit::BUFFER_UPDATE_BIT);
+    context->barrierTracker.Flush();
+
+    FWOG_COUNT(glTransferCalls, 1);
     glCopyNamedBufferSubData(copy.source.Handle(),
                              copy.target.Handle(),
                              static_cast<GLintptr>(copy.sourceOffset),
@@ -608,9 +993,20 @@ namespace Fwog
 
   void CopyTextureToBuffer(const CopyTextureToBufferInfo& copy)
   {
+    if (context->capture)
+    {
+      context->capture->RecordUnrecordedCall("CopyTextureToBuffer");
+    }
+
+    context->barrierTracker.RequireTexture(detail::GetHandle(copy.sourceTexture), MemoryBarrierBit::TEXTURE_UPDATE_BIT);
+    context->barrierTracker.RequireBuffer(copy.targetBuffer.Handle(), MemoryBarrierBit::PIXEL_BUFFER_BIT);
+    context->barrierTracker.Flush();
+
+    FWOG_COUNT(glStateCalls, 2);
     glPixelStorei(GL_PACK_ROW_LENGTH, copy.bufferRowLength);
     glPixelStorei(GL_PACK_IMAGE_HEIGHT, copy.bufferImageHeight);
 
+    FWOG_COUNT(glBindCalls, 1);
     glBindBuffer(GL_PIXEL_PACK_BUFFER, copy.targetBuffer.Handle());
 
     GLenum format{};
@@ -633,6 +1029,7 @@ namespace Fwog
       type = detail::UploadTypeToGL(copy.type);
     }
 
+    FWOG_COUNT(glTransferCalls, 1);
     glGetTextureSubImage(const_cast<Texture&>(copy.sourceTexture).Handle(),
                          copy.level,
                          copy.sourceOffset.x,
@@ -649,11 +1046,31 @@ namespace Fwog
 
   void CopyBufferToTexture(const CopyBufferToTextureInfo& copy)
   {
+    if (context->capture)
+    {
+      context->capture->RecordUnrecordedCall("CopyBufferToTexture");
+    }
+
+    context->barrierTracker.RequireBuffer(copy.sourceBuffer.Handle(), MemoryBarrierBit::PIXEL_BUFFER_BIT);
+    context->barrierTracker.RequireTexture(copy.targetTexture.Handle(), MemoryBarrierBit::TEXTURE_UPDATE_BIT);
+    context->barrierTracker.Flush();
+
+    FWOG_COUNT(glStateCalls, 2);
     glPixelStorei(GL_UNPACK_ROW_LENGTH, copy.bufferRowLength);
     glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, copy.bufferImageHeight);
 
+    FWOG_COUNT(glBindCalls, 1);
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, copy.sourceBuffer.Handle());
 
+    if (detail::IsBlockCompressedFormat(copy.targetTexture.GetCreateInfo().format))
+    {
+      copy.targetTexture.subCompressedImageInternal({copy.level,
+                                                     copy.targetOffset,
+                                                     copy.extent,
+                                                     reinterpret_cast<void*>(static_cast<uintptr_t>(copy.sourceOffset))});
+      return;
+    }
+
     copy.targetTexture.subImageInternal({copy.level,
                                          copy.targetOffset,
                                          copy.extent,
@@ -664,245 +1081,190 @@ namespace Fwog
                                          copy.bufferImageHeight});
   }
 
-  namespace Cmd
+  namespace detail
   {
-    void BindGraphicsPipeline(const GraphicsPipeline& pipeline)
+    void BindGraphicsPipelineInternal(uint64_t pipeline)
     {
       FWOG_ASSERT(context->isRendering);
-      FWOG_ASSERT(pipeline.Handle() != 0);
+      FWOG_ASSERT(pipeline != 0);
+      CaptureCommand(CommandType::BIND_GRAPHICS_PIPELINE, BindGraphicsPipelineCommand{pipeline});
 
-      auto pipelineState = detail::GetGraphicsPipelineInternal(pipeline.Handle());
+      const auto* pipelineState = detail::GetGraphicsPipelineInternal(pipeline);
       FWOG_ASSERT(pipelineState);
+      FWOG_ASSERT(!(pipeline == context->lastGraphicsPipeline && context->isLastGraphicsPipelineDestroyed) &&
+                  "The pipeline has been destroyed");
 
       //////////////////////////////////////////////////////////////// shader program
-      if (context->lastGraphicsPipeline != pipelineState || context->lastPipelineWasCompute)
+      if (context->lastGraphicsPipeline != pipeline || context->lastPipelineWasCompute)
       {
-        glUseProgram(static_cast<GLuint>(pipeline.Handle()));
+        FWOG_COUNT(glBindCalls, 1);
+        glUseProgram(pipelineState->program);
       }
 
       context->lastPipelineWasCompute = false;
 
       // Early-out if this was the last pipeline bound
-      if (context->lastGraphicsPipeline == pipelineState)
+      if (context->lastGraphicsPipeline == pipeline)
       {
+        FWOG_COUNT(pipelineBindsElided, 1);
         return;
       }
 
+      FWOG_COUNT(pipelineBinds, 1);
+
+      // Null if no graphics pipeline has been bound since the pipeline state was invalidated
+      const auto* lastPipelineState = detail::GetGraphicsPipelineInternal(context->lastGraphicsPipeline);
+
       if (context->isPipelineDebugGroupPushed)
       {
         context->isPipelineDebugGroupPushed = false;
-        glPopDebugGroup();
+        PopDebugGroup();
       }
 
       if (!pipelineState->name.empty())
       {
-        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION,
-                         0,
-                         static_cast<GLsizei>(pipelineState->name.size()),
-                         pipelineState->name.data());
+        PushDebugGroup(pipelineState->name);
         context->isPipelineDebugGroupPushed = true;
       }
 
       // Always enable this.
       // The user can create a context with a non-sRGB framebuffer or create a non-sRGB view of an sRGB texture.
-      if (!context->lastGraphicsPipeline)
+      if (!lastPipelineState)
       {
+        FWOG_COUNT(glStateCalls, 1);
         glEnable(GL_FRAMEBUFFER_SRGB);
       }
 
       //////////////////////////////////////////////////////////////// input assembly
-      const auto& ias = pipelineState->inputAssemblyState;
-      if (!context->lastGraphicsPipeline ||
-          ias.primitiveRestartEnable != context->lastGraphicsPipeline->inputAssemblyState.primitiveRestartEnable)
-      {
-        GLEnableOrDisable(GL_PRIMITIVE_RESTART_FIXED_INDEX, ias.primitiveRestartEnable);
-      }
-      context->currentTopology = ias.topology;
+      context->currentTopology = pipelineState->inputAssemblyState.topology;
 
       //////////////////////////////////////////////////////////////// vertex input
-      if (auto nextVao = context->vaoCache.CreateOrGetCachedVertexArray(pipelineState->vertexInputState);
-          nextVao != context->currentVao)
+      // The VAO was resolved when the pipeline was compiled. Vertex buffer bindings are VAO state, so each cached VAO
+      // keeps its own shadow. Unflushed bindings of the previous VAO stay pending until it is drawn with again.
+      if (auto* nextVao = pipelineState->vertexArray; nextVao->id != context->currentVao)
       {
-        context->currentVao = nextVao;
+        context->currentVao = nextVao->id;
+        context->currentVertexArrayBindings = &nextVao->bindings;
+        FWOG_COUNT(glBindCalls, 1);
         glBindVertexArray(context->currentVao);
       }
 
-      //////////////////////////////////////////////////////////////// tessellation
-      const auto& ts = pipelineState->tessellationState;
-      if (ts.patchControlPoints > 0)
+      //////////////////////////////////////////////////////////////// fixed-function state
+      // Compare the packed state of the two pipelines, then only emit the GL calls whose arguments changed.
+      // Everything is dirty if no graphics pipeline has been bound since the pipeline state was invalidated.
+      using Block = detail::PipelineStateBlock;
+      const auto& words = pipelineState->stateBlock.words;
+      const auto* lastBlock = lastPipelineState ? &lastPipelineState->stateBlock : nullptr;
+      const uint32_t dirty = lastBlock ? detail::DiffPipelineStateBlocks(pipelineState->stateBlock, *lastBlock) : ~0u;
+      auto isDirty = [dirty](uint32_t wordMask) { return (dirty & wordMask) != 0; };
+
+      if (isDirty(1u << Block::ENABLES))
       {
-        if (!context->lastGraphicsPipeline ||
-            ts.patchControlPoints != context->lastGraphicsPipeline->tessellationState.patchControlPoints)
+        constexpr uint32_t allEnableBits = (1u << Block::ENABLE_BIT_COUNT) - 1;
+        const uint32_t enables = words[Block::ENABLES];
+        const uint32_t changed = lastBlock ? enables ^ lastBlock->words[Block::ENABLES] : allEnableBits;
+        for (uint32_t bits = changed; bits != 0; bits &= bits - 1)
         {
-          glPatchParameteri(GL_PATCH_VERTICES, static_cast<GLint>(pipelineState->tessellationState.patchControlPoints));
+          const auto bit = std::countr_zero(bits);
+          GLEnableOrDisable(gPipelineEnableBitCapabilities[bit], (enables >> bit) & 1);
         }
       }
 
-      //////////////////////////////////////////////////////////////// rasterization
-      const auto& rs = pipelineState->rasterizationState;
-      if (!context->lastGraphicsPipeline ||
-          rs.depthClampEnable != context->lastGraphicsPipeline->rasterizationState.depthClampEnable)
+      const auto& ts = pipelineState->tessellationState;
+      if (isDirty(1u << Block::PATCH_CONTROL_POINTS) && ts.patchControlPoints > 0)
       {
-        GLEnableOrDisable(GL_DEPTH_CLAMP, rs.depthClampEnable);
+        FWOG_COUNT(glStateCalls, 1);
+        glPatchParameteri(GL_PATCH_VERTICES, static_cast<GLint>(ts.patchControlPoints));
       }
 
-      if (!context->lastGraphicsPipeline || rs.polygonMode != context->lastGraphicsPipeline->rasterizationState.polygonMode)
+      const auto& rs = pipelineState->rasterizationState;
+      if (isDirty(1u << Block::POLYGON_MODE))
       {
+        FWOG_COUNT(glStateCalls, 1);
         glPolygonMode(GL_FRONT_AND_BACK, detail::PolygonModeToGL(rs.polygonMode));
       }
 
-      if (!context->lastGraphicsPipeline || rs.cullMode != context->lastGraphicsPipeline->rasterizationState.cullMode)
+      if (isDirty(1u << Block::CULL_FACE) && rs.cullMode != CullMode::NONE)
       {
-        GLEnableOrDisable(GL_CULL_FACE, rs.cullMode != CullMode::NONE);
-        if (rs.cullMode != CullMode::NONE)
-        {
-          glCullFace(detail::CullModeToGL(rs.cullMode));
-        }
+        FWOG_COUNT(glStateCalls, 1);
+        glCullFace(detail::CullModeToGL(rs.cullMode));
       }
 
-      if (!context->lastGraphicsPipeline || rs.frontFace != context->lastGraphicsPipeline->rasterizationState.frontFace)
+      if (isDirty(1u << Block::FRONT_FACE))
       {
+        FWOG_COUNT(glStateCalls, 1);
         glFrontFace(detail::FrontFaceToGL(rs.frontFace));
       }
 
-      if (!context->lastGraphicsPipeline ||
-          rs.depthBiasEnable != context->lastGraphicsPipeline->rasterizationState.depthBiasEnable)
-      {
-        GLEnableOrDisable(GL_POLYGON_OFFSET_FILL, rs.depthBiasEnable);
-        GLEnableOrDisable(GL_POLYGON_OFFSET_LINE, rs.depthBiasEnable);
-        GLEnableOrDisable(GL_POLYGON_OFFSET_POINT, rs.depthBiasEnable);
-      }
-
-      if (!context->lastGraphicsPipeline ||
-          rs.depthBiasSlopeFactor != context->lastGraphicsPipeline->rasterizationState.depthBiasSlopeFactor ||
-          rs.depthBiasConstantFactor != context->lastGraphicsPipeline->rasterizationState.depthBiasConstantFactor)
+      if (isDirty(Block::DEPTH_BIAS_WORDS))
       {
+        FWOG_COUNT(glStateCalls, 1);
         glPolygonOffset(rs.depthBiasSlopeFactor, rs.depthBiasConstantFactor);
       }
 
-      if (!context->lastGraphicsPipeline || rs.lineWidth != context->lastGraphicsPipeline->rasterizationState.lineWidth)
+      if (isDirty(1u << Block::LINE_WIDTH))
       {
+        FWOG_COUNT(glStateCalls, 1);
         glLineWidth(rs.lineWidth);
       }
 
-      if (!context->lastGraphicsPipeline || rs.pointSize != context->lastGraphicsPipeline->rasterizationState.pointSize)
+      if (isDirty(1u << Block::POINT_SIZE))
       {
+        FWOG_COUNT(glStateCalls, 1);
         glPointSize(rs.pointSize);
       }
 
-      //////////////////////////////////////////////////////////////// multisample
       const auto& ms = pipelineState->multisampleState;
-      if (!context->lastGraphicsPipeline ||
-          ms.sampleShadingEnable != context->lastGraphicsPipeline->multisampleState.sampleShadingEnable)
-      {
-        GLEnableOrDisable(GL_SAMPLE_SHADING, ms.sampleShadingEnable);
-      }
-
-      if (!context->lastGraphicsPipeline ||
-          ms.minSampleShading != context->lastGraphicsPipeline->multisampleState.minSampleShading)
+      if (isDirty(1u << Block::MIN_SAMPLE_SHADING))
       {
+        FWOG_COUNT(glStateCalls, 1);
         glMinSampleShading(ms.minSampleShading);
       }
 
-      if (!context->lastGraphicsPipeline || ms.sampleMask != context->lastGraphicsPipeline->multisampleState.sampleMask)
+      if (isDirty(1u << Block::SAMPLE_MASK))
       {
-        GLEnableOrDisable(GL_SAMPLE_MASK, ms.sampleMask != 0xFFFFFFFF);
+        FWOG_COUNT(glStateCalls, 1);
         glSampleMaski(0, ms.sampleMask);
       }
 
-      if (!context->lastGraphicsPipeline ||
-          ms.alphaToCoverageEnable != context->lastGraphicsPipeline->multisampleState.alphaToCoverageEnable)
-      {
-        GLEnableOrDisable(GL_SAMPLE_ALPHA_TO_COVERAGE, ms.alphaToCoverageEnable);
-      }
-
-      if (!context->lastGraphicsPipeline ||
-          ms.alphaToOneEnable != context->lastGraphicsPipeline->multisampleState.alphaToOneEnable)
-      {
-        GLEnableOrDisable(GL_SAMPLE_ALPHA_TO_ONE, ms.alphaToOneEnable);
-      }
-
-      //////////////////////////////////////////////////////////////// depth + stencil
       const auto& ds = pipelineState->depthState;
-      if (!context->lastGraphicsPipeline || ds.depthTestEnable != context->lastGraphicsPipeline->depthState.depthTestEnable)
-      {
-        GLEnableOrDisable(GL_DEPTH_TEST, ds.depthTestEnable);
-      }
-
-      if (ds.depthTestEnable)
+      if (isDirty(1u << Block::DEPTH_FUNC))
       {
-        if (!context->lastGraphicsPipeline ||
-            ds.depthWriteEnable != context->lastGraphicsPipeline->depthState.depthWriteEnable)
-        {
-          if (ds.depthWriteEnable != context->lastDepthMask)
-          {
-            glDepthMask(ds.depthWriteEnable);
-            context->lastDepthMask = ds.depthWriteEnable;
-          }
-        }
-
-        if (!context->lastGraphicsPipeline || ds.depthCompareOp != context->lastGraphicsPipeline->depthState.depthCompareOp)
-        {
-          glDepthFunc(detail::CompareOpToGL(ds.depthCompareOp));
-        }
+        FWOG_COUNT(glStateCalls, 1);
+        glDepthFunc(detail::CompareOpToGL(ds.depthCompareOp));
       }
 
       const auto& ss = pipelineState->stencilState;
-      if (!context->lastGraphicsPipeline ||
-          ss.stencilTestEnable != context->lastGraphicsPipeline->stencilState.stencilTestEnable)
+      if (isDirty(Block::STENCIL_FRONT_WORDS))
       {
-        GLEnableOrDisable(GL_STENCIL_TEST, ss.stencilTestEnable);
+        FWOG_COUNT(glStateCalls, 2);
+        glStencilOpSeparate(GL_FRONT,
+                            detail::StencilOpToGL(ss.front.failOp),
+                            detail::StencilOpToGL(ss.front.depthFailOp),
+                            detail::StencilOpToGL(ss.front.passOp));
+        glStencilFuncSeparate(GL_FRONT, detail::CompareOpToGL(ss.front.compareOp), ss.front.reference, ss.front.compareMask);
       }
 
-      if (ss.stencilTestEnable)
+      if (isDirty(Block::STENCIL_BACK_WORDS))
       {
-        if (!context->lastGraphicsPipeline || !context->lastGraphicsPipeline->stencilState.stencilTestEnable ||
-            ss.front != context->lastGraphicsPipeline->stencilState.front)
-        {
-          glStencilOpSeparate(GL_FRONT,
-                              detail::StencilOpToGL(ss.front.failOp),
-                              detail::StencilOpToGL(ss.front.depthFailOp),
-                              detail::StencilOpToGL(ss.front.passOp));
-          glStencilFuncSeparate(GL_FRONT, detail::CompareOpToGL(ss.front.compareOp), ss.front.reference, ss.front.compareMask);
-          if (context->lastStencilMask[0] != ss.front.writeMask)
-          {
-            glStencilMaskSeparate(GL_FRONT, ss.front.writeMask);
-            context->lastStencilMask[0] = ss.front.writeMask;
-          }
-        }
-
-        if (!context->lastGraphicsPipeline || !context->lastGraphicsPipeline->stencilState.stencilTestEnable ||
-            ss.back != context->lastGraphicsPipeline->stencilState.back)
-        {
-          glStencilOpSeparate(GL_BACK,
-                              detail::StencilOpToGL(ss.back.failOp),
-                              detail::StencilOpToGL(ss.back.depthFailOp),
-                              detail::StencilOpToGL(ss.back.passOp));
-          glStencilFuncSeparate(GL_BACK, detail::CompareOpToGL(ss.back.compareOp), ss.back.reference, ss.back.compareMask);
-          if (context->lastStencilMask[1] != ss.back.writeMask)
-          {
-            glStencilMaskSeparate(GL_BACK, ss.back.writeMask);
-            context->lastStencilMask[1] = ss.back.writeMask;
-          }
-        }
+        FWOG_COUNT(glStateCalls, 2);
+        glStencilOpSeparate(GL_BACK,
+                            detail::StencilOpToGL(ss.back.failOp),
+                            detail::StencilOpToGL(ss.back.depthFailOp),
+                            detail::StencilOpToGL(ss.back.passOp));
+        glStencilFuncSeparate(GL_BACK, detail::CompareOpToGL(ss.back.compareOp), ss.back.reference, ss.back.compareMask);
       }
 
-      //////////////////////////////////////////////////////////////// color blending state
       const auto& cb = pipelineState->colorBlendState;
-      if (!context->lastGraphicsPipeline || cb.logicOpEnable != context->lastGraphicsPipeline->colorBlendState.logicOpEnable)
+      if (isDirty(1u << Block::LOGIC_OP))
       {
-        GLEnableOrDisable(GL_COLOR_LOGIC_OP, cb.logicOpEnable);
-        if (!context->lastGraphicsPipeline || !context->lastGraphicsPipeline->colorBlendState.logicOpEnable ||
-            (cb.logicOpEnable && cb.logicOp != context->lastGraphicsPipeline->colorBlendState.logicOp))
-        {
-          glLogicOp(detail::LogicOpToGL(cb.logicOp));
-        }
+        FWOG_COUNT(glStateCalls, 1);
+        glLogicOp(detail::LogicOpToGL(cb.logicOp));
       }
 
-      if (!context->lastGraphicsPipeline || std::memcmp(cb.blendConstants,
-                                                        context->lastGraphicsPipeline->colorBlendState.blendConstants,
-                                                        sizeof(cb.blendConstants)) != 0)
+      if (isDirty(Block::BLEND_CONSTANTS_WORDS))
       {
+        FWOG_COUNT(glStateCalls, 1);
         glBlendColor(cb.blendConstants[0], cb.blendConstants[1], cb.blendConstants[2], cb.blendConstants[3]);
       }
 
@@ -911,23 +1273,21 @@ namespace Fwog
       //   || lastRenderInfo->colorAttachments.size() >= cb.attachments.size()
       //   && "There must be at least a color blend attachment for each render target, or none");
 
-      if (!context->lastGraphicsPipeline ||
-          cb.attachments.empty() != context->lastGraphicsPipeline->colorBlendState.attachments.empty())
-      {
-        GLEnableOrDisable(GL_BLEND, !cb.attachments.empty());
-      }
-
-      for (GLuint i = 0; i < static_cast<GLuint>(cb.attachments.size()); i++)
+      // Words of attachments the pipeline doesn't have can be dirty too, but there is nothing to emit for them
+      const auto attachmentCount = static_cast<uint32_t>(cb.attachments.size());
+      const uint32_t dirtyAttachments = (dirty & Block::BLEND_ATTACHMENTS_WORDS) >> Block::BLEND_ATTACHMENTS;
+      for (uint32_t bits = dirtyAttachments; bits != 0; bits &= bits - 1)
       {
-        const auto& cba = cb.attachments[i];
-        if (context->lastGraphicsPipeline && i < context->lastGraphicsPipeline->colorBlendState.attachments.size() &&
-            cba == context->lastGraphicsPipeline->colorBlendState.attachments[i])
+        const auto i = static_cast<GLuint>(std::countr_zero(bits));
+        if (i >= attachmentCount)
         {
-          continue;
+          break;
         }
 
+        const auto& cba = cb.attachments[i];
         if (cba.blendEnable)
         {
+          FWOG_COUNT(glStateCalls, 2);
           glBlendFuncSeparatei(i,
                                detail::BlendFactorToGL(cba.srcColorBlendFactor),
                                detail::BlendFactorToGL(cba.dstColorBlendFactor),
@@ -938,55 +1298,285 @@ namespace Fwog
         else
         {
           // "no blending" blend state
+          FWOG_COUNT(glStateCalls, 2);
           glBlendFuncSeparatei(i, GL_SRC_COLOR, GL_ZERO, GL_SRC_ALPHA, GL_ZERO);
           glBlendEquationSeparatei(i, GL_FUNC_ADD, GL_FUNC_ADD);
         }
+      }
+
+      //////////////////////////////////////////////////////////////// write masks
+      // These are compared against what was last set, as clearing attachments at the start of rendering changes them
+      if (ds.depthTestEnable && ds.depthWriteEnable != context->lastDepthMask)
+      {
+        FWOG_COUNT(glStateCalls, 1);
+        glDepthMask(ds.depthWriteEnable);
+        context->lastDepthMask = ds.depthWriteEnable;
+      }
 
-        if (context->lastColorMask[i] != cba.colorWriteMask)
+      if (ss.stencilTestEnable)
+      {
+        if (context->lastStencilMask[0] != ss.front.writeMask)
+        {
+          FWOG_COUNT(glStateCalls, 1);
+          glStencilMaskSeparate(GL_FRONT, ss.front.writeMask);
+          context->lastStencilMask[0] = ss.front.writeMask;
+        }
+
+        if (context->lastStencilMask[1] != ss.back.writeMask)
         {
+          FWOG_COUNT(glStateCalls, 1);
+          glStencilMaskSeparate(GL_BACK, ss.back.writeMask);
+          context->lastStencilMask[1] = ss.back.writeMask;
+        }
+      }
+
+      for (GLuint i = 0; i < attachmentCount; i++)
+      {
+        const auto colorWriteMask = cb.attachments[i].colorWriteMask;
+        if (context->lastColorMask[i] != colorWriteMask)
+        {
+          FWOG_COUNT(glStateCalls, 1);
           glColorMaski(i,
-                       (cba.colorWriteMask & ColorComponentFlag::R_BIT) != ColorComponentFlag::NONE,
-                       (cba.colorWriteMask & ColorComponentFlag::G_BIT) != ColorComponentFlag::NONE,
-                       (cba.colorWriteMask & ColorComponentFlag::B_BIT) != ColorComponentFlag::NONE,
-                       (cba.colorWriteMask & ColorComponentFlag::A_BIT) != ColorComponentFlag::NONE);
-          context->lastColorMask[i] = cba.colorWriteMask;
+                       (colorWriteMask & ColorComponentFlag::R_BIT) != ColorComponentFlag::NONE,
+                       (colorWriteMask & ColorComponentFlag::G_BIT) != ColorComponentFlag::NONE,
+                       (colorWriteMask & ColorComponentFlag::B_BIT) != ColorComponentFlag::NONE,
+                       (colorWriteMask & ColorComponentFlag::A_BIT) != ColorComponentFlag::NONE);
+          context->lastColorMask[i] = colorWriteMask;
         }
       }
 
-      context->lastGraphicsPipeline = pipelineState;
+      detail::SetLastGraphicsPipelineInternal(pipeline);
     }
 
-    void BindComputePipeline(const ComputePipeline& pipeline)
+    void BindComputePipelineInternal(uint64_t pipeline, Extent3D workgroupSize)
     {
       FWOG_ASSERT(context->isComputeActive);
-      FWOG_ASSERT(pipeline.Handle() != 0);
+      FWOG_ASSERT(pipeline != 0);
+      CaptureCommand(CommandType::BIND_COMPUTE_PIPELINE, BindComputePipelineCommand{pipeline, workgroupSize});
 
-      auto pipelineState = detail::GetComputePipelineInternal(pipeline.Handle());
+      const auto* pipelineState = detail::GetComputePipelineInternal(pipeline);
+      FWOG_ASSERT(pipelineState);
 
-      context->lastComputePipelineWorkgroupSize = pipeline.WorkgroupSize();
+      context->lastComputePipelineWorkgroupSize = workgroupSize;
       context->lastPipelineWasCompute = true;
 
       if (context->isPipelineDebugGroupPushed)
       {
         context->isPipelineDebugGroupPushed = false;
-        glPopDebugGroup();
+        PopDebugGroup();
       }
 
       if (!pipelineState->name.empty())
       {
-        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION,
-                         0,
-                         static_cast<GLsizei>(pipelineState->name.size()),
-                         pipelineState->name.data());
+        PushDebugGroup(pipelineState->name);
         context->isPipelineDebugGroupPushed = true;
       }
 
-      glUseProgram(static_cast<GLuint>(pipeline.Handle()));
+      FWOG_COUNT(pipelineBinds, 1);
+      FWOG_COUNT(glBindCalls, 1);
+      glUseProgram(pipelineState->program);
+    }
+
+    void BindVertexBufferInternal(uint32_t bindingIndex, uint32_t buffer, uint64_t offset, uint64_t stride)
+    {
+      FWOG_ASSERT(context->isRendering);
+
+      FWOG_ASSERT(context->currentVertexArrayBindings && "A graphics pipeline must be bound before binding vertex buffers");
+      CaptureCommand(CommandType::BIND_VERTEX_BUFFER, BindVertexBufferCommand{bindingIndex, buffer, offset, stride});
+
+      context->currentVertexArrayBindings->vertexBuffers.Set(
+        bindingIndex,
+        {buffer, static_cast<GLintptr>(offset), static_cast<GLsizei>(stride)});
+    }
+
+    void BindIndexBufferInternal(uint32_t buffer, IndexType indexType)
+    {
+      FWOG_ASSERT(context->isRendering);
+
+      context->isIndexBufferBound = true;
+      context->currentIndexType = indexType;
+
+      FWOG_ASSERT(context->currentVertexArrayBindings && "A graphics pipeline must be bound before binding an index buffer");
+      CaptureCommand(CommandType::BIND_INDEX_BUFFER, BindIndexBufferCommand{buffer, indexType});
+      if (auto& indexBuffer = context->currentVertexArrayBindings->indexBuffer; indexBuffer != buffer)
+      {
+        indexBuffer = buffer;
+        FWOG_COUNT(glBindCalls, 1);
+        glVertexArrayElementBuffer(context->currentVao, buffer);
+      }
+    }
+
+    void DrawIndirectInternal(uint32_t commandBuffer, uint64_t commandBufferOffset, uint32_t drawCount, uint32_t stride)
+    {
+      FWOG_ASSERT(context->isRendering);
+      CaptureCommand(CommandType::DRAW_INDIRECT,
+                     DrawIndirectCommand{commandBuffer, drawCount, commandBufferOffset, stride});
+      FlushResourceBindings(true);
+      FlushMemoryBarriers(true, commandBuffer);
+
+      FWOG_COUNT(glBindCalls, 1);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+      FWOG_COUNT(drawCalls, 1);
+      glMultiDrawArraysIndirect(detail::PrimitiveTopologyToGL(context->currentTopology),
+                                reinterpret_cast<void*>(static_cast<uintptr_t>(commandBufferOffset)),
+                                drawCount,
+                                stride);
+      RecordShaderWrites();
+    }
+
+    void DrawIndirectCountInternal(uint32_t commandBuffer,
+                                   uint64_t commandBufferOffset,
+                                   uint32_t countBuffer,
+                                   uint64_t countBufferOffset,
+                                   uint32_t maxDrawCount,
+                                   uint32_t stride)
+    {
+      FWOG_ASSERT(context->isRendering);
+      CaptureCommand(
+        CommandType::DRAW_INDIRECT_COUNT,
+        DrawIndirectCountCommand{commandBuffer, countBuffer, commandBufferOffset, countBufferOffset, maxDrawCount, stride});
+      FlushResourceBindings(true);
+      FlushMemoryBarriers(true, commandBuffer, countBuffer);
+
+      FWOG_COUNT(glBindCalls, 2);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+      glBindBuffer(GL_PARAMETER_BUFFER, countBuffer);
+      FWOG_COUNT(drawCalls, 1);
+      glMultiDrawArraysIndirectCount(detail::PrimitiveTopologyToGL(context->currentTopology),
+                                     reinterpret_cast<void*>(static_cast<uintptr_t>(commandBufferOffset)),
+                                     static_cast<GLintptr>(countBufferOffset),
+                                     maxDrawCount,
+                                     stride);
+      RecordShaderWrites();
+    }
+
+    void DrawIndexedIndirectInternal(uint32_t commandBuffer, uint64_t commandBufferOffset, uint32_t drawCount, uint32_t stride)
+    {
+      FWOG_ASSERT(context->isRendering);
+      FWOG_ASSERT(context->isIndexBufferBound);
+      CaptureCommand(CommandType::DRAW_INDEXED_INDIRECT,
+                     DrawIndirectCommand{commandBuffer, drawCount, commandBufferOffset, stride});
+      FlushResourceBindings(true);
+      FlushMemoryBarriers(true, commandBuffer);
+
+      FWOG_COUNT(glBindCalls, 1);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+      FWOG_COUNT(drawCalls, 1);
+      glMultiDrawElementsIndirect(detail::PrimitiveTopologyToGL(context->currentTopology),
+                                  detail::IndexTypeToGL(context->currentIndexType),
+                                  reinterpret_cast<void*>(static_cast<uintptr_t>(commandBufferOffset)),
+                                  drawCount,
+                                  stride);
+      RecordShaderWrites();
+    }
+
+    void DrawIndexedIndirectCountInternal(uint32_t commandBuffer,
+                                          uint64_t commandBufferOffset,
+                                          uint32_t countBuffer,
+                                          uint64_t countBufferOffset,
+                                          uint32_t maxDrawCount,
+                                          uint32_t stride)
+    {
+      FWOG_ASSERT(context->isRendering);
+      FWOG_ASSERT(context->isIndexBufferBound);
+      CaptureCommand(
+        CommandType::DRAW_INDEXED_INDIRECT_COUNT,
+        DrawIndirectCountCommand{commandBuffer, countBuffer, commandBufferOffset, countBufferOffset, maxDrawCount, stride});
+      FlushResourceBindings(true);
+      FlushMemoryBarriers(true, commandBuffer, countBuffer);
+
+      FWOG_COUNT(glBindCalls, 2);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+      glBindBuffer(GL_PARAMETER_BUFFER, countBuffer);
+      FWOG_COUNT(drawCalls, 1);
+      glMultiDrawElementsIndirectCount(detail::PrimitiveTopologyToGL(context->currentTopology),
+                                       detail::IndexTypeToGL(context->currentIndexType),
+                                       reinterpret_cast<void*>(static_cast<uintptr_t>(commandBufferOffset)),
+                                       static_cast<GLintptr>(countBufferOffset),
+                                       maxDrawCount,
+                                       stride);
+      RecordShaderWrites();
+    }
+
+    void BindUniformBufferInternal(uint32_t index, uint32_t buffer, uint64_t offset, uint64_t size)
+    {
+      FWOG_ASSERT(context->isRendering || context->isComputeActive);
+      CaptureCommand(CommandType::BIND_UNIFORM_BUFFER, BindBufferRangeCommand{index, buffer, offset, size});
+
+      context->uniformBuffers.Set(index,
+                                  {buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size)});
+    }
+
+    void BindStorageBufferInternal(uint32_t index, uint32_t buffer, uint64_t offset, uint64_t size, AccessType access)
+    {
+      FWOG_ASSERT(context->isRendering || context->isComputeActive);
+      CaptureCommand(CommandType::BIND_STORAGE_BUFFER,
+                     BindStorageBufferCommand{{index, buffer, offset, size}, access});
+
+      context->storageBuffers.Set(index,
+                                  {buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size)});
+
+      const bool writable = access != AccessType::READ_ONLY;
+      context->storageBufferWritable[index] = writable;
+      if (writable)
+      {
+        context->storageBufferWritableEnd = std::max(context->storageBufferWritableEnd, index + 1);
+      }
+    }
+
+    void BindSampledImageInternal(uint32_t index, uint32_t texture, uint32_t sampler)
+    {
+      FWOG_ASSERT(context->isRendering || context->isComputeActive);
+      CaptureCommand(CommandType::BIND_SAMPLED_IMAGE, BindSampledImageCommand{index, texture, sampler});
+
+      context->textureUnits.Set(index, texture);
+      context->samplerUnits.Set(index, sampler);
+    }
+
+    void BindImageInternal(uint32_t index, uint32_t texture, uint32_t level, Format format, AccessType access)
+    {
+      FWOG_ASSERT(context->isRendering || context->isComputeActive);
+      FWOG_ASSERT(IsValidImageFormat(format));
+      CaptureCommand(CommandType::BIND_IMAGE, BindImageCommand{index, texture, level, format, access});
+
+      context->imageUnits.Set(index,
+                              {.texture = texture,
+                               .level = static_cast<GLint>(level),
+                               .access = detail::AccessTypeToGL(access),
+                               .format = static_cast<GLenum>(detail::FormatToGL(format))});
+    }
+
+    void DispatchIndirectInternal(uint32_t commandBuffer, uint64_t commandBufferOffset)
+    {
+      FWOG_ASSERT(context->isComputeActive);
+      CaptureCommand(CommandType::DISPATCH_INDIRECT, DispatchIndirectCommand{commandBuffer, commandBufferOffset});
+      FlushResourceBindings(false);
+      FlushMemoryBarriers(false, commandBuffer);
+
+      FWOG_COUNT(glBindCalls, 1);
+      glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, commandBuffer);
+      FWOG_COUNT(dispatchCalls, 1);
+      glDispatchComputeIndirect(static_cast<GLintptr>(commandBufferOffset));
+      RecordShaderWrites();
+    }
+  } // namespace detail
+
+  namespace Cmd
+  {
+    void BindGraphicsPipeline(const GraphicsPipeline& pipeline)
+    {
+      detail::BindGraphicsPipelineInternal(pipeline.RegistryHandle());
+    }
+
+    void BindComputePipeline(const ComputePipeline& pipeline)
+    {
+      detail::BindComputePipelineInternal(pipeline.RegistryHandle(), pipeline.WorkgroupSize());
     }
 
     void SetViewport(const Viewport& viewport)
     {
       FWOG_ASSERT(context->isRendering);
+      CaptureCommand(CommandType::SET_VIEWPORT, SetViewportCommand{viewport});
 
       SetViewportInternal(viewport, context->lastViewport, false);
 
@@ -996,9 +1586,11 @@ namespace Fwog
     void SetScissor(const Rect2D& scissor)
     {
       FWOG_ASSERT(context->isRendering);
+      CaptureCommand(CommandType::SET_SCISSOR, SetScissorCommand{scissor});
 
       if (!context->scissorEnabled)
       {
+        FWOG_COUNT(glStateCalls, 1);
         glEnable(GL_SCISSOR_TEST);
         context->scissorEnabled = true;
       }
@@ -1008,6 +1600,7 @@ namespace Fwog
         return;
       }
 
+      FWOG_COUNT(glStateCalls, 1);
       glScissor(scissor.offset.x, scissor.offset.y, scissor.extent.width, scissor.extent.height);
 
       context->lastScissor = scissor;
@@ -1015,39 +1608,44 @@ namespace Fwog
 
     void BindVertexBuffer(uint32_t bindingIndex, const Buffer& buffer, uint64_t offset, uint64_t stride)
     {
-      FWOG_ASSERT(context->isRendering);
-
-      glVertexArrayVertexBuffer(context->currentVao,
-                                bindingIndex,
-                                buffer.Handle(),
-                                static_cast<GLintptr>(offset),
-                                static_cast<GLsizei>(stride));
+      detail::BindVertexBufferInternal(bindingIndex, buffer.Handle(), offset, stride);
     }
 
     void BindIndexBuffer(const Buffer& buffer, IndexType indexType)
     {
-      FWOG_ASSERT(context->isRendering);
-
-      context->isIndexBufferBound = true;
-      context->currentIndexType = indexType;
-      glVertexArrayElementBuffer(context->currentVao, buffer.Handle());
+      detail::BindIndexBufferInternal(buffer.Handle(), indexType);
     }
 
     void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
     {
       FWOG_ASSERT(context->isRendering);
+      CaptureCommand(CommandType::DRAW, DrawCommand{vertexCount, instanceCount, firstVertex, firstInstance});
+      FlushResourceBindings(true);
+      FlushMemoryBarriers(true);
 
+      FWOG_COUNT(drawCalls, 1);
+      FWOG_COUNT(vertices, vertexCount);
+      FWOG_COUNT(instances, instanceCount);
       glDrawArraysInstancedBaseInstance(detail::PrimitiveTopologyToGL(context->currentTopology),
                                         firstVertex,
                                         vertexCount,
                                         instanceCount,
                                         firstInstance);
+      RecordShaderWrites();
     }
 
     void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
     {
       FWOG_ASSERT(context->isRendering);
       FWOG_ASSERT(context->isIndexBufferBound);
+      CaptureCommand(CommandType::DRAW_INDEXED,
+                     DrawIndexedCommand{indexCount, instanceCount, firstIndex, vertexOffset, firstInstance});
+      FlushResourceBindings(true);
+      FlushMemoryBarriers(true);
+
+      FWOG_COUNT(drawCalls, 1);
+      FWOG_COUNT(indices, indexCount);
+      FWOG_COUNT(instances, instanceCount);
 
       // double cast is needed to prevent compiler from complaining about 32->64 bit pointer cast
       glDrawElementsInstancedBaseVertexBaseInstance(
@@ -1058,17 +1656,12 @@ namespace Fwog
         instanceCount,
         vertexOffset,
         firstInstance);
+      RecordShaderWrites();
     }
 
     void DrawIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset, uint32_t drawCount, uint32_t stride)
     {
-      FWOG_ASSERT(context->isRendering);
-
-      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.Handle());
-      glMultiDrawArraysIndirect(detail::PrimitiveTopologyToGL(context->currentTopology),
-                                reinterpret_cast<void*>(static_cast<uintptr_t>(commandBufferOffset)),
-                                drawCount,
-                                stride);
+      detail::DrawIndirectInternal(commandBuffer.Handle(), commandBufferOffset, drawCount, stride);
     }
 
     void DrawIndirectCount(const Buffer& commandBuffer,
@@ -1078,28 +1671,17 @@ namespace Fwog
                            uint32_t maxDrawCount,
                            uint32_t stride)
     {
-      FWOG_ASSERT(context->isRendering);
-
-      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.Handle());
-      glBindBuffer(GL_PARAMETER_BUFFER, countBuffer.Handle());
-      glMultiDrawArraysIndirectCount(detail::PrimitiveTopologyToGL(context->currentTopology),
-                                     reinterpret_cast<void*>(static_cast<uintptr_t>(commandBufferOffset)),
-                                     static_cast<GLintptr>(countBufferOffset),
-                                     maxDrawCount,
-                                     stride);
+      detail::DrawIndirectCountInternal(commandBuffer.Handle(),
+                                        commandBufferOffset,
+                                        countBuffer.Handle(),
+                                        countBufferOffset,
+                                        maxDrawCount,
+                                        stride);
     }
 
     void DrawIndexedIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset, uint32_t drawCount, uint32_t stride)
     {
-      FWOG_ASSERT(context->isRendering);
-      FWOG_ASSERT(context->isIndexBufferBound);
-
-      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.Handle());
-      glMultiDrawElementsIndirect(detail::PrimitiveTopologyToGL(context->currentTopology),
-                                  detail::IndexTypeToGL(context->currentIndexType),
-                                  reinterpret_cast<void*>(static_cast<uintptr_t>(commandBufferOffset)),
-                                  drawCount,
-                                  stride);
+      detail::DrawIndexedIndirectInternal(commandBuffer.Handle(), commandBufferOffset, drawCount, stride);
     }
 
     void DrawIndexedIndirectCount(const Buffer& commandBuffer,
@@ -1109,78 +1691,72 @@ namespace Fwog
                                   uint32_t maxDrawCount,
                                   uint32_t stride)
     {
-      FWOG_ASSERT(context->isRendering);
-      FWOG_ASSERT(context->isIndexBufferBound);
-
-      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.Handle());
-      glBindBuffer(GL_PARAMETER_BUFFER, countBuffer.Handle());
-      glMultiDrawElementsIndirectCount(detail::PrimitiveTopologyToGL(context->currentTopology),
-                                       detail::IndexTypeToGL(context->currentIndexType),
-                                       reinterpret_cast<void*>(static_cast<uintptr_t>(commandBufferOffset)),
-                                       static_cast<GLintptr>(countBufferOffset),
-                                       maxDrawCount,
-                                       stride);
+      detail::DrawIndexedIndirectCountInternal(commandBuffer.Handle(),
+                                               commandBufferOffset,
+                                               countBuffer.Handle(),
+                                               countBufferOffset,
+                                               maxDrawCount,
+                                               stride);
     }
 
     void BindUniformBuffer(uint32_t index, const Buffer& buffer, uint64_t offset, uint64_t size)
     {
-      FWOG_ASSERT(context->isRendering || context->isComputeActive);
-
       if (size == WHOLE_BUFFER)
       {
         size = buffer.Size() - offset;
       }
 
-      glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer.Handle(), offset, size);
+      detail::BindUniformBufferInternal(index, buffer.Handle(), offset, size);
     }
 
-    void BindStorageBuffer(uint32_t index, const Buffer& buffer, uint64_t offset, uint64_t size)
+    void BindStorageBuffer(uint32_t index, const Buffer& buffer, uint64_t offset, uint64_t size, AccessType access)
     {
-      FWOG_ASSERT(context->isRendering || context->isComputeActive);
-
       if (size == WHOLE_BUFFER)
       {
         size = buffer.Size() - offset;
       }
 
-      glBindBufferRange(GL_SHADER_STORAGE_BUFFER, index, buffer.Handle(), offset, size);
+      detail::BindStorageBufferInternal(index, buffer.Handle(), offset, size, access);
     }
 
     void BindSampledImage(uint32_t index, const Texture& texture, const Sampler& sampler)
     {
-      FWOG_ASSERT(context->isRendering || context->isComputeActive);
-
-      glBindTextureUnit(index, const_cast<Texture&>(texture).Handle());
-      glBindSampler(index, sampler.Handle());
+      detail::BindSampledImageInternal(index, const_cast<Texture&>(texture).Handle(), sampler.Handle());
     }
 
-    void BindImage(uint32_t index, const Texture& texture, uint32_t level)
+    void BindImage(uint32_t index, const Texture& texture, uint32_t level, AccessType access)
     {
-      FWOG_ASSERT(context->isRendering || context->isComputeActive);
       FWOG_ASSERT(level < texture.GetCreateInfo().mipLevels);
-      FWOG_ASSERT(IsValidImageFormat(texture.GetCreateInfo().format));
-
-      glBindImageTexture(index,
-                         const_cast<Texture&>(texture).Handle(),
-                         level,
-                         GL_TRUE,
-                         0,
-                         GL_READ_WRITE,
-                         detail::FormatToGL(texture.GetCreateInfo().format));
+
+      detail::BindImageInternal(index,
+                                const_cast<Texture&>(texture).Handle(),
+                                level,
+                                texture.GetCreateInfo().format,
+                                access);
     }
 
     void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
     {
       FWOG_ASSERT(context->isComputeActive);
+      CaptureCommand(CommandType::DISPATCH, DispatchCommand{{groupCountX, groupCountY, groupCountZ}});
+      FlushResourceBindings(false);
+      FlushMemoryBarriers(false);
 
+      FWOG_COUNT(dispatchCalls, 1);
       glDispatchCompute(groupCountX, groupCountY, groupCountZ);
+      RecordShaderWrites();
     }
 
     void Dispatch(Extent3D groupCount)
     {
       FWOG_ASSERT(context->isComputeActive);
+      CaptureCommand(CommandType::DISPATCH, DispatchCommand{groupCount});
+      FlushResourceBindings(false);
+      FlushMemoryBarriers(false);
 
+      FWOG_COUNT(dispatchCalls, 1);
       glDispatchCompute(groupCount.width, groupCount.height, groupCount.depth);
+      RecordShaderWrites();
     }
 
     void DispatchInvocations(uint32_t invocationCountX, uint32_t invocationCountY, uint32_t invocationCountZ)
@@ -1191,19 +1767,21 @@ namespace Fwog
     void DispatchInvocations(Extent3D invocationCount)
     {
       FWOG_ASSERT(context->isComputeActive);
+      CaptureCommand(CommandType::DISPATCH_INVOCATIONS, DispatchCommand{invocationCount});
+      FlushResourceBindings(false);
+      FlushMemoryBarriers(false);
 
       const auto workgroupSize = context->lastComputePipelineWorkgroupSize;
       const auto groupCount = (invocationCount + workgroupSize - 1) / workgroupSize;
 
+      FWOG_COUNT(dispatchCalls, 1);
       glDispatchCompute(groupCount.width, groupCount.height, groupCount.depth);
+      RecordShaderWrites();
     }
 
     void DispatchIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset)
     {
-      FWOG_ASSERT(context->isComputeActive);
-
-      glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, commandBuffer.Handle());
-      glDispatchComputeIndirect(static_cast<GLintptr>(commandBufferOffset));
+      detail::DispatchIndirectInternal(commandBuffer.Handle(), commandBufferOffset);
     }
   } // namespace Cmd
 } // namespace Fwog
\ No newline at end of file
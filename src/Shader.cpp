@@ -1,7 +1,9 @@
 #include <Fwog/Exception.h>
 #include <Fwog/Shader.h>
 #include <Fwog/detail/ContextState.h>
+#include <Fwog/detail/ProgramCache.h>
 
+#include <chrono>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -26,16 +28,58 @@ namespace Fwog
     }
   } // namespace
 
-  Shader::Shader(PipelineStage stage, std::string_view source)
+  namespace detail
+  {
+    uint64_t GetSourceHash(const Shader& shader)
+    {
+      return shader.sourceHash_;
+    }
+
+    void CompileIfSkipped(const Shader& shader)
+    {
+      if (!shader.isCompileSkipped_)
+      {
+        return;
+      }
+
+      // The shader may have been compiled for another pipeline already
+      GLint success{};
+      glGetShaderiv(shader.id_, GL_COMPILE_STATUS, &success);
+      if (!success)
+      {
+        glCompileShader(shader.id_);
+        gProgramCache.RecordSkippedShaderCompiled(shader.sourceHash_);
+      }
+    }
+  } // namespace detail
+
+  Shader::Shader(PipelineStage stage, std::string_view source, ShaderCompileMode compileMode)
   {
     const GLchar* strings = source.data();
+    const auto length = static_cast<GLint>(source.size());
 
+    sourceHash_ = detail::HashShaderSource(PipelineStageToGL(stage), source);
     id_ = glCreateShader(PipelineStageToGL(stage));
-    glShaderSource(id_, 1, &strings, nullptr);
+    glShaderSource(id_, 1, &strings, &length);
+
+    // The source is known to compile if it was linked into a cached program, which is loaded without the shader
+    if (detail::gProgramCache.SkipShaderCompile(sourceHash_))
+    {
+      isCompileSkipped_ = true;
+      detail::InvokeVerboseMessageCallback("Created shader with handle ", id_);
+      return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
     glCompileShader(id_);
 
-    GLint success;
-    glGetShaderiv(id_, GL_COMPILE_STATUS, &success);
+    // Querying the status waits for compilation to finish
+    GLint success = GL_TRUE;
+    if (compileMode == ShaderCompileMode::BLOCKING)
+    {
+      glGetShaderiv(id_, GL_COMPILE_STATUS, &success);
+    }
+
     if (!success)
     {
 
@@ -47,10 +91,17 @@ namespace Fwog
       throw ShaderCompilationException("Failed to compile shader source.\n" + infoLog);
     }
 
+    detail::gProgramCache.RecordShaderCompile(sourceHash_, std::chrono::steady_clock::now() - start);
+
     detail::InvokeVerboseMessageCallback("Created shader with handle ", id_);
   }
 
-  Shader::Shader(Shader&& old) noexcept : id_(std::exchange(old.id_, 0)) {}
+  Shader::Shader(Shader&& old) noexcept
+    : id_(std::exchange(old.id_, 0)),
+      sourceHash_(std::exchange(old.sourceHash_, 0)),
+      isCompileSkipped_(std::exchange(old.isCompileSkipped_, false))
+  {
+  }
 
   Shader& Shader::operator=(Shader&& old) noexcept
   {
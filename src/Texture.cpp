@@ -1,6 +1,7 @@
 #include <Fwog/Texture.h>
 #include <Fwog/detail/ApiToEnum.h>
 #include <Fwog/detail/ContextState.h>
+#include <Fwog/detail/SamplerCache.h>
 
 #include <array>
 #include <new>
@@ -159,15 +160,8 @@ namespace Fwog
       return;
     }
 
-    if (bindlessHandle_ != 0)
-    {
-      glMakeTextureHandleNonResidentARB(bindlessHandle_);
-    }
-
     detail::InvokeVerboseMessageCallback("Destroyed texture with handle ", id_);
-    glDeleteTextures(1, &id_);
-    // Ensure that the texture is no longer referenced in the FBO cache
-    Fwog::detail::context->fboCache.RemoveTexture(*this);
+    detail::DestroyTexture(id_, bindlessHandle_);
   }
 
   TextureView Texture::CreateSingleMipView(uint32_t level)
@@ -235,12 +229,30 @@ namespace Fwog
 
   void Texture::UpdateImage(const TextureUpdateInfo& info)
   {
+    if (detail::context->capture)
+    {
+      detail::context->capture->RecordTextureUpdate(*this, info);
+    }
+
+    auto& barrierTracker = detail::context->barrierTracker;
+    barrierTracker.RequireTexture(id_, MemoryBarrierBit::TEXTURE_UPDATE_BIT);
+    barrierTracker.Flush();
+
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     subImageInternal(info);
   }
 
   void Texture::UpdateCompressedImage(const CompressedTextureUpdateInfo& info)
   {
+    if (detail::context->capture)
+    {
+      detail::context->capture->RecordUnrecordedCall("Texture::UpdateCompressedImage");
+    }
+
+    auto& barrierTracker = detail::context->barrierTracker;
+    barrierTracker.RequireTexture(id_, MemoryBarrierBit::TEXTURE_UPDATE_BIT);
+    barrierTracker.Flush();
+
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     subCompressedImageInternal(info);
   }
@@ -344,6 +356,11 @@ namespace Fwog
 
   void Texture::ClearImage(const TextureClearInfo& info)
   {
+    if (detail::context->capture)
+    {
+      detail::context->capture->RecordTextureClear(*this, info);
+    }
+
     // Infer format
     GLenum format{};
     if (info.format == UploadFormat::INFER_FORMAT)
@@ -373,6 +390,10 @@ namespace Fwog
       extent = createInfo_.extent;
     }
 
+    auto& barrierTracker = detail::context->barrierTracker;
+    barrierTracker.RequireTexture(id_, MemoryBarrierBit::TEXTURE_UPDATE_BIT);
+    barrierTracker.Flush();
+
     glClearTexSubImage(id_,
                        info.level,
                        info.offset.x,
@@ -388,6 +409,17 @@ namespace Fwog
 
   void Texture::GenMipmaps()
   {
+    if (detail::context->capture)
+    {
+      detail::context->capture->RecordUnrecordedCall("Texture::GenMipmaps");
+    }
+
+    // Mipmap generation reads the base level, which may be implemented with texture fetches
+    auto& barrierTracker = detail::context->barrierTracker;
+    barrierTracker.RequireTexture(id_, MemoryBarrierBit::TEXTURE_FETCH_BIT);
+    barrierTracker.RequireTexture(id_, MemoryBarrierBit::TEXTURE_UPDATE_BIT);
+    barrierTracker.Flush();
+
     glGenerateTextureMipmap(id_);
   }
 
@@ -406,6 +438,7 @@ namespace Fwog
                   viewInfo.numLevels,
                   viewInfo.minLayer,
                   viewInfo.numLayers);
+    detail::context->barrierTracker.AddTextureView(id_, texture.Handle());
 
     glTextureParameteri(id_, GL_TEXTURE_SWIZZLE_R, detail::ComponentSwizzleToGL(viewInfo.components.r));
     glTextureParameteri(id_, GL_TEXTURE_SWIZZLE_G, detail::ComponentSwizzleToGL(viewInfo.components.g));
@@ -460,7 +493,7 @@ namespace Fwog
   TextureView::~TextureView() {}
 
   Sampler::Sampler(const SamplerState& samplerState)
-    : Sampler(Fwog::detail::context->samplerCache.CreateOrGetCachedTextureSampler(samplerState))
+    : Sampler(Fwog::detail::gSamplerCache.CreateOrGetCachedTextureSampler(samplerState))
   {
   }
 
@@ -0,0 +1,150 @@
+#include <Fwog/TexturePool.h>
+#include <Fwog/detail/Hash.h>
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+std::size_t std::hash<Fwog::TextureCreateInfo>::operator()(const Fwog::TextureCreateInfo& k) const noexcept
+{
+  auto rtup = std::make_tuple(k.imageType,
+                              k.format,
+                              k.extent.width,
+                              k.extent.height,
+                              k.extent.depth,
+                              k.mipLevels,
+                              k.arrayLayers,
+                              k.sampleCount);
+  return Fwog::detail::hashing::hash<decltype(rtup)>{}(rtup);
+}
+
+namespace Fwog
+{
+  PooledTexture::PooledTexture(PooledTexture&& old) noexcept
+    : pool_(std::exchange(old.pool_, nullptr)), entry_(old.entry_)
+  {
+  }
+
+  PooledTexture& PooledTexture::operator=(PooledTexture&& old) noexcept
+  {
+    if (&old == this)
+      return *this;
+    this->~PooledTexture();
+    return *new (this) PooledTexture(std::move(old));
+  }
+
+  PooledTexture::~PooledTexture()
+  {
+    Reset();
+  }
+
+  void PooledTexture::Reset()
+  {
+    if (pool_)
+    {
+      pool_->Release(entry_);
+      pool_ = nullptr;
+    }
+  }
+
+  Texture& PooledTexture::Get() const
+  {
+    FWOG_ASSERT(pool_ && "The pooled texture is empty");
+    return pool_->entries_[entry_]->texture;
+  }
+
+  TexturePool::TexturePool(uint32_t maxIdleFrames) : maxIdleFrames_(maxIdleFrames) {}
+
+  TexturePool::~TexturePool()
+  {
+    FWOG_ASSERT(statistics_.texturesInUse == 0 && "Pooled textures must be returned before their pool is destroyed");
+  }
+
+  PooledTexture TexturePool::Acquire(const TextureCreateInfo& createInfo, std::string_view name)
+  {
+    statistics_.texturesInUse++;
+
+    if (auto it = available_.find(createInfo); it != available_.end() && !it->second.empty())
+    {
+      // Reuse the most recently released texture
+      const auto index = it->second.back();
+      it->second.pop_back();
+      entries_[index]->isInUse = true;
+      statistics_.reuseCount++;
+      return {*this, index};
+    }
+
+    uint32_t index;
+    if (!freeSlots_.empty())
+    {
+      index = freeSlots_.back();
+      freeSlots_.pop_back();
+    }
+    else
+    {
+      index = static_cast<uint32_t>(entries_.size());
+      entries_.emplace_back();
+    }
+
+    entries_[index] = std::make_unique<Entry>(Entry{Texture(createInfo, name), frame_, true});
+    statistics_.createCount++;
+    statistics_.textureCount++;
+    return {*this, index};
+  }
+
+  void TexturePool::Release(uint32_t entry)
+  {
+    auto& e = *entries_[entry];
+    FWOG_ASSERT(e.isInUse);
+    e.isInUse = false;
+    e.lastUsedFrame = frame_;
+    available_[e.texture.GetCreateInfo()].push_back(entry);
+    statistics_.texturesInUse--;
+  }
+
+  void TexturePool::Destroy(uint32_t entry)
+  {
+    entries_[entry].reset();
+    freeSlots_.push_back(entry);
+    statistics_.destroyCount++;
+    statistics_.textureCount--;
+  }
+
+  void TexturePool::NextFrame()
+  {
+    frame_++;
+
+    for (auto it = available_.begin(); it != available_.end();)
+    {
+      // Lists are ordered by release time, so idle textures are at the front
+      auto& list = it->second;
+      const auto idleEnd = std::find_if(list.begin(),
+                                        list.end(),
+                                        [this](uint32_t entry)
+                                        { return entries_[entry]->lastUsedFrame + maxIdleFrames_ >= frame_; });
+      std::for_each(list.begin(), idleEnd, [this](uint32_t entry) { Destroy(entry); });
+      list.erase(list.begin(), idleEnd);
+
+      if (list.empty())
+      {
+        it = available_.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+
+  void TexturePool::Clear()
+  {
+    for (const auto& [createInfo, list] : available_)
+    {
+      for (auto entry : list)
+      {
+        Destroy(entry);
+      }
+    }
+    available_.clear();
+  }
+} // namespace Fwog
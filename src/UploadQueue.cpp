@@ -0,0 +1,258 @@
+#include <Fwog/Rendering.h>
+#include <Fwog/Texture.h>
+#include <Fwog/UploadQueue.h>
+#include <Fwog/Exception.h>
+#include <Fwog/detail/ApiToEnum.h>
+#include FWOG_OPENGL_HEADER
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace Fwog
+{
+  namespace
+  {
+    // Covers the alignment of every pixel type, since buffer offsets of pixel transfers must be aligned to it
+    constexpr uint64_t STAGING_ALIGNMENT = 16;
+  } // namespace
+
+  UploadQueue::UploadQueue(const UploadQueueCreateInfo& createInfo)
+    : stagingBufferSize_(createInfo.stagingBufferSize),
+      bytesPerFrame_(createInfo.bytesPerFrame),
+      millisecondsPerFrame_(createInfo.millisecondsPerFrame)
+  {
+    FWOG_ASSERT(createInfo.stagingBufferCount > 0);
+    stagingBuffers_.reserve(createInfo.stagingBufferCount);
+    for (uint32_t i = 0; i < createInfo.stagingBufferCount; i++)
+    {
+      stagingBuffers_.push_back({Buffer(stagingBufferSize_, BufferStorageFlag::MAP_MEMORY), Fence(), 0});
+    }
+  }
+
+  UploadHandle UploadQueue::UploadTexture(const TextureUploadInfo& info)
+  {
+    FWOG_ASSERT(!info.data.empty());
+    const bool isCompressed = detail::IsBlockCompressedFormat(info.texture.GetCreateInfo().format);
+
+    // 3D and array textures are split by slices, other textures by rows of texels or blocks
+    uint64_t unitCount = info.extent.depth;
+    if (unitCount <= 1)
+    {
+      unitCount = isCompressed ? (info.extent.height + 3) / 4 : info.extent.height;
+    }
+    unitCount = std::max<uint64_t>(unitCount, 1);
+    FWOG_ASSERT(info.data.size() % unitCount == 0 && "The data must be tightly packed");
+
+    // Units are never split across staging buffers, so one that doesn't fit in a staging buffer can never be copied
+    if (info.data.size() / unitCount > stagingBufferSize_)
+    {
+      throw Exception("A row or slice of the texture upload is larger than a staging buffer");
+    }
+
+    requests_.push_back({
+      .id = nextId_,
+      .texture = &info.texture,
+      .buffer = nullptr,
+      .bufferOffset = 0,
+      .level = info.level,
+      .offset = info.offset,
+      .extent = info.extent,
+      .format = info.format,
+      .type = info.type,
+      .data = info.data,
+      .unitCount = unitCount,
+      .unitSize = info.data.size() / unitCount,
+      .unitsDone = 0,
+    });
+    statistics_.pendingUploads++;
+    return {nextId_++};
+  }
+
+  UploadHandle UploadQueue::UploadBuffer(const BufferUploadInfo& info)
+  {
+    FWOG_ASSERT(!info.data.empty() && info.offset + info.data.size() <= info.buffer.Size());
+
+    requests_.push_back({
+      .id = nextId_,
+      .texture = nullptr,
+      .buffer = &info.buffer,
+      .bufferOffset = info.offset,
+      .data = info.data,
+      .unitCount = info.data.size(),
+      .unitSize = 1,
+      .unitsDone = 0,
+    });
+    statistics_.pendingUploads++;
+    return {nextId_++};
+  }
+
+  void UploadQueue::Process()
+  {
+    ProcessInternal(bytesPerFrame_, millisecondsPerFrame_, false);
+  }
+
+  void UploadQueue::Flush()
+  {
+    ProcessInternal(0, 0, true);
+    while (submittedCount_ > 0)
+    {
+      RetireStagingBuffers(true);
+    }
+  }
+
+  void UploadQueue::ProcessInternal(uint64_t maxBytes, double maxMilliseconds, bool wait)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    const auto stagingCount = static_cast<uint32_t>(stagingBuffers_.size());
+    uint64_t bytes = 0;
+
+    RetireStagingBuffers(false);
+
+    while (!requests_.empty())
+    {
+      if (submittedCount_ == stagingCount)
+      {
+        if (!wait)
+        {
+          break;
+        }
+        RetireStagingBuffers(true);
+      }
+
+      auto& request = requests_.front();
+      auto& staging = stagingBuffers_[current_];
+
+      const auto stagingOffset = std::min((stagingHead_ + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1),
+                                          stagingBufferSize_);
+      auto unitCount = std::min(request.unitCount - request.unitsDone,
+                                (stagingBufferSize_ - stagingOffset) / request.unitSize);
+
+      // The first copy of a call is allowed to exceed the budget, so uploads always progress
+      if (maxBytes != 0)
+      {
+        const auto budgetUnits = bytes == 0 ? std::max<uint64_t>(maxBytes / request.unitSize, 1)
+                                            : (maxBytes - std::min(maxBytes, bytes)) / request.unitSize;
+        if (budgetUnits == 0)
+        {
+          break;
+        }
+        unitCount = std::min(unitCount, budgetUnits);
+      }
+
+      if (unitCount == 0)
+      {
+        FWOG_ASSERT(stagingHead_ != 0 && "A row or slice of the upload is larger than a staging buffer");
+        Submit(staging);
+        continue;
+      }
+
+      const auto size = unitCount * request.unitSize;
+      std::memcpy(static_cast<std::byte*>(staging.buffer.GetMappedPointer()) + stagingOffset,
+                  request.data.data() + request.unitsDone * request.unitSize,
+                  size);
+      CopyUnits(request, staging, stagingOffset, unitCount);
+
+      stagingHead_ = stagingOffset + size;
+      bytes += size;
+      request.unitsDone += unitCount;
+      if (request.unitsDone == request.unitCount)
+      {
+        staging.lastRequestId = request.id;
+        requests_.pop_front();
+      }
+
+      if (maxMilliseconds > 0 &&
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= maxMilliseconds)
+      {
+        break;
+      }
+    }
+
+    // Submit the partially filled staging buffer so it can retire even if there are no more uploads
+    if (stagingHead_ > 0)
+    {
+      Submit(stagingBuffers_[current_]);
+    }
+
+    statistics_.bytesUploaded += bytes;
+    statistics_.bytesLastProcess = bytes;
+  }
+
+  void UploadQueue::Submit(StagingBuffer& staging)
+  {
+    staging.fence.Signal();
+    current_ = (current_ + 1) % stagingBuffers_.size();
+    submittedCount_++;
+    stagingHead_ = 0;
+  }
+
+  void UploadQueue::RetireStagingBuffers(bool waitForOldest)
+  {
+    // Staging buffers are submitted in order, so they retire in order
+    while (submittedCount_ > 0)
+    {
+      auto& staging = stagingBuffers_[oldestSubmitted_];
+      if (staging.fence.Wait(waitForOldest ? FENCE_WAIT_FOREVER : 0) == FenceStatus::TIMEOUT)
+      {
+        break;
+      }
+
+      completedId_ = std::max(completedId_, staging.lastRequestId);
+      staging.lastRequestId = 0;
+      oldestSubmitted_ = (oldestSubmitted_ + 1) % stagingBuffers_.size();
+      submittedCount_--;
+      waitForOldest = false;
+    }
+
+    statistics_.pendingUploads = nextId_ - 1 - completedId_;
+  }
+
+  void UploadQueue::CopyUnits(const Request& request,
+                              const StagingBuffer& staging,
+                              uint64_t stagingOffset,
+                              uint64_t unitCount)
+  {
+    if (request.buffer)
+    {
+      CopyBuffer({
+        .source = staging.buffer,
+        .target = *request.buffer,
+        .sourceOffset = stagingOffset,
+        .targetOffset = request.bufferOffset + request.unitsDone,
+        .size = unitCount,
+      });
+      return;
+    }
+
+    auto offset = request.offset;
+    auto extent = request.extent;
+    if (request.extent.depth > 1)
+    {
+      offset.z += static_cast<uint32_t>(request.unitsDone);
+      extent.depth = static_cast<uint32_t>(unitCount);
+    }
+    else
+    {
+      const uint32_t rowsPerUnit = detail::IsBlockCompressedFormat(request.texture->GetCreateInfo().format) ? 4 : 1;
+      const auto firstRow = static_cast<uint32_t>(request.unitsDone) * rowsPerUnit;
+      offset.y += firstRow;
+      extent.height = std::min(static_cast<uint32_t>(unitCount) * rowsPerUnit, request.extent.height - firstRow);
+    }
+
+    // Rows are tightly packed in the staging buffer, but Fwog leaves GL_UNPACK_ALIGNMENT at its default of 4, which
+    // would skew rows whose size is not a multiple of 4 (e.g., R8 or RGB8 textures with an odd width)
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    CopyBufferToTexture({
+      .sourceBuffer = staging.buffer,
+      .targetTexture = *request.texture,
+      .level = request.level,
+      .sourceOffset = stagingOffset,
+      .targetOffset = offset,
+      .extent = extent,
+      .format = request.format,
+      .type = request.type,
+    });
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  }
+} // namespace Fwog
@@ -0,0 +1,79 @@
+#include <Fwog/Context.h>
+#include <Fwog/UploadRing.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace Fwog
+{
+  namespace
+  {
+    uint32_t GetBufferOffsetAlignment()
+    {
+      const auto& limits = GetDeviceProperties().limits;
+      return static_cast<uint32_t>(
+        std::max({1, limits.uniformBufferOffsetAlignment, limits.shaderStorageBufferOffsetAlignment}));
+    }
+  } // namespace
+
+  UploadRing::UploadRing(const UploadRingCreateInfo& createInfo)
+    : frameSize_(createInfo.frameSize),
+      frameCount_(createInfo.frameCount),
+      alignment_(GetBufferOffsetAlignment()),
+      buffer_(static_cast<size_t>(createInfo.frameSize) * createInfo.frameCount, BufferStorageFlag::MAP_MEMORY),
+      fences_(createInfo.frameCount)
+  {
+    FWOG_ASSERT(frameCount_ > 0);
+    // Start at the end of the last region so the first BeginFrame switches to the first one
+    frame_ = frameCount_ - 1;
+  }
+
+  void UploadRing::BeginFrame()
+  {
+    FWOG_ASSERT(!isRecording_ && "EndFrame must be called before beginning another frame");
+    isRecording_ = true;
+    frame_ = (frame_ + 1) % frameCount_;
+    head_ = 0;
+    statistics_.bytesUsed = 0;
+
+    fences_[frame_].Wait();
+  }
+
+  void UploadRing::EndFrame()
+  {
+    FWOG_ASSERT(isRecording_ && "BeginFrame must be called before ending a frame");
+    isRecording_ = false;
+    fences_[frame_].Signal();
+    statistics_.peakBytesUsed = std::max(statistics_.peakBytesUsed, statistics_.bytesUsed);
+  }
+
+  UploadAllocation UploadRing::Allocate(uint64_t size, uint64_t alignment)
+  {
+    FWOG_ASSERT(isRecording_ && "Allocations can only be made between BeginFrame and EndFrame");
+    FWOG_ASSERT(alignment == 0 || std::has_single_bit(alignment));
+
+    // Regions start at a multiple of the frame size, which may not be a multiple of the alignment
+    const auto align = std::max<uint64_t>(alignment, alignment_);
+    const auto regionStart = static_cast<uint64_t>(frame_) * frameSize_;
+    const auto offset = (regionStart + head_ + align - 1) & ~(align - 1);
+    if (offset + size > regionStart + frameSize_)
+    {
+      return {};
+    }
+
+    head_ = offset + size - regionStart;
+    statistics_.bytesUsed = head_;
+    return {&buffer_, offset, size, static_cast<std::byte*>(buffer_.GetMappedPointer()) + offset};
+  }
+
+  UploadAllocation UploadRing::Upload(TriviallyCopyableByteSpan data, uint64_t alignment)
+  {
+    auto allocation = Allocate(data.size_bytes(), alignment);
+    if (allocation)
+    {
+      std::memcpy(allocation.data, data.data(), data.size_bytes());
+    }
+    return allocation;
+  }
+} // namespace Fwog
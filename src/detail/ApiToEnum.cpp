@@ -861,7 +861,19 @@ int ImageTypeToDimension(ImageType imageType)
     ret |= bits & MemoryBarrierBit::FRAMEBUFFER_BIT ? GL_FRAMEBUFFER_BARRIER_BIT : 0;
     ret |= bits & MemoryBarrierBit::SHADER_STORAGE_BIT ? GL_SHADER_STORAGE_BARRIER_BIT : 0;
     ret |= bits & MemoryBarrierBit::QUERY_COUNTER_BIT ? GL_QUERY_BUFFER_BARRIER_BIT : 0;
+    ret |= bits & MemoryBarrierBit::PIXEL_BUFFER_BIT ? GL_PIXEL_BUFFER_BARRIER_BIT : 0;
     return ret;
   }
+
+  GLenum AccessTypeToGL(AccessType access)
+  {
+    switch (access)
+    {
+    case AccessType::READ_ONLY: return GL_READ_ONLY;
+    case AccessType::WRITE_ONLY: return GL_WRITE_ONLY;
+    case AccessType::READ_WRITE: return GL_READ_WRITE;
+    default: FWOG_UNREACHABLE; return 0;
+    }
+  }
   // clang-format on
 } // namespace Fwog::detail
\ No newline at end of file
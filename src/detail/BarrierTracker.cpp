@@ -0,0 +1,80 @@
+#include "Fwog/detail/BarrierTracker.h"
+#include "Fwog/detail/ApiToEnum.h"
+#include "Fwog/detail/ContextState.h"
+#include FWOG_OPENGL_HEADER
+
+namespace Fwog::detail
+{
+  void BarrierTracker::RecordBufferWrite(GLuint buffer)
+  {
+    if (buffer >= bufferWrites_.size())
+    {
+      bufferWrites_.resize(buffer + 1);
+    }
+    bufferWrites_[buffer] = serial_;
+    lastWrite_ = serial_;
+  }
+
+  void BarrierTracker::RecordTextureWrite(GLuint texture)
+  {
+    texture = GetStorage(texture);
+    if (texture >= textureWrites_.size())
+    {
+      textureWrites_.resize(texture + 1);
+    }
+    textureWrites_[texture] = serial_;
+    lastWrite_ = serial_;
+  }
+
+  void BarrierTracker::OnMemoryBarrier(MemoryBarrierBits bits)
+  {
+    for (uint32_t i = 0; i < KIND_COUNT; i++)
+    {
+      if (static_cast<uint32_t>(bits) & (1u << i))
+      {
+        lastBarrier_[i] = serial_;
+      }
+    }
+
+    // Writes after this point are not covered by the barrier
+    serial_++;
+    requiredBits_ &= ~static_cast<uint32_t>(bits);
+  }
+
+  void BarrierTracker::AddTextureView(GLuint view, GLuint parent)
+  {
+    if (view >= textureStorage_.size())
+    {
+      textureStorage_.resize(view + 1);
+    }
+    textureStorage_[view] = GetStorage(parent);
+  }
+
+  void BarrierTracker::RemoveBuffer(GLuint buffer)
+  {
+    if (buffer < bufferWrites_.size())
+    {
+      bufferWrites_[buffer] = 0;
+    }
+  }
+
+  void BarrierTracker::RemoveTexture(GLuint texture)
+  {
+    if (texture < textureWrites_.size())
+    {
+      textureWrites_[texture] = 0;
+    }
+    if (texture < textureStorage_.size())
+    {
+      textureStorage_[texture] = 0;
+    }
+  }
+
+  void BarrierTracker::IssueRequiredBarriers()
+  {
+    const auto bits = MemoryBarrierBits(requiredBits_);
+    FWOG_COUNT(glBarrierCalls, 1);
+    glMemoryBarrier(BarrierBitsToGL(bits));
+    OnMemoryBarrier(bits);
+  }
+} // namespace Fwog::detail
@@ -1,145 +1,304 @@
 #include "Fwog/detail/FramebufferCache.h"
 #include "Fwog/Texture.h"
 #include "Fwog/detail/ContextState.h"
+#include "Fwog/detail/Hash.h"
 #include FWOG_OPENGL_HEADER
 
+#include <algorithm>
+
 namespace Fwog::detail
 {
+  namespace
+  {
+    size_t FramebufferKeyHash(const FramebufferKey& key)
+    {
+      size_t hashVal{};
+      for (uint32_t i = 0; i < key.colorAttachmentCount; i++)
+      {
+        hashing::hash_combine(hashVal, key.colorAttachments[i]);
+      }
+      hashing::hash_combine(hashVal, key.depthAttachment);
+      hashing::hash_combine(hashVal, key.stencilAttachment);
+      return hashVal;
+    }
+
+    // Calls a function once for each texture attached to the framebuffer
+    template<class Fn>
+    void ForEachTexture(const FramebufferKey& key, Fn&& fn)
+    {
+      for (uint32_t i = 0; i < key.colorAttachmentCount; i++)
+      {
+        fn(key.colorAttachments[i]);
+      }
+      if (key.depthAttachment != 0)
+      {
+        fn(key.depthAttachment);
+      }
+      if (key.stencilAttachment != 0 && key.stencilAttachment != key.depthAttachment)
+      {
+        fn(key.stencilAttachment);
+      }
+    }
+  } // namespace
+
   uint32_t FramebufferCache::CreateOrGetCachedFramebuffer(const RenderInfo& renderInfo)
   {
-    RenderAttachments attachments;
-    for (const auto& colorAttachment : renderInfo.colorAttachments)
+    FWOG_ASSERT(renderInfo.colorAttachments.size() <= MAX_COLOR_ATTACHMENTS);
+
+    FramebufferKey key;
+    key.colorAttachmentCount = static_cast<uint32_t>(renderInfo.colorAttachments.size());
+    for (uint32_t i = 0; i < key.colorAttachmentCount; i++)
     {
-      attachments.colorAttachments.emplace_back(TextureProxy{
-        colorAttachment.texture.get().GetCreateInfo(),
-        detail::GetHandle(colorAttachment.texture),
-      });
+      key.colorAttachments[i] = detail::GetHandle(renderInfo.colorAttachments[i].texture);
     }
     if (renderInfo.depthAttachment)
     {
-      attachments.depthAttachment.emplace(TextureProxy{
-        renderInfo.depthAttachment->texture.get().GetCreateInfo(),
-        detail::GetHandle(renderInfo.depthAttachment->texture),
-      });
+      key.depthAttachment = detail::GetHandle(renderInfo.depthAttachment->texture);
     }
     if (renderInfo.stencilAttachment)
     {
-      attachments.stencilAttachment.emplace(TextureProxy{
-        renderInfo.stencilAttachment->texture.get().GetCreateInfo(),
-        detail::GetHandle(renderInfo.stencilAttachment->texture),
-      });
+      key.stencilAttachment = detail::GetHandle(renderInfo.stencilAttachment->texture);
+    }
+
+    const auto hash = FramebufferKeyHash(key);
+    if (auto entry = Find(key, hash); entry != NONE)
+    {
+      FWOG_COUNT(framebufferCache.hits, 1);
+      if (entry != mostRecent_)
+      {
+        Unlink(entry);
+        LinkFront(entry);
+      }
+      return entries_[entry].fbo;
     }
 
-    for (size_t i = 0; i < framebufferCacheKey_.size(); i++)
+    FWOG_COUNT(framebufferCache.misses, 1);
+
+    if (capacity_ != 0 && size_ >= capacity_)
     {
-      if (framebufferCacheKey_[i] == attachments)
-        return framebufferCacheValue_[i];
+      Erase(leastRecent_);
     }
 
     uint32_t fbo{};
     glCreateFramebuffers(1, &fbo);
-    std::vector<GLenum> drawBuffers;
-    for (size_t i = 0; i < attachments.colorAttachments.size(); i++)
+    GLenum drawBuffers[MAX_COLOR_ATTACHMENTS];
+    for (uint32_t i = 0; i < key.colorAttachmentCount; i++)
     {
-      const auto& attachment = attachments.colorAttachments[i];
-      glNamedFramebufferTexture(fbo, static_cast<GLenum>(GL_COLOR_ATTACHMENT0 + i), attachment.id, 0);
-      drawBuffers.push_back(static_cast<GLenum>(GL_COLOR_ATTACHMENT0 + i));
+      glNamedFramebufferTexture(fbo, GL_COLOR_ATTACHMENT0 + i, key.colorAttachments[i], 0);
+      drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
     }
-    glNamedFramebufferDrawBuffers(fbo, static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+    glNamedFramebufferDrawBuffers(fbo, static_cast<GLsizei>(key.colorAttachmentCount), drawBuffers);
 
-    if (attachments.depthAttachment && attachments.stencilAttachment &&
-        attachments.depthAttachment == attachments.stencilAttachment)
+    if (key.depthAttachment != 0 && key.depthAttachment == key.stencilAttachment)
     {
-      glNamedFramebufferTexture(fbo, GL_DEPTH_STENCIL_ATTACHMENT, attachments.depthAttachment->id, 0);
+      glNamedFramebufferTexture(fbo, GL_DEPTH_STENCIL_ATTACHMENT, key.depthAttachment, 0);
     }
-    else if (attachments.depthAttachment)
+    else if (key.depthAttachment != 0)
     {
-      glNamedFramebufferTexture(fbo, GL_DEPTH_ATTACHMENT, attachments.depthAttachment->id, 0);
+      glNamedFramebufferTexture(fbo, GL_DEPTH_ATTACHMENT, key.depthAttachment, 0);
     }
-    else if (attachments.stencilAttachment)
+    else if (key.stencilAttachment != 0)
     {
-      glNamedFramebufferTexture(fbo, GL_STENCIL_ATTACHMENT, attachments.stencilAttachment->id, 0);
+      glNamedFramebufferTexture(fbo, GL_STENCIL_ATTACHMENT, key.stencilAttachment, 0);
     }
 
     detail::InvokeVerboseMessageCallback("Created framebuffer with handle ", fbo);
 
-    framebufferCacheKey_.emplace_back(std::move(attachments));
-    return framebufferCacheValue_.emplace_back(fbo);
+    Insert(key, hash, fbo);
+    return fbo;
   }
 
   void FramebufferCache::Clear()
   {
-    for (const auto& fbo : framebufferCacheValue_)
+    for (const auto& entry : entries_)
     {
-      detail::InvokeVerboseMessageCallback("Destroyed framebuffer with handle ", fbo);
-      glDeleteFramebuffers(1, &fbo);
+      if (entry.fbo != 0)
+      {
+        detail::InvokeVerboseMessageCallback("Destroyed framebuffer with handle ", entry.fbo);
+        glDeleteFramebuffers(1, &entry.fbo);
+      }
     }
 
-    framebufferCacheKey_.clear();
-    framebufferCacheValue_.clear();
+    entries_.clear();
+    freeEntries_ = NONE;
+    size_ = 0;
+    slots_.clear();
+    mostRecent_ = NONE;
+    leastRecent_ = NONE;
+    textureEntries_.clear();
   }
 
-  // Must be called when a texture is deleted, otherwise the cache becomes invalid.
-  void FramebufferCache::RemoveTexture(const Texture& texture)
+  void FramebufferCache::RemoveTexture(uint32_t texture)
   {
-    const TextureProxy texp = {texture.GetCreateInfo(), detail::GetHandle(texture)};
+    auto it = textureEntries_.find(texture);
+    if (it == textureEntries_.end())
+    {
+      return;
+    }
 
-    for (size_t i = 0; i < framebufferCacheKey_.size(); i++)
+    // Erasing entries modifies the list
+    const auto entries = std::move(it->second);
+    textureEntries_.erase(it);
+    for (auto entry : entries)
     {
-      const auto& attachments = framebufferCacheKey_[i];
+      Erase(entry);
+    }
+  }
 
-      for (const auto& ci : attachments.colorAttachments)
-      {
-        if (texp == ci)
-        {
-          framebufferCacheKey_.erase(framebufferCacheKey_.begin() + i);
-          auto fboIt = framebufferCacheValue_.begin() + i;
-          glDeleteFramebuffers(1, &*fboIt);
-          framebufferCacheValue_.erase(fboIt);
-          i--;
-          break;
-        }
-      }
+  void FramebufferCache::SetCapacity(uint32_t maxFramebuffers)
+  {
+    capacity_ = maxFramebuffers == 0 ? 0 : std::max(maxFramebuffers, 2u);
+    while (capacity_ != 0 && size_ > capacity_)
+    {
+      Erase(leastRecent_);
+    }
+  }
 
-      if (texp == attachments.depthAttachment || texp == attachments.stencilAttachment)
+  uint32_t FramebufferCache::Find(const FramebufferKey& key, size_t hash) const
+  {
+    if (slots_.empty())
+    {
+      return NONE;
+    }
+
+    const size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask; slots_[slot] != NONE; slot = (slot + 1) & mask)
+    {
+      const auto& entry = entries_[slots_[slot]];
+      if (entry.hash == hash && entry.key == key)
       {
-        framebufferCacheKey_.erase(framebufferCacheKey_.begin() + i);
-        auto fboIt = framebufferCacheValue_.begin() + i;
-        glDeleteFramebuffers(1, &*fboIt);
-        framebufferCacheValue_.erase(fboIt);
-        i--;
-        continue;
+        return slots_[slot];
       }
     }
+    return NONE;
   }
 
-  bool RenderAttachments::operator==(const RenderAttachments& rhs) const
+  uint32_t FramebufferCache::Insert(const FramebufferKey& key, size_t hash, uint32_t fbo)
   {
-    if (colorAttachments.size() != rhs.colorAttachments.size())
-      return false;
+    if ((size_ + 1) * 2 > slots_.size())
+    {
+      Grow();
+    }
 
-    // Crucially, two attachments with the same address are not necessarily the same.
-    // The inverse is also true: two attachments with different addresses are not necessarily different.
+    uint32_t entry;
+    if (freeEntries_ != NONE)
+    {
+      entry = freeEntries_;
+      freeEntries_ = entries_[entry].next;
+    }
+    else
+    {
+      entry = static_cast<uint32_t>(entries_.size());
+      entries_.emplace_back();
+    }
+    entries_[entry] = {.key = key, .hash = hash, .fbo = fbo, .prev = NONE, .next = NONE};
+    size_++;
 
-    for (size_t i = 0; i < colorAttachments.size(); i++)
+    const size_t mask = slots_.size() - 1;
+    size_t slot = hash & mask;
+    while (slots_[slot] != NONE)
     {
-      // Color attachments must be non-null
-      if (colorAttachments[i] != rhs.colorAttachments[i])
-        return false;
+      slot = (slot + 1) & mask;
     }
+    slots_[slot] = entry;
 
-    // Nullity of the attachments differ
-    if ((depthAttachment && !rhs.depthAttachment) || (!depthAttachment && rhs.depthAttachment))
-      return false;
-    // Both attachments are non-null, but have different values
-    if (depthAttachment && rhs.depthAttachment && (*depthAttachment != *rhs.depthAttachment))
-      return false;
+    LinkFront(entry);
+    ForEachTexture(key,
+                   [this, entry](uint32_t texture)
+                   {
+                     // A texture can be attached more than once, but the entry should only be erased once
+                     auto& entries = textureEntries_[texture];
+                     if (entries.empty() || entries.back() != entry)
+                     {
+                       entries.push_back(entry);
+                     }
+                   });
+    return entry;
+  }
+
+  void FramebufferCache::Erase(uint32_t entry)
+  {
+    auto& e = entries_[entry];
+
+    // Remove the entry from the table with backward-shift deletion, so probe sequences stay unbroken without tombstones
+    const size_t mask = slots_.size() - 1;
+    size_t hole = e.hash & mask;
+    while (slots_[hole] != entry)
+    {
+      hole = (hole + 1) & mask;
+    }
+    for (size_t slot = (hole + 1) & mask; slots_[slot] != NONE; slot = (slot + 1) & mask)
+    {
+      // An entry can fill the hole if the hole lies between its home slot and its current slot
+      const size_t home = entries_[slots_[slot]].hash & mask;
+      if (((slot - home) & mask) >= ((slot - hole) & mask))
+      {
+        slots_[hole] = slots_[slot];
+        hole = slot;
+      }
+    }
+    slots_[hole] = NONE;
 
-    if ((stencilAttachment && !rhs.stencilAttachment) || (!stencilAttachment && rhs.stencilAttachment))
-      return false;
-    if (stencilAttachment && rhs.stencilAttachment && (*stencilAttachment != *rhs.stencilAttachment))
-      return false;
+    ForEachTexture(e.key,
+                   [this, entry](uint32_t texture)
+                   {
+                     // The texture's list is absent when the entry is being erased by RemoveTexture
+                     if (auto it = textureEntries_.find(texture); it != textureEntries_.end())
+                     {
+                       auto& entries = it->second;
+                       std::erase(entries, entry);
+                       if (entries.empty())
+                       {
+                         textureEntries_.erase(it);
+                       }
+                     }
+                   });
 
-    return true;
+    Unlink(entry);
+
+    detail::InvokeVerboseMessageCallback("Destroyed framebuffer with handle ", e.fbo);
+    glDeleteFramebuffers(1, &e.fbo);
+    e.fbo = 0;
+    e.next = freeEntries_;
+    freeEntries_ = entry;
+    size_--;
+  }
+
+  void FramebufferCache::Grow()
+  {
+    slots_.assign(std::max<size_t>(slots_.size() * 2, 16), NONE);
+    const size_t mask = slots_.size() - 1;
+    for (uint32_t entry = 0; entry < entries_.size(); entry++)
+    {
+      if (entries_[entry].fbo == 0)
+      {
+        continue;
+      }
+
+      size_t slot = entries_[entry].hash & mask;
+      while (slots_[slot] != NONE)
+      {
+        slot = (slot + 1) & mask;
+      }
+      slots_[slot] = entry;
+    }
+  }
+
+  void FramebufferCache::Unlink(uint32_t entry)
+  {
+    auto& e = entries_[entry];
+    (e.prev != NONE ? entries_[e.prev].next : mostRecent_) = e.next;
+    (e.next != NONE ? entries_[e.next].prev : leastRecent_) = e.prev;
+    e.prev = NONE;
+    e.next = NONE;
+  }
+
+  void FramebufferCache::LinkFront(uint32_t entry)
+  {
+    auto& e = entries_[entry];
+    e.prev = NONE;
+    e.next = mostRecent_;
+    (mostRecent_ != NONE ? entries_[mostRecent_].prev : leastRecent_) = entry;
+    mostRecent_ = entry;
   }
 } // namespace Fwog::detail
@@ -0,0 +1,324 @@
+// Derived from OffsetAllocator by Sebastian Aaltonen (https://github.com/sebbbi/OffsetAllocator), under this license:
+//
+// MIT License
+//
+// Copyright (c) 2023 Sebastian Aaltonen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Fwog/detail/OffsetAllocator.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace Fwog::detail
+{
+  namespace
+  {
+    constexpr uint32_t MANTISSA_BITS = 3;
+    constexpr uint32_t MANTISSA_VALUE = 1 << MANTISSA_BITS;
+    constexpr uint32_t MANTISSA_MASK = MANTISSA_VALUE - 1;
+
+    // Converts a size to the index of the smallest bin whose sizes are all at least as large.
+    // Used for allocation, so any node found in the bin is large enough.
+    uint32_t SizeToBinRoundUp(uint32_t size)
+    {
+      if (size < MANTISSA_VALUE)
+      {
+        return size;
+      }
+
+      const uint32_t mantissaStartBit = 31 - static_cast<uint32_t>(std::countl_zero(size)) - MANTISSA_BITS;
+      const uint32_t exponent = mantissaStartBit + 1;
+      uint32_t mantissa = (size >> mantissaStartBit) & MANTISSA_MASK;
+      if ((size & ((1u << mantissaStartBit) - 1)) != 0)
+      {
+        mantissa++;
+      }
+
+      // A mantissa that overflows carries into the exponent
+      return (exponent << MANTISSA_BITS) + mantissa;
+    }
+
+    // Converts a size to the index of the largest bin whose sizes are all at most as large.
+    // Used when inserting free nodes.
+    uint32_t SizeToBinRoundDown(uint32_t size)
+    {
+      if (size < MANTISSA_VALUE)
+      {
+        return size;
+      }
+
+      const uint32_t mantissaStartBit = 31 - static_cast<uint32_t>(std::countl_zero(size)) - MANTISSA_BITS;
+      const uint32_t exponent = mantissaStartBit + 1;
+      const uint32_t mantissa = (size >> mantissaStartBit) & MANTISSA_MASK;
+      return (exponent << MANTISSA_BITS) | mantissa;
+    }
+
+    uint32_t BinToSize(uint32_t bin)
+    {
+      const uint32_t exponent = bin >> MANTISSA_BITS;
+      const uint32_t mantissa = bin & MANTISSA_MASK;
+      if (exponent == 0)
+      {
+        return mantissa;
+      }
+      return (mantissa | MANTISSA_VALUE) << (exponent - 1);
+    }
+
+    // Returns the index of the lowest set bit at or after startIndex, or 32 if there is none
+    uint32_t FindLowestSetBitAfter(uint32_t mask, uint32_t startIndex)
+    {
+      if (startIndex >= 32)
+      {
+        return 32;
+      }
+      return static_cast<uint32_t>(std::countr_zero(mask & ~((1u << startIndex) - 1)));
+    }
+  } // namespace
+
+  OffsetAllocator::OffsetAllocator(uint32_t size)
+  {
+    Reset(size);
+  }
+
+  uint32_t OffsetAllocator::RoundUpToBinSize(uint32_t size)
+  {
+    FWOG_ASSERT(size <= BinToSize(LEAF_BIN_COUNT - 1));
+    return BinToSize(SizeToBinRoundUp(size));
+  }
+
+  void OffsetAllocator::Reset(uint32_t size)
+  {
+    size_ = size;
+    freeStorage_ = 0;
+    usedBinsTop_ = 0;
+    usedBins_.fill(0);
+    binHeads_.fill(UNUSED);
+    nodes_.clear();
+    freeNodes_.clear();
+
+    if (size > 0)
+    {
+      InsertNodeIntoBin(size, 0);
+    }
+  }
+
+  OffsetAllocator::Allocation OffsetAllocator::Allocate(uint32_t size)
+  {
+    FWOG_ASSERT(size > 0);
+
+    // Find the first non-empty bin that only has large enough nodes: first in the same top bin, then in larger ones
+    const uint32_t minBinIndex = SizeToBinRoundUp(size);
+    const uint32_t minTopBin = minBinIndex >> MANTISSA_BITS;
+    const uint32_t minLeafBin = minBinIndex & MANTISSA_MASK;
+
+    uint32_t topBin = minTopBin;
+    uint32_t leafBin = 32;
+    if (topBin < TOP_BIN_COUNT && (usedBinsTop_ & (1u << topBin)))
+    {
+      leafBin = FindLowestSetBitAfter(usedBins_[topBin], minLeafBin);
+    }
+
+    if (leafBin == 32)
+    {
+      topBin = FindLowestSetBitAfter(usedBinsTop_, minTopBin + 1);
+      if (topBin == 32)
+      {
+        return {};
+      }
+      leafBin = static_cast<uint32_t>(std::countr_zero(static_cast<uint32_t>(usedBins_[topBin])));
+    }
+
+    const uint32_t binIndex = (topBin << MANTISSA_BITS) | leafBin;
+
+    // Take the first node of the bin
+    const uint32_t nodeIndex = binHeads_[binIndex];
+    const uint32_t nodeTotalSize = nodes_[nodeIndex].size;
+    nodes_[nodeIndex].size = size;
+    nodes_[nodeIndex].isUsed = true;
+
+    binHeads_[binIndex] = nodes_[nodeIndex].binListNext;
+    if (nodes_[nodeIndex].binListNext != UNUSED)
+    {
+      nodes_[nodes_[nodeIndex].binListNext].binListPrev = UNUSED;
+    }
+    nodes_[nodeIndex].binListNext = UNUSED;
+    freeStorage_ -= nodeTotalSize;
+
+    if (binHeads_[binIndex] == UNUSED)
+    {
+      usedBins_[topBin] &= ~(1u << leafBin);
+      if (usedBins_[topBin] == 0)
+      {
+        usedBinsTop_ &= ~(1u << topBin);
+      }
+    }
+
+    // Return the rest of the node to the bins
+    if (const uint32_t remainder = nodeTotalSize - size; remainder > 0)
+    {
+      const uint32_t newNodeIndex = InsertNodeIntoBin(remainder, nodes_[nodeIndex].offset + size);
+
+      const uint32_t neighborNext = nodes_[nodeIndex].neighborNext;
+      if (neighborNext != UNUSED)
+      {
+        nodes_[neighborNext].neighborPrev = newNodeIndex;
+      }
+      nodes_[newNodeIndex].neighborPrev = nodeIndex;
+      nodes_[newNodeIndex].neighborNext = neighborNext;
+      nodes_[nodeIndex].neighborNext = newNodeIndex;
+    }
+
+    return {nodes_[nodeIndex].offset, nodeIndex};
+  }
+
+  void OffsetAllocator::Free(uint32_t nodeIndex)
+  {
+    FWOG_ASSERT(nodeIndex < nodes_.size() && nodes_[nodeIndex].isUsed);
+
+    auto node = nodes_[nodeIndex];
+    uint32_t offset = node.offset;
+    uint32_t size = node.size;
+
+    // Merge with free neighbors
+    if (node.neighborPrev != UNUSED && !nodes_[node.neighborPrev].isUsed)
+    {
+      const auto prev = nodes_[node.neighborPrev];
+      offset = prev.offset;
+      size += prev.size;
+      RemoveNodeFromBin(node.neighborPrev);
+      node.neighborPrev = prev.neighborPrev;
+    }
+
+    if (node.neighborNext != UNUSED && !nodes_[node.neighborNext].isUsed)
+    {
+      const auto next = nodes_[node.neighborNext];
+      size += next.size;
+      RemoveNodeFromBin(node.neighborNext);
+      node.neighborNext = next.neighborNext;
+    }
+
+    freeNodes_.push_back(nodeIndex);
+
+    const uint32_t combinedIndex = InsertNodeIntoBin(size, offset);
+    if (node.neighborNext != UNUSED)
+    {
+      nodes_[combinedIndex].neighborNext = node.neighborNext;
+      nodes_[node.neighborNext].neighborPrev = combinedIndex;
+    }
+    if (node.neighborPrev != UNUSED)
+    {
+      nodes_[combinedIndex].neighborPrev = node.neighborPrev;
+      nodes_[node.neighborPrev].neighborNext = combinedIndex;
+    }
+  }
+
+  uint32_t OffsetAllocator::InsertNodeIntoBin(uint32_t size, uint32_t offset)
+  {
+    const uint32_t binIndex = SizeToBinRoundDown(size);
+    const uint32_t topBin = binIndex >> MANTISSA_BITS;
+    const uint32_t leafBin = binIndex & MANTISSA_MASK;
+
+    if (binHeads_[binIndex] == UNUSED)
+    {
+      usedBins_[topBin] |= static_cast<uint8_t>(1u << leafBin);
+      usedBinsTop_ |= 1u << topBin;
+    }
+
+    uint32_t nodeIndex;
+    if (!freeNodes_.empty())
+    {
+      nodeIndex = freeNodes_.back();
+      freeNodes_.pop_back();
+    }
+    else
+    {
+      nodeIndex = static_cast<uint32_t>(nodes_.size());
+      nodes_.emplace_back();
+    }
+
+    const uint32_t head = binHeads_[binIndex];
+    nodes_[nodeIndex] = Node{.offset = offset, .size = size, .binListNext = head};
+    if (head != UNUSED)
+    {
+      nodes_[head].binListPrev = nodeIndex;
+    }
+    binHeads_[binIndex] = nodeIndex;
+
+    freeStorage_ += size;
+    return nodeIndex;
+  }
+
+  void OffsetAllocator::RemoveNodeFromBin(uint32_t nodeIndex)
+  {
+    const auto& node = nodes_[nodeIndex];
+
+    if (node.binListPrev != UNUSED)
+    {
+      nodes_[node.binListPrev].binListNext = node.binListNext;
+      if (node.binListNext != UNUSED)
+      {
+        nodes_[node.binListNext].binListPrev = node.binListPrev;
+      }
+    }
+    else
+    {
+      // The node is the head of its bin
+      const uint32_t binIndex = SizeToBinRoundDown(node.size);
+      const uint32_t topBin = binIndex >> MANTISSA_BITS;
+      const uint32_t leafBin = binIndex & MANTISSA_MASK;
+
+      binHeads_[binIndex] = node.binListNext;
+      if (node.binListNext != UNUSED)
+      {
+        nodes_[node.binListNext].binListPrev = UNUSED;
+      }
+
+      if (binHeads_[binIndex] == UNUSED)
+      {
+        usedBins_[topBin] &= ~(1u << leafBin);
+        if (usedBins_[topBin] == 0)
+        {
+          usedBinsTop_ &= ~(1u << topBin);
+        }
+      }
+    }
+
+    freeStorage_ -= node.size;
+    freeNodes_.push_back(nodeIndex);
+  }
+
+  OffsetAllocator::StorageReport OffsetAllocator::GetStorageReport() const
+  {
+    uint32_t largestFreeRegion = 0;
+    if (usedBinsTop_ != 0)
+    {
+      // Every node in the highest non-empty bin is larger than the nodes in other bins, but they differ from each other
+      const uint32_t topBin = 31 - static_cast<uint32_t>(std::countl_zero(usedBinsTop_));
+      const uint32_t leafBin = 31 - static_cast<uint32_t>(std::countl_zero(static_cast<uint32_t>(usedBins_[topBin])));
+      for (uint32_t node = binHeads_[(topBin << MANTISSA_BITS) | leafBin]; node != UNUSED; node = nodes_[node].binListNext)
+      {
+        largestFreeRegion = std::max(largestFreeRegion, nodes_[node].size);
+      }
+    }
+
+    return {freeStorage_, largestFreeRegion};
+  }
+} // namespace Fwog::detail
@@ -1,19 +1,51 @@
 #include <Fwog/Exception.h>
 #include <Fwog/Shader.h>
+#include <Fwog/detail/ContextState.h>
 #include <Fwog/detail/PipelineManager.h>
-#include <unordered_map>
+#include <Fwog/detail/ProgramCache.h>
+#include <Fwog/detail/SlotMap.h>
 #include FWOG_OPENGL_HEADER
 
+#include <array>
+#include <chrono>
+#include <initializer_list>
+
 namespace Fwog::detail
 {
   namespace
   {
-    std::unordered_map<GLuint, std::shared_ptr<const GraphicsPipelineInfoOwning>> gGraphicsPipelines;
-    std::unordered_map<GLuint, std::shared_ptr<const ComputePipelineInfoOwning>> gComputePipelines;
+    SlotMap<GraphicsPipelineInfoOwning> gGraphicsPipelines;
+    SlotMap<ComputePipelineInfoOwning> gComputePipelines;
+
+    // A program that is being linked, and what is needed to store it in the program cache when it is done
+    struct ProgramLink
+    {
+      GLuint program;
+
+      // Zero if the program was loaded from the cache or the cache is closed
+      uint64_t programCacheKey;
+      std::array<uint64_t, 4> shaderHashes;
+      uint32_t shaderCount;
+
+      // Time spent creating the program, not counting the time between beginning and finishing the link
+      std::chrono::steady_clock::duration linkDuration;
+    };
+
+    template<class T>
+    struct PendingPipeline
+    {
+      T info;
+      ProgramLink link;
+    };
+
+    // Pipelines whose programs are still being linked
+    SlotMap<PendingPipeline<GraphicsPipelineInfoOwning>> gPendingGraphicsPipelines;
+    SlotMap<PendingPipeline<ComputePipelineInfoOwning>> gPendingComputePipelines;
 
-    GraphicsPipelineInfoOwning MakePipelineInfoOwning(const GraphicsPipelineInfo& info)
+    GraphicsPipelineInfoOwning MakePipelineInfoOwning(GLuint program, const GraphicsPipelineInfo& info)
     {
       return GraphicsPipelineInfoOwning{
+        .program = program,
         .name = std::string(info.name),
         .inputAssemblyState = info.inputAssemblyState,
         .vertexInputState =
@@ -40,125 +72,308 @@ namespace Fwog::detail
               info.colorBlendState.blendConstants[3],
             },
         },
+        .stateBlock = MakePipelineStateBlock(info),
       };
     }
 
-    bool LinkProgram(GLuint program, std::string& outInfoLog)
+    // Returns whether the driver has finished linking a program, without waiting for it
+    bool IsLinkComplete(GLuint program)
     {
-      glLinkProgram(program);
+      if (!context->properties.features.parallelShaderCompile)
+      {
+        return true;
+      }
+
+      GLint complete{};
+      glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &complete);
+      return complete;
+    }
 
+    // Waits for a program to be linked and returns whether it succeeded
+    bool CheckLinkStatus(GLuint program, std::string& outInfoLog)
+    {
       GLint success{};
       glGetProgramiv(program, GL_LINK_STATUS, &success);
-      if (!success)
+      if (success)
+      {
+        return true;
+      }
+
+      // Shaders created without waiting for compilation are first checked here, so include their errors
+      GLuint shaders[5];
+      GLsizei shaderCount{};
+      glGetAttachedShaders(program, 5, &shaderCount, shaders);
+      for (GLsizei i = 0; i < shaderCount; i++)
+      {
+        GLint compiled{};
+        glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &compiled);
+        if (!compiled)
+        {
+          GLchar shaderLog[512];
+          GLsizei length{};
+          glGetShaderInfoLog(shaders[i], sizeof(shaderLog), &length, shaderLog);
+          outInfoLog.append(shaderLog, length);
+        }
+      }
+
+      GLchar programLog[512];
+      GLsizei length{};
+      glGetProgramInfoLog(program, sizeof(programLog), &length, programLog);
+      outInfoLog.append(programLog, length);
+      return false;
+    }
+
+    // Loads a program for the shaders (which may be null) from the program cache, or starts linking it from them
+    ProgramLink BeginLink(std::initializer_list<const Shader*> shaders)
+    {
+      auto link = ProgramLink{};
+      for (const auto* shader : shaders)
+      {
+        if (shader)
+        {
+          link.shaderHashes[link.shaderCount++] = GetSourceHash(*shader);
+        }
+      }
+
+      if (gProgramCache.IsOpen())
+      {
+        const auto key = HashProgramShaders({link.shaderHashes.data(), link.shaderCount});
+        if ((link.program = gProgramCache.LoadProgram(key)) != 0)
+        {
+          // The binary needs no linking, but captures read the sources of the pipeline's shaders from the program
+          for (const auto* shader : shaders)
+          {
+            if (shader)
+            {
+              glAttachShader(link.program, shader->Handle());
+            }
+          }
+          return link;
+        }
+        link.programCacheKey = key;
+      }
+
+      for (const auto* shader : shaders)
+      {
+        if (shader)
+        {
+          CompileIfSkipped(*shader);
+        }
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      link.program = glCreateProgram();
+      for (const auto* shader : shaders)
+      {
+        if (shader)
+        {
+          glAttachShader(link.program, shader->Handle());
+        }
+      }
+
+      if (link.programCacheKey != 0)
+      {
+        glProgramParameteri(link.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      }
+
+      // With GL_KHR_parallel_shader_compile, linking happens on driver threads until the status of the program is
+      // queried
+      glLinkProgram(link.program);
+      link.linkDuration = std::chrono::steady_clock::now() - start;
+      return link;
+    }
+
+    // Waits for a program to be linked and stores it in the program cache if it succeeded
+    bool FinishLink(ProgramLink& link, std::string& outInfoLog)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      if (!CheckLinkStatus(link.program, outInfoLog))
       {
-        const GLsizei length = 512;
-        outInfoLog.resize(length + 1, '\0');
-        glGetProgramInfoLog(program, length, nullptr, outInfoLog.data());
         return false;
       }
 
+      if (link.programCacheKey != 0)
+      {
+        link.linkDuration += std::chrono::steady_clock::now() - start;
+        gProgramCache.StoreProgram(link.programCacheKey,
+                                   link.program,
+                                   {link.shaderHashes.data(), link.shaderCount},
+                                   link.linkDuration);
+      }
       return true;
     }
   } // namespace
 
   uint64_t CompileGraphicsPipelineInternal(const GraphicsPipelineInfo& info)
   {
+    return FinishGraphicsPipelineInternal(BeginGraphicsPipelineInternal(info));
+  }
+
+  uint64_t BeginGraphicsPipelineInternal(const GraphicsPipelineInfo& info)
+  {
+    // Pipelines are stored in process-wide maps, which are not thread-safe
+    FWOG_ASSERT(!context->isWorkerContext && "Pipelines must be created on the main thread");
     FWOG_ASSERT(info.vertexShader && "A graphics pipeline must at least have a vertex shader");
     if (info.tessellationControlShader || info.tessellationEvaluationShader)
     {
       FWOG_ASSERT(info.tessellationControlShader && info.tessellationEvaluationShader &&
                   "Either both or neither tessellation shader can be present");
     }
-    GLuint program = glCreateProgram();
-    glAttachShader(program, info.vertexShader->Handle());
-    if (info.fragmentShader)
-    {
-      glAttachShader(program, info.fragmentShader->Handle());
-    }
+    auto link = BeginLink({
+      info.vertexShader,
+      info.fragmentShader,
+      info.tessellationControlShader,
+      info.tessellationEvaluationShader,
+    });
+    return gPendingGraphicsPipelines.Insert({MakePipelineInfoOwning(link.program, info), link});
+  }
 
-    if (info.tessellationControlShader)
-    {
-      glAttachShader(program, info.tessellationControlShader->Handle());
-    }
+  bool IsGraphicsPipelineReadyInternal(uint64_t pendingPipeline)
+  {
+    auto* pending = gPendingGraphicsPipelines.Get(pendingPipeline);
+    FWOG_ASSERT(pending);
+    return IsLinkComplete(pending->link.program);
+  }
 
-    if (info.tessellationEvaluationShader)
-    {
-      glAttachShader(program, info.tessellationEvaluationShader->Handle());
-    }
+  uint64_t FinishGraphicsPipelineInternal(uint64_t pendingPipeline)
+  {
+    auto* pending = gPendingGraphicsPipelines.Get(pendingPipeline);
+    FWOG_ASSERT(pending);
+    auto pipelineInfo = std::move(pending->info);
+    auto link = pending->link;
+    gPendingGraphicsPipelines.Erase(pendingPipeline);
 
     std::string infolog;
-    if (!LinkProgram(program, infolog))
+    if (!FinishLink(link, infolog))
     {
-      glDeleteProgram(program);
+      glDeleteProgram(pipelineInfo.program);
       throw PipelineCompilationException("Failed to compile graphics pipeline.\n" + infolog);
     }
 
-    auto owning = MakePipelineInfoOwning(info);
-    gGraphicsPipelines.insert({program, std::make_shared<const GraphicsPipelineInfoOwning>(std::move(owning))});
-    return program;
+    // Pipelines with equal vertex input layouts share a VAO, so binding a pipeline only has to compare VAO names
+    pipelineInfo.vertexArray = &context->vaoCache.Acquire(pipelineInfo.vertexInputState);
+
+    return gGraphicsPipelines.Insert(std::move(pipelineInfo));
   }
 
-  std::shared_ptr<const GraphicsPipelineInfoOwning> GetGraphicsPipelineInternal(uint64_t pipeline)
+  void AbandonGraphicsPipelineInternal(uint64_t pendingPipeline)
   {
-    if (auto it = gGraphicsPipelines.find(static_cast<GLuint>(pipeline)); it != gGraphicsPipelines.end())
-    {
-      return it->second;
-    }
-    return nullptr;
+    auto* pending = gPendingGraphicsPipelines.Get(pendingPipeline);
+    FWOG_ASSERT(pending);
+    glDeleteProgram(pending->link.program);
+    gPendingGraphicsPipelines.Erase(pendingPipeline);
+  }
+
+  const GraphicsPipelineInfoOwning* GetGraphicsPipelineInternal(uint64_t pipeline)
+  {
+    return gGraphicsPipelines.Get(pipeline);
   }
 
   void DestroyGraphicsPipelineInternal(uint64_t pipeline)
   {
-    auto it = gGraphicsPipelines.find(static_cast<GLuint>(pipeline));
-    if (it == gGraphicsPipelines.end())
+    auto* pipelineState = gGraphicsPipelines.Get(pipeline);
+    if (!pipelineState)
     {
       // Tried to delete a nonexistent pipeline.
       FWOG_UNREACHABLE;
       return;
     }
 
-    glDeleteProgram(static_cast<GLuint>(pipeline));
-    gGraphicsPipelines.erase(it);
+    glDeleteProgram(pipelineState->program);
+
+    // The VAO is owned by the main context, which is already gone if the pipeline outlives it
+    if (context)
+    {
+      FWOG_ASSERT(!context->isWorkerContext && "Pipelines must be destroyed on the main thread");
+      context->vaoCache.Release(pipelineState->vertexInputState);
+    }
+
+    // The next pipeline to be bound is compared against the last one, so the state of the last one must outlive it
+    if (context && context->lastGraphicsPipeline == pipeline)
+    {
+      context->isLastGraphicsPipelineDestroyed = true;
+      return;
+    }
+
+    gGraphicsPipelines.Erase(pipeline);
+  }
+
+  void SetLastGraphicsPipelineInternal(uint64_t pipeline)
+  {
+    if (context->isLastGraphicsPipelineDestroyed)
+    {
+      gGraphicsPipelines.Erase(context->lastGraphicsPipeline);
+      context->isLastGraphicsPipelineDestroyed = false;
+    }
+
+    context->lastGraphicsPipeline = pipeline;
   }
 
   uint64_t CompileComputePipelineInternal(const ComputePipelineInfo& info)
   {
+    return FinishComputePipelineInternal(BeginComputePipelineInternal(info));
+  }
+
+  uint64_t BeginComputePipelineInternal(const ComputePipelineInfo& info)
+  {
+    FWOG_ASSERT(!context->isWorkerContext && "Pipelines must be created on the main thread");
     FWOG_ASSERT(info.shader);
-    GLuint program = glCreateProgram();
-    glAttachShader(program, info.shader->Handle());
+    auto link = BeginLink({info.shader});
+    return gPendingComputePipelines.Insert({
+      ComputePipelineInfoOwning{.program = link.program, .name = std::string(info.name)},
+      link,
+    });
+  }
+
+  bool IsComputePipelineReadyInternal(uint64_t pendingPipeline)
+  {
+    auto* pending = gPendingComputePipelines.Get(pendingPipeline);
+    FWOG_ASSERT(pending);
+    return IsLinkComplete(pending->link.program);
+  }
+
+  uint64_t FinishComputePipelineInternal(uint64_t pendingPipeline)
+  {
+    auto* pending = gPendingComputePipelines.Get(pendingPipeline);
+    FWOG_ASSERT(pending);
+    auto pipelineInfo = std::move(pending->info);
+    auto link = pending->link;
+    gPendingComputePipelines.Erase(pendingPipeline);
 
     std::string infolog;
-    if (!LinkProgram(program, infolog))
+    if (!FinishLink(link, infolog))
     {
-      glDeleteProgram(program);
+      glDeleteProgram(pipelineInfo.program);
       throw PipelineCompilationException("Failed to compile compute pipeline.\n" + infolog);
     }
 
-    auto owning = ComputePipelineInfoOwning{.name = std::string(info.name)};
-    gComputePipelines.insert({program, std::make_shared<const ComputePipelineInfoOwning>()});
-    return program;
+    return gComputePipelines.Insert(std::move(pipelineInfo));
   }
 
-  std::shared_ptr<const ComputePipelineInfoOwning> GetComputePipelineInternal(uint64_t pipeline)
+  void AbandonComputePipelineInternal(uint64_t pendingPipeline)
   {
-    if (auto it = gComputePipelines.find(static_cast<GLuint>(pipeline)); it != gComputePipelines.end())
-    {
-      return it->second;
-    }
-    return nullptr;
+    auto* pending = gPendingComputePipelines.Get(pendingPipeline);
+    FWOG_ASSERT(pending);
+    glDeleteProgram(pending->link.program);
+    gPendingComputePipelines.Erase(pendingPipeline);
+  }
+
+  const ComputePipelineInfoOwning* GetComputePipelineInternal(uint64_t pipeline)
+  {
+    return gComputePipelines.Get(pipeline);
   }
 
   void DestroyComputePipelineInternal(uint64_t pipeline)
   {
-    auto it = gComputePipelines.find(static_cast<GLuint>(pipeline));
-    if (it == gComputePipelines.end())
+    auto* pipelineState = gComputePipelines.Get(pipeline);
+    if (!pipelineState)
     {
       // Tried to delete a nonexistent pipeline.
       FWOG_UNREACHABLE;
       return;
     }
 
-    glDeleteProgram(static_cast<GLuint>(pipeline));
-    gComputePipelines.erase(it);
+    glDeleteProgram(pipelineState->program);
+    gComputePipelines.Erase(pipeline);
   }
 } // namespace Fwog::detail
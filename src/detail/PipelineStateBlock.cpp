@@ -0,0 +1,99 @@
+#include <Fwog/detail/PipelineStateBlock.h>
+
+#include <bit>
+
+namespace Fwog::detail
+{
+  namespace
+  {
+    uint32_t PackStencilOps(const StencilOpState& state)
+    {
+      return static_cast<uint32_t>(state.failOp) | static_cast<uint32_t>(state.depthFailOp) << 4 |
+             static_cast<uint32_t>(state.passOp) << 8 | static_cast<uint32_t>(state.compareOp) << 12;
+    }
+
+    uint32_t PackBlendAttachment(const ColorBlendAttachmentState& state)
+    {
+      // The factors and ops are ignored by GL when blending is disabled, but they are still emitted, so they are packed
+      // regardless of blendEnable
+      return static_cast<uint32_t>(state.blendEnable) | static_cast<uint32_t>(state.srcColorBlendFactor) << 1 |
+             static_cast<uint32_t>(state.dstColorBlendFactor) << 6 | static_cast<uint32_t>(state.colorBlendOp) << 11 |
+             static_cast<uint32_t>(state.srcAlphaBlendFactor) << 14 |
+             static_cast<uint32_t>(state.dstAlphaBlendFactor) << 19 | static_cast<uint32_t>(state.alphaBlendOp) << 24;
+    }
+  } // namespace
+
+  PipelineStateBlock MakePipelineStateBlock(const GraphicsPipelineInfo& info)
+  {
+    using B = PipelineStateBlock;
+    const auto& inputAssemblyState = info.inputAssemblyState;
+    const auto& tessellationState = info.tessellationState;
+    const auto& rasterizationState = info.rasterizationState;
+    const auto& multisampleState = info.multisampleState;
+    const auto& depthState = info.depthState;
+    const auto& stencilState = info.stencilState;
+    const auto& colorBlendState = info.colorBlendState;
+    FWOG_ASSERT(colorBlendState.attachments.size() <= MAX_COLOR_ATTACHMENTS);
+
+    auto block = PipelineStateBlock{};
+    auto& w = block.words;
+
+    uint32_t enables = 0;
+    auto setEnable = [&enables](B::EnableBit bit, bool enable)
+    {
+      if (enable)
+      {
+        enables |= bit;
+      }
+    };
+    setEnable(B::PRIMITIVE_RESTART_BIT, inputAssemblyState.primitiveRestartEnable);
+    setEnable(B::DEPTH_CLAMP_BIT, rasterizationState.depthClampEnable);
+    setEnable(B::CULL_FACE_BIT, rasterizationState.cullMode != CullMode::NONE);
+    setEnable(B::POLYGON_OFFSET_FILL_BIT, rasterizationState.depthBiasEnable);
+    setEnable(B::POLYGON_OFFSET_LINE_BIT, rasterizationState.depthBiasEnable);
+    setEnable(B::POLYGON_OFFSET_POINT_BIT, rasterizationState.depthBiasEnable);
+    setEnable(B::SAMPLE_SHADING_BIT, multisampleState.sampleShadingEnable);
+    setEnable(B::SAMPLE_MASK_BIT, multisampleState.sampleMask != 0xFFFFFFFF);
+    setEnable(B::SAMPLE_ALPHA_TO_COVERAGE_BIT, multisampleState.alphaToCoverageEnable);
+    setEnable(B::SAMPLE_ALPHA_TO_ONE_BIT, multisampleState.alphaToOneEnable);
+    setEnable(B::DEPTH_TEST_BIT, depthState.depthTestEnable);
+    setEnable(B::STENCIL_TEST_BIT, stencilState.stencilTestEnable);
+    setEnable(B::COLOR_LOGIC_OP_BIT, colorBlendState.logicOpEnable);
+    setEnable(B::BLEND_BIT, !colorBlendState.attachments.empty());
+    w[B::ENABLES] = enables;
+
+    w[B::POLYGON_MODE] = static_cast<uint32_t>(rasterizationState.polygonMode);
+    w[B::CULL_FACE] = static_cast<uint32_t>(rasterizationState.cullMode);
+    w[B::FRONT_FACE] = static_cast<uint32_t>(rasterizationState.frontFace);
+    w[B::DEPTH_BIAS_SLOPE] = std::bit_cast<uint32_t>(rasterizationState.depthBiasSlopeFactor);
+    w[B::DEPTH_BIAS_CONSTANT] = std::bit_cast<uint32_t>(rasterizationState.depthBiasConstantFactor);
+    w[B::LINE_WIDTH] = std::bit_cast<uint32_t>(rasterizationState.lineWidth);
+    w[B::POINT_SIZE] = std::bit_cast<uint32_t>(rasterizationState.pointSize);
+    w[B::PATCH_CONTROL_POINTS] = tessellationState.patchControlPoints;
+    w[B::MIN_SAMPLE_SHADING] = std::bit_cast<uint32_t>(multisampleState.minSampleShading);
+    w[B::SAMPLE_MASK] = multisampleState.sampleMask;
+    w[B::DEPTH_FUNC] = static_cast<uint32_t>(depthState.depthCompareOp);
+    w[B::LOGIC_OP] = static_cast<uint32_t>(colorBlendState.logicOp);
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+      w[B::BLEND_CONSTANTS + i] = std::bit_cast<uint32_t>(colorBlendState.blendConstants[i]);
+    }
+
+    w[B::STENCIL_FRONT + 0] = PackStencilOps(stencilState.front);
+    w[B::STENCIL_FRONT + 1] = stencilState.front.reference;
+    w[B::STENCIL_FRONT + 2] = stencilState.front.compareMask;
+    w[B::STENCIL_BACK + 0] = PackStencilOps(stencilState.back);
+    w[B::STENCIL_BACK + 1] = stencilState.back.reference;
+    w[B::STENCIL_BACK + 2] = stencilState.back.compareMask;
+
+    for (uint32_t i = 0; i < MAX_COLOR_ATTACHMENTS; i++)
+    {
+      w[B::BLEND_ATTACHMENTS + i] = i < colorBlendState.attachments.size()
+                                      ? PackBlendAttachment(colorBlendState.attachments[i])
+                                      : B::UNUSED_ATTACHMENT;
+    }
+
+    return block;
+  }
+} // namespace Fwog::detail
@@ -0,0 +1,358 @@
+#include "Fwog/detail/ProgramCache.h"
+#include FWOG_OPENGL_HEADER
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace Fwog::detail
+{
+  namespace
+  {
+    // "FWPC" when read as bytes
+    constexpr uint32_t FILE_MAGIC = 0x43505746;
+
+    // Incremented when the layout of the file changes, so old files are ignored
+    constexpr uint32_t FILE_VERSION = 1;
+
+    // File layout, in native byte order:
+    // uint32 magic, uint32 version, uint64 driver hash, uint32 shader count, uint32 program count
+    // Each shader: uint64 hash, uint32 compile microseconds
+    // Each program: uint64 key, uint32 binary format, uint32 link microseconds, uint32 binary size, binary
+
+    // FNV-1a, which is simple and gives the same result on every platform
+    uint64_t Fnv1a(uint64_t hash, const void* data, size_t size)
+    {
+      const auto* bytes = static_cast<const unsigned char*>(data);
+      for (size_t i = 0; i < size; i++)
+      {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+      }
+      return hash;
+    }
+
+    constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+
+    uint32_t ToMicroseconds(std::chrono::nanoseconds duration)
+    {
+      const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+      return static_cast<uint32_t>(std::clamp<int64_t>(microseconds, 0, UINT32_MAX));
+    }
+
+    // Reads values from the contents of a file, failing instead of reading past its end
+    class FileReader
+    {
+    public:
+      explicit FileReader(std::span<const std::byte> bytes) : bytes_(bytes) {}
+
+      template<class T>
+      bool Read(T& value)
+      {
+        return Read(std::as_writable_bytes(std::span(&value, 1)));
+      }
+
+      bool Read(std::span<std::byte> out)
+      {
+        if (out.size() > bytes_.size() - offset_)
+        {
+          return false;
+        }
+        std::memcpy(out.data(), bytes_.data() + offset_, out.size());
+        offset_ += out.size();
+        return true;
+      }
+
+    private:
+      std::span<const std::byte> bytes_;
+      size_t offset_ = 0;
+    };
+
+    template<class T>
+    void Write(std::vector<std::byte>& out, const T& value)
+    {
+      auto bytes = std::as_bytes(std::span(&value, 1));
+      out.insert(out.end(), bytes.begin(), bytes.end());
+    }
+  } // namespace
+
+  uint64_t HashShaderSource(uint32_t stage, std::string_view source)
+  {
+    return Fnv1a(Fnv1a(FNV_OFFSET_BASIS, &stage, sizeof(stage)), source.data(), source.size());
+  }
+
+  uint64_t HashProgramShaders(std::span<const uint64_t> shaderHashes)
+  {
+    return Fnv1a(FNV_OFFSET_BASIS, shaderHashes.data(), shaderHashes.size_bytes());
+  }
+
+  void ProgramCache::Open(std::string_view path, const DeviceProperties& properties)
+  {
+    FWOG_ASSERT(!isOpen_);
+    statistics_ = {};
+
+    // Some drivers (e.g., for debugging) support no binary formats, in which case there is nothing to cache
+    GLint binaryFormatCount{};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatCount);
+    if (binaryFormatCount == 0)
+    {
+      return;
+    }
+
+    path_ = std::string(path);
+    driverHash_ = FNV_OFFSET_BASIS;
+    for (auto string : {properties.vendor, properties.renderer, properties.version})
+    {
+      // Include the terminator, so moving characters between strings changes the hash
+      driverHash_ = Fnv1a(driverHash_, string.data(), string.size() + 1);
+    }
+    isOpen_ = true;
+
+    if (!Read())
+    {
+      shaders_.clear();
+      programs_.clear();
+    }
+  }
+
+  bool ProgramCache::Read()
+  {
+    auto file = std::ifstream(path_, std::ios::binary);
+    if (!file)
+    {
+      return false;
+    }
+
+    auto contents = std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    auto reader = FileReader(std::as_bytes(std::span(contents)));
+
+    uint32_t magic{};
+    uint32_t version{};
+    uint64_t driverHash{};
+    uint32_t shaderCount{};
+    uint32_t programCount{};
+    if (!reader.Read(magic) || !reader.Read(version) || !reader.Read(driverHash) || !reader.Read(shaderCount) ||
+        !reader.Read(programCount) || magic != FILE_MAGIC || version != FILE_VERSION || driverHash != driverHash_)
+    {
+      return false;
+    }
+
+    for (uint32_t i = 0; i < shaderCount; i++)
+    {
+      uint64_t hash{};
+      uint32_t compileMicroseconds{};
+      if (!reader.Read(hash) || !reader.Read(compileMicroseconds))
+      {
+        return false;
+      }
+      shaders_[hash] = compileMicroseconds;
+    }
+
+    for (uint32_t i = 0; i < programCount; i++)
+    {
+      uint64_t key{};
+      uint32_t binarySize{};
+      auto entry = ProgramEntry{};
+      if (!reader.Read(key) || !reader.Read(entry.binaryFormat) || !reader.Read(entry.linkMicroseconds) ||
+          !reader.Read(binarySize) || binarySize > contents.size())
+      {
+        return false;
+      }
+
+      entry.binary.resize(binarySize);
+      if (!reader.Read(std::span(entry.binary)))
+      {
+        return false;
+      }
+      programs_[key] = std::move(entry);
+    }
+
+    return true;
+  }
+
+  bool ProgramCache::Save()
+  {
+    std::lock_guard lock(mutex_);
+    if (!isOpen_ || !isDirty_)
+    {
+      return true;
+    }
+
+    auto contents = std::vector<std::byte>();
+    Write(contents, FILE_MAGIC);
+    Write(contents, FILE_VERSION);
+    Write(contents, driverHash_);
+    Write(contents, static_cast<uint32_t>(shaders_.size()));
+    Write(contents, static_cast<uint32_t>(programs_.size()));
+    for (const auto& [hash, compileMicroseconds] : shaders_)
+    {
+      Write(contents, hash);
+      Write(contents, compileMicroseconds);
+    }
+    for (const auto& [key, entry] : programs_)
+    {
+      Write(contents, key);
+      Write(contents, entry.binaryFormat);
+      Write(contents, entry.linkMicroseconds);
+      Write(contents, static_cast<uint32_t>(entry.binary.size()));
+      contents.insert(contents.end(), entry.binary.begin(), entry.binary.end());
+    }
+
+    // Write to another file first, so the cache isn't left truncated if the program exits while writing
+    const auto tempPath = path_ + ".tmp";
+    {
+      auto file = std::ofstream(tempPath, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+      if (!file)
+      {
+        return false;
+      }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path_, error);
+    if (error)
+    {
+      std::filesystem::remove(tempPath, error);
+      return false;
+    }
+
+    isDirty_ = false;
+    return true;
+  }
+
+  void ProgramCache::Close()
+  {
+    Save();
+
+    std::lock_guard lock(mutex_);
+    isOpen_ = false;
+    isDirty_ = false;
+    path_.clear();
+    shaders_.clear();
+    pendingShaders_.clear();
+    programs_.clear();
+  }
+
+  bool ProgramCache::SkipShaderCompile(uint64_t shaderHash)
+  {
+    std::lock_guard lock(mutex_);
+    auto it = shaders_.find(shaderHash);
+    if (it == shaders_.end())
+    {
+      return false;
+    }
+
+    statistics_.skippedShaderCompiles++;
+    statistics_.millisecondsSaved += it->second / 1000.0;
+    return true;
+  }
+
+  void ProgramCache::RecordShaderCompile(uint64_t shaderHash, std::chrono::nanoseconds duration)
+  {
+    std::lock_guard lock(mutex_);
+    if (isOpen_ && !shaders_.contains(shaderHash))
+    {
+      pendingShaders_[shaderHash] = ToMicroseconds(duration);
+    }
+  }
+
+  void ProgramCache::RecordSkippedShaderCompiled(uint64_t shaderHash)
+  {
+    std::lock_guard lock(mutex_);
+    if (auto it = shaders_.find(shaderHash); it != shaders_.end())
+    {
+      statistics_.skippedShaderCompiles--;
+      statistics_.millisecondsSaved -= it->second / 1000.0;
+    }
+  }
+
+  uint32_t ProgramCache::LoadProgram(uint64_t key)
+  {
+    std::lock_guard lock(mutex_);
+    if (!isOpen_)
+    {
+      return 0;
+    }
+
+    auto it = programs_.find(key);
+    if (it == programs_.end())
+    {
+      statistics_.misses++;
+      return 0;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto& entry = it->second;
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, entry.binaryFormat, entry.binary.data(), static_cast<GLsizei>(entry.binary.size()));
+
+    // Drivers reject binaries that they can no longer load (e.g., after an update that didn't change the version
+    // string), in which case the program is linked from source and stored again
+    GLint success{};
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+      glDeleteProgram(program);
+      programs_.erase(it);
+      isDirty_ = true;
+      statistics_.rejectedBinaries++;
+      statistics_.misses++;
+      return 0;
+    }
+
+    const auto loadMicroseconds = ToMicroseconds(std::chrono::steady_clock::now() - start);
+    statistics_.hits++;
+    statistics_.millisecondsSaved += (static_cast<double>(entry.linkMicroseconds) - loadMicroseconds) / 1000.0;
+    return program;
+  }
+
+  void ProgramCache::StoreProgram(uint64_t key,
+                                  uint32_t program,
+                                  std::span<const uint64_t> shaderHashes,
+                                  std::chrono::nanoseconds linkDuration)
+  {
+    if (!isOpen_)
+    {
+      return;
+    }
+
+    GLint binaryLength{};
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (binaryLength <= 0)
+    {
+      return;
+    }
+
+    auto entry = ProgramEntry{.binaryFormat = 0, .linkMicroseconds = ToMicroseconds(linkDuration)};
+    entry.binary.resize(static_cast<size_t>(binaryLength));
+    GLenum binaryFormat{};
+    glGetProgramBinary(program, binaryLength, nullptr, &binaryFormat, entry.binary.data());
+    entry.binaryFormat = binaryFormat;
+
+    std::lock_guard lock(mutex_);
+    for (auto hash : shaderHashes)
+    {
+      // Shaders that skipped compilation are already in shaders_
+      if (auto it = pendingShaders_.find(hash); it != pendingShaders_.end())
+      {
+        shaders_[hash] = it->second;
+        pendingShaders_.erase(it);
+      }
+      else
+      {
+        shaders_.try_emplace(hash, 0);
+      }
+    }
+
+    programs_[key] = std::move(entry);
+    isDirty_ = true;
+  }
+
+  ProgramCacheStatistics ProgramCache::GetStatistics() const
+  {
+    std::lock_guard lock(mutex_);
+    return statistics_;
+  }
+} // namespace Fwog::detail
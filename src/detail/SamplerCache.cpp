@@ -1,140 +1,324 @@
 #include "Fwog/detail/SamplerCache.h"
 #include "Fwog/detail/ApiToEnum.h"
-#include "Fwog/detail/Hash.h"
 #include "Fwog/detail/ContextState.h"
 #include FWOG_OPENGL_HEADER
 
+#include <algorithm>
+#include <bit>
+
 namespace Fwog::detail
 {
-  Sampler SamplerCache::CreateOrGetCachedTextureSampler(const SamplerState& samplerState)
+  namespace
   {
-    if (auto it = samplerCache_.find(samplerState); it != samplerCache_.end())
-    {
-      return it->second;
-    }
+    // LODs are stored in 13 bits as signed fixed-point numbers with 8 fractional bits
+    constexpr uint32_t LOD_BITS = 13;
+    constexpr float LOD_SCALE = 256;
+    constexpr int32_t LOD_MIN = -(1 << (LOD_BITS - 1));
+    constexpr int32_t LOD_MAX = (1 << (LOD_BITS - 1)) - 1;
 
-    uint32_t sampler{};
-    glCreateSamplers(1, &sampler);
-
-    glSamplerParameteri(sampler,
-                        GL_TEXTURE_COMPARE_MODE,
-                        samplerState.compareEnable ? GL_COMPARE_REF_TO_TEXTURE : GL_NONE);
-
-    glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_FUNC, detail::CompareOpToGL(samplerState.compareOp));
+    // The layout of a sampler key. Min and mag filters only need one bit, as NONE samples like NEAREST.
+    struct PackedSamplerState
+    {
+      uint64_t valid : 1; // Always set, so no key is zero
+      uint64_t minFilterLinear : 1;
+      uint64_t magFilterLinear : 1;
+      uint64_t mipmapFilter : 2;
+      uint64_t addressModeU : 3;
+      uint64_t addressModeV : 3;
+      uint64_t addressModeW : 3;
+      uint64_t borderColor : 3;
+      uint64_t anisotropyLog2 : 3;
+      uint64_t compareEnable : 1;
+      uint64_t compareOp : 3; // NEVER if comparison is disabled
+      uint64_t lodBias : LOD_BITS;
+      uint64_t minLod : LOD_BITS;
+      uint64_t maxLod : LOD_BITS;
+    };
 
-    GLint magFilter = samplerState.magFilter == Filter::LINEAR ? GL_LINEAR : GL_NEAREST;
-    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, magFilter);
+    static_assert(sizeof(PackedSamplerState) == sizeof(uint64_t));
 
-    GLint minFilter{};
-    switch (samplerState.mipmapFilter)
+    uint64_t QuantizeLod(float lod)
     {
-    case Filter::NONE:
-      minFilter = samplerState.minFilter == Filter::LINEAR ? GL_LINEAR : GL_NEAREST;
-      break;
-    case Filter::NEAREST:
-      minFilter = samplerState.minFilter == Filter::LINEAR ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST;
-      break;
-    case Filter::LINEAR:
-      minFilter = samplerState.minFilter == Filter::LINEAR ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR;
-      break;
-    default: FWOG_UNREACHABLE;
+      // Offset to be non-negative, so truncating rounds to the nearest step
+      const auto clamped = std::clamp(lod, LOD_MIN / LOD_SCALE, LOD_MAX / LOD_SCALE);
+      return static_cast<uint64_t>(clamped * LOD_SCALE - LOD_MIN + 0.5f);
     }
-    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, minFilter);
-
-    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, detail::AddressModeToGL(samplerState.addressModeU));
-    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, detail::AddressModeToGL(samplerState.addressModeV));
-    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, detail::AddressModeToGL(samplerState.addressModeW));
 
-    // TODO: determine whether int white values should be 1 or 255
-    switch (samplerState.borderColor)
+    float DequantizeLod(uint64_t bits)
     {
-    case BorderColor::FLOAT_TRANSPARENT_BLACK:
-    {
-      constexpr GLfloat color[4]{0, 0, 0, 0};
-      glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, color);
-      break;
+      return (static_cast<int32_t>(bits) + LOD_MIN) / LOD_SCALE;
     }
-    case BorderColor::INT_TRANSPARENT_BLACK:
+
+    // Spreads the bits of a key over the low bits used to index the table
+    size_t HashKey(uint64_t key)
     {
-      constexpr GLint color[4]{0, 0, 0, 0};
-      glSamplerParameteriv(sampler, GL_TEXTURE_BORDER_COLOR, color);
-      break;
+      key ^= key >> 33;
+      key *= 0xff51afd7ed558ccdull;
+      key ^= key >> 33;
+      return static_cast<size_t>(key);
     }
-    case BorderColor::FLOAT_OPAQUE_BLACK:
+
+    uint32_t CreateSampler(const SamplerState& samplerState)
     {
-      constexpr GLfloat color[4]{0, 0, 0, 1};
-      glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, color);
-      break;
+      uint32_t sampler{};
+      glCreateSamplers(1, &sampler);
+
+      glSamplerParameteri(sampler,
+                          GL_TEXTURE_COMPARE_MODE,
+                          samplerState.compareEnable ? GL_COMPARE_REF_TO_TEXTURE : GL_NONE);
+
+      glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_FUNC, detail::CompareOpToGL(samplerState.compareOp));
+
+      GLint magFilter = samplerState.magFilter == Filter::LINEAR ? GL_LINEAR : GL_NEAREST;
+      glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, magFilter);
+
+      GLint minFilter{};
+      switch (samplerState.mipmapFilter)
+      {
+      case Filter::NONE:
+        minFilter = samplerState.minFilter == Filter::LINEAR ? GL_LINEAR : GL_NEAREST;
+        break;
+      case Filter::NEAREST:
+        minFilter = samplerState.minFilter == Filter::LINEAR ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST;
+        break;
+      case Filter::LINEAR:
+        minFilter = samplerState.minFilter == Filter::LINEAR ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR;
+        break;
+      default: FWOG_UNREACHABLE;
+      }
+      glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, minFilter);
+
+      glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, detail::AddressModeToGL(samplerState.addressModeU));
+      glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, detail::AddressModeToGL(samplerState.addressModeV));
+      glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, detail::AddressModeToGL(samplerState.addressModeW));
+
+      // TODO: determine whether int white values should be 1 or 255
+      switch (samplerState.borderColor)
+      {
+      case BorderColor::FLOAT_TRANSPARENT_BLACK:
+      {
+        constexpr GLfloat color[4]{0, 0, 0, 0};
+        glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, color);
+        break;
+      }
+      case BorderColor::INT_TRANSPARENT_BLACK:
+      {
+        constexpr GLint color[4]{0, 0, 0, 0};
+        glSamplerParameteriv(sampler, GL_TEXTURE_BORDER_COLOR, color);
+        break;
+      }
+      case BorderColor::FLOAT_OPAQUE_BLACK:
+      {
+        constexpr GLfloat color[4]{0, 0, 0, 1};
+        glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, color);
+        break;
+      }
+      case BorderColor::INT_OPAQUE_BLACK:
+      {
+        // constexpr GLint color[4]{ 0, 0, 0, 255 };
+        constexpr GLint color[4]{0, 0, 0, 1};
+        glSamplerParameteriv(sampler, GL_TEXTURE_BORDER_COLOR, color);
+        break;
+      }
+      case BorderColor::FLOAT_OPAQUE_WHITE:
+      {
+        constexpr GLfloat color[4]{1, 1, 1, 1};
+        glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, color);
+        break;
+      }
+      case BorderColor::INT_OPAQUE_WHITE:
+      {
+        // constexpr GLint color[4]{ 255, 255, 255, 255 };
+        constexpr GLint color[4]{1, 1, 1, 1};
+        glSamplerParameteriv(sampler, GL_TEXTURE_BORDER_COLOR, color);
+        break;
+      }
+      default: FWOG_UNREACHABLE; break;
+      }
+
+      glSamplerParameterf(sampler,
+                          GL_TEXTURE_MAX_ANISOTROPY,
+                          static_cast<GLfloat>(detail::SampleCountToGL(samplerState.anisotropy)));
+
+      glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, samplerState.lodBias);
+
+      glSamplerParameterf(sampler, GL_TEXTURE_MIN_LOD, samplerState.minLod);
+
+      glSamplerParameterf(sampler, GL_TEXTURE_MAX_LOD, samplerState.maxLod);
+
+      detail::InvokeVerboseMessageCallback("Created sampler with handle ", sampler);
+      return sampler;
     }
-    case BorderColor::INT_OPAQUE_BLACK:
+  } // namespace
+
+  uint64_t PackSamplerState(const SamplerState& samplerState)
+  {
+    const auto packed = PackedSamplerState{
+      .valid = 1,
+      .minFilterLinear = samplerState.minFilter == Filter::LINEAR,
+      .magFilterLinear = samplerState.magFilter == Filter::LINEAR,
+      .mipmapFilter = static_cast<uint64_t>(samplerState.mipmapFilter),
+      .addressModeU = static_cast<uint64_t>(samplerState.addressModeU),
+      .addressModeV = static_cast<uint64_t>(samplerState.addressModeV),
+      .addressModeW = static_cast<uint64_t>(samplerState.addressModeW),
+      .borderColor = static_cast<uint64_t>(samplerState.borderColor),
+      .anisotropyLog2 = static_cast<uint64_t>(std::countr_zero(static_cast<uint32_t>(samplerState.anisotropy))),
+      .compareEnable = samplerState.compareEnable,
+      .compareOp = samplerState.compareEnable ? static_cast<uint64_t>(samplerState.compareOp) : 0,
+      .lodBias = QuantizeLod(samplerState.lodBias),
+      .minLod = QuantizeLod(samplerState.minLod),
+      .maxLod = QuantizeLod(samplerState.maxLod),
+    };
+    return std::bit_cast<uint64_t>(packed);
+  }
+
+  SamplerState UnpackSamplerState(uint64_t key)
+  {
+    const auto packed = std::bit_cast<PackedSamplerState>(key);
+    return SamplerState{
+      .lodBias = DequantizeLod(packed.lodBias),
+      .minLod = DequantizeLod(packed.minLod),
+      .maxLod = DequantizeLod(packed.maxLod),
+      .minFilter = packed.minFilterLinear ? Filter::LINEAR : Filter::NEAREST,
+      .magFilter = packed.magFilterLinear ? Filter::LINEAR : Filter::NEAREST,
+      .mipmapFilter = static_cast<Filter>(packed.mipmapFilter),
+      .addressModeU = static_cast<AddressMode>(packed.addressModeU),
+      .addressModeV = static_cast<AddressMode>(packed.addressModeV),
+      .addressModeW = static_cast<AddressMode>(packed.addressModeW),
+      .borderColor = static_cast<BorderColor>(packed.borderColor),
+      .anisotropy = static_cast<SampleCount>(1u << packed.anisotropyLog2),
+      .compareEnable = packed.compareEnable != 0,
+      .compareOp = static_cast<CompareOp>(packed.compareOp),
+    };
+  }
+
+  Sampler SamplerCache::CreateOrGetCachedTextureSampler(const SamplerState& samplerState)
+  {
+    const auto key = PackSamplerState(samplerState);
+    if (const auto* table = table_.load(std::memory_order_acquire))
     {
-      // constexpr GLint color[4]{ 0, 0, 0, 255 };
-      constexpr GLint color[4]{0, 0, 0, 1};
-      glSamplerParameteriv(sampler, GL_TEXTURE_BORDER_COLOR, color);
-      break;
+      if (auto sampler = Find(*table, key); sampler != 0)
+      {
+        if (context)
+        {
+          FWOG_COUNT(samplerCache.hits, 1);
+        }
+        return Sampler(sampler);
+      }
     }
-    case BorderColor::FLOAT_OPAQUE_WHITE:
+
+    FWOG_ASSERT(context && "Creating a sampler requires a context on the calling thread");
+
+    auto lock = std::lock_guard(mutex_);
+
+    // Another thread may have created the sampler, or grown the table, since the lookup above
+    auto* table = table_.load(std::memory_order_relaxed);
+    if (table)
     {
-      constexpr GLfloat color[4]{1, 1, 1, 1};
-      glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, color);
-      break;
+      if (auto sampler = Find(*table, key); sampler != 0)
+      {
+        FWOG_COUNT(samplerCache.hits, 1);
+        return Sampler(sampler);
+      }
     }
-    case BorderColor::INT_OPAQUE_WHITE:
+
+    FWOG_COUNT(samplerCache.misses, 1);
+
+    const auto sampler = CreateSampler(UnpackSamplerState(key));
+
+    const auto size = size_.load(std::memory_order_relaxed);
+    if (!table || (size + 1) * 2 > table->mask + 1)
     {
-      // constexpr GLint color[4]{ 255, 255, 255, 255 };
-      constexpr GLint color[4]{1, 1, 1, 1};
-      glSamplerParameteriv(sampler, GL_TEXTURE_BORDER_COLOR, color);
-      break;
+      // Readers may still be probing the old table, so the entries are copied to a new one, which is then published
+      auto& newTable = tables_.emplace_back(std::make_unique<Table>(table ? (table->mask + 1) * 2 : 64));
+      if (table)
+      {
+        for (size_t i = 0; i <= table->mask; i++)
+        {
+          if (const auto oldKey = table->slots[i].key.load(std::memory_order_relaxed); oldKey != 0)
+          {
+            Insert(*newTable, oldKey, table->slots[i].sampler.load(std::memory_order_relaxed));
+          }
+        }
+      }
+      Insert(*newTable, key, sampler);
+      table_.store(newTable.get(), std::memory_order_release);
     }
-    default: FWOG_UNREACHABLE; break;
+    else
+    {
+      Insert(*table, key, sampler);
     }
 
-    glSamplerParameterf(sampler,
-                        GL_TEXTURE_MAX_ANISOTROPY,
-                        static_cast<GLfloat>(detail::SampleCountToGL(samplerState.anisotropy)));
-
-    glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, samplerState.lodBias);
+    size_.store(size + 1, std::memory_order_relaxed);
+    return Sampler(sampler);
+  }
 
-    glSamplerParameterf(sampler, GL_TEXTURE_MIN_LOD, samplerState.minLod);
+  size_t SamplerCache::Size() const
+  {
+    return size_.load(std::memory_order_relaxed);
+  }
 
-    glSamplerParameterf(sampler, GL_TEXTURE_MAX_LOD, samplerState.maxLod);
+  std::optional<SamplerState> SamplerCache::FindSamplerState(uint32_t sampler) const
+  {
+    if (const auto* table = table_.load(std::memory_order_acquire))
+    {
+      for (size_t i = 0; i <= table->mask; i++)
+      {
+        const auto key = table->slots[i].key.load(std::memory_order_acquire);
+        if (key != 0 && table->slots[i].sampler.load(std::memory_order_relaxed) == sampler)
+        {
+          return UnpackSamplerState(key);
+        }
+      }
+    }
+    return std::nullopt;
+  }
 
-    detail::InvokeVerboseMessageCallback("Created sampler with handle ", sampler);
+  void SamplerCache::Clear()
+  {
+    auto lock = std::lock_guard(mutex_);
+    if (const auto* table = table_.load(std::memory_order_relaxed))
+    {
+      for (size_t i = 0; i <= table->mask; i++)
+      {
+        if (table->slots[i].key.load(std::memory_order_relaxed) != 0)
+        {
+          const auto sampler = table->slots[i].sampler.load(std::memory_order_relaxed);
+          detail::InvokeVerboseMessageCallback("Destroyed sampler with handle ", sampler);
+          glDeleteSamplers(1, &sampler);
+        }
+      }
+    }
 
-    return samplerCache_.insert({samplerState, Sampler(sampler)}).first->second;
+    table_.store(nullptr, std::memory_order_relaxed);
+    tables_.clear();
+    size_.store(0, std::memory_order_relaxed);
   }
 
-  size_t SamplerCache::Size() const
+  uint32_t SamplerCache::Find(const Table& table, uint64_t key)
   {
-    return samplerCache_.size();
+    for (size_t slot = HashKey(key) & table.mask;; slot = (slot + 1) & table.mask)
+    {
+      const auto slotKey = table.slots[slot].key.load(std::memory_order_acquire);
+      if (slotKey == key)
+      {
+        return table.slots[slot].sampler.load(std::memory_order_relaxed);
+      }
+      if (slotKey == 0)
+      {
+        return 0;
+      }
+    }
   }
 
-  void SamplerCache::Clear()
+  void SamplerCache::Insert(Table& table, uint64_t key, uint32_t sampler)
   {
-    for (const auto& [_, sampler] : samplerCache_)
+    size_t slot = HashKey(key) & table.mask;
+    while (table.slots[slot].key.load(std::memory_order_relaxed) != 0)
     {
-      detail::InvokeVerboseMessageCallback("Destroyed sampler with handle ", sampler.id_);
-      glDeleteSamplers(1, &sampler.id_);
+      slot = (slot + 1) & table.mask;
     }
-
-    samplerCache_.clear();
+    table.slots[slot].sampler.store(sampler, std::memory_order_relaxed);
+    table.slots[slot].key.store(key, std::memory_order_release);
   }
 } // namespace Fwog::detail
-
-std::size_t std::hash<Fwog::SamplerState>::operator()(const Fwog::SamplerState& k) const noexcept
-{
-  auto rtup = std::make_tuple(k.minFilter,
-                              k.magFilter,
-                              k.mipmapFilter,
-                              k.addressModeU,
-                              k.addressModeV,
-                              k.addressModeW,
-                              k.borderColor,
-                              k.anisotropy,
-                              k.compareEnable,
-                              k.compareOp,
-                              k.lodBias,
-                              k.minLod,
-                              k.maxLod);
-  return Fwog::detail::hashing::hash<decltype(rtup)>{}(rtup);
-}
@@ -8,31 +8,31 @@
 
 namespace Fwog::detail
 {
-  namespace
+  size_t VertexInputStateHash::operator()(const VertexInputStateOwning& inputState) const
   {
-    size_t VertexInputStateHash(const VertexInputStateOwning& k)
-    {
-      size_t hashVal{};
-
-      for (const auto& desc : k.vertexBindingDescriptions)
-      {
-        auto cctup = std::make_tuple(desc.location, desc.binding, desc.format, desc.offset);
-        auto chashVal = Fwog::detail::hashing::hash<decltype(cctup)>{}(cctup);
-        Fwog::detail::hashing::hash_combine(hashVal, chashVal);
-      }
+    size_t hashVal{};
 
-      return hashVal;
+    for (const auto& desc : inputState.vertexBindingDescriptions)
+    {
+      auto cctup = std::make_tuple(desc.location, desc.binding, desc.format, desc.offset);
+      auto chashVal = Fwog::detail::hashing::hash<decltype(cctup)>{}(cctup);
+      Fwog::detail::hashing::hash_combine(hashVal, chashVal);
     }
-  } // namespace
 
-  uint32_t VertexArrayCache::CreateOrGetCachedVertexArray(const VertexInputStateOwning& inputState)
+    return hashVal;
+  }
+
+  CachedVertexArray& VertexArrayCache::Acquire(const VertexInputStateOwning& inputState)
   {
-    auto inputHash = VertexInputStateHash(inputState);
-    if (auto it = vertexArrayCache_.find(inputHash); it != vertexArrayCache_.end())
+    if (auto it = vertexArrayCache_.find(inputState); it != vertexArrayCache_.end())
     {
+      FWOG_COUNT(vertexArrayCache.hits, 1);
+      it->second.pipelineCount++;
       return it->second;
     }
 
+    FWOG_COUNT(vertexArrayCache.misses, 1);
+
     uint32_t vao{};
     glCreateVertexArrays(1, &vao);
     for (uint32_t i = 0; i < inputState.vertexBindingDescriptions.size(); i++)
@@ -56,17 +56,73 @@ namespace Fwog::detail
 
     detail::InvokeVerboseMessageCallback("Created vertex array with handle ", vao);
 
-    return vertexArrayCache_.insert({inputHash, vao}).first->second;
+    auto maxBindings = static_cast<size_t>(context->properties.limits.maxVertexAttribBindings);
+    return vertexArrayCache_
+      .emplace(inputState,
+               CachedVertexArray{
+                 .id = vao,
+                 .bindings = {.vertexBuffers = BindingSlots<VertexBufferBinding>(maxBindings)},
+                 .pipelineCount = 1,
+               })
+      .first->second;
+  }
+
+  void VertexArrayCache::Release(const VertexInputStateOwning& inputState)
+  {
+    auto it = vertexArrayCache_.find(inputState);
+    FWOG_ASSERT(it != vertexArrayCache_.end() && it->second.pipelineCount > 0);
+    if (--it->second.pipelineCount > 0)
+    {
+      return;
+    }
+
+    // The name of a deleted VAO can be reused, so it must not be mistaken for the current one
+    if (context->currentVao == it->second.id)
+    {
+      context->currentVao = 0;
+      context->currentVertexArrayBindings = nullptr;
+    }
+
+    detail::InvokeVerboseMessageCallback("Destroyed vertex array with handle ", it->second.id);
+    glDeleteVertexArrays(1, &it->second.id);
+    vertexArrayCache_.erase(it);
   }
 
   void VertexArrayCache::Clear()
   {
-    for (auto [_, vao] : vertexArrayCache_)
+    for (const auto& [_, vao] : vertexArrayCache_)
     {
-      detail::InvokeVerboseMessageCallback("Destroyed vertex array with handle ", vao);
-      glDeleteVertexArrays(1, &vao);
+      detail::InvokeVerboseMessageCallback("Destroyed vertex array with handle ", vao.id);
+      glDeleteVertexArrays(1, &vao.id);
     }
 
     vertexArrayCache_.clear();
   }
+
+  void VertexArrayCache::RemoveBuffer(uint32_t buffer)
+  {
+    for (auto& [_, vao] : vertexArrayCache_)
+    {
+      auto& vertexBuffers = vao.bindings.vertexBuffers;
+      for (uint32_t i = 0; i < static_cast<uint32_t>(vertexBuffers.bound.size()); i++)
+      {
+        if (vertexBuffers.bound[i].buffer == buffer)
+        {
+          glVertexArrayVertexBuffer(vao.id, i, 0, 0, 0);
+          vertexBuffers.bound[i] = {};
+        }
+
+        if (vertexBuffers.pending[i].buffer == buffer)
+        {
+          vertexBuffers.pending[i] = {};
+        }
+      }
+
+      if (vao.bindings.indexBuffer == buffer)
+      {
+        glVertexArrayElementBuffer(vao.id, 0);
+        vao.bindings.indexBuffer = 0;
+      }
+    }
+  }
 } // namespace Fwog::detail
@@ -0,0 +1,73 @@
+// Checks that texture clears and blits are replayed from a capture, and that calls the capture cannot replay are
+// reported by the replayer.
+
+#include "Check.h"
+
+#include <Fwog/Capture.h>
+#include <Fwog/Context.h>
+#include <Fwog/HeadlessContext.h>
+#include <Fwog/OffscreenSwapchain.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Texture.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+int main()
+{
+  auto context = Fwog::HeadlessContext();
+  Fwog::Initialize();
+
+  {
+    constexpr uint32_t size = 4;
+    auto pixels = std::vector<std::byte>();
+    auto swapchain = Fwog::OffscreenSwapchain({
+      .extent = {size, size},
+      .format = Fwog::Format::R8G8B8A8_UNORM,
+      .depthStencilFormat = std::nullopt,
+      .imageCount = 1,
+      .onFrameReady = [&pixels](const Fwog::OffscreenFrame& frame)
+      { pixels.assign(frame.pixels.begin(), frame.pixels.end()); },
+    });
+
+    auto texture = Fwog::CreateTexture2D({size, size}, Fwog::Format::R8G8B8A8_UNORM);
+    constexpr auto red = std::array<uint8_t, 4>{255, 0, 0, 255};
+
+    Fwog::BeginCapture();
+    texture.ClearImage({.format = Fwog::UploadFormat::RGBA, .type = Fwog::UploadType::UBYTE, .data = red.data()});
+    Fwog::BlitTextureToSwapchain(texture, {}, {}, {size, size, 1}, {size, size, 1}, Fwog::Filter::NEAREST);
+    texture.GenMipmaps();
+    const auto capture = Fwog::EndCapture();
+
+    auto replayer = Fwog::CaptureReplayer(capture);
+    const auto unrecorded = replayer.GetUnrecordedCalls();
+    CHECK(unrecorded.size() == 1);
+    CHECK(!unrecorded.empty() && unrecorded[0] == "Texture::GenMipmaps");
+
+    // Only the replay can make the swapchain red again. The replayer's texture starts out undefined, so the replayed
+    // clear is needed as well as the blit.
+    Fwog::RenderToSwapchain(
+      {
+        .viewport = {.drawRect = {{0, 0}, {size, size}}},
+        .colorLoadOp = Fwog::AttachmentLoadOp::CLEAR,
+        .clearColorValue = {0.0f, 0.0f, 0.0f, 1.0f},
+      },
+      [] {});
+    replayer.ReplayFrame();
+    swapchain.Present();
+    swapchain.Flush();
+
+    CHECK(pixels.size() == size * size * 4);
+    bool allRed = !pixels.empty();
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+      allRed &= static_cast<uint8_t>(pixels[i]) == 255 && static_cast<uint8_t>(pixels[i + 1]) == 0;
+    }
+    CHECK(allRed);
+  }
+
+  Fwog::Terminate();
+  return gFailedChecks == 0 ? 0 : 1;
+}
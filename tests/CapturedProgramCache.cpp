@@ -0,0 +1,121 @@
+// Checks that a pipeline whose program was loaded from the program cache can be captured and replayed.
+
+#include "Check.h"
+
+#include <Fwog/Capture.h>
+#include <Fwog/Context.h>
+#include <Fwog/HeadlessContext.h>
+#include <Fwog/OffscreenSwapchain.h>
+#include <Fwog/Pipeline.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Shader.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace
+{
+  constexpr auto vertexSource = R"(
+#version 450 core
+void main()
+{
+  vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+  constexpr auto fragmentSource = R"(
+#version 450 core
+layout(location = 0) out vec4 o_color;
+void main()
+{
+  o_color = vec4(0.0, 1.0, 0.0, 1.0);
+}
+)";
+
+  Fwog::GraphicsPipeline CreatePipeline()
+  {
+    const auto vertexShader = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER, vertexSource);
+    const auto fragmentShader = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER, fragmentSource);
+    constexpr auto colorAttachment = Fwog::ColorBlendAttachmentState{};
+    return Fwog::GraphicsPipeline({
+      .vertexShader = &vertexShader,
+      .fragmentShader = &fragmentShader,
+      .colorBlendState = {.attachments = {&colorAttachment, 1}},
+    });
+  }
+} // namespace
+
+int main()
+{
+  auto context = Fwog::HeadlessContext();
+  const auto cachePath = (std::filesystem::temp_directory_path() / "fwog_test_captured_program_cache.bin").string();
+  std::filesystem::remove(cachePath);
+
+  // The first run links the program and stores it in the cache
+  Fwog::Initialize({.programCachePath = cachePath});
+  {
+    auto pipeline = CreatePipeline();
+  }
+  Fwog::Terminate();
+
+  // The second run loads the program from the cache
+  Fwog::Initialize({.programCachePath = cachePath});
+  {
+    auto pipeline = CreatePipeline();
+    const auto statistics = Fwog::GetProgramCacheStatistics();
+    CHECK(statistics.hits == 1);
+    CHECK(statistics.misses == 0);
+
+    constexpr uint32_t size = 4;
+    auto pixels = std::vector<std::byte>();
+    auto swapchain = Fwog::OffscreenSwapchain({
+      .extent = {size, size},
+      .format = Fwog::Format::R8G8B8A8_UNORM,
+      .depthStencilFormat = std::nullopt,
+      .imageCount = 1,
+      .onFrameReady = [&pixels](const Fwog::OffscreenFrame& frame)
+      { pixels.assign(frame.pixels.begin(), frame.pixels.end()); },
+    });
+
+    const auto renderInfo = Fwog::SwapchainRenderInfo{
+      .viewport = {.drawRect = {{0, 0}, {size, size}}},
+      .colorLoadOp = Fwog::AttachmentLoadOp::CLEAR,
+      .clearColorValue = {0.0f, 0.0f, 0.0f, 1.0f},
+    };
+
+    Fwog::BeginCapture();
+    Fwog::RenderToSwapchain(renderInfo,
+                            [&]
+                            {
+                              Fwog::Cmd::BindGraphicsPipeline(pipeline);
+                              Fwog::Cmd::Draw(3, 1, 0, 0);
+                            });
+    const auto capture = Fwog::EndCapture();
+
+    // The replayer compiles the pipeline from the shader sources in the capture, so it can only draw if they were
+    // recorded
+    auto replayer = Fwog::CaptureReplayer(capture);
+    CHECK(replayer.GetUnrecordedCalls().empty());
+    Fwog::RenderToSwapchain(renderInfo, [] {});
+    replayer.ReplayFrame();
+    swapchain.Present();
+    swapchain.Flush();
+
+    CHECK(pixels.size() == size * size * 4);
+    bool allGreen = !pixels.empty();
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+      allGreen &= static_cast<uint8_t>(pixels[i]) == 0 && static_cast<uint8_t>(pixels[i + 1]) == 255;
+    }
+    CHECK(allGreen);
+  }
+  Fwog::Terminate();
+
+  std::filesystem::remove(cachePath);
+  return gFailedChecks == 0 ? 0 : 1;
+}
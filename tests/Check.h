@@ -0,0 +1,16 @@
+#pragma once
+// A minimal assertion helper for the tests. Each test is an executable that returns nonzero if any check failed.
+
+#include <cstdio>
+
+inline int gFailedChecks = 0;
+
+#define CHECK(expr)                                                                  \
+  do                                                                                 \
+  {                                                                                  \
+    if (!(expr))                                                                     \
+    {                                                                                \
+      std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+      gFailedChecks++;                                                               \
+    }                                                                                \
+  } while (false)
@@ -0,0 +1,72 @@
+// Checks the state change counts reported by RenderQueue::Submit. Packets without commands make no OpenGL calls, so
+// this runs without a context.
+
+#include "Check.h"
+
+#include <Fwog/RenderQueue.h>
+
+#include <cstdint>
+#include <initializer_list>
+
+namespace
+{
+  void Submit(Fwog::RenderQueue& queue, std::initializer_list<uint64_t> keys)
+  {
+    queue.Clear();
+    for (auto key : keys)
+    {
+      queue.Enqueue(key, [](Fwog::CommandBuffer&) {});
+    }
+    queue.Submit();
+  }
+
+  void SortingSavesChanges()
+  {
+    using Fwog::RenderQueue;
+    auto queue = RenderQueue();
+    Submit(queue,
+           {
+             RenderQueue::MakeSortKey(0, 0, 0, 0),
+             RenderQueue::MakeSortKey(1, 0, 0, 0),
+             RenderQueue::MakeSortKey(0, 0, 0, 0),
+             RenderQueue::MakeSortKey(1, 0, 0, 0),
+           });
+
+    const auto& stats = queue.GetStatistics();
+    CHECK(stats.packetCount == 4);
+    CHECK(stats.pipelineChanges == 2);
+    CHECK(stats.pipelineChangesAvoided == 2);
+    CHECK(stats.vertexInputChanges == 1);
+    CHECK(stats.vertexInputChangesAvoided == 0);
+  }
+
+  // Sorting by pipeline splits up the runs of vertex input state, so it causes more vertex input changes than it avoids
+  void SortingAddsChanges()
+  {
+    using Fwog::RenderQueue;
+    auto queue = RenderQueue();
+    Submit(queue,
+           {
+             RenderQueue::MakeSortKey(0, 1, 0, 0),
+             RenderQueue::MakeSortKey(1, 1, 0, 0),
+             RenderQueue::MakeSortKey(0, 2, 0, 0),
+             RenderQueue::MakeSortKey(1, 2, 0, 0),
+           });
+
+    const auto& stats = queue.GetStatistics();
+    CHECK(stats.pipelineChanges == 2);
+    CHECK(stats.pipelineChangesAvoided == 2);
+    CHECK(stats.vertexInputChanges == 4);
+    CHECK(stats.vertexInputChangesAvoided < 0);
+    CHECK(stats.vertexInputChangesAvoided == -2);
+    CHECK(stats.materialChanges == 1);
+    CHECK(stats.materialChangesAvoided == 0);
+  }
+} // namespace
+
+int main()
+{
+  SortingSavesChanges();
+  SortingAddsChanges();
+  return gFailedChecks == 0 ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+// Checks that UploadQueue copies tightly packed rows of any size, and rejects rows that don't fit in a staging buffer.
+
+#include "Check.h"
+
+#include <Fwog/Context.h>
+#include <Fwog/Exception.h>
+#include <Fwog/HeadlessContext.h>
+#include <Fwog/Texture.h>
+#include <Fwog/UploadQueue.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glad/gl.h>
+
+namespace
+{
+  // Rows of an R8 texture with a width of 5 are not multiples of 4 bytes
+  void UnalignedRows()
+  {
+    constexpr uint32_t width = 5;
+    constexpr uint32_t height = 3;
+    auto texture = Fwog::CreateTexture2D({width, height}, Fwog::Format::R8_UNORM);
+
+    auto pixels = std::vector<std::byte>(width * height);
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+      pixels[i] = static_cast<std::byte>(i + 1);
+    }
+
+    // Small staging buffers split the upload into several copies
+    auto queue = Fwog::UploadQueue({.stagingBufferSize = 32, .stagingBufferCount = 2});
+    auto handle = queue.UploadTexture({
+      .texture = texture,
+      .extent = {width, height, 1},
+      .format = Fwog::UploadFormat::R,
+      .type = Fwog::UploadType::UBYTE,
+      .data = pixels,
+    });
+    queue.Flush();
+    CHECK(queue.IsComplete(handle));
+
+    auto readback = std::vector<std::byte>(pixels.size());
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    const auto size = static_cast<GLsizei>(readback.size());
+    glGetTextureImage(texture.Handle(), 0, GL_RED, GL_UNSIGNED_BYTE, size, readback.data());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    CHECK(readback == pixels);
+  }
+
+  void RowLargerThanStagingBuffer()
+  {
+    auto texture = Fwog::CreateTexture2D({64, 1}, Fwog::Format::R8_UNORM);
+    auto pixels = std::vector<std::byte>(64);
+    auto queue = Fwog::UploadQueue({.stagingBufferSize = 32, .stagingBufferCount = 1});
+
+    bool threw = false;
+    try
+    {
+      (void)queue.UploadTexture({.texture = texture, .extent = {64, 1, 1}, .data = pixels});
+    }
+    catch (const Fwog::Exception&)
+    {
+      threw = true;
+    }
+    CHECK(threw);
+    CHECK(queue.GetStatistics().pendingUploads == 0);
+  }
+} // namespace
+
+int main()
+{
+  auto context = Fwog::HeadlessContext();
+  Fwog::Initialize();
+
+  UnalignedRows();
+  RowLargerThanStagingBuffer();
+
+  Fwog::Terminate();
+  return gFailedChecks == 0 ? 0 : 1;
+}
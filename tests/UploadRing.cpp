@@ -0,0 +1,49 @@
+// Checks that UploadRing returns an empty allocation instead of overflowing the current frame's region.
+
+#include "Check.h"
+
+#include <Fwog/Context.h>
+#include <Fwog/HeadlessContext.h>
+#include <Fwog/UploadRing.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+int main()
+{
+  auto context = Fwog::HeadlessContext();
+  Fwog::Initialize();
+
+  {
+    constexpr uint32_t frameSize = 1024;
+    auto ring = Fwog::UploadRing({.frameSize = frameSize, .frameCount = 2});
+
+    for (int frame = 0; frame < 2; frame++)
+    {
+      ring.BeginFrame();
+
+      const auto first = ring.Allocate(frameSize / 2);
+      CHECK(first);
+
+      const auto overflow = ring.Allocate(frameSize);
+      CHECK(!overflow);
+      CHECK(overflow.data == nullptr);
+
+      const auto data = std::vector<std::byte>(frameSize);
+      CHECK(!ring.Upload(std::span(data)));
+
+      // The failed allocations did not use up the region
+      const auto second = ring.Allocate(16);
+      CHECK(second);
+      CHECK(second.offset + second.size <= first.offset + frameSize);
+      CHECK(ring.GetStatistics().bytesUsed <= frameSize);
+
+      ring.EndFrame();
+    }
+  }
+
+  Fwog::Terminate();
+  return gFailedChecks == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+// Checks that resources created on a worker context can be handed to the main context with a fence, and that
+// resources destroyed on a worker context are deleted by the main context.
+
+#include "Check.h"
+
+#include <Fwog/Buffer.h>
+#include <Fwog/Context.h>
+#include <Fwog/Fence.h>
+#include <Fwog/HeadlessContext.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Texture.h>
+
+#include <array>
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <thread>
+
+#include <glad/gl.h>
+
+namespace
+{
+  constexpr auto expected = std::array<uint32_t, 4>{1, 2, 3, 4};
+
+  struct Handoff
+  {
+    Fwog::Buffer buffer;
+    Fwog::Fence fence;
+  };
+
+  struct Deleted
+  {
+    uint32_t buffer;
+    uint32_t texture;
+    uint32_t newBuffer;
+  };
+
+  void Worker(const Fwog::HeadlessContext& mainContext,
+              std::promise<Handoff>& handoff,
+              std::future<Fwog::Buffer> returned,
+              std::promise<Deleted>& deleted)
+  {
+    auto context = Fwog::HeadlessContext({.shareContext = &mainContext});
+    Fwog::CreateWorkerContext();
+
+    {
+      auto buffer = Fwog::Buffer(sizeof(expected), Fwog::BufferStorageFlag::DYNAMIC_STORAGE);
+      buffer.UpdateData(expected);
+      auto fence = Fwog::Fence();
+      fence.Signal();
+      handoff.set_value({std::move(buffer), std::move(fence)});
+    }
+
+    // Destroy the buffer the main thread handed back, and a texture, then create a buffer that could reuse a name
+    {
+      auto buffer = std::optional(returned.get());
+      auto texture = std::optional(Fwog::CreateTexture2D({4, 4}, Fwog::Format::R8G8B8A8_UNORM));
+      auto result = Deleted{buffer->Handle(), texture->Handle(), 0};
+      buffer.reset();
+      texture.reset();
+      auto newBuffer = Fwog::Buffer(16);
+      result.newBuffer = newBuffer.Handle();
+      deleted.set_value(result);
+    }
+
+    Fwog::DestroyWorkerContext();
+  }
+} // namespace
+
+int main()
+{
+  auto mainContext = Fwog::HeadlessContext();
+  Fwog::Initialize();
+
+  {
+    auto handoff = std::promise<Handoff>();
+    auto returned = std::promise<Fwog::Buffer>();
+    auto deleted = std::promise<Deleted>();
+    auto worker =
+      std::thread(Worker, std::cref(mainContext), std::ref(handoff), returned.get_future(), std::ref(deleted));
+
+    auto [buffer, fence] = handoff.get_future().get();
+    CHECK(fence.Wait() == Fwog::FenceStatus::SIGNALED);
+
+    auto data = std::array<uint32_t, 4>{};
+    glGetNamedBufferSubData(buffer.Handle(), 0, sizeof(data), data.data());
+    CHECK(data == expected);
+
+    returned.set_value(std::move(buffer));
+    const auto names = deleted.get_future().get();
+    worker.join();
+
+    // The main context has not deleted them yet, so their names cannot have been reused
+    CHECK(glIsBuffer(names.buffer));
+    CHECK(glIsTexture(names.texture));
+    CHECK(names.newBuffer != names.buffer);
+
+    Fwog::Compute("Deferred deletions", [] {});
+    CHECK(!glIsBuffer(names.buffer));
+    CHECK(!glIsTexture(names.texture));
+  }
+
+  Fwog::Terminate();
+  return gFailedChecks == 0 ? 0 : 1;
+}